@@ -1 +1 @@
-
+CONFIG += c++14
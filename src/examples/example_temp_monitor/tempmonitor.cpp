@@ -30,6 +30,8 @@ TempMonitor::TempMonitor(const QString & serialPort, QObject *parent) :
     xbee_success = m_xbee->open();
     Q_ASSERT(xbee_success);
 
+    updatePollTemplate();
+
     connect(&m_pollingTimer, SIGNAL(timeout()),
             this, SLOT(timerTriggered()));
     connect(m_xbee, SIGNAL(receivedRxResponse16(QtXBee::Wpan::RxResponse16*)),
@@ -59,6 +61,7 @@ float TempMonitor::maxTemperature() const
 void TempMonitor::setTempSensorAddress(const quint16 address)
 {
     m_sensorAddr = address;
+    updatePollTemplate();
 }
 
 void TempMonitor::start(const uint pollingTime)
@@ -73,23 +76,32 @@ void TempMonitor::stop()
 
 void TempMonitor::timerTriggered()
 {
+    // A poll not sent within a period is useless: the next one replaces it
+    m_xbee->sendAsync(&m_pollTemplate, m_pollingTimer.interval(), m_pollKey);
+}
+
+void TempMonitor::updatePollTemplate()
+{
+    // The poll frame only changes with the sensor address: assemble it once,
+    // each poll then only patches the frame id and the checksum.
     QtXBee::Wpan::TxRequest16 req;
     req.setDestinationAddress(m_sensorAddr);
     req.setData("temp");
 
-    m_xbee->sendAsync(&req);
+    m_pollTemplate.setRequest(&req);
+    m_pollKey = QByteArray("poll temp ") + QByteArray::number(m_sensorAddr);
 }
 
 void TempMonitor::onPacketReceived(QtXBee::Wpan::RxResponse16 * packet)
 {
-    QByteArray data;
     float_sensor_result result;
     float temperature;
 
-    data = packet->data();
+    // Read the payload in place, in the received frame
+    const QtXBee::ByteSlice data = packet->payload();
 
     if(data.size() == 4) {
-        memcpy(&result.bytes, data.data(), 4);
+        memcpy(&result.bytes, data.constData(), 4);
 
         temperature = result.value;
         qDebug("Temp: %f°C", temperature);
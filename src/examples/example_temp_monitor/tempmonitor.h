@@ -4,6 +4,8 @@
 #include <QObject>
 #include <QTimer>
 
+#include <FrameTemplate>
+
 namespace QtXBee {
 class XBee;
 namespace Wpan {
@@ -41,9 +43,13 @@ private slots:
     void onPacketReceived(QtXBee::Wpan::RxResponse16*);
 
 private:
+    void updatePollTemplate();
+
     QtXBee::XBee *m_xbee;
     quint16 m_sensorAddr;
     QTimer m_pollingTimer;
+    QtXBee::FrameTemplate m_pollTemplate;
+    QByteArray m_pollKey;
     float m_currentTemp;
     float m_minTemp;
     float m_maxTemp;
@@ -1,83 +1,86 @@
-#include <XBee.h>
+// xbeecodec.h links to src/qtxb/codec/xbeecodec.h: the frames are encoded and decoded
+// by the same code as in the QtXBee library.
+// On Windows, git checks symbolic links out as plain text files unless core.symlinks is
+// enabled (which needs the developer mode): copy src/qtxb/codec/xbeecodec.h over
+// xbee_temp_sensor/xbeecodec.h before building the sketch.
+//
+// The XBee runs in API mode 2 (AP=2, escaped frames), as with the xbee-arduino library.
+#include "xbeecodec.h"
 #include <OneWire.h>
 
+using namespace QtXBee;
+
 #define PAYLOAD_SIZE sizeof(float)
+#define REQUEST      "temp"
 
 typedef union {
     float float_variable;
     uint8_t bytes_array[4];
 } float_sensor_result;
 
-uint8_t *data                   = NULL; // received data
-size_t data_len                 = 0;    // recevied data length
-uint8_t option                  = 0;    // received packet option
-uint8_t payload[PAYLOAD_SIZE]   = {0};  // data to be sent (4bytes (sizeof(float)=32bits))
 int DS18S20_Pin                 = 2;    // DS18S20 Signal pin on digital 2
 
 //Temperature chip i/o
 OneWire ds(DS18S20_Pin); // on digital pin 2
 
-XBee xbee = XBee();
-XBeeResponse response = XBeeResponse();
-Rx16Response rx16 = Rx16Response();
-Rx64Response rx64 = Rx64Response();
-Tx16Request tx = Tx16Request(0x0, &payload[0], PAYLOAD_SIZE);
+Codec::FrameParser<64> parser;          // received frames (API mode 2)
+uint8_t tx[Codec::frameSize(Codec::Layout::TxRequest16::Data, PAYLOAD_SIZE)];
+uint8_t txEscaped[2*sizeof(tx)];        // every byte but the start delimiter may be escaped
 
 float getTemp(bool * success = NULL);
 
 void setup() {
     Serial.begin(9600);
-    xbee.setSerial(Serial);
+    parser.setEscaped(true);
 }
 
-void loop() {
+void handleData(const uint8_t * data, size_t data_len) {
     bool temp_success = false;
-    xbee.readPacket();
-    if (xbee.getResponse().isAvailable()) {
-        if (xbee.getResponse().getApiId() == RX_16_RESPONSE || xbee.getResponse().getApiId() == RX_64_RESPONSE) {
-            if (xbee.getResponse().getApiId() == RX_16_RESPONSE) {
-                xbee.getResponse().getRx16Response(rx16);
-                option = rx16.getOption();
-                data = rx16.getData();
-                data_len = rx16.getDataLength();
-            } else {
-                xbee.getResponse().getRx64Response(rx64);
-                option = rx64.getOption();
-                data = rx64.getData();
-                data_len = rx64.getDataLength();
-            }
-            if(NULL != data) {
-                Serial.println("Received");
-                Serial.write(data, data_len);
-                Serial.println("");
-                if(strcmp((char*)data, "temp") == 0) {
-                    Serial.println("Temp request");
-                    float temp = getTemp(&temp_success);
-                    if(!temp_success) {
-                        Serial.println("Failed to get temperature !!!");
-                        return;
-                    }
-                    Serial.print("Temp: ");
-                    Serial.print(temp, sizeof(float));
-                    Serial.println("°C");
-                    float_sensor_result res;
-                    res.float_variable = temp;
-                    memcpy(&payload, &res.bytes_array[0], PAYLOAD_SIZE);
-
-                    xbee.send(tx);
-                }
-            }
-            else {
-                Serial.println("Failed to get data");
-            }
+
+    Serial.println("Received");
+    Serial.write(data, data_len);
+    Serial.println("");
+    // The payload isn't null-terminated
+    if(data_len != strlen(REQUEST) || memcmp(data, REQUEST, data_len) != 0) {
+        return;
+    }
+
+    Serial.println("Temp request");
+    float temp = getTemp(&temp_success);
+    if(!temp_success) {
+        Serial.println("Failed to get temperature !!!");
+        return;
+    }
+    Serial.print("Temp: ");
+    Serial.print(temp, sizeof(float));
+    Serial.println("°C");
+    float_sensor_result res;
+    res.float_variable = temp;
+
+    const size_t size = Codec::encodeTxRequest16(tx, sizeof(tx), 0x01, 0x0000, 0,
+                                                 &res.bytes_array[0], PAYLOAD_SIZE);
+    Serial.write(txEscaped, Codec::escape(tx, size, txEscaped, sizeof(txEscaped)));
+}
+
+void loop() {
+    while(Serial.available() > 0) {
+        if(!parser.push((uint8_t)Serial.read())) {
+            continue;
+        }
+
+        const Codec::FrameView frame = parser.view();
+        if(frame.apiId() == Codec::Rx16ResponseId) {
+            handleData(frame.data(Codec::Layout::Rx16Response::Data),
+                       frame.dataSize(Codec::Layout::Rx16Response::Data));
+        }
+        else if(frame.apiId() == Codec::Rx64ResponseId) {
+            handleData(frame.data(Codec::Layout::Rx64Response::Data),
+                       frame.dataSize(Codec::Layout::Rx64Response::Data));
         }
         else {
             //Serial.println("Ignoring received packet");
         }
     }
-    else {
-        //Serial.println("No data");
-    }
 }
 
 //returns the temperature from one DS18S20 in DEG Celsius
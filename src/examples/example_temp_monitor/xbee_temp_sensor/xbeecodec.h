@@ -0,0 +1 @@
+../../../qtxb/codec/xbeecodec.h
\ No newline at end of file
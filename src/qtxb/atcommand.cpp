@@ -19,6 +19,8 @@
  */
 
 #include "ATCommand"
+#include "ATParameter"
+#include "codec/XBeeCodec"
 
 #include <QDebug>
 
@@ -29,7 +31,8 @@ namespace QtXBee {
  * @param parent
  */
 ATCommand::ATCommand(QObject *parent) :
-    XBeePacket(parent)
+    XBeePacket(parent),
+    m_command(ATUndefined)
 {
     setFrameType(ATCommandId);
     setFrameId(0x01);
@@ -83,17 +86,15 @@ QByteArray ATCommand::parameter() const
 
 void ATCommand::assemblePacket()
 {
-    m_packet.clear();
-    m_packet.append(frameType());
-    m_packet.append(frameId());
-    m_packet.append(atCommandToByteArray(command()));
-    m_packet.append(parameter());
-    setLength(m_packet.size());
-    createChecksum(m_packet);
-    m_packet.append(checksum());
-    m_packet.insert(0, startDelimiter());
-    m_packet.insert(1, (length()>>8)&0xFF);
-    m_packet.insert(2, length()&0xFF);
+    const QByteArray at = atCommandToByteArray(command());
+    const QByteArray param = parameter();
+    m_packet.resize(Codec::frameSize(Codec::Layout::ATCommand::Data, param.size()));
+    // Not Codec::encodeATCommand(): ATCommandQueueParam shares this encoder
+    setEncodedSize(Codec::FrameWriter(encodeBuffer(), m_packet.size())
+                   .begin(frameType(), frameId())
+                   .put(at.constData(), at.size())
+                   .put(param.constData(), param.size())
+                   .finish());
 }
 
 QString ATCommand::toString()
@@ -122,12 +123,12 @@ void ATCommand::clear()
 /**
  * @brief Returns the given ATCommand::ATCommand into QString
  * @param command the ATCommand to be converted into QString
- * @return the given ATCommand into QString
+ * @return the given ATCommand into QString; or an empty string if the command is unknown.
+ * @sa ATParameter::find()
  */
 QString ATCommand::atCommandToString(const ATCommandType command)
 {
-    QString at(atCommandToByteArray(command));
-    return at;
+    return ATParameter::isKnown(command) ? QString(atCommandToByteArray(command)) : QString();
 }
 
 /**
@@ -146,14 +147,15 @@ QByteArray ATCommand::atCommandToByteArray(const ATCommandType command)
 /**
  * @brief Returns the ATCommand::ATCommand corresponding to the given QByteArray
  * @param command
- * @return the ATCommand::ATCommand corresponding to the given QByteArray.
+ * @return the ATCommand::ATCommand corresponding to the given QByteArray; or ATCommand::ATUndefined if unknown.
+ * @sa ATParameter::commandFromCode()
  */
 ATCommand::ATCommandType ATCommand::atCommandFromByteArray(const QByteArray &command)
 {
-    ATCommand::ATCommandType at;
-    at = (ATCommand::ATCommandType) ( ( (command.at(0)&0xFF)<<8) + command.at(1) );
-
-    return at;
+    if(command.size() != 2) {
+        return ATUndefined;
+    }
+    return ATParameter::commandFromCode(((quint8)command.at(0) << 8) | (quint8)command.at(1));
 }
 
 } // END namepsace
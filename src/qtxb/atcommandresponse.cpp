@@ -19,6 +19,7 @@
  */
 
 #include "ATCommandResponse"
+#include "codec/XBeeCodec"
 #include <QDebug>
 
 namespace QtXBee {
@@ -43,7 +44,6 @@ ATCommandResponse::ATCommandResponse(const QByteArray &packet, QObject *parent)
 bool ATCommandResponse::parseApiSpecificData(const QByteArray &data)
 {
     QByteArray at;
-    int i;
     if(data.size() < 3) {
         qDebug() << Q_FUNC_INFO << "bad packet";
         return false;
@@ -53,9 +53,8 @@ bool ATCommandResponse::parseApiSpecificData(const QByteArray &data)
     at.append(data.at(2));
     setATCommand(at);
     setStatus((Status)(unsigned char)data.at(3));
-    for(i=4; i<data.size();i++) {
-        m_data.append(data.at(i));
-    }
+    // The value is sliced from the packet on access
+    setDataOffset(Codec::Layout::ATCommandResponse::Data);
 
     return true;
 }
@@ -155,8 +154,8 @@ QString ATCommandResponse::toString()
     str.append(QString("AT command      : %1 (0x%2)\n").arg(ATCommand::atCommandToString(m_atCommand)).arg(QString::number(m_atCommand, 16)));
     str.append(QString("Start delimiter : 0x%1\n").arg(QString::number(startDelimiter(), 16)));
     str.append(QString("Length          : %1 bytes\n").arg(length()));
-    if(!m_data.isEmpty())
-    str.append(QString("Data            : 0x%1\n").arg(QString(m_data.toHex())));
+    if(!payload().isEmpty())
+    str.append(QString("Data            : 0x%1\n").arg(QString(payload().toHex())));
     else
     str.append(QString("Data            : No data\n"));
     str.append(QString("Checksum        : %1\n").arg(checksum()));
@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2015 ThomArmax (Thomas COIN)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * Thomas COIN <esvcorp@gmail.com> 18/04/2015
+ */
+
+#include "ATParameter"
+
+#include <QDebug>
+
+namespace QtXBee {
+
+/**
+ * @brief Returns true if the given value is in the parameter's range; false otherwise.
+ *
+ * For signed parameters, @a value holds the two's complement representation of the signed value.
+ * @param value
+ */
+bool ATParameter::inRange(const quint64 value) const
+{
+    if(isSigned()) {
+        return (qint64)value >= (qint64)m_minimum && (qint64)value <= (qint64)m_maximum;
+    }
+    return value >= m_minimum && value <= m_maximum;
+}
+
+/**
+ * @brief Encodes the given numeric value into its big-endian binary representation.
+ * @param value the value to encode (two's complement representation for signed parameters)
+ * @param out the encoded value (width() bytes)
+ * @return true if succeeded; false if the parameter isn't numeric, is read only or if the value is out of range.
+ */
+bool ATParameter::encode(const quint64 value, QByteArray *out) const
+{
+    Q_ASSERT(out);
+
+    if(!isNumeric() || isReadOnly()) {
+        qWarning() << Q_FUNC_INFO << ATCommand::atCommandToString(m_command) << "is not a writable numeric parameter";
+        return false;
+    }
+    if(!inRange(value)) {
+        qWarning() << Q_FUNC_INFO << ATCommand::atCommandToString(m_command) << "value out of range" << value;
+        return false;
+    }
+
+    out->clear();
+    out->reserve(m_width);
+    for(int i=m_width-1; i>=0; i--) {
+        out->append((value >> (i*8))&0xFF);
+    }
+    return true;
+}
+
+/**
+ * @brief Validates the given string or binary value.
+ * @param value the value to encode
+ * @param out the encoded value
+ * @return true if succeeded; false if the parameter is numeric, is read only or if the value is too long.
+ */
+bool ATParameter::encode(const QByteArray &value, QByteArray *out) const
+{
+    Q_ASSERT(out);
+
+    if(isNumeric() || isReadOnly()) {
+        qWarning() << Q_FUNC_INFO << ATCommand::atCommandToString(m_command) << "is not a writable string parameter";
+        return false;
+    }
+    if(value.size() > m_width) {
+        qWarning() << Q_FUNC_INFO << ATCommand::atCommandToString(m_command) << "value too long" << value.size() << ">" << m_width;
+        return false;
+    }
+
+    *out = value;
+    return true;
+}
+
+/**
+ * @brief Decodes the given big-endian binary data, as received in an ATCommandResponse.
+ *
+ * The radio may answer with less than width() bytes (leading zeros are stripped by some firmwares).
+ * Signed values are sign-extended.
+ * @param data the received data
+ * @param value the decoded value
+ * @return true if succeeded; false otherwise.
+ */
+bool ATParameter::decode(const QByteArray &data, quint64 *value) const
+{
+    Q_ASSERT(value);
+    quint64 v = 0;
+
+    if(!isNumeric() || data.isEmpty() || data.size() > 8) {
+        return false;
+    }
+
+    for(int i=0; i<data.size(); i++) {
+        v = (v << 8) | (quint8)data.at(i);
+    }
+
+    if(isSigned() && data.size() < 8 && (data.at(0) & 0x80)) {
+        v |= ~Q_UINT64_C(0) << (data.size()*8);
+    }
+
+    *value = v;
+    return true;
+}
+
+/**
+ * @brief Returns true if the two given raw values are the same parameter value; false otherwise.
+ *
+ * Numeric values are compared once decoded, since the radio may strip leading zeros.
+ * @param a first raw value
+ * @param b second raw value
+ */
+bool ATParameter::isEqual(const QByteArray &a, const QByteArray &b) const
+{
+    quint64 va = 0;
+    quint64 vb = 0;
+
+    if(isNumeric() && decode(a, &va) && decode(b, &vb)) {
+        return va == vb;
+    }
+    return a == b;
+}
+
+} // END namespace
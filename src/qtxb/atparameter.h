@@ -0,0 +1,308 @@
+/*
+ * Copyright (C) 2015 ThomArmax (Thomas COIN)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * Thomas COIN <esvcorp@gmail.com> 18/04/2015
+ */
+
+#ifndef ATPARAMETER_H
+#define ATPARAMETER_H
+
+#include "ATCommand"
+#include <QByteArray>
+
+namespace QtXBee {
+
+/**
+ * @brief The ATParameter class describes how an AT command parameter is encoded.
+ *
+ * Each known ATCommand::ATCommandType has an entry in a compile-time table recording
+ * the parameter's width (in bytes), signedness, valid range and access flags.
+ * This table is used to encode/decode the binary big-endian values exchanged with the radio in API mode.
+ *
+ * The lookup from a 16-bits AT command code to its table entry is a constexpr perfect hash,
+ * so it can be used in constant expressions:
+ * @code
+ * static_assert(ATParameter::find(ATCommand::ATSH)->isReadOnly(), "SH is read only");
+ * @endcode
+ * @sa XBee::setParameter()
+ * @sa XBee::parameter()
+ */
+class ATParameter
+{
+public:
+    /**
+     * @brief The Flag enum defines the parameter's properties
+     */
+    enum Flag {
+        NoFlag      = 0x00,
+        Signed      = 0x01, /**< Numeric value is signed (two's complement) */
+        ReadOnly    = 0x02, /**< Parameter can't be written */
+        Volatile    = 0x04, /**< Value changes without being written (RSSI, voltage, ...), cached values are only a snapshot */
+        String      = 0x08, /**< Printable string, up to width() characters */
+        Binary      = 0x10, /**< Raw bytes (keys, ...), up to width() bytes */
+        Executable  = 0x20  /**< Execution command (WR, AC, ND, ...) */
+    };
+
+    constexpr               ATParameter             (const ATCommand::ATCommandType command,
+                                                     const quint8 width,
+                                                     const quint8 flags,
+                                                     const quint64 minimum,
+                                                     const quint64 maximum) :
+        m_command(command), m_width(width), m_flags(flags), m_minimum(minimum), m_maximum(maximum) {}
+
+    constexpr ATCommand::ATCommandType command      () const { return m_command; }
+    constexpr quint8        width                   () const { return m_width; }
+    constexpr quint8        flags                   () const { return m_flags; }
+    constexpr quint64       minimum                 () const { return m_minimum; }
+    constexpr quint64       maximum                 () const { return m_maximum; }
+
+    constexpr bool          isSigned                () const { return m_flags & Signed; }
+    constexpr bool          isReadOnly              () const { return m_flags & ReadOnly; }
+    constexpr bool          isVolatile              () const { return m_flags & Volatile; }
+    constexpr bool          isString                () const { return m_flags & String; }
+    constexpr bool          isBinary                () const { return m_flags & Binary; }
+    constexpr bool          isExecutable            () const { return m_flags & Executable; }
+    constexpr bool          isNumeric               () const { return !(m_flags & (String|Binary|Executable)); }
+
+    static constexpr quint16    hash                (const quint16 code);
+    static constexpr const ATParameter * find       (const quint16 code);
+    static constexpr bool       isKnown             (const quint16 code);
+    static constexpr ATCommand::ATCommandType commandFromCode(const quint16 code);
+
+    bool                    inRange                 (const quint64 value) const;
+    bool                    encode                  (const quint64 value, QByteArray * out) const;
+    bool                    encode                  (const QByteArray & value, QByteArray * out) const;
+    bool                    decode                  (const QByteArray & data, quint64 * value) const;
+    bool                    isEqual                 (const QByteArray & a, const QByteArray & b) const;
+
+private:
+    ATCommand::ATCommandType m_command;
+    quint8                  m_width;
+    quint8                  m_flags;
+    quint64                 m_minimum;
+    quint64                 m_maximum;
+};
+
+namespace ATParameters {
+
+enum {
+    HashBits        = 10,
+    HashSize        = 1 << HashBits,
+    HashMultiplier  = 0x396867 /**< Must be re-computed when an entry is added, see the static_assert below */
+};
+
+} // END namespace ATParameters
+
+/**
+ * @brief Returns the perfect hash slot of the given AT command code.
+ * @param code the 16-bits AT command code (eg. ATCommand::ATDH)
+ */
+constexpr quint16 ATParameter::hash(const quint16 code)
+{
+    return (quint32)(code * (quint32)ATParameters::HashMultiplier) >> (32 - ATParameters::HashBits);
+}
+
+namespace ATParameters {
+
+/**
+ * @brief The AT parameters table.
+ *
+ * Widths and ranges follow the XBee/XBee-PRO 802.15.4 (Serie 1) product manual;
+ * ZigBee specific parameters follow the ZigBee (Serie 2) manual.
+ */
+constexpr ATParameter table[] = {
+    // Serial
+    ATParameter(ATCommand::ATWR, 0, ATParameter::Executable,                            0, 0),
+    ATParameter(ATCommand::ATRE, 0, ATParameter::Executable,                            0, 0),
+    ATParameter(ATCommand::ATFR, 0, ATParameter::Executable,                            0, 0),
+    // Addressing
+    ATParameter(ATCommand::ATDH, 4, ATParameter::NoFlag,                                0, 0xFFFFFFFF),
+    ATParameter(ATCommand::ATDL, 4, ATParameter::NoFlag,                                0, 0xFFFFFFFF),
+    ATParameter(ATCommand::ATMY, 2, ATParameter::NoFlag,                                0, 0xFFFF),
+    ATParameter(ATCommand::ATMP, 2, ATParameter::ReadOnly,                              0, 0xFFFF),
+    ATParameter(ATCommand::ATNC, 1, ATParameter::ReadOnly|ATParameter::Volatile,        0, 0xFF),
+    ATParameter(ATCommand::ATSH, 4, ATParameter::ReadOnly,                              0, 0xFFFFFFFF),
+    ATParameter(ATCommand::ATSL, 4, ATParameter::ReadOnly,                              0, 0xFFFFFFFF),
+    ATParameter(ATCommand::ATNI, 20, ATParameter::String,                               0, 0),
+    ATParameter(ATCommand::ATSE, 1, ATParameter::NoFlag,                                0, 0xFF),
+    ATParameter(ATCommand::ATDE, 1, ATParameter::NoFlag,                                0, 0xFF),
+    ATParameter(ATCommand::ATCI, 2, ATParameter::NoFlag,                                0, 0xFFFF),
+    ATParameter(ATCommand::ATTO, 1, ATParameter::NoFlag,                                0, 0xFF),
+    ATParameter(ATCommand::ATNP, 2, ATParameter::ReadOnly,                              0, 0xFFFF),
+    ATParameter(ATCommand::ATDD, 4, ATParameter::NoFlag,                                0, 0xFFFFFFFF),
+    ATParameter(ATCommand::ATCR, 1, ATParameter::NoFlag,                                1, 0x3F),
+    // Networking
+    ATParameter(ATCommand::ATCH, 1, ATParameter::NoFlag,                                0x0B, 0x1A),
+    ATParameter(ATCommand::ATDA, 0, ATParameter::Executable,                            0, 0),
+    ATParameter(ATCommand::ATID, 2, ATParameter::NoFlag,                                0, 0xFFFF),
+    ATParameter(ATCommand::ATFP, 0, ATParameter::Executable,                            0, 0),
+    ATParameter(ATCommand::ATAS, 1, ATParameter::Executable,                            0, 0),
+    ATParameter(ATCommand::ATED, 1, ATParameter::Executable,                            0, 0),
+    ATParameter(ATCommand::ATOP, 8, ATParameter::ReadOnly|ATParameter::Volatile,        0, Q_UINT64_C(0xFFFFFFFFFFFFFFFF)),
+    ATParameter(ATCommand::ATRR, 1, ATParameter::NoFlag,                                0, 6),
+    ATParameter(ATCommand::ATRN, 1, ATParameter::NoFlag,                                0, 3),
+    ATParameter(ATCommand::ATMM, 1, ATParameter::NoFlag,                                0, 3),
+    ATParameter(ATCommand::ATCE, 1, ATParameter::NoFlag,                                0, 1),
+    ATParameter(ATCommand::ATNH, 1, ATParameter::NoFlag,                                0, 0xFF),
+    ATParameter(ATCommand::ATBH, 1, ATParameter::NoFlag,                                0, 0x1E),
+    ATParameter(ATCommand::ATOI, 2, ATParameter::ReadOnly|ATParameter::Volatile,        0, 0xFFFF),
+    ATParameter(ATCommand::ATNT, 1, ATParameter::NoFlag,                                0x01, 0xFC),
+    ATParameter(ATCommand::ATNO, 1, ATParameter::NoFlag,                                0, 3),
+    ATParameter(ATCommand::ATSC, 2, ATParameter::NoFlag,                                0, 0xFFFF),
+    ATParameter(ATCommand::ATSD, 1, ATParameter::NoFlag,                                0, 0x0F),
+    ATParameter(ATCommand::ATZS, 1, ATParameter::NoFlag,                                0, 2),
+    ATParameter(ATCommand::ATNJ, 1, ATParameter::NoFlag,                                0, 0xFF),
+    ATParameter(ATCommand::ATJV, 1, ATParameter::NoFlag,                                0, 1),
+    ATParameter(ATCommand::ATNW, 2, ATParameter::NoFlag,                                0, 0x64FF),
+    ATParameter(ATCommand::ATJN, 1, ATParameter::NoFlag,                                0, 1),
+    ATParameter(ATCommand::ATAR, 1, ATParameter::NoFlag,                                0, 0xFF),
+    ATParameter(ATCommand::ATA1, 1, ATParameter::NoFlag,                                0, 0x0F),
+    ATParameter(ATCommand::ATA2, 1, ATParameter::NoFlag,                                0, 0x0F),
+    // Security
+    ATParameter(ATCommand::ATEE, 1, ATParameter::NoFlag,                                0, 1),
+    ATParameter(ATCommand::ATEO, 1, ATParameter::NoFlag,                                0, 0xFF),
+    ATParameter(ATCommand::ATNK, 16, ATParameter::Binary,                               0, 0),
+    ATParameter(ATCommand::ATKY, 16, ATParameter::Binary,                               0, 0),
+    // RF Interfacing
+    ATParameter(ATCommand::ATPL, 1, ATParameter::NoFlag,                                0, 4),
+    ATParameter(ATCommand::ATCA, 1, ATParameter::NoFlag,                                0x24, 0x50),
+    ATParameter(ATCommand::ATPM, 1, ATParameter::NoFlag,                                0, 1),
+    ATParameter(ATCommand::ATDB, 1, ATParameter::ReadOnly|ATParameter::Volatile,        0, 0xFF),
+    ATParameter(ATCommand::ATPP, 1, ATParameter::ReadOnly,                              0, 0xFF),
+    // Serial Interfacing (I/O)
+    ATParameter(ATCommand::ATAP, 1, ATParameter::NoFlag,                                0, 2),
+    ATParameter(ATCommand::ATAO, 1, ATParameter::NoFlag,                                0, 3),
+    ATParameter(ATCommand::ATBD, 4, ATParameter::NoFlag,                                0, 0x1C200),
+    ATParameter(ATCommand::ATNB, 1, ATParameter::NoFlag,                                0, 4),
+    ATParameter(ATCommand::ATSB, 1, ATParameter::NoFlag,                                0, 1),
+    ATParameter(ATCommand::ATRO, 1, ATParameter::NoFlag,                                0, 0xFF),
+    // I/O ATs
+    ATParameter(ATCommand::ATIR, 2, ATParameter::NoFlag,                                0, 0xFFFF),
+    ATParameter(ATCommand::ATIC, 2, ATParameter::NoFlag,                                0, 0xFFFF),
+    ATParameter(ATCommand::ATP0, 1, ATParameter::NoFlag,                                0, 5),
+    ATParameter(ATCommand::ATP1, 1, ATParameter::NoFlag,                                0, 5),
+    ATParameter(ATCommand::ATP2, 1, ATParameter::NoFlag,                                0, 5),
+    ATParameter(ATCommand::ATP3, 1, ATParameter::NoFlag,                                0, 5),
+    ATParameter(ATCommand::ATD0, 1, ATParameter::NoFlag,                                0, 5),
+    ATParameter(ATCommand::ATD1, 1, ATParameter::NoFlag,                                0, 5),
+    ATParameter(ATCommand::ATD2, 1, ATParameter::NoFlag,                                0, 5),
+    ATParameter(ATCommand::ATD3, 1, ATParameter::NoFlag,                                0, 5),
+    ATParameter(ATCommand::ATD4, 1, ATParameter::NoFlag,                                0, 5),
+    ATParameter(ATCommand::ATD5, 1, ATParameter::NoFlag,                                0, 5),
+    ATParameter(ATCommand::ATD6, 1, ATParameter::NoFlag,                                0, 5),
+    ATParameter(ATCommand::ATD7, 1, ATParameter::NoFlag,                                0, 5),
+    ATParameter(ATCommand::ATD8, 1, ATParameter::NoFlag,                                0, 5),
+    ATParameter(ATCommand::ATLT, 1, ATParameter::NoFlag,                                0, 0xFF),
+    ATParameter(ATCommand::ATPR, 2, ATParameter::NoFlag,                                0, 0xFFFF),
+    ATParameter(ATCommand::ATRP, 1, ATParameter::NoFlag,                                0, 0xFF),
+    ATParameter(ATCommand::ATV , 2, ATParameter::ReadOnly|ATParameter::Volatile,        0, 0xFFFF),
+    ATParameter(ATCommand::ATVP, 2, ATParameter::NoFlag,                                0, 0xFFFF),
+    ATParameter(ATCommand::ATTP, 2, ATParameter::ReadOnly|ATParameter::Volatile|ATParameter::Signed,
+                                                                                        Q_UINT64_C(0xFFFFFFFFFFFF8000), 0x7FFF),
+    ATParameter(ATCommand::ATVR, 2, ATParameter::ReadOnly,                              0, 0xFFFF),
+    ATParameter(ATCommand::ATHV, 2, ATParameter::ReadOnly,                              0, 0xFFFF),
+    ATParameter(ATCommand::ATAI, 1, ATParameter::ReadOnly|ATParameter::Volatile,        0, 0xFF),
+    // AT Command Options
+    ATParameter(ATCommand::ATCT, 2, ATParameter::NoFlag,                                2, 0xFFFF),
+    ATParameter(ATCommand::ATCN, 0, ATParameter::Executable,                            0, 0),
+    ATParameter(ATCommand::ATGT, 2, ATParameter::NoFlag,                                2, 0x0CE4),
+    ATParameter(ATCommand::ATCC, 1, ATParameter::NoFlag,                                0, 0xFF),
+    // Sleep ATs
+    ATParameter(ATCommand::ATSM, 1, ATParameter::NoFlag,                                0, 6),
+    ATParameter(ATCommand::ATSN, 2, ATParameter::NoFlag,                                1, 0xFFFF),
+    ATParameter(ATCommand::ATSP, 2, ATParameter::NoFlag,                                0, 0x68B0),
+    ATParameter(ATCommand::ATDP, 2, ATParameter::NoFlag,                                1, 0x68B0),
+    ATParameter(ATCommand::ATST, 2, ATParameter::NoFlag,                                1, 0xFFFF),
+    ATParameter(ATCommand::ATSO, 1, ATParameter::NoFlag,                                0, 0xFF),
+    ATParameter(ATCommand::ATWH, 2, ATParameter::NoFlag,                                0, 0xFFFF),
+    ATParameter(ATCommand::ATSI, 0, ATParameter::Executable,                            0, 0),
+    ATParameter(ATCommand::ATPO, 2, ATParameter::NoFlag,                                0, 0x3E8),
+    // Execution ATs
+    ATParameter(ATCommand::ATAC, 0, ATParameter::Executable,                            0, 0),
+    ATParameter(ATCommand::ATNR, 1, ATParameter::Executable,                            0, 0),
+    ATParameter(ATCommand::ATCB, 1, ATParameter::Executable,                            0, 0),
+    ATParameter(ATCommand::ATND, 20, ATParameter::Executable,                           0, 0),
+    ATParameter(ATCommand::ATDN, 20, ATParameter::Executable,                           0, 0),
+    ATParameter(ATCommand::ATIS, 0, ATParameter::Executable,                            0, 0),
+    ATParameter(ATCommand::AT1S, 0, ATParameter::Executable,                            0, 0)
+};
+
+enum { Count = sizeof(table) / sizeof(table[0]) };
+
+/**
+ * @brief Perfect hash index: maps ATParameter::hash() to (table index + 1), 0 for an empty entry.
+ */
+struct Index {
+    quint8 entries[HashSize];
+
+    constexpr Index() : entries() {
+        for(int i=0; i<Count; i++) {
+            entries[ATParameter::hash(table[i].command())] = i + 1;
+        }
+    }
+
+    constexpr bool isPerfect() const {
+        for(int i=0; i<Count; i++) {
+            if(entries[ATParameter::hash(table[i].command())] != i + 1)
+                return false;
+        }
+        return true;
+    }
+};
+
+constexpr Index hashIndex;
+
+static_assert(Count < 0xFF, "ATParameters::Index slots are 8 bits wide");
+static_assert(hashIndex.isPerfect(), "ATParameters::HashMultiplier produces collisions, pick another one");
+
+} // END namespace ATParameters
+
+/**
+ * @brief Returns the table entry of the given AT command code.
+ * @param code the 16-bits AT command code (eg. ATCommand::ATDH)
+ * @return the table entry; or NULL if the code isn't a known AT command.
+ */
+constexpr const ATParameter * ATParameter::find(const quint16 code)
+{
+    return (ATParameters::hashIndex.entries[hash(code)] != 0 &&
+            ATParameters::table[ATParameters::hashIndex.entries[hash(code)] - 1].command() == code)
+            ? &ATParameters::table[ATParameters::hashIndex.entries[hash(code)] - 1]
+            : nullptr;
+}
+
+/**
+ * @brief Returns true if the given code is a known AT command; false otherwise.
+ * @param code the 16-bits AT command code
+ */
+constexpr bool ATParameter::isKnown(const quint16 code)
+{
+    return find(code) != nullptr;
+}
+
+/**
+ * @brief Returns the ATCommand::ATCommandType of the given code.
+ * @param code the 16-bits AT command code (eg. 0x4448 for DH)
+ * @return the ATCommand::ATCommandType; or ATCommand::ATUndefined if the code isn't a known AT command.
+ */
+constexpr ATCommand::ATCommandType ATParameter::commandFromCode(const quint16 code)
+{
+    return isKnown(code) ? find(code)->command() : ATCommand::ATUndefined;
+}
+
+} // END namespace
+
+#endif // ATPARAMETER_H
@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2015 ThomArmax (Thomas COIN)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * Thomas COIN <esvcorp@gmail.com> 18/04/2015
+ */
+
+
+
+#include "ByteSlice"
+
+#include <cstring>
+
+namespace QtXBee {
+
+/**
+ * @brief Constructs an empty slice
+ */
+ByteSlice::ByteSlice() :
+    m_offset(0),
+    m_size(0)
+{
+}
+
+/**
+ * @brief Constructs a slice viewing the whole given array
+ * @param storage
+ */
+ByteSlice::ByteSlice(const QByteArray &storage) :
+    m_storage(storage),
+    m_offset(0),
+    m_size(storage.size())
+{
+}
+
+/**
+ * @brief Constructs a slice viewing @a size bytes of the given array, from @a offset.
+ *
+ * The view is bounded to the array: a negative @a size views up to the end of the array.
+ * @param storage
+ * @param offset
+ * @param size
+ */
+ByteSlice::ByteSlice(const QByteArray &storage, const int offset, const int size) :
+    m_storage(storage),
+    m_offset(qBound(0, offset, storage.size())),
+    m_size(0)
+{
+    const int available = storage.size() - m_offset;
+    m_size = (size < 0 || size > available) ? available : size;
+}
+
+/**
+ * @brief Returns a pointer to the first viewed byte.
+ *
+ * The bytes are not null-terminated.
+ */
+const char *ByteSlice::constData() const
+{
+    return m_storage.constData() + m_offset;
+}
+
+const char *ByteSlice::begin() const
+{
+    return constData();
+}
+
+const char *ByteSlice::end() const
+{
+    return constData() + m_size;
+}
+
+/**
+ * @brief Returns the number of viewed bytes.
+ */
+int ByteSlice::size() const
+{
+    return m_size;
+}
+
+/**
+ * @brief Returns true if the slice views no byte; false otherwise.
+ */
+bool ByteSlice::isEmpty() const
+{
+    return m_size == 0;
+}
+
+/**
+ * @brief Returns the byte at index @a i of the slice.
+ * @param i must be a valid index (0 <= i < size())
+ */
+char ByteSlice::at(const int i) const
+{
+    Q_ASSERT(i >= 0 && i < m_size);
+    return m_storage.at(m_offset + i);
+}
+
+/**
+ * @brief Returns a slice of this slice, sharing the same array.
+ * @param position
+ * @param size
+ */
+ByteSlice ByteSlice::mid(const int position, const int size) const
+{
+    const int offset = qBound(0, position, m_size);
+    const int available = m_size - offset;
+
+    return ByteSlice(m_storage, m_offset + offset, (size < 0 || size > available) ? available : size);
+}
+
+/**
+ * @brief Returns the viewed bytes as a QByteArray.
+ *
+ * If the slice views the whole array, the array is shared; otherwise the viewed bytes are copied.
+ */
+QByteArray ByteSlice::toByteArray() const
+{
+    if(m_offset == 0 && m_size == m_storage.size()) {
+        return m_storage;
+    }
+    return QByteArray(constData(), m_size);
+}
+
+/**
+ * @brief Returns a hex encoded copy of the viewed bytes.
+ */
+QByteArray ByteSlice::toHex() const
+{
+    return QByteArray::fromRawData(constData(), m_size).toHex();
+}
+
+/**
+ * @brief Returns the whole array the slice views a part of.
+ */
+const QByteArray &ByteSlice::storage() const
+{
+    return m_storage;
+}
+
+bool ByteSlice::operator==(const ByteSlice &other) const
+{
+    return m_size == other.m_size && (m_size == 0 || memcmp(constData(), other.constData(), m_size) == 0);
+}
+
+bool ByteSlice::operator!=(const ByteSlice &other) const
+{
+    return !(*this == other);
+}
+
+} // END namespace
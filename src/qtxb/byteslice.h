@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2015 ThomArmax (Thomas COIN)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * Thomas COIN <esvcorp@gmail.com> 18/04/2015
+ */
+
+
+
+#ifndef BYTESLICE_H
+#define BYTESLICE_H
+
+#include <QByteArray>
+
+namespace QtXBee {
+
+/**
+ * @brief The ByteSlice class is a read-only view on a part of an implicitly shared QByteArray.
+ *
+ * The slice holds a reference to the whole array, so it stays valid as long as the slice lives,
+ * without copying the bytes. A received payload is handed to the application as a slice of the
+ * received frame:
+ * @code
+ * const ByteSlice payload = response->payload();   // No copy
+ * memcpy(&value, payload.constData(), sizeof(value));
+ * @endcode
+ * Use toByteArray() to get an independent copy (only the viewed bytes are copied).
+ */
+class ByteSlice
+{
+public:
+    explicit                ByteSlice               ();
+                            ByteSlice               (const QByteArray & storage);
+                            ByteSlice               (const QByteArray & storage, const int offset, const int size = -1);
+
+    const char *            constData               () const;
+    const char *            begin                   () const;
+    const char *            end                     () const;
+    int                     size                    () const;
+    bool                    isEmpty                 () const;
+    char                    at                      (const int i) const;
+
+    ByteSlice               mid                     (const int position, const int size = -1) const;
+    QByteArray              toByteArray             () const;
+    QByteArray              toHex                   () const;
+    const QByteArray &      storage                 () const;
+
+    bool                    operator==              (const ByteSlice & other) const;
+    bool                    operator!=              (const ByteSlice & other) const;
+
+private:
+    QByteArray              m_storage;              /**< Shared array holding the viewed bytes */
+    int                     m_offset;               /**< Offset of the first viewed byte */
+    int                     m_size;                 /**< Number of viewed bytes */
+};
+
+} // END namespace
+
+#endif // BYTESLICE_H
@@ -0,0 +1,636 @@
+/*
+ * Copyright (C) 2015 ThomArmax (Thomas COIN)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * Thomas COIN <esvcorp@gmail.com> 18/04/2015
+ */
+
+
+#ifndef XBEECODEC_H
+#define XBEECODEC_H
+
+// Only the C library: this header is shared with the firmwares and the non-Qt tools
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+namespace QtXBee {
+
+/**
+ * @brief The Codec namespace holds the XBee API frame encoder and decoder.
+ *
+ * It is header-only, C++11, and depends on nothing but the C library: no Qt, no heap allocation.
+ * The Qt classes (XBeePacket and its subclasses, FrameDecoder, FrameTemplate) are wrappers around it,
+ * and the same header is compiled in the firmwares (see the xbee_temp_sensor example) and in non-Qt tools.
+ *
+ * All functions work on caller-provided buffers, holding unescaped frames:
+ * start delimiter, length (big-endian), frame data (API id, frame-specific data) and checksum.
+ * @code
+ * uint8_t frame[Codec::frameSize(Codec::Layout::TxRequest16::Data, 4)];
+ * const size_t size = Codec::encodeTxRequest16(frame, sizeof(frame), 0x01, 0x0001, 0, "temp", 4);
+ * @endcode
+ */
+namespace Codec {
+
+/**
+ * @brief The SpecialByte enum defines the special bytes (same values as XBeePacket::SpecialByte)
+ */
+enum SpecialByte {
+    StartDelimiter  = 0x7E, /**< Start delimiter */
+    Escape          = 0x7D, /**< Escape caracter */
+    XON             = 0x11, /**< XON */
+    XOFF            = 0x13  /**< XOFF */
+};
+
+/**
+ * @brief The ApiId enum identifies the frames the codec knows the layout of (same values as XBeePacket::ApiId)
+ */
+enum ApiId {
+    TxRequest64Id               = 0x00,
+    TxRequest16Id               = 0x01,
+    ATCommandId                 = 0x08,
+    ATCommandQueueId            = 0x09,
+    ZBTxRequestId               = 0x10,
+    RemoteATCommandRequestId    = 0x17,
+    Rx64ResponseId              = 0x80,
+    Rx16ResponseId              = 0x81,
+    ATCommandResponseId         = 0x88,
+    TxStatusResponseId          = 0x89,
+    ModemStatusResponseId       = 0x8A,
+    ZBTxStatusResponseId        = 0x8B,
+    ZBRxResponseId              = 0x90,
+    RemoteATCommandResponseId   = 0x97
+};
+
+enum {
+    FrameOverhead   = 4,        /**< Start delimiter, length and checksum */
+    MaxLength       = 0xFFFF    /**< Largest value of the length field */
+};
+
+/**
+ * @brief Offsets of the frame fields, counted from the start delimiter of the unescaped frame.
+ *
+ * Data is the offset of the variable-size part, which runs until the checksum.
+ */
+namespace Layout {
+struct Frame                    { enum { Delimiter = 0, Length = 1, ApiId = 3, FrameId = 4 }; };
+struct TxRequest16              { enum { Destination = 5, Options = 7, Data = 8 }; };
+struct TxRequest64              { enum { Destination = 5, Options = 13, Data = 14 }; };
+struct ZBTxRequest              { enum { Destination64 = 5, Destination16 = 13, BroadcastRadius = 15, Options = 16, Data = 17 }; };
+struct ATCommand                { enum { Command = 5, Data = 7 }; };
+struct RemoteATCommand          { enum { Destination64 = 5, Destination16 = 13, Options = 15, Command = 16, Data = 18 }; };
+struct Rx16Response             { enum { Source = 4, Rssi = 6, Options = 7, Data = 8 }; };
+struct Rx64Response             { enum { Source = 4, Rssi = 12, Options = 13, Data = 14 }; };
+struct ZBRxResponse             { enum { Source64 = 4, Source16 = 12, Options = 14, Data = 15 }; };
+struct ATCommandResponse        { enum { Command = 5, Status = 7, Data = 8 }; };
+struct RemoteATCommandResponse  { enum { Source64 = 5, Source16 = 13, Command = 15, Status = 17, Data = 18 }; };
+struct TxStatusResponse         { enum { Status = 5 }; };
+struct ZBTxStatusResponse       { enum { Destination16 = 5, Retries = 7, DeliveryStatus = 8, DiscoveryStatus = 9 }; };
+struct ModemStatusResponse      { enum { Status = 4 }; };
+} // END namespace Layout
+
+/**
+ * @brief Returns the size of a frame whose variable-size part starts at @a dataOffset and holds @a dataSize bytes.
+ */
+constexpr size_t frameSize(size_t dataOffset, size_t dataSize)
+{
+    return dataOffset + dataSize + 1;
+}
+
+/**
+ * @brief Returns the checksum of the given frame data (from the API id, checksum excluded).
+ *
+ * The checksum is 0xFF minus the 8-bit sum of the frame data.
+ */
+inline uint8_t checksum(const uint8_t *data, size_t size)
+{
+    uint8_t sum = 0;
+    for(size_t i=0; i<size; i++) {
+        sum = (uint8_t)(sum + data[i]);
+    }
+    return (uint8_t)(0xFF - sum);
+}
+
+/**
+ * @brief Returns true if the given byte must be escaped in API mode 2 (AP=2); false otherwise.
+ */
+inline bool isSpecialByte(uint8_t c)
+{
+    return c == StartDelimiter || c == Escape || c == XON || c == XOFF;
+}
+
+/**
+ * @brief Returns the size of the given frame once escaped. The start delimiter isn't escaped.
+ */
+inline size_t escapedSize(const uint8_t *frame, size_t size)
+{
+    size_t escaped = size;
+    for(size_t i=1; i<size; i++) {
+        if(isSpecialByte(frame[i])) {
+            escaped++;
+        }
+    }
+    return escaped;
+}
+
+/**
+ * @brief Escapes the given frame into @a out, as required in API mode 2 (AP=2).
+ *
+ * @a out must not overlap @a frame.
+ * @return the escaped size; 0 if @a capacity is too small.
+ */
+inline size_t escape(const uint8_t *frame, size_t size, uint8_t *out, size_t capacity)
+{
+    size_t n = 0;
+
+    for(size_t i=0; i<size; i++) {
+        const bool special = i > 0 && isSpecialByte(frame[i]);
+        if(n + (special ? 2 : 1) > capacity) {
+            return 0;
+        }
+        if(special) {
+            out[n++] = Escape;
+            out[n++] = (uint8_t)(frame[i] ^ 0x20);
+        }
+        else {
+            out[n++] = frame[i];
+        }
+    }
+    return n;
+}
+
+/**
+ * @brief Restores the escaped bytes of the given data into @a out, which must hold @a size bytes.
+ *
+ * @a out may be @a data itself: the bytes are never moved forward.
+ * @param ok if not null, set to false if the data ends with an escape byte
+ * @return the unescaped size
+ */
+inline size_t unescape(const uint8_t *data, size_t size, uint8_t *out, bool *ok = 0)
+{
+    size_t n = 0;
+
+    if(ok) *ok = true;
+    for(size_t i=0; i<size; i++) {
+        if(data[i] == Escape) {
+            if(++i >= size) {
+                if(ok) *ok = false;
+                break;
+            }
+            out[n++] = (uint8_t)(data[i] ^ 0x20);
+        }
+        else {
+            out[n++] = data[i];
+        }
+    }
+    return n;
+}
+
+/**
+ * @brief The ScanResult enum is returned by scanFrame()
+ */
+enum ScanResult {
+    NeedMoreData,   /**< The frame isn't complete yet */
+    FrameFound,     /**< A complete frame, with a good checksum */
+    BadChecksum     /**< A complete frame, with a bad checksum */
+};
+
+/**
+ * @brief Checks whether the given unescaped bytes, starting with a start delimiter, hold a complete frame.
+ * @param frameSize set to the size of the frame, unless NeedMoreData is returned
+ */
+inline ScanResult scanFrame(const uint8_t *data, size_t size, size_t *frameSize)
+{
+    if(size < 3) {
+        return NeedMoreData;
+    }
+    const uint32_t total = (((uint32_t)data[Layout::Frame::Length] << 8) | data[Layout::Frame::Length + 1]) + FrameOverhead;
+    if((uint32_t)size < total) {
+        return NeedMoreData;
+    }
+    *frameSize = (size_t)total;
+    return checksum(data + Layout::Frame::ApiId, (size_t)total - 4) == data[total - 1] ? FrameFound : BadChecksum;
+}
+
+/**
+ * @brief Sets the frame id of the given assembled request, updating the checksum incrementally.
+ *
+ * Replacing the frame id byte only moves the checksum by the difference between the old and the new id.
+ * @return true if succeeded; false if the frame is too short to hold a frame id.
+ */
+inline bool setFrameId(uint8_t *frame, size_t size, uint8_t frameId)
+{
+    if(size <= (size_t)Layout::Frame::FrameId + 1) {
+        return false;
+    }
+    const uint8_t previous = frame[Layout::Frame::FrameId];
+    frame[Layout::Frame::FrameId] = frameId;
+    frame[size - 1] = (uint8_t)(frame[size - 1] + previous - frameId);
+    return true;
+}
+
+/**
+ * @brief The FrameWriter class assembles a frame into a caller-provided buffer.
+ *
+ * The fields are appended in order, then finish() fills the length and the checksum in.
+ * Writing past the buffer's capacity is detected, and makes finish() fail.
+ * @code
+ * uint8_t buffer[32];
+ * const size_t size = Codec::FrameWriter(buffer, sizeof(buffer))
+ *         .begin(Codec::ATCommandId, 0x01)
+ *         .put("NI", 2)
+ *         .finish();
+ * @endcode
+ */
+class FrameWriter
+{
+public:
+    FrameWriter(uint8_t *buffer, size_t capacity) :
+        m_buffer(buffer),
+        m_capacity(capacity),
+        m_size(0),
+        m_overflow(false)
+    {
+    }
+
+    /** @brief Starts a frame without frame id */
+    FrameWriter & begin(uint8_t apiId)
+    {
+        m_size = 0;
+        m_overflow = false;
+        return put8(StartDelimiter).put16(0).put8(apiId);
+    }
+
+    /** @brief Starts a frame with the given frame id */
+    FrameWriter & begin(uint8_t apiId, uint8_t frameId)
+    {
+        return begin(apiId).put8(frameId);
+    }
+
+    FrameWriter & put8(uint8_t value)
+    {
+        if(m_size < m_capacity) {
+            m_buffer[m_size++] = value;
+        }
+        else {
+            m_overflow = true;
+        }
+        return *this;
+    }
+
+    /** @brief Appends the given value, big-endian */
+    FrameWriter & put16(uint16_t value)
+    {
+        return put8((uint8_t)(value >> 8)).put8((uint8_t)value);
+    }
+
+    /** @brief Appends the given value, big-endian */
+    FrameWriter & put64(uint64_t value)
+    {
+        for(int i=7; i>=0; i--) {
+            put8((uint8_t)(value >> (i*8)));
+        }
+        return *this;
+    }
+
+    FrameWriter & put(const void *data, size_t size)
+    {
+        if(size > m_capacity - m_size) {
+            m_overflow = true;
+        }
+        else if(size > 0) {
+            memcpy(m_buffer + m_size, data, size);
+            m_size += size;
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Fills the length in and appends the checksum.
+     * @return the frame's size; 0 if the buffer was too small.
+     */
+    size_t finish()
+    {
+        if(m_overflow || m_size <= (size_t)Layout::Frame::ApiId || m_size >= m_capacity || (uint32_t)(m_size - 3) > MaxLength) {
+            m_overflow = true;
+            return 0;
+        }
+        const size_t length = m_size - 3;
+        m_buffer[Layout::Frame::Length] = (uint8_t)(length >> 8);
+        m_buffer[Layout::Frame::Length + 1] = (uint8_t)length;
+        m_buffer[m_size] = checksum(m_buffer + Layout::Frame::ApiId, length);
+        return ++m_size;
+    }
+
+    size_t size() const { return m_size; }
+    bool hasOverflowed() const { return m_overflow; }
+
+private:
+    uint8_t *   m_buffer;
+    size_t      m_capacity;
+    size_t      m_size;
+    bool        m_overflow;
+};
+
+/**
+ * @brief Encodes a TX request with a 16-bit destination address (802.15.4).
+ * @return the frame's size; 0 if @a capacity is too small.
+ */
+inline size_t encodeTxRequest16(uint8_t *buffer, size_t capacity, uint8_t frameId,
+                                uint16_t destination, uint8_t options,
+                                const void *data, size_t size)
+{
+    return FrameWriter(buffer, capacity).begin(TxRequest16Id, frameId)
+            .put16(destination).put8(options).put(data, size).finish();
+}
+
+/**
+ * @brief Encodes a TX request with a 64-bit destination address (802.15.4).
+ * @return the frame's size; 0 if @a capacity is too small.
+ */
+inline size_t encodeTxRequest64(uint8_t *buffer, size_t capacity, uint8_t frameId,
+                                uint64_t destination, uint8_t options,
+                                const void *data, size_t size)
+{
+    return FrameWriter(buffer, capacity).begin(TxRequest64Id, frameId)
+            .put64(destination).put8(options).put(data, size).finish();
+}
+
+/**
+ * @brief Encodes a ZigBee transmit request.
+ * @return the frame's size; 0 if @a capacity is too small.
+ */
+inline size_t encodeZBTxRequest(uint8_t *buffer, size_t capacity, uint8_t frameId,
+                                uint64_t destination64, uint16_t destination16,
+                                uint8_t broadcastRadius, uint8_t options,
+                                const void *data, size_t size)
+{
+    return FrameWriter(buffer, capacity).begin(ZBTxRequestId, frameId)
+            .put64(destination64).put16(destination16).put8(broadcastRadius).put8(options)
+            .put(data, size).finish();
+}
+
+/**
+ * @brief Encodes a local AT command.
+ * @param command the two command characters (e.g. "NI")
+ * @return the frame's size; 0 if @a capacity is too small.
+ */
+inline size_t encodeATCommand(uint8_t *buffer, size_t capacity, uint8_t frameId,
+                              const char *command, const void *parameter, size_t size)
+{
+    return FrameWriter(buffer, capacity).begin(ATCommandId, frameId)
+            .put(command, 2).put(parameter, size).finish();
+}
+
+/**
+ * @brief Encodes a remote AT command request.
+ * @param command the two command characters (e.g. "D0")
+ * @return the frame's size; 0 if @a capacity is too small.
+ */
+inline size_t encodeRemoteATCommand(uint8_t *buffer, size_t capacity, uint8_t frameId,
+                                    uint64_t destination64, uint16_t destination16, uint8_t options,
+                                    const char *command, const void *parameter, size_t size)
+{
+    return FrameWriter(buffer, capacity).begin(RemoteATCommandRequestId, frameId)
+            .put64(destination64).put16(destination16).put8(options)
+            .put(command, 2).put(parameter, size).finish();
+}
+
+/**
+ * @brief The FrameView class reads the fields of an unescaped frame, without copying it.
+ *
+ * Reads out of the frame return 0, so that truncated frames can't be read past their end.
+ * @code
+ * const Codec::FrameView view(frame, size);
+ * if(view.apiId() == Codec::Rx16ResponseId) {
+ *     const uint16_t source = view.u16(Codec::Layout::Rx16Response::Source);
+ *     ...
+ * }
+ * @endcode
+ */
+class FrameView
+{
+public:
+    FrameView() :
+        m_frame(0),
+        m_size(0)
+    {
+    }
+
+    FrameView(const uint8_t *frame, size_t size) :
+        m_frame(frame),
+        m_size(size)
+    {
+    }
+
+    /** @brief Returns true if the view holds exactly one complete frame, with a good checksum; false otherwise. */
+    bool isValid() const
+    {
+        size_t size = 0;
+        return m_size >= FrameOverhead + 1 &&
+               m_frame[0] == StartDelimiter &&
+               scanFrame(m_frame, m_size, &size) == FrameFound &&
+               size == m_size;
+    }
+
+    const uint8_t * frame() const { return m_frame; }
+    size_t size() const { return m_size; }
+
+    uint8_t apiId() const { return u8(Layout::Frame::ApiId); }
+    uint8_t frameId() const { return u8(Layout::Frame::FrameId); }
+
+    uint8_t u8(size_t offset) const
+    {
+        return offset < m_size ? m_frame[offset] : 0;
+    }
+
+    /** @brief Returns the big-endian 16-bit field at the given offset */
+    uint16_t u16(size_t offset) const
+    {
+        return offset + 2 <= m_size ? (uint16_t)((m_frame[offset] << 8) | m_frame[offset + 1]) : 0;
+    }
+
+    /** @brief Returns the big-endian 64-bit field at the given offset */
+    uint64_t u64(size_t offset) const
+    {
+        uint64_t value = 0;
+        if(offset + 8 <= m_size) {
+            for(size_t i=0; i<8; i++) {
+                value = (value << 8) | m_frame[offset + i];
+            }
+        }
+        return value;
+    }
+
+    /** @brief Returns the variable-size part starting at the given offset (see Layout) */
+    const uint8_t * data(size_t offset) const
+    {
+        return m_frame + offset;
+    }
+
+    /** @brief Returns the size of the variable-size part starting at the given offset, checksum excluded */
+    size_t dataSize(size_t offset) const
+    {
+        return offset + 1 < m_size ? m_size - offset - 1 : 0;
+    }
+
+private:
+    const uint8_t * m_frame;
+    size_t          m_size;
+};
+
+/**
+ * @brief The FrameParser class extracts the frames from a byte stream, one byte at a time.
+ *
+ * Frames are assembled in a fixed buffer of @a Capacity bytes: larger frames are dropped.
+ * Garbage before a start delimiter is skipped, and frames with a bad checksum are dropped and counted.
+ * In API mode 2 (AP=2), setEscaped() must be enabled: escaped bytes are then restored,
+ * and a start delimiter always starts a new frame.
+ *
+ * Unlike FrameDecoder, the parser doesn't keep the bytes of a bad frame to look for a start delimiter inside them:
+ * it resumes at the next start delimiter received.
+ * @code
+ * static Codec::FrameParser<64> parser;
+ * while(Serial.available()) {
+ *     if(parser.push(Serial.read())) {
+ *         handle(parser.view());
+ *     }
+ * }
+ * @endcode
+ */
+template<size_t Capacity>
+class FrameParser
+{
+public:
+    FrameParser() :
+        m_size(0),
+        m_expected(0),
+        m_frameSize(0),
+        m_errors(0),
+        m_escaped(false),
+        m_pendingEscape(false)
+    {
+    }
+
+    void setEscaped(bool escaped)
+    {
+        m_escaped = escaped;
+        m_pendingEscape = false;
+    }
+
+    bool isEscaped() const { return m_escaped; }
+
+    /**
+     * @brief Pushes the next received byte.
+     * @return true if a frame has been completed; it can then be read until the next push.
+     */
+    bool push(uint8_t c)
+    {
+        bool delimiter = c == StartDelimiter;
+
+        m_frameSize = 0;
+        if(m_escaped) {
+            if(delimiter) {
+                if(m_size > 0) {
+                    m_errors++; // truncated frame
+                    m_size = 0;
+                }
+                m_pendingEscape = false;
+            }
+            else if(m_pendingEscape) {
+                c = (uint8_t)(c ^ 0x20);
+                m_pendingEscape = false;
+            }
+            else if(c == Escape) {
+                m_pendingEscape = true;
+                return false;
+            }
+        }
+
+        if(m_size == 0) {
+            if(delimiter) {
+                m_buffer[m_size++] = c;
+            }
+            return false;
+        }
+
+        m_buffer[m_size++] = c;
+        if(m_size == 3) {
+            m_expected = (((uint32_t)m_buffer[1] << 8) | m_buffer[2]) + FrameOverhead;
+            if(m_expected > Capacity) {
+                m_errors++;
+                m_size = 0;
+            }
+            return false;
+        }
+        if(m_size < 3 || m_size < m_expected) {
+            return false;
+        }
+
+        m_size = 0;
+        if(checksum(m_buffer + Layout::Frame::ApiId, m_expected - 4) != m_buffer[m_expected - 1]) {
+            m_errors++;
+            return false;
+        }
+        m_frameSize = (size_t)m_expected;
+        return true;
+    }
+
+    /**
+     * @brief Pushes the given bytes until a frame is completed.
+     * @return the number of bytes consumed; the remaining ones must be pushed once the frame has been read.
+     */
+    size_t feed(const uint8_t *data, size_t size)
+    {
+        for(size_t i=0; i<size; i++) {
+            if(push(data[i])) {
+                return i + 1;
+            }
+        }
+        return size;
+    }
+
+    /** @brief Drops the frame being received */
+    void reset()
+    {
+        m_size = 0;
+        m_frameSize = 0;
+        m_pendingEscape = false;
+    }
+
+    /** @brief Returns true if a frame has just been completed; false otherwise. */
+    bool hasFrame() const { return m_frameSize > 0; }
+
+    const uint8_t * frame() const { return m_buffer; }
+    size_t frameSize() const { return m_frameSize; }
+    FrameView view() const { return FrameView(m_buffer, m_frameSize); }
+
+    /** @brief Returns the number of frames dropped (bad checksum, too large or truncated) */
+    uint32_t errorCount() const { return m_errors; }
+
+private:
+    uint8_t     m_buffer[Capacity];
+    size_t      m_size;
+    uint32_t    m_expected;
+    size_t      m_frameSize;
+    uint32_t    m_errors;
+    bool        m_escaped;
+    bool        m_pendingEscape;
+};
+
+}} // END namespace
+
+#endif // XBEECODEC_H
@@ -0,0 +1,414 @@
+/*
+ * Copyright (C) 2015 ThomArmax (Thomas COIN)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * Thomas COIN <esvcorp@gmail.com> 18/04/2015
+ */
+
+
+#include "CommandModeEngine"
+
+#include <QDebug>
+#include <QIODevice>
+
+namespace QtXBee {
+
+/**
+ * @brief CommandModeEngine's constructor
+ *
+ * The timings are initialized to the XBee's defaults (GT = 1 s, CT = 10 s).
+ * @param parent parent object
+ */
+CommandModeEngine::CommandModeEngine(QObject *parent) :
+    QObject(parent),
+    m_device(NULL),
+    m_state(Idle),
+    m_guardTime(1000),
+    m_commandModeTimeout(10000),
+    m_responseTimeout(2000),
+    m_sequenceCharacter('+'),
+    m_maxLineSize(256),
+    m_overflow(false)
+{
+    m_timer.setSingleShot(true);
+    m_commandModeTimer.setSingleShot(true);
+    connect(&m_timer, SIGNAL(timeout()), SLOT(onTimeout()));
+    connect(&m_commandModeTimer, SIGNAL(timeout()), SLOT(onCommandModeTimeout()));
+}
+
+/**
+ * @brief Sets the device (usually the XBee's serial port) on which the commands are written.
+ *
+ * The received data must be given to processData().
+ * @param device
+ */
+void CommandModeEngine::setDevice(QIODevice *device)
+{
+    abort();
+    m_device = device;
+}
+
+/**
+ * @brief Returns the device on which the commands are written
+ */
+QIODevice *CommandModeEngine::device() const
+{
+    return m_device;
+}
+
+/**
+ * @brief Sets the guard time (must match the XBee's GT parameter)
+ * @param ms the guard time, in milliseconds
+ */
+void CommandModeEngine::setGuardTime(const int ms)
+{
+    m_guardTime = ms;
+}
+
+/**
+ * @brief Returns the guard time, in milliseconds
+ */
+int CommandModeEngine::guardTime() const
+{
+    return m_guardTime;
+}
+
+/**
+ * @brief Sets the command mode timeout (must match the XBee's CT parameter)
+ * @param ms the timeout, in milliseconds
+ */
+void CommandModeEngine::setCommandModeTimeout(const int ms)
+{
+    m_commandModeTimeout = ms;
+}
+
+/**
+ * @brief Returns the command mode timeout, in milliseconds
+ */
+int CommandModeEngine::commandModeTimeout() const
+{
+    return m_commandModeTimeout;
+}
+
+/**
+ * @brief Sets the maximum time to wait for each response line
+ * @param ms the timeout, in milliseconds
+ */
+void CommandModeEngine::setResponseTimeout(const int ms)
+{
+    m_responseTimeout = ms;
+}
+
+/**
+ * @brief Returns the maximum time to wait for each response line, in milliseconds
+ */
+int CommandModeEngine::responseTimeout() const
+{
+    return m_responseTimeout;
+}
+
+/**
+ * @brief Sets the command sequence character (must match the XBee's CC parameter)
+ * @param c
+ */
+void CommandModeEngine::setSequenceCharacter(const char c)
+{
+    m_sequenceCharacter = c;
+}
+
+/**
+ * @brief Returns the command sequence character
+ */
+char CommandModeEngine::sequenceCharacter() const
+{
+    return m_sequenceCharacter;
+}
+
+/**
+ * @brief Sets the maximum size of a received line.
+ *
+ * Longer lines are dropped, up to their trailing CR.
+ * @param size
+ */
+void CommandModeEngine::setMaxLineSize(const int size)
+{
+    m_maxLineSize = size;
+}
+
+/**
+ * @brief Returns the maximum size of a received line
+ */
+int CommandModeEngine::maxLineSize() const
+{
+    return m_maxLineSize;
+}
+
+/**
+ * @brief Returns the engine's state
+ */
+CommandModeEngine::State CommandModeEngine::state() const
+{
+    return m_state;
+}
+
+/**
+ * @brief Returns true if the XBee is in command mode; false otherwise.
+ */
+bool CommandModeEngine::isInCommandMode() const
+{
+    return m_state == Ready || m_state == WaitingResponses;
+}
+
+/**
+ * @brief Starts entering the command mode.
+ *
+ * The command sequence is sent after a guard time of silence;
+ * the commandModeEntered() signal is emitted when the XBee answers "OK".
+ * @return true if succeeded; false if no device is set.
+ */
+bool CommandModeEngine::enterCommandMode()
+{
+    if(!m_device || !m_device->isOpen()) {
+        qWarning() << Q_FUNC_INFO << "No device";
+        return false;
+    }
+    if(m_state != Idle) {
+        return true;
+    }
+
+    m_buffer.clear();
+    m_overflow = false;
+    setState(GuardBefore);
+    m_timer.start(m_guardTime);
+    return true;
+}
+
+/**
+ * @brief Sends the given command line, eg. "ATID1234,CH0C,WR,CN".
+ *
+ * The line may contain several comma separated commands, which are written at once;
+ * responseReceived() is emitted for each one of them. If the XBee isn't in command mode yet,
+ * the line is written once it is.
+ * @param line the command line, with or without the leading "AT" and trailing CR.
+ * @return true if succeeded; false if no device is set.
+ */
+bool CommandModeEngine::sendCommands(const QByteArray &line)
+{
+    QByteArray l = line.trimmed();
+
+    if(!m_device) {
+        qWarning() << Q_FUNC_INFO << "No device";
+        return false;
+    }
+    if(l.isEmpty()) {
+        return false;
+    }
+    if(!l.toUpper().startsWith("AT")) {
+        l.prepend("AT");
+    }
+
+    m_pendingLines.append(l);
+    if(m_state == Idle) {
+        return enterCommandMode();
+    }
+    if(m_state == Ready) {
+        writePending();
+    }
+    return true;
+}
+
+/**
+ * @brief Sends the given commands (without "AT") in a single line.
+ * @param commands
+ * @return true if succeeded; false otherwise.
+ * @sa CommandModeEngine::sendCommands(const QByteArray &line)
+ */
+bool CommandModeEngine::sendCommands(const QList<QByteArray> &commands)
+{
+    QByteArray line("AT");
+    for(int i=0; i<commands.size(); i++) {
+        if(i > 0) {
+            line.append(',');
+        }
+        line.append(commands.at(i));
+    }
+    return sendCommands(line);
+}
+
+/**
+ * @brief Drops the pending commands and resets the engine to the Idle state.
+ *
+ * commandsFinished(false) is emitted if commands were pending.
+ * The XBee itself leaves the command mode after its CT timeout.
+ */
+void CommandModeEngine::abort()
+{
+    const bool wasIn = m_state != Idle;
+    const bool pending = !m_pendingLines.isEmpty() || !m_expected.isEmpty();
+    m_timer.stop();
+    m_commandModeTimer.stop();
+    m_pendingLines.clear();
+    m_expected.clear();
+    m_buffer.clear();
+    m_overflow = false;
+    setState(Idle);
+    if(pending) {
+        emit commandsFinished(false);
+    }
+    if(wasIn) {
+        emit commandModeExited();
+    }
+}
+
+/**
+ * @brief Processes the data received from the device.
+ * @param data
+ */
+void CommandModeEngine::processData(const QByteArray &data)
+{
+    for(int i=0; i<data.size(); i++) {
+        const char c = data.at(i);
+        if(c == 0x0D) {
+            if(!m_overflow) {
+                processLine(m_buffer);
+            }
+            m_buffer.clear();
+            m_overflow = false;
+        }
+        else if(m_overflow) {
+            continue;
+        }
+        else if(m_buffer.size() >= m_maxLineSize) {
+            qWarning() << Q_FUNC_INFO << "Line too long, dropped";
+            m_buffer.clear();
+            m_overflow = true;
+        }
+        else {
+            m_buffer.append(c);
+        }
+    }
+}
+
+void CommandModeEngine::onTimeout()
+{
+    switch(m_state) {
+    case GuardBefore :
+        // Silence elapsed: send the sequence, the XBee answers after another guard time
+        m_device->write(QByteArray(3, m_sequenceCharacter));
+        setState(WaitingOk);
+        m_timer.start(m_guardTime + m_responseTimeout);
+        break;
+    case WaitingOk :
+        qWarning() << Q_FUNC_INFO << "XBee failed to enter in command mode";
+        m_pendingLines.clear();
+        setState(Idle);
+        emit commandsFinished(false);
+        break;
+    case WaitingResponses :
+        qWarning() << Q_FUNC_INFO << "No response to" << m_expected.first();
+        finish(false);
+        break;
+    default:
+        break;
+    }
+}
+
+void CommandModeEngine::onCommandModeTimeout()
+{
+    if(isInCommandMode()) {
+        qDebug() << Q_FUNC_INFO << "Command mode timeout";
+        abort();
+    }
+}
+
+void CommandModeEngine::setState(const State state)
+{
+    m_state = state;
+}
+
+void CommandModeEngine::processLine(const QByteArray &line)
+{
+    emit lineReceived(line);
+
+    if(m_state == WaitingOk) {
+        if(line == "OK") {
+            m_timer.stop();
+            setState(Ready);
+            m_commandModeTimer.start(m_commandModeTimeout);
+            emit commandModeEntered();
+            writePending();
+        }
+        return;
+    }
+
+    if(m_state != WaitingResponses || m_expected.isEmpty()) {
+        return;
+    }
+
+    const QByteArray command = m_expected.takeFirst();
+    emit responseReceived(command, line);
+
+    if(line == "ERROR") {
+        // The XBee stops executing the line on error
+        finish(false);
+    }
+    else if(command.toUpper() == "CN") {
+        m_timer.stop();
+        m_commandModeTimer.stop();
+        m_expected.clear();
+        m_pendingLines.clear();
+        setState(Idle);
+        emit commandsFinished(true);
+        emit commandModeExited();
+    }
+    else if(m_expected.isEmpty()) {
+        finish(true);
+    }
+    else {
+        m_timer.start(m_responseTimeout);
+    }
+}
+
+void CommandModeEngine::writePending()
+{
+    if(m_pendingLines.isEmpty()) {
+        return;
+    }
+
+    const QByteArray line = m_pendingLines.takeFirst();
+    foreach(const QByteArray & command, line.mid(2).split(',')) {
+        m_expected.append(command.trimmed());
+    }
+
+    m_device->write(QByteArray(line).append(0x0D));
+    setState(WaitingResponses);
+    m_timer.start(m_responseTimeout);
+    m_commandModeTimer.start(m_commandModeTimeout);
+}
+
+void CommandModeEngine::finish(const bool ok)
+{
+    m_timer.stop();
+    m_expected.clear();
+    setState(Ready);
+    if(!ok) {
+        m_pendingLines.clear();
+    }
+    emit commandsFinished(ok);
+    writePending();
+}
+
+} // END namespace
@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2015 ThomArmax (Thomas COIN)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * Thomas COIN <esvcorp@gmail.com> 18/04/2015
+ */
+
+
+#ifndef COMMANDMODEENGINE_H
+#define COMMANDMODEENGINE_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QList>
+
+#include "WheelTimer"
+
+class QIODevice;
+
+namespace QtXBee {
+
+/**
+ * @brief The CommandModeEngine class drives the XBee's command mode (AT transparent mode) asynchronously.
+ *
+ * The guard times surrounding the command sequence ("+++") are handled with timers, and
+ * several commands can be sent in a single line; each response line is reported as soon as it is received :
+ * @code
+ * engine->enterCommandMode();
+ * engine->sendCommands("ATID1234,CH0C,WR,CN");
+ * // responseReceived("ID1234", "OK"), responseReceived("CH0C", "OK"), ...
+ * @endcode
+ * Commands sent while entering the command mode are written once the XBee has answered "OK".
+ * The reception buffer is bounded, see setMaxLineSize().
+ * @sa XBee::commandModeEngine()
+ */
+class CommandModeEngine : public QObject
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief The State enum defines the engine's states
+     */
+    enum State {
+        Idle,               /**< Not in command mode */
+        GuardBefore,        /**< Waiting the guard time before sending the command sequence */
+        WaitingOk,          /**< Command sequence sent, waiting for "OK" */
+        Ready,              /**< In command mode, no command pending */
+        WaitingResponses    /**< In command mode, waiting for responses */
+    };
+
+    explicit                CommandModeEngine       (QObject *parent = 0);
+
+    void                    setDevice               (QIODevice * device);
+    QIODevice *             device                  () const;
+
+    void                    setGuardTime            (const int ms);
+    int                     guardTime               () const;
+    void                    setCommandModeTimeout   (const int ms);
+    int                     commandModeTimeout      () const;
+    void                    setResponseTimeout      (const int ms);
+    int                     responseTimeout         () const;
+    void                    setSequenceCharacter    (const char c);
+    char                    sequenceCharacter       () const;
+    void                    setMaxLineSize          (const int size);
+    int                     maxLineSize             () const;
+
+    State                   state                   () const;
+    bool                    isInCommandMode         () const;
+
+    bool                    enterCommandMode        ();
+    bool                    sendCommands            (const QByteArray & line);
+    bool                    sendCommands            (const QList<QByteArray> & commands);
+    void                    abort                   ();
+
+    void                    processData             (const QByteArray & data);
+
+signals:
+    void                    commandModeEntered      ();                                                     /**< @brief Emitted when the XBee answered "OK" to the command sequence */
+    void                    commandModeExited       ();                                                     /**< @brief Emitted when the XBee left the command mode (CN, timeout or abort) */
+    void                    lineReceived            (const QByteArray & line);                              /**< @brief Emitted for each received line (without the trailing CR) */
+    void                    responseReceived        (const QByteArray & command, const QByteArray & response); /**< @brief Emitted for each response line, with the command it answers (without "AT") */
+    void                    commandsFinished        (bool ok);                                              /**< @brief Emitted when all the sent commands have been answered; @a ok is false on ERROR or timeout */
+
+private slots:
+    void                    onTimeout               ();
+    void                    onCommandModeTimeout    ();
+
+private:
+    void                    setState                (const State state);
+    void                    processLine             (const QByteArray & line);
+    void                    writePending            ();
+    void                    finish                  (const bool ok);
+
+    QIODevice *             m_device;
+    State                   m_state;
+    int                     m_guardTime;            /**< GT, in milliseconds */
+    int                     m_commandModeTimeout;   /**< CT, in milliseconds */
+    int                     m_responseTimeout;      /**< Maximum time between two response lines, in milliseconds */
+    char                    m_sequenceCharacter;    /**< CC */
+    int                     m_maxLineSize;
+    QByteArray              m_buffer;               /**< Received bytes of the current line */
+    QList<QByteArray>       m_pendingLines;         /**< Lines to write once in command mode */
+    QList<QByteArray>       m_expected;             /**< Sent commands waiting for their response */
+    bool                    m_overflow;             /**< The current line is too long and is being dropped */
+    WheelTimer              m_timer;                /**< Guard time / response timeout */
+    WheelTimer              m_commandModeTimer;     /**< Command mode timeout (CT) */
+};
+
+} // END namespace
+
+#endif // COMMANDMODEENGINE_H
@@ -0,0 +1,225 @@
+/*
+ * Copyright (C) 2015 ThomArmax (Thomas COIN)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * Thomas COIN <esvcorp@gmail.com> 18/04/2015
+ */
+
+
+#include "FrameDecoder"
+#include "XBeePacket"
+#include "codec/XBeeCodec"
+
+#include <QDebug>
+
+namespace QtXBee {
+
+/**
+ * @brief FrameDecoder's constructor
+ */
+FrameDecoder::FrameDecoder() :
+    m_pos(0),
+    m_maxFrameSize(DefaultMaxFrameSize),
+    m_escaped(false),
+    m_pendingEscape(false)
+{
+}
+
+/**
+ * @brief Appends the given received bytes to the decoder's buffer
+ * @param data
+ * @param timestamp the time the bytes were read (see QtXBee::monotonicTime()); 0 if unknown
+ */
+void FrameDecoder::append(const QByteArray &data, const qint64 timestamp)
+{
+    compact();
+
+    if(!data.isEmpty()) {
+        ReadMark mark;
+        mark.offset = m_buffer.size();
+        mark.timestamp = timestamp;
+        if(!m_marks.isEmpty() && m_marks.last().offset == mark.offset) {
+            // The previous read only held an escape byte
+            m_marks.last() = mark;
+        }
+        else {
+            m_marks.append(mark);
+        }
+    }
+
+    if(!m_escaped) {
+        m_buffer.append(data);
+        return;
+    }
+
+    m_buffer.reserve(m_buffer.size() + data.size());
+    for(int i=0; i<data.size(); i++) {
+        const char c = data.at(i);
+        if(m_pendingEscape) {
+            m_buffer.append(c ^ 0x20);
+            m_pendingEscape = false;
+        }
+        else if(c == (char)XBeePacket::Escape) {
+            m_pendingEscape = true;
+        }
+        else {
+            m_buffer.append(c);
+        }
+    }
+}
+
+/**
+ * @brief Extracts the next complete frame (start delimiter, length, frame data and checksum).
+ * @param frame the extracted frame
+ * @param timestamp if not null, set to the timestamp of the read holding the frame's start delimiter
+ * @return true if a frame has been extracted; false if more bytes are needed.
+ */
+bool FrameDecoder::takeFrame(QByteArray *frame, qint64 *timestamp)
+{
+    Q_ASSERT(frame);
+
+    forever {
+        const int start = m_buffer.indexOf((char)XBeePacket::StartDelimiter, m_pos);
+        if(start < 0) {
+            m_pos = m_buffer.size();
+            return false;
+        }
+        m_pos = start;
+
+        // A start delimiter in noise may announce up to 64 KB: don't wait for it, resynchronize
+        if(m_buffer.size() - m_pos >= 3) {
+            const int length = ((quint8)m_buffer.at(m_pos + 1) << 8) | (quint8)m_buffer.at(m_pos + 2);
+            if(length + 4 > m_maxFrameSize) {
+                qWarning() << Q_FUNC_INFO << "Frame too long (" << length + 4 << "bytes), dropping its start delimiter";
+                m_pos++;
+                continue;
+            }
+        }
+
+        size_t total = 0;
+        const Codec::ScanResult result = Codec::scanFrame((const quint8*)m_buffer.constData() + m_pos,
+                                                          m_buffer.size() - m_pos, &total);
+        if(result == Codec::NeedMoreData) {
+            return false;
+        }
+        if(result == Codec::BadChecksum) {
+            qWarning() << Q_FUNC_INFO << "Bad checksum, dropping" << m_buffer.mid(m_pos, total).toHex();
+            m_pos++;
+            continue;
+        }
+
+        *frame = m_buffer.mid(m_pos, total);
+        if(timestamp) {
+            *timestamp = timestampAt(m_pos);
+        }
+        m_pos += total;
+        return true;
+    }
+}
+
+/**
+ * @brief Returns the number of bytes not consumed yet
+ */
+int FrameDecoder::bytesAvailable() const
+{
+    return m_buffer.size() - m_pos;
+}
+
+/**
+ * @brief Drops all buffered bytes
+ */
+void FrameDecoder::clear()
+{
+    m_buffer.clear();
+    m_pos = 0;
+    m_pendingEscape = false;
+    m_marks.clear();
+}
+
+/**
+ * @brief Sets the size of the longest frame accepted (512 bytes by default), start delimiter and checksum included.
+ *
+ * A start delimiter announcing a longer frame is taken as noise and skipped, instead of holding back
+ * the following frames while waiting for up to 64 KB.
+ * @param size
+ */
+void FrameDecoder::setMaxFrameSize(const int size)
+{
+    m_maxFrameSize = size;
+}
+
+/**
+ * @brief Returns the size of the longest frame accepted.
+ * @sa FrameDecoder::setMaxFrameSize()
+ */
+int FrameDecoder::maxFrameSize() const
+{
+    return m_maxFrameSize;
+}
+
+/**
+ * @brief Enables or disables the restoration of escaped bytes (API mode 2)
+ * @param escaped
+ * @sa XBeePacket::unescape()
+ */
+void FrameDecoder::setEscaped(const bool escaped)
+{
+    m_escaped = escaped;
+    m_pendingEscape = false;
+}
+
+/**
+ * @brief Returns true if the escaped bytes are restored (API mode 2); false otherwise.
+ */
+bool FrameDecoder::isEscaped() const
+{
+    return m_escaped;
+}
+
+void FrameDecoder::compact()
+{
+    if(m_pos <= 0) {
+        return;
+    }
+
+    // Keep the mark covering m_pos, drop the older ones
+    int first = 0;
+    while(first + 1 < m_marks.size() && m_marks.at(first + 1).offset <= m_pos) {
+        first++;
+    }
+    m_marks.remove(0, first);
+    for(int i=0; i<m_marks.size(); i++) {
+        m_marks[i].offset = qMax(0, m_marks.at(i).offset - m_pos);
+    }
+    if(m_pos >= m_buffer.size()) {
+        m_marks.clear();
+    }
+
+    m_buffer.remove(0, m_pos);
+    m_pos = 0;
+}
+
+qint64 FrameDecoder::timestampAt(const int offset) const
+{
+    for(int i=m_marks.size()-1; i>=0; i--) {
+        if(m_marks.at(i).offset <= offset) {
+            return m_marks.at(i).timestamp;
+        }
+    }
+    return 0;
+}
+
+} // END namespace
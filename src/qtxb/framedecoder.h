@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2015 ThomArmax (Thomas COIN)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * Thomas COIN <esvcorp@gmail.com> 18/04/2015
+ */
+
+
+#ifndef FRAMEDECODER_H
+#define FRAMEDECODER_H
+
+#include <QByteArray>
+#include <QVector>
+
+namespace QtXBee {
+
+/**
+ * @brief The FrameDecoder class splits the bytes received from the serial port into API frames.
+ *
+ * Received bytes are appended with append(), complete frames are then extracted with takeFrame().
+ * Garbage before a start delimiter, frames with a bad checksum and frames longer than maxFrameSize() are dropped.
+ * In API mode 2 (AP=2), setEscaped() must be enabled so that the escaped bytes are restored when appended.
+ *
+ * Each append can be given the time the bytes were read: a frame gets the time of the read holding its start delimiter.
+ * @code
+ * decoder.append(serial->readAll(), monotonicTime());
+ * while(decoder.takeFrame(&frame, &timestamp)) {
+ *     processPacket(frame, timestamp);
+ * }
+ * @endcode
+ */
+class FrameDecoder
+{
+public:
+    static const int        DefaultMaxFrameSize = 512; /**< Default FrameDecoder::maxFrameSize(), in bytes */
+
+    explicit                FrameDecoder            ();
+
+    void                    append                  (const QByteArray & data, const qint64 timestamp = 0);
+    bool                    takeFrame               (QByteArray * frame, qint64 * timestamp = 0);
+    int                     bytesAvailable          () const;
+    void                    clear                   ();
+
+    void                    setMaxFrameSize         (const int size);
+    int                     maxFrameSize            () const;
+    void                    setEscaped              (const bool escaped);
+    bool                    isEscaped               () const;
+
+private:
+    struct ReadMark {
+        int                 offset;                 /**< Offset in m_buffer of the first byte of the read */
+        qint64              timestamp;
+    };
+
+    void                    compact                 ();
+    qint64                  timestampAt             (const int offset) const;
+
+    QByteArray              m_buffer;               /**< Received bytes */
+    int                     m_pos;                  /**< Read position in m_buffer */
+    int                     m_maxFrameSize;         /**< Longer frames are dropped */
+    bool                    m_escaped;              /**< Escaped bytes are restored (AP=2) */
+    bool                    m_pendingEscape;        /**< The last appended byte was an escape byte */
+    QVector<ReadMark>       m_marks;                /**< Timestamped reads, by increasing offset */
+};
+
+} // END namespace
+
+#endif // FRAMEDECODER_H
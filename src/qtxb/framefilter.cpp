@@ -0,0 +1,322 @@
+/*
+ * Copyright (C) 2015 ThomArmax (Thomas COIN)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * Thomas COIN <esvcorp@gmail.com> 18/04/2015
+ */
+
+
+
+#include "FrameFilter"
+#include "XBeePacket"
+
+#include <QDebug>
+#include <QStringList>
+#include <cstring>
+
+namespace QtXBee {
+
+/**
+ * @brief Constructs an empty filter, accepting every frame
+ */
+FrameFilter::FrameFilter()
+{
+    clear();
+}
+
+/**
+ * @brief Adds @a apiId to the accepted frame types
+ * @param apiId
+ * @sa XBeePacket::ApiId
+ */
+void FrameFilter::addFrameType(const quint8 apiId)
+{
+    m_types[apiId >> 5] |= 1u << (apiId & 0x1F);
+    m_anyType = false;
+    updateEmpty();
+}
+
+/**
+ * @brief Adds @a address to the accepted 16-bit source addresses
+ * @param address
+ */
+void FrameFilter::addSourceAddress16(const quint16 address)
+{
+    if(m_addresses16.isEmpty()) {
+        m_addresses16.resize(0x10000);
+    }
+    m_addresses16.setBit(address);
+    updateEmpty();
+}
+
+/**
+ * @brief Adds @a address to the accepted 64-bit source addresses
+ * @param address
+ */
+void FrameFilter::addSourceAddress64(const quint64 address)
+{
+    m_addresses64.insert(address);
+    updateEmpty();
+}
+
+/**
+ * @brief Only accepts the frames whose receive options, masked with @a mask, equal @a value
+ * @param mask 0 removes the criterion
+ * @param value
+ */
+void FrameFilter::setOptions(const quint8 mask, const quint8 value)
+{
+    m_optionMask = mask;
+    m_optionValue = value & mask;
+    updateEmpty();
+}
+
+/**
+ * @brief Adds @a prefix to the accepted payload prefixes
+ * @param prefix
+ */
+void FrameFilter::addPayloadPrefix(const QByteArray &prefix)
+{
+    m_prefixes.append(prefix);
+    if(prefix.isEmpty()) {
+        m_emptyPrefix = true;
+    }
+    else {
+        const quint8 first = prefix.at(0);
+        m_prefixFirstBytes[first >> 5] |= 1u << (first & 0x1F);
+    }
+    updateEmpty();
+}
+
+/**
+ * @brief Removes all the criteria, every frame is accepted
+ */
+void FrameFilter::clear()
+{
+    memset(m_types, 0, sizeof(m_types));
+    memset(m_prefixFirstBytes, 0, sizeof(m_prefixFirstBytes));
+    m_anyType = true;
+    m_addresses16.clear();
+    m_addresses64.clear();
+    m_optionMask = 0;
+    m_optionValue = 0;
+    m_prefixes.clear();
+    m_emptyPrefix = false;
+    m_empty = true;
+}
+
+/**
+ * @brief Returns true if the filter has no criterion (every frame is accepted); false otherwise.
+ */
+bool FrameFilter::isEmpty() const
+{
+    return m_empty;
+}
+
+/**
+ * @brief Returns true if the given raw frame (unescaped, checksum included) passes the filter; false otherwise.
+ * @param frame
+ */
+bool FrameFilter::accepts(const QByteArray &frame) const
+{
+    if(m_empty || frame.size() < 5) {
+        return true;
+    }
+
+    const quint8 apiId = frame.at(3);
+    const Layout * layout = layoutOf(apiId);
+    if(!layout) {
+        // Local frame
+        return true;
+    }
+
+    if(!m_anyType && !(m_types[apiId >> 5] & (1u << (apiId & 0x1F)))) {
+        return false;
+    }
+
+    const uchar * data = reinterpret_cast<const uchar *>(frame.constData());
+    const int end = frame.size() - 1; // Checksum
+    if(end < layout->payload) {
+        return false;
+    }
+
+    if(!m_addresses16.isEmpty() || !m_addresses64.isEmpty()) {
+        bool match = false;
+        if(layout->address16 >= 0 && !m_addresses16.isEmpty()) {
+            match = m_addresses16.testBit((data[layout->address16] << 8) | data[layout->address16 + 1]);
+        }
+        if(!match && layout->address64 >= 0 && !m_addresses64.isEmpty()) {
+            quint64 address = 0;
+            for(int i=0; i<8; i++) {
+                address = (address << 8) | data[layout->address64 + i];
+            }
+            match = m_addresses64.contains(address);
+        }
+        if(!match) {
+            return false;
+        }
+    }
+
+    if(m_optionMask) {
+        if(layout->options < 0 || (data[layout->options] & m_optionMask) != m_optionValue) {
+            return false;
+        }
+    }
+
+    if(!m_prefixes.isEmpty() && !m_emptyPrefix) {
+        const int size = end - layout->payload;
+        const uchar first = size > 0 ? data[layout->payload] : 0;
+        if(size <= 0 || !(m_prefixFirstBytes[first >> 5] & (1u << (first & 0x1F)))) {
+            return false;
+        }
+        bool match = false;
+        foreach(const QByteArray & prefix, m_prefixes) {
+            if(prefix.size() <= size && memcmp(data + layout->payload, prefix.constData(), prefix.size()) == 0) {
+                match = true;
+                break;
+            }
+        }
+        if(!match) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Builds a filter from the given expression.
+ *
+ * The expression is a whitespace separated list of clauses; each clause lists comma separated hexadecimal values:
+ * @li @c type=81,90 accepted frame types;
+ * @li @c src16=0002,fffe accepted 16-bit source addresses;
+ * @li @c src64=0013a20040a1b2c3 accepted 64-bit source addresses;
+ * @li @c options=02/00 receive options mask and expected value;
+ * @li @c prefix=74656d70 accepted payload prefixes.
+ * @param expression
+ * @param ok set to false if the expression is invalid
+ * @return the filter; an empty filter if the expression is invalid.
+ */
+FrameFilter FrameFilter::fromString(const QString &expression, bool *ok)
+{
+    FrameFilter filter;
+    bool valid = true;
+
+    const QString simplified = expression.simplified();
+    const QStringList clauses = simplified.isEmpty() ? QStringList() : simplified.split(' ');
+
+    foreach(const QString & clause, clauses) {
+        const int separator = clause.indexOf('=');
+        const QString name = clause.left(separator).toLower();
+        const QStringList values = clause.mid(separator + 1).split(',');
+
+        if(separator <= 0) {
+            valid = false;
+        }
+        foreach(const QString & value, values) {
+            bool converted = false;
+            if(name == "type") {
+                const uint apiId = value.toUInt(&converted, 16);
+                converted = converted && apiId <= 0xFF;
+                if(converted) filter.addFrameType(apiId);
+            }
+            else if(name == "src16") {
+                const uint address = value.toUInt(&converted, 16);
+                converted = converted && address <= 0xFFFF;
+                if(converted) filter.addSourceAddress16(address);
+            }
+            else if(name == "src64") {
+                const quint64 address = value.toULongLong(&converted, 16);
+                if(converted) filter.addSourceAddress64(address);
+            }
+            else if(name == "options") {
+                const int slash = value.indexOf('/');
+                const uint mask = value.left(slash).toUInt(&converted, 16);
+                bool convertedValue = false;
+                const uint expected = value.mid(slash + 1).toUInt(&convertedValue, 16);
+                converted = converted && slash > 0;
+                converted = converted && convertedValue && mask <= 0xFF && expected <= 0xFF && values.size() == 1;
+                if(converted) filter.setOptions(mask, expected);
+            }
+            else if(name == "prefix") {
+                const QByteArray prefix = QByteArray::fromHex(value.toLatin1());
+                converted = !value.isEmpty() && prefix.size()*2 == value.size();
+                if(converted) filter.addPayloadPrefix(prefix);
+            }
+            if(!converted) {
+                valid = false;
+            }
+        }
+        if(!valid) {
+            qWarning() << Q_FUNC_INFO << "Invalid clause" << clause;
+            break;
+        }
+    }
+
+    if(ok) {
+        *ok = valid;
+    }
+    return valid ? filter : FrameFilter();
+}
+
+/**
+ * @brief Returns true if the given frame type is sent by a remote node (the filter's criteria apply to it); false otherwise.
+ * @param apiId
+ */
+bool FrameFilter::isRemoteFrame(const quint8 apiId)
+{
+    return layoutOf(apiId) != NULL;
+}
+
+/**
+ * @brief Returns the layout of the frames sent by remote nodes; NULL for local frames.
+ * @param apiId
+ */
+const FrameFilter::Layout *FrameFilter::layoutOf(const quint8 apiId)
+{
+    static const Layout rx64        = { 4, -1, 13, 14};
+    static const Layout rx16        = {-1,  4,  7,  8};
+    static const Layout zbRx        = { 4, 12, 14, 15};
+    static const Layout zbExplicitRx= { 4, 12, 20, 21};
+    static const Layout remoteAt    = { 5, 13, -1, 18};
+
+    switch(apiId) {
+    case XBeePacket::Rx64ResponseId :
+    case XBeePacket::Rx64IOResponseId :
+        return &rx64;
+    case XBeePacket::Rx16ResponseId :
+    case XBeePacket::Rx16IOResponseId :
+        return &rx16;
+    case XBeePacket::ZBRxResponseId :
+    case XBeePacket::ZBIOSampleResponseId :
+    case XBeePacket::XBeeSensorReadIndicatorId :
+    case XBeePacket::ZBIONodeIdentificationId :
+        return &zbRx;
+    case XBeePacket::ZBExplicitRxResponseId :
+        return &zbExplicitRx;
+    case XBeePacket::RemoteATCommandResponseId :
+        return &remoteAt;
+    default:
+        return NULL;
+    }
+}
+
+void FrameFilter::updateEmpty()
+{
+    m_empty = m_anyType && m_addresses16.isEmpty() && m_addresses64.isEmpty() && m_optionMask == 0 && m_prefixes.isEmpty();
+}
+
+} // END namespace
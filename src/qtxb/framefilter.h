@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2015 ThomArmax (Thomas COIN)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * Thomas COIN <esvcorp@gmail.com> 18/04/2015
+ */
+
+
+
+#ifndef FRAMEFILTER_H
+#define FRAMEFILTER_H
+
+#include <QBitArray>
+#include <QByteArray>
+#include <QSet>
+#include <QString>
+#include <QVector>
+
+namespace QtXBee {
+
+/**
+ * @brief The FrameFilter class selects the received frames to deliver, before they are decoded.
+ *
+ * The filter is checked on the raw frame: frames it rejects are dropped without building any response object
+ * nor emitting any signal. Its criteria are compiled when added: the frame types into a 256-bit set,
+ * the 16-bit addresses into a 65536-bit set and the 64-bit addresses into a hash set.
+ *
+ * A frame is accepted if it matches all the given criteria:
+ * @li its frame type is one of the given types;
+ * @li its 16-bit or 64-bit source address is one of the given addresses;
+ * @li its receive options, masked, equal the given value;
+ * @li its payload starts with one of the given prefixes.
+ *
+ * A frame which doesn't carry a constrained field is rejected (e.g. a RemoteATCommandResponse has no receive options).
+ * The criteria only apply to the frames sent by remote nodes (Rx, ZigBee Rx, IO samples, node identification,
+ * remote AT command responses): the local frames (AT command responses, modem status, transmit status) are always
+ * delivered, since the XBee class relies on them. The XBee class also delivers, without checking the filter,
+ * the responses to its frames in flight (e.g. a RemoteATCommandResponse from a filtered out node).
+ *
+ * Filters can be written as a whitespace separated list of clauses, all values being hexadecimal:
+ * @code
+ * FrameFilter filter = FrameFilter::fromString("type=81,90 src16=0002,0003 options=02/00 prefix=74656d70");
+ * xbee->setFrameFilter(filter);
+ * @endcode
+ */
+class FrameFilter
+{
+public:
+    explicit                FrameFilter             ();
+
+    void                    addFrameType            (const quint8 apiId);
+    void                    addSourceAddress16      (const quint16 address);
+    void                    addSourceAddress64      (const quint64 address);
+    void                    setOptions              (const quint8 mask, const quint8 value);
+    void                    addPayloadPrefix        (const QByteArray & prefix);
+    void                    clear                   ();
+
+    bool                    isEmpty                 () const;
+    bool                    accepts                 (const QByteArray & frame) const;
+
+    static FrameFilter      fromString              (const QString & expression, bool * ok = 0);
+    static bool             isRemoteFrame           (const quint8 apiId);
+
+private:
+    struct Layout {
+        int                 address64;              /**< Offset of the 64-bit source address; -1 if none */
+        int                 address16;              /**< Offset of the 16-bit source address; -1 if none */
+        int                 options;                /**< Offset of the receive options; -1 if none */
+        int                 payload;                /**< Offset of the payload */
+    };
+
+    static const Layout *   layoutOf                (const quint8 apiId);
+    void                    updateEmpty             ();
+
+    quint32                 m_types[8];             /**< 256-bit set of the accepted frame types */
+    bool                    m_anyType;              /**< No frame type criterion */
+    QBitArray               m_addresses16;          /**< 65536-bit set of the accepted 16-bit addresses; empty if none */
+    QSet<quint64>           m_addresses64;          /**< Accepted 64-bit addresses */
+    quint8                  m_optionMask;           /**< Receive options mask; 0 if no options criterion */
+    quint8                  m_optionValue;          /**< Expected masked receive options */
+    QVector<QByteArray>     m_prefixes;             /**< Accepted payload prefixes */
+    quint32                 m_prefixFirstBytes[8];  /**< 256-bit set of the prefixes first byte */
+    bool                    m_emptyPrefix;          /**< One of the prefixes is empty, every payload matches */
+    bool                    m_empty;                /**< No criterion, every frame is accepted */
+};
+
+} // END namespace
+
+#endif // FRAMEFILTER_H
@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2015 ThomArmax (Thomas COIN)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * Thomas COIN <esvcorp@gmail.com> 18/04/2015
+ */
+
+
+#include "FrameIdAllocator"
+
+namespace QtXBee {
+
+static const int MaxFrameIds = 255;
+
+/**
+ * @brief FrameIdAllocator's constructor, no id is in use.
+ */
+FrameIdAllocator::FrameIdAllocator()
+{
+    clear();
+}
+
+/**
+ * @brief Acquires a free frame id.
+ * @return the acquired id; or 0 if the 255 ids are in use.
+ */
+quint8 FrameIdAllocator::acquire()
+{
+    if(m_count >= MaxFrameIds) {
+        return 0;
+    }
+
+    forever {
+        const quint8 id = m_next;
+        const quint32 word = m_used[id >> 5];
+
+        m_next = m_next == 0xFF ? 1 : m_next + 1;
+
+        if(word == 0xFFFFFFFF) {
+            // Skip the rest of a full word
+            m_next = (id | 0x1F) == 0xFF ? 1 : (id | 0x1F) + 1;
+            continue;
+        }
+        if(!(word & (1u << (id & 0x1F)))) {
+            m_used[id >> 5] |= 1u << (id & 0x1F);
+            m_count++;
+            return id;
+        }
+    }
+}
+
+/**
+ * @brief Releases the given frame id.
+ * @param frameId
+ * @return true if the id was in use; false otherwise.
+ */
+bool FrameIdAllocator::release(const quint8 frameId)
+{
+    if(!isInUse(frameId)) {
+        return false;
+    }
+    m_used[frameId >> 5] &= ~(1u << (frameId & 0x1F));
+    m_count--;
+    return true;
+}
+
+/**
+ * @brief Returns true if the given frame id is in use; false otherwise.
+ * @param frameId
+ */
+bool FrameIdAllocator::isInUse(const quint8 frameId) const
+{
+    return m_used[frameId >> 5] & (1u << (frameId & 0x1F));
+}
+
+/**
+ * @brief Returns the number of frame ids in use.
+ */
+int FrameIdAllocator::inUseCount() const
+{
+    return m_count;
+}
+
+/**
+ * @brief Returns true if the 255 frame ids are in use; false otherwise.
+ */
+bool FrameIdAllocator::isExhausted() const
+{
+    return m_count >= MaxFrameIds;
+}
+
+/**
+ * @brief Releases all the frame ids.
+ */
+void FrameIdAllocator::clear()
+{
+    for(int i=0; i<8; i++) {
+        m_used[i] = 0;
+    }
+    m_next = 1;
+    m_count = 0;
+}
+
+} // END namespace
@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2015 ThomArmax (Thomas COIN)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * Thomas COIN <esvcorp@gmail.com> 18/04/2015
+ */
+
+
+#ifndef FRAMEIDALLOCATOR_H
+#define FRAMEIDALLOCATOR_H
+
+#include <QtGlobal>
+
+namespace QtXBee {
+
+/**
+ * @brief The FrameIdAllocator class hands out the API frame ids (1 to 255) and tracks the ones in use.
+ *
+ * An id is acquired when a frame expecting a response is sent, and released when its response is received
+ * (or when the response is given up), so that a late response can't be attributed to another frame.
+ * Frame id 0 is never allocated: it tells the XBee not to send any response.
+ *
+ * Ids are handed out round-robin, which delays the reuse of a released id as much as possible.
+ * @code
+ * const quint8 id = allocator.acquire();
+ * if(id == 0) {
+ *     // 255 frames are waiting for their response
+ * }
+ * ...
+ * allocator.release(id);
+ * @endcode
+ */
+class FrameIdAllocator
+{
+public:
+    explicit                FrameIdAllocator        ();
+
+    quint8                  acquire                 ();
+    bool                    release                 (const quint8 frameId);
+    bool                    isInUse                 (const quint8 frameId) const;
+    int                     inUseCount              () const;
+    bool                    isExhausted             () const;
+    void                    clear                   ();
+
+private:
+    quint32                 m_used[8];              /**< 256-bit set of the ids in use (bit 0 is never set) */
+    quint8                  m_next;                 /**< Next id to try */
+    int                     m_count;                /**< Number of ids in use */
+};
+
+} // END namespace
+
+#endif // FRAMEIDALLOCATOR_H
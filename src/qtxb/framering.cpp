@@ -0,0 +1,370 @@
+/*
+ * Copyright (C) 2015 ThomArmax (Thomas COIN)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * Thomas COIN <esvcorp@gmail.com> 18/04/2015
+ */
+
+
+
+#include "FrameRing"
+
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <QThread>
+#include <QDebug>
+
+namespace QtXBee {
+
+/**
+ * @brief FrameRing's constructor
+ * @param capacity number of frames the ring holds, rounded up to a power of two
+ * @param parent
+ */
+FrameRing::FrameRing(const int capacity, QObject *parent) :
+    QObject(parent),
+    m_slots(NULL),
+    m_capacity(2),
+    m_mask(1),
+    m_published(-1),
+    m_notified(-1),
+    m_gatingSequence(0),
+    m_blockingCount(0),
+    m_blockTimeout(100)
+{
+    while(m_capacity < capacity) {
+        m_capacity <<= 1;
+    }
+    m_mask = m_capacity - 1;
+    m_slots = new Slot[m_capacity];
+    for(int i=0; i<m_capacity; i++) {
+        m_slots[i].sequence = -1;
+        m_slots[i].timestamp = 0;
+    }
+}
+
+/**
+ * @brief FrameRing's destructor
+ */
+FrameRing::~FrameRing()
+{
+    delete [] m_slots;
+}
+
+/**
+ * @brief Returns the number of frames the ring holds
+ */
+int FrameRing::capacity() const
+{
+    return m_capacity;
+}
+
+/**
+ * @brief Sets how long the producer waits for a FrameRing::Block consumer before overwriting its unread frames (100 ms by default).
+ *
+ * The producer is the XBee's thread: waiting forever for a stuck consumer would stop the XBee, hence the wait is always bounded.
+ * @param msecs from 0 to FrameRing::MaxBlockTimeout
+ * @return true if succeeded; false if @a msecs is out of range.
+ */
+bool FrameRing::setBlockTimeout(const int msecs)
+{
+    if(msecs < 0 || msecs > MaxBlockTimeout) {
+        qWarning() << Q_FUNC_INFO << "Invalid block timeout" << msecs;
+        return false;
+    }
+    m_blockTimeout = msecs;
+    return true;
+}
+
+/**
+ * @brief Returns how long the producer waits for a FrameRing::Block consumer.
+ * @sa FrameRing::setBlockTimeout()
+ */
+int FrameRing::blockTimeout() const
+{
+    return m_blockTimeout;
+}
+
+/**
+ * @brief Publishes a frame to all the consumers.
+ *
+ * Must only be called from one thread (the producer's one).
+ * Consumers are woken up by FrameRing::notify(), so that a batch of frames is notified once.
+ * @param frame
+ * @param timestamp the frame's receive time (see XBeePacket::timestamp())
+ */
+void FrameRing::publish(const QByteArray &frame, const qint64 timestamp)
+{
+    const qint64 sequence = m_published.loadAcquire() + 1;
+
+    if(m_blockingCount.loadAcquire() > 0 && sequence - m_gatingSequence >= m_capacity) {
+        m_gatingSequence = minimumBlockingCursor(sequence);
+        if(sequence - m_gatingSequence >= m_capacity) {
+            QMutexLocker locker(&m_mutex);
+            QElapsedTimer timer;
+            timer.start();
+            while(sequence - (m_gatingSequence = minimumBlockingCursor(sequence)) >= m_capacity) {
+                const qint64 remaining = m_blockTimeout - timer.elapsed();
+                if(remaining <= 0) {
+                    qWarning() << Q_FUNC_INFO << "Blocking consumer too slow, overwriting its frames";
+                    break;
+                }
+                m_spaceAvailable.wait(&m_mutex, remaining);
+            }
+        }
+    }
+
+    Slot & slot = m_slots[sequence & m_mask];
+    lockSlot(slot);
+    slot.frame = frame;
+    slot.timestamp = timestamp;
+    slot.sequence = sequence;
+    slot.lock.storeRelease(0);
+
+    m_published.storeRelease(sequence);
+}
+
+/**
+ * @brief Wakes up the consumers if frames have been published since the last call.
+ *
+ * Emits FrameRing::framesAvailable() once for the whole batch.
+ */
+void FrameRing::notify()
+{
+    const qint64 published = m_published.loadAcquire();
+
+    if(published == m_notified) {
+        return;
+    }
+    m_notified = published;
+    {
+        QMutexLocker locker(&m_mutex);
+        m_frameAvailable.wakeAll();
+    }
+    emit framesAvailable();
+}
+
+/**
+ * @brief Returns the number of frames published since the ring's creation.
+ */
+qint64 FrameRing::publishedCount() const
+{
+    return m_published.loadAcquire() + 1;
+}
+
+/**
+ * @brief Attaches a new consumer, which reads the frames published from now on.
+ * @param policy what happens when the consumer falls behind
+ * @return the consumer's id; -1 if FrameRing::MaxConsumers consumers are already attached.
+ */
+int FrameRing::attach(const OverflowPolicy policy)
+{
+    QMutexLocker locker(&m_mutex);
+
+    for(int i=0; i<MaxConsumers; i++) {
+        Consumer & consumer = m_consumers[i];
+        if(consumer.policy.loadAcquire() == 0) {
+            consumer.cursor.storeRelease(m_published.loadAcquire() + 1);
+            consumer.dropped.storeRelease(0);
+            consumer.policy.storeRelease(policy);
+            if(policy == Block) {
+                m_blockingCount.fetchAndAddOrdered(1);
+            }
+            return i;
+        }
+    }
+
+    qWarning() << Q_FUNC_INFO << "Too many consumers";
+    return -1;
+}
+
+/**
+ * @brief Detaches the given consumer; its id may be reused by the next attached consumer.
+ * @param consumer
+ */
+void FrameRing::detach(const int consumer)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if(!isAttached(consumer)) {
+        return;
+    }
+    if(m_consumers[consumer].policy.fetchAndStoreOrdered(0) == Block) {
+        m_blockingCount.fetchAndAddOrdered(-1);
+        m_spaceAvailable.wakeAll();
+    }
+}
+
+/**
+ * @brief Reads the frames published since the consumer's last read.
+ *
+ * @a frames is cleared then filled; reusing the same vector between calls avoids any allocation.
+ * Frames overwritten before being read are skipped and added to FrameRing::droppedCount().
+ * @param consumer the consumer's id
+ * @param frames the read frames, oldest first
+ * @param max maximum number of frames to read; -1 reads all the available frames
+ * @return the number of read frames.
+ */
+int FrameRing::read(const int consumer, QVector<QByteArray> *frames, const int max)
+{
+    return read(consumer, frames, NULL, max);
+}
+
+/**
+ * @brief Reads the frames published since the consumer's last read, with their receive time.
+ * @param consumer the consumer's id
+ * @param frames the read frames, oldest first
+ * @param timestamps if not null, the receive time of each read frame (see XBeePacket::timestamp())
+ * @param max maximum number of frames to read; -1 reads all the available frames
+ * @return the number of read frames.
+ * @sa FrameRing::read(const int consumer, QVector<QByteArray> *frames, const int max)
+ */
+int FrameRing::read(const int consumer, QVector<QByteArray> *frames, QVector<qint64> *timestamps, const int max)
+{
+    Q_ASSERT(frames);
+    frames->resize(0);
+    if(timestamps) {
+        timestamps->resize(0);
+    }
+
+    if(!isAttached(consumer)) {
+        return 0;
+    }
+
+    Consumer & c = m_consumers[consumer];
+    qint64 cursor = c.cursor.loadAcquire();
+    const qint64 published = m_published.loadAcquire();
+
+    while(cursor <= published && (max < 0 || frames->size() < max)) {
+        if(published - cursor >= m_capacity) {
+            // Lapped by the producer
+            c.dropped.fetchAndAddOrdered(published - m_capacity + 1 - cursor);
+            cursor = published - m_capacity + 1;
+        }
+
+        Slot & slot = m_slots[cursor & m_mask];
+        lockSlot(slot);
+        const qint64 sequence = slot.sequence;
+        if(sequence == cursor) {
+            frames->append(slot.frame);
+            if(timestamps) {
+                timestamps->append(slot.timestamp);
+            }
+        }
+        slot.lock.storeRelease(0);
+
+        if(sequence != cursor) {
+            // Overwritten while reading: resume from the oldest frame still in the ring
+            const qint64 oldest = m_published.loadAcquire() - m_capacity + 1;
+            c.dropped.fetchAndAddOrdered(qMax(oldest, cursor + 1) - cursor);
+            cursor = qMax(oldest, cursor + 1);
+            continue;
+        }
+        cursor++;
+    }
+
+    c.cursor.storeRelease(cursor);
+
+    if(c.policy.loadAcquire() == Block) {
+        QMutexLocker locker(&m_mutex);
+        m_spaceAvailable.wakeAll();
+    }
+    return frames->size();
+}
+
+/**
+ * @brief Returns the number of frames the consumer can read (capped to the capacity).
+ * @param consumer
+ */
+int FrameRing::available(const int consumer) const
+{
+    if(!isAttached(consumer)) {
+        return 0;
+    }
+    const qint64 count = m_published.loadAcquire() + 1 - m_consumers[consumer].cursor.loadAcquire();
+    return qBound(qint64(0), count, qint64(m_capacity));
+}
+
+/**
+ * @brief Waits until the consumer has frames to read.
+ * @param consumer
+ * @param msecs -1 waits forever
+ * @return true if frames are available; false on timeout.
+ */
+bool FrameRing::waitForFrames(const int consumer, const int msecs)
+{
+    QMutexLocker locker(&m_mutex);
+    QElapsedTimer timer;
+    timer.start();
+
+    while(available(consumer) == 0) {
+        if(!isAttached(consumer)) {
+            return false;
+        }
+        if(msecs < 0) {
+            m_frameAvailable.wait(&m_mutex);
+            continue;
+        }
+        const qint64 remaining = msecs - timer.elapsed();
+        if(remaining <= 0 || !m_frameAvailable.wait(&m_mutex, remaining)) {
+            return available(consumer) > 0;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Returns the number of frames the consumer missed because they were overwritten.
+ * @param consumer
+ */
+qint64 FrameRing::droppedCount(const int consumer) const
+{
+    return isAttached(consumer) ? m_consumers[consumer].dropped.loadAcquire() : 0;
+}
+
+bool FrameRing::isAttached(const int consumer) const
+{
+    return consumer >= 0 && consumer < MaxConsumers && m_consumers[consumer].policy.loadAcquire() != 0;
+}
+
+/**
+ * @brief Returns the minimum cursor of the blocking consumers; @a sequence if there is none.
+ * @param sequence
+ */
+qint64 FrameRing::minimumBlockingCursor(const qint64 sequence) const
+{
+    qint64 minimum = sequence;
+
+    for(int i=0; i<MaxConsumers; i++) {
+        if(m_consumers[i].policy.loadAcquire() == Block) {
+            minimum = qMin(minimum, m_consumers[i].cursor.loadAcquire());
+        }
+    }
+    return minimum;
+}
+
+/**
+ * @brief Locks the given slot; slots are only held while a QByteArray is copied.
+ * @param slot
+ */
+void FrameRing::lockSlot(Slot &slot) const
+{
+    while(!slot.lock.testAndSetAcquire(0, 1)) {
+        QThread::yieldCurrentThread();
+    }
+}
+
+} // END namespace
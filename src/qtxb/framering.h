@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2015 ThomArmax (Thomas COIN)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * Thomas COIN <esvcorp@gmail.com> 18/04/2015
+ */
+
+
+
+#ifndef FRAMERING_H
+#define FRAMERING_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QVector>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QAtomicInteger>
+
+namespace QtXBee {
+
+/**
+ * @brief The FrameRing class broadcasts the received frames to several consumers, possibly in other threads.
+ *
+ * The ring is a single producer, multiple consumers circular buffer (Disruptor like): the XBee publishes each
+ * received frame once, and each consumer reads it through its own sequence cursor. Publishing costs the same
+ * whatever the number of consumers and allocates nothing: the slot shares the frame's data.
+ *
+ * Each consumer chooses what happens when it falls behind by more than the ring's capacity:
+ * @li FrameRing::DropOldest: the producer overwrites the frames it hasn't read, the consumer skips them and counts them as dropped.
+ *     A slow consumer only affects itself.
+ * @li FrameRing::Block: the producer waits for the consumer to read (up to blockTimeout(), which is always bounded),
+ *     slowing down every consumer; past the timeout, the consumer's unread frames are overwritten.
+ *
+ * Consumers read in batches:
+ * @code
+ * const int consumer = ring->attach();
+ * QVector<QByteArray> frames;
+ * forever {
+ *     ring->waitForFrames(consumer, 1000);
+ *     ring->read(consumer, &frames);
+ *     foreach(const QByteArray & frame, frames) {
+ *         ...
+ *     }
+ * }
+ * @endcode
+ * Consumers running an event loop can connect FrameRing::framesAvailable() instead of waiting.
+ * @sa XBee::setFrameRing()
+ */
+class FrameRing : public QObject
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief The OverflowPolicy enum defines what happens when a consumer falls behind by more than the capacity
+     */
+    enum OverflowPolicy {
+        DropOldest  = 1,    /**< Unread frames are overwritten */
+        Block       = 2     /**< The producer waits for the consumer */
+    };
+
+    static const int        MaxConsumers = 32;
+    static const int        MaxBlockTimeout = 1000;     /**< Maximum FrameRing::blockTimeout(), in milliseconds */
+
+    explicit                FrameRing               (const int capacity = 1024, QObject * parent = 0);
+                            ~FrameRing              ();
+
+    int                     capacity                () const;
+    bool                    setBlockTimeout         (const int msecs);
+    int                     blockTimeout            () const;
+
+    // Producer
+    void                    publish                 (const QByteArray & frame, const qint64 timestamp = 0);
+    void                    notify                  ();
+    qint64                  publishedCount          () const;
+
+    // Consumers
+    int                     attach                  (const OverflowPolicy policy = DropOldest);
+    void                    detach                  (const int consumer);
+    int                     read                    (const int consumer, QVector<QByteArray> * frames, const int max = -1);
+    int                     read                    (const int consumer, QVector<QByteArray> * frames, QVector<qint64> * timestamps, const int max = -1);
+    int                     available               (const int consumer) const;
+    bool                    waitForFrames           (const int consumer, const int msecs = -1);
+    qint64                  droppedCount            (const int consumer) const;
+
+signals:
+    void                    framesAvailable         ();                 /**< @brief Emitted by FrameRing::notify() when frames have been published. */
+
+private:
+    struct Slot {
+        QAtomicInt          lock;                   /**< Held while the frame is written or copied */
+        qint64              sequence;               /**< Sequence of the frame in the slot */
+        QByteArray          frame;
+        qint64              timestamp;              /**< Receive time of the frame */
+    };
+
+    struct Consumer {
+        QAtomicInt          policy;                 /**< OverflowPolicy; 0 if the consumer isn't attached */
+        QAtomicInteger<qint64> cursor;              /**< Next sequence to read */
+        QAtomicInteger<qint64> dropped;             /**< Frames overwritten before being read */
+    };
+
+    bool                    isAttached              (const int consumer) const;
+    qint64                  minimumBlockingCursor   (const qint64 sequence) const;
+    void                    lockSlot                (Slot & slot) const;
+
+    Slot *                  m_slots;
+    int                     m_capacity;             /**< Power of two */
+    int                     m_mask;                 /**< m_capacity - 1 */
+    QAtomicInteger<qint64>  m_published;            /**< Last published sequence; -1 if none */
+    qint64                  m_notified;             /**< Last sequence notified to the consumers */
+    qint64                  m_gatingSequence;       /**< Cached minimum cursor of the blocking consumers */
+    QAtomicInt              m_blockingCount;        /**< Number of consumers with the Block policy */
+    int                     m_blockTimeout;
+    Consumer                m_consumers[MaxConsumers];
+    mutable QMutex          m_mutex;                /**< Protects attach/detach and the waits */
+    QWaitCondition          m_frameAvailable;
+    QWaitCondition          m_spaceAvailable;
+};
+
+} // END namespace
+
+#endif // FRAMERING_H
@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2015 ThomArmax (Thomas COIN)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * Thomas COIN <esvcorp@gmail.com> 18/04/2015
+ */
+
+
+#include "FrameTemplate"
+#include "XBeePacket"
+#include "codec/XBeeCodec"
+
+#include <QDebug>
+
+namespace QtXBee {
+
+static const int ApiIdOffset    = Codec::Layout::Frame::ApiId;
+static const int FrameIdOffset  = Codec::Layout::Frame::FrameId;
+
+/**
+ * @brief Constructs an invalid template
+ */
+FrameTemplate::FrameTemplate()
+{
+}
+
+/**
+ * @brief Constructs a template from the given request
+ * @param request
+ * @sa FrameTemplate::setRequest()
+ */
+FrameTemplate::FrameTemplate(XBeePacket *request)
+{
+    setRequest(request);
+}
+
+/**
+ * @brief Assembles the given request and caches the resulting frame.
+ * @param request
+ * @return true if succeeded; false if @a request is not a request type.
+ */
+bool FrameTemplate::setRequest(XBeePacket *request)
+{
+    Q_ASSERT(request);
+
+    m_frame.clear();
+    request->assemblePacket();
+    const QByteArray frame = request->packet();
+
+    if(frame.size() <= FrameIdOffset + 1 || !isRequest((quint8)frame.at(ApiIdOffset))) {
+        qWarning() << Q_FUNC_INFO << "Not a request frame" << frame.toHex();
+        return false;
+    }
+    m_frame = frame;
+    return true;
+}
+
+/**
+ * @brief Returns true if the template holds a request frame; false otherwise.
+ */
+bool FrameTemplate::isValid() const
+{
+    return !m_frame.isEmpty();
+}
+
+/**
+ * @brief Sets the frame id, updating the checksum incrementally.
+ *
+ * The checksum is 0xFF minus the sum of the bytes between the length and the checksum,
+ * so replacing the frame id byte only moves it by the difference between the old and the new id.
+ * @param frameId
+ */
+void FrameTemplate::setFrameId(const quint8 frameId)
+{
+    if(!isValid()) {
+        return;
+    }
+
+    Codec::setFrameId((quint8*)m_frame.data(), m_frame.size(), frameId);
+}
+
+/**
+ * @brief Returns the frame id; 0 if invalid.
+ */
+quint8 FrameTemplate::frameId() const
+{
+    return isValid() ? (quint8)m_frame.at(FrameIdOffset) : 0;
+}
+
+/**
+ * @brief Returns the frame's API id; XBeePacket::UndefinedId if invalid.
+ */
+quint8 FrameTemplate::apiId() const
+{
+    return isValid() ? (quint8)m_frame.at(ApiIdOffset) : (quint8)XBeePacket::UndefinedId;
+}
+
+/**
+ * @brief Returns the assembled frame, with the current frame id.
+ */
+const QByteArray &FrameTemplate::frame() const
+{
+    return m_frame;
+}
+
+/**
+ * @brief Returns true if the given API id is a request type (which has a frame id); false otherwise.
+ * @param apiId
+ */
+bool FrameTemplate::isRequest(const quint8 apiId)
+{
+    switch(apiId) {
+    case XBeePacket::TxRequest64Id :
+    case XBeePacket::TxRequest16Id :
+    case XBeePacket::ATCommandId :
+    case XBeePacket::ATCommandQueueId :
+    case XBeePacket::ZBTxRequestId :
+    case XBeePacket::ZBExplicitTxRequestId :
+    case XBeePacket::RemoteATCommandRequestId :
+        return true;
+    default:
+        return false;
+    }
+}
+
+} // END namespace
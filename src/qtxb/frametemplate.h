@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2015 ThomArmax (Thomas COIN)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * Thomas COIN <esvcorp@gmail.com> 18/04/2015
+ */
+
+
+#ifndef FRAMETEMPLATE_H
+#define FRAMETEMPLATE_H
+
+#include <QByteArray>
+
+namespace QtXBee {
+
+class XBeePacket;
+
+/**
+ * @brief The FrameTemplate class caches an assembled request frame, to send it again without re-assembling it.
+ *
+ * Periodic requests (polls...) are byte-identical except for their frame id.
+ * The template assembles the request once; setFrameId() then only patches the frame id byte and
+ * adjusts the checksum arithmetically.
+ *
+ * All the request types carry their frame id at the same offset, so any request can be used as template:
+ * ATCommand, ATCommandQueueParam, RemoteATCommandRequest, TxRequest16, TxRequest64, ZBTxRequest, ZBExplicitTxRequest.
+ * @code
+ * TxRequest16 request;
+ * request.setDestinationAddress(2);
+ * request.setData("temp");
+ * FrameTemplate poll(&request);
+ * ...
+ * xbee->sendAsync(&poll);
+ * @endcode
+ * @note The template is a snapshot: changing the request afterwards doesn't change the template.
+ */
+class FrameTemplate
+{
+public:
+    explicit                FrameTemplate           ();
+    explicit                FrameTemplate           (XBeePacket * request);
+
+    bool                    setRequest              (XBeePacket * request);
+    bool                    isValid                 () const;
+
+    void                    setFrameId              (const quint8 frameId);
+    quint8                  frameId                 () const;
+    quint8                  apiId                   () const;
+    const QByteArray &      frame                   () const;
+
+    static bool             isRequest               (const quint8 apiId);
+
+private:
+    QByteArray              m_frame;                /**< Assembled frame, not escaped; empty if invalid */
+};
+
+} // END namespace
+
+#endif // FRAMETEMPLATE_H
@@ -0,0 +1,313 @@
+/*
+ * Copyright (C) 2015 ThomArmax (Thomas COIN)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * Thomas COIN <esvcorp@gmail.com> 18/04/2015
+ */
+
+#include "FrameTracer"
+#include "XBeePacket"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QMutexLocker>
+#include <QThread>
+#include <QVector>
+#include <QDebug>
+
+#include <atomic>
+
+namespace QtXBee {
+
+namespace {
+
+struct Span {
+    qint64              begin;
+    qint64              end;
+    quint32             ticket;
+    quint8              stage;
+    quint8              frameId;
+    quint8              apiId;
+};
+
+/*
+ * Written by its thread only: a span is filled, then published by incrementing head.
+ * The exporter copies the spans, then drops those overwritten meanwhile.
+ */
+struct ThreadBuffer {
+    Span                spans[FrameTracer::BufferSize];
+    QAtomicInteger<quint64> head;                   /**< Spans recorded since the thread's first span */
+    QAtomicInteger<quint64> first;                  /**< First span to export, moved by FrameTracer::clear() */
+    int                 tid;
+    QByteArray          name;
+    bool                finished;                   /**< Its thread exited, the buffer is reused by the next thread */
+};
+
+struct Registry {
+    Registry() : lastTid(0) {}
+    ~Registry() { qDeleteAll(buffers); }
+    QMutex              mutex;
+    QVector<ThreadBuffer*> buffers;                 /**< Kept after their thread exits, for the export */
+    int                 lastTid;
+};
+
+Registry * registry()
+{
+    static Registry r;
+    return &r;
+}
+
+void detachThread(ThreadBuffer * buffer);
+
+// Hands the thread's buffer over when the thread exits
+struct ThreadSlot {
+    ThreadSlot() : buffer(NULL) {}
+    ~ThreadSlot() { if(buffer) { detachThread(buffer); } }
+    ThreadBuffer *      buffer;
+};
+
+thread_local ThreadSlot t_slot;
+
+ThreadBuffer * attachThread()
+{
+    Registry * r = registry();
+    QMutexLocker locker(&r->mutex);
+    ThreadBuffer * buffer = NULL;
+
+    // The spans of an exited thread are exportable until another thread takes its buffer over
+    foreach(ThreadBuffer * b, r->buffers) {
+        if(b->finished) {
+            buffer = b;
+            break;
+        }
+    }
+    if(!buffer) {
+        buffer = new ThreadBuffer;
+        r->buffers.append(buffer);
+    }
+    buffer->head.storeRelease(0);
+    buffer->first.storeRelease(0);
+    buffer->finished = false;
+    buffer->tid = ++r->lastTid;
+    buffer->name = QThread::currentThread()->objectName().toUtf8();
+    if(buffer->name.isEmpty()) {
+        buffer->name = QByteArray("Thread ").append(QByteArray::number(buffer->tid));
+    }
+    t_slot.buffer = buffer;
+    return buffer;
+}
+
+void detachThread(ThreadBuffer * buffer)
+{
+    Registry * r = registry();
+    QMutexLocker locker(&r->mutex);
+
+    buffer->finished = true;
+}
+
+quint8 frameIdOf(const QByteArray & frame, const quint8 apiId)
+{
+    switch(apiId) {
+    case XBeePacket::TxRequest64Id :
+    case XBeePacket::TxRequest16Id :
+    case XBeePacket::ATCommandId :
+    case XBeePacket::ATCommandQueueId :
+    case XBeePacket::ZBTxRequestId :
+    case XBeePacket::ZBExplicitTxRequestId :
+    case XBeePacket::RemoteATCommandRequestId :
+    case XBeePacket::ATCommandResponseId :
+    case XBeePacket::TxStatusResponseId :
+    case XBeePacket::ZBTxStatusResponseId :
+    case XBeePacket::RemoteATCommandResponseId :
+        return frame.size() > 4 ? (quint8)frame.at(4) : 0;
+    default:
+        return 0;
+    }
+}
+
+// Nanoseconds to the trace_event microseconds, without going through a double
+QByteArray microseconds(const qint64 ns)
+{
+    return QByteArray::number(ns / 1000) + '.' + QByteArray::number(ns % 1000).rightJustified(3, '0');
+}
+
+QByteArray jsonString(const QByteArray & s)
+{
+    QByteArray out("\"");
+    for(int i=0; i<s.size(); i++) {
+        const char c = s.at(i);
+        if(c == '"' || c == '\\') {
+            out.append('\\').append(c);
+        }
+        else if((uchar)c < 0x20) {
+            out.append("\\u00").append(QByteArray::number((uchar)c, 16).rightJustified(2, '0'));
+        }
+        else {
+            out.append(c);
+        }
+    }
+    return out.append('"');
+}
+
+} // END anonymous namespace
+
+QBasicAtomicInt FrameTracer::s_enabled = Q_BASIC_ATOMIC_INITIALIZER(0);
+
+/**
+ * @brief Starts or stops the recording of the spans; the recorded spans are kept.
+ * @param enabled
+ */
+void FrameTracer::setEnabled(const bool enabled)
+{
+    s_enabled.storeRelease(enabled ? 1 : 0);
+}
+
+/**
+ * @brief Records a span in the current thread's buffer.
+ *
+ * Trace points call it only if isEnabled(), so that a disabled tracer costs a single branch.
+ * @param stage
+ * @param frame the API frame (not escaped); its API id and frame id are recorded
+ * @param begin the span's start, on the QtXBee::monotonicTime() clock
+ * @param end the span's end, on the QtXBee::monotonicTime() clock
+ * @param ticket the XBee::post() ticket; 0 if none
+ */
+void FrameTracer::record(const Stage stage, const QByteArray &frame, const qint64 begin, const qint64 end, const quint32 ticket)
+{
+    ThreadBuffer * buffer = t_slot.buffer ? t_slot.buffer : attachThread();
+    const quint64 index = buffer->head.loadAcquire();
+    Span & span = buffer->spans[index & (BufferSize - 1)];
+
+    span.begin = begin;
+    span.end = end;
+    span.ticket = ticket;
+    span.stage = stage;
+    span.apiId = frame.size() > 3 ? (quint8)frame.at(3) : (quint8)XBeePacket::UndefinedId;
+    span.frameId = frameIdOf(frame, span.apiId);
+    buffer->head.storeRelease(index + 1);
+}
+
+/**
+ * @brief Drops the recorded spans of all the threads.
+ */
+void FrameTracer::clear()
+{
+    Registry * r = registry();
+    QMutexLocker locker(&r->mutex);
+
+    foreach(ThreadBuffer * buffer, r->buffers) {
+        buffer->first.storeRelease(buffer->head.loadAcquire());
+    }
+}
+
+/**
+ * @brief Returns the recorded spans of all the threads, in the Chrome trace_event JSON format.
+ *
+ * Spans are complete events ("ph":"X") of the "xbee" category, one track per thread;
+ * the frame id, API id and ticket are in their args.
+ * It may be called while recording: the spans overwritten during the export are left out.
+ */
+QByteArray FrameTracer::toChromeTrace()
+{
+    const QByteArray pid = QByteArray::number(QCoreApplication::applicationPid());
+    Registry * r = registry();
+    QMutexLocker locker(&r->mutex);
+    QVector<Span> spans;
+    QByteArray json("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+    bool first = true;
+
+    foreach(ThreadBuffer * buffer, r->buffers) {
+        const QByteArray tid = QByteArray::number(buffer->tid);
+        const quint64 head = buffer->head.loadAcquire();
+        // The slot of head - BufferSize may be being overwritten by the span head
+        const quint64 from = qMax(buffer->first.loadAcquire(), head >= (quint64)BufferSize ? head - BufferSize + 1 : 0);
+
+        spans.resize(0);
+        for(quint64 i=from; i<head; i++) {
+            spans.append(buffer->spans[i & (BufferSize - 1)]);
+        }
+
+        // The thread kept recording meanwhile: drop the copies of the overwritten spans, and of the one
+        // being written (index now, which overwrites now - BufferSize). The fence orders the copy before the re-read.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const quint64 now = buffer->head.loadAcquire();
+        const quint64 valid = now >= (quint64)BufferSize ? now - BufferSize + 1 : 0;
+
+        json.append(first ? "\n" : ",\n");
+        first = false;
+        json.append("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":").append(pid)
+            .append(",\"tid\":").append(tid)
+            .append(",\"args\":{\"name\":").append(jsonString(buffer->name)).append("}}");
+
+        for(int i=0; i<spans.size(); i++) {
+            const Span & span = spans.at(i);
+            if(from + i < valid) {
+                continue;
+            }
+            json.append(",\n{\"name\":\"").append(stageToString((Stage)span.stage).toLatin1())
+                .append("\",\"cat\":\"xbee\",\"ph\":\"X\",\"ts\":").append(microseconds(span.begin))
+                .append(",\"dur\":").append(microseconds(qMax((qint64)0, span.end - span.begin)))
+                .append(",\"pid\":").append(pid)
+                .append(",\"tid\":").append(tid)
+                .append(",\"args\":{\"frameId\":").append(QByteArray::number(span.frameId))
+                .append(",\"apiId\":\"0x").append(QByteArray::number(span.apiId, 16).rightJustified(2, '0')).append('"');
+            if(span.ticket != 0) {
+                json.append(",\"ticket\":").append(QByteArray::number(span.ticket));
+            }
+            json.append("}}");
+        }
+    }
+    return json.append("\n]}\n");
+}
+
+/**
+ * @brief Writes toChromeTrace() to the given file.
+ * @param fileName
+ * @return true if succeeded; false otherwise.
+ */
+bool FrameTracer::saveChromeTrace(const QString &fileName)
+{
+    QFile file(fileName);
+
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << Q_FUNC_INFO << "Cannot open" << fileName << ":" << file.errorString();
+        return false;
+    }
+    const QByteArray json = toChromeTrace();
+    if(file.write(json) != json.size()) {
+        qWarning() << Q_FUNC_INFO << "Cannot write" << fileName << ":" << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Returns the span name of the given stage, as exported.
+ * @param stage
+ */
+QString FrameTracer::stageToString(const Stage stage)
+{
+    switch(stage) {
+    case Enqueue :  return "enqueue";
+    case Write :    return "write";
+    case Status :   return "status";
+    case Decode :   return "decode";
+    case Dispatch : return "dispatch";
+    }
+    return "unknown";
+}
+
+} // END namespace
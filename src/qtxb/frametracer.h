@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2015 ThomArmax (Thomas COIN)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * Thomas COIN <esvcorp@gmail.com> 18/04/2015
+ */
+
+#ifndef FRAMETRACER_H
+#define FRAMETRACER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QAtomicInt>
+
+namespace QtXBee {
+
+/**
+ * @brief The FrameTracer class records the lifecycle of the frames as spans, for latency investigations.
+ *
+ * When enabled, the XBee records one span per stage of each frame:
+ * @li Enqueue: from XBee::send() (or XBee::post()) to the write; the time spent in the transmit queues
+ * @li Write: the write to the serial port
+ * @li Status: from the write to the transmit status or command response; the radio, RF retries included
+ * @li Decode: from the read of the frame's first byte to its extraction from the received bytes
+ * @li Dispatch: the execution of the slots connected to the response's signal
+ *
+ * Spans carry the frame id, the API id and the XBee::post() ticket, so that the stages of a frame can be matched.
+ * Each thread records into its own ring of BufferSize spans, without lock nor allocation;
+ * the oldest spans are overwritten. The ring of an exited thread is exported until another thread reuses it.
+ *
+ * The spans are exported in the Chrome trace_event JSON format, which chrome://tracing and the Perfetto UI load.
+ * @code
+ * FrameTracer::setEnabled(true);
+ * ...
+ * FrameTracer::setEnabled(false);
+ * FrameTracer::saveChromeTrace("xbee.json");
+ * @endcode
+ *
+ * While disabled, a trace point costs a single branch on isEnabled().
+ */
+class FrameTracer
+{
+public:
+    /**
+     * @brief The Stage enum identifies the spans of a frame's lifecycle
+     */
+    enum Stage {
+        Enqueue,        /**< Waiting in the transmit queues */
+        Write,          /**< Written to the serial port */
+        Status,         /**< Waiting for the transmit status or the command response */
+        Decode,         /**< Received bytes extracted as a frame */
+        Dispatch        /**< Response signal emitted */
+    };
+
+    static const int        BufferSize = 8192;      /**< Ring size per thread, a power of 2; the last BufferSize - 1 spans are exported */
+
+    /**
+     * @brief Returns true if the spans are recorded; false otherwise.
+     */
+    static inline bool      isEnabled               () { return s_enabled.loadAcquire() != 0; }
+    static void             setEnabled              (const bool enabled);
+
+    static void             record                  (const Stage stage,
+                                                     const QByteArray & frame,
+                                                     const qint64 begin,
+                                                     const qint64 end,
+                                                     const quint32 ticket = 0);
+    static void             clear                   ();
+
+    static QByteArray       toChromeTrace           ();
+    static bool             saveChromeTrace         (const QString & fileName);
+
+    static QString          stageToString           (const Stage stage);
+
+private:
+    static QBasicAtomicInt  s_enabled;
+};
+
+} // END namespace
+
+#endif // FRAMETRACER_H
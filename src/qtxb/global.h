@@ -22,6 +22,7 @@
 #define GLOBAL
 
 #include <QtGlobal>
+#include <QDeadlineTimer>
 
 /**
  * @file global.h Defines global properties and glob enums.
@@ -51,6 +52,17 @@ enum HardwareVersion {
 typedef quint64 XBee64BitsAddr;
 typedef quint16 XBee16BitsAddr;
 
+/**
+ * @brief Returns the monotonic clock, in nanoseconds.
+ *
+ * Frame timestamps (XBeePacket::timestamp(), XBee::frameTimestamps()) are taken on this clock.
+ * On Linux it is CLOCK_MONOTONIC, so they can be compared with the timestamps taken by other processes.
+ */
+inline qint64 monotonicTime()
+{
+    return QDeadlineTimer::current(Qt::PreciseTimer).deadlineNSecs();
+}
+
 } // END namespace
 
 #endif // GLOBAL
@@ -0,0 +1,792 @@
+/*
+ * Copyright (C) 2015 ThomArmax (Thomas COIN)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * Thomas COIN <esvcorp@gmail.com> 18/04/2015
+ */
+
+
+#include "LinuxSerialTransport"
+#include "Global"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QSocketNotifier>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/serial.h>
+
+namespace QtXBee {
+
+static const int ReadChunkSize = 4096;
+
+static bool toSpeed(const qint32 baudRate, speed_t * speed)
+{
+    switch(baudRate) {
+    case 1200       : *speed = B1200;       break;
+    case 2400       : *speed = B2400;       break;
+    case 4800       : *speed = B4800;       break;
+    case 9600       : *speed = B9600;       break;
+    case 19200      : *speed = B19200;      break;
+    case 38400      : *speed = B38400;      break;
+    case 57600      : *speed = B57600;      break;
+    case 115200     : *speed = B115200;     break;
+    case 230400     : *speed = B230400;     break;
+    case 460800     : *speed = B460800;     break;
+    case 921600     : *speed = B921600;     break;
+    case 1000000    : *speed = B1000000;    break;
+    default         : return false;
+    }
+    return true;
+}
+
+/**
+ * @brief LinuxSerialTransport's constructor
+ *
+ * The default configuration is 9600 bauds, 8 data bits, no parity, one stop bit, no flow control, low latency enabled.
+ * @param portName the tty name (eg. ttyUSB0) or path (eg. /dev/pts/3)
+ * @param parent parent object
+ */
+LinuxSerialTransport::LinuxSerialTransport(const QString &portName, QObject *parent) :
+    QIODevice(parent),
+    m_fd(-1),
+    m_portName(portName),
+    m_baudRate(QSerialPort::Baud9600),
+    m_dataBits(QSerialPort::Data8),
+    m_parity(QSerialPort::NoParity),
+    m_stopBits(QSerialPort::OneStop),
+    m_flowControl(QSerialPort::NoFlowControl),
+    m_lowLatency(true),
+    m_notifiers(true),
+    m_readNotifier(NULL),
+    m_writeNotifier(NULL),
+    m_readPos(0),
+    m_readTimestamp(0),
+    m_bytesWritten(0)
+{
+}
+
+/**
+ * @brief Closes the tty
+ */
+LinuxSerialTransport::~LinuxSerialTransport()
+{
+    close();
+}
+
+/**
+ * @brief Sets the tty name (eg. ttyUSB0) or path (eg. /dev/pts/3)
+ * @param portName
+ * @note Takes effect on the next open()
+ */
+void LinuxSerialTransport::setPortName(const QString &portName)
+{
+    m_portName = portName;
+}
+
+/**
+ * @brief Returns the tty name or path
+ */
+QString LinuxSerialTransport::portName() const
+{
+    return m_portName;
+}
+
+/**
+ * @brief Returns the tty path
+ */
+QString LinuxSerialTransport::systemLocation() const
+{
+    return m_portName.startsWith('/') ? m_portName : QString("/dev/") + m_portName;
+}
+
+/**
+ * @brief Opens and configures the tty
+ * @param mode
+ * @return true if succeeded; false otherwise.
+ */
+bool LinuxSerialTransport::open(OpenMode mode)
+{
+    int flags = O_NOCTTY | O_NONBLOCK | O_CLOEXEC;
+
+    if(isOpen()) {
+        qWarning() << Q_FUNC_INFO << "Already opened";
+        return false;
+    }
+
+    if((mode & ReadWrite) == ReadWrite) flags |= O_RDWR;
+    else if(mode & WriteOnly)           flags |= O_WRONLY;
+    else                                flags |= O_RDONLY;
+
+    m_fd = ::open(QFile::encodeName(systemLocation()).constData(), flags);
+    if(m_fd < 0) {
+        const int err = errno;
+        setError(err == ENOENT ? QSerialPort::DeviceNotFoundError :
+                 err == EACCES ? QSerialPort::PermissionError :
+                                 QSerialPort::OpenError,
+                 QString::fromLocal8Bit(strerror(err)));
+        return false;
+    }
+
+    ::ioctl(m_fd, TIOCEXCL);
+    if(!applySettings()) {
+        ::close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+    if(m_lowLatency) {
+        applyLowLatency();
+    }
+
+    if(m_notifiers) {
+        createNotifiers();
+    }
+    return QIODevice::open(mode | Unbuffered);
+}
+
+/**
+ * @brief Closes the tty, pending bytes are dropped
+ */
+void LinuxSerialTransport::close()
+{
+    if(isOpen()) {
+        QIODevice::close();
+    }
+    deleteNotifiers();
+    if(m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+    clearReadBuffer();
+    m_writeBuffer.clear();
+    m_bytesWritten = 0;
+}
+
+/**
+ * @brief Returns true: a tty is a sequential device
+ */
+bool LinuxSerialTransport::isSequential() const
+{
+    return true;
+}
+
+/**
+ * @brief Returns the number of bytes ready to be read
+ */
+qint64 LinuxSerialTransport::bytesAvailable() const
+{
+    return m_readBuffer.size() - m_readPos + QIODevice::bytesAvailable();
+}
+
+/**
+ * @brief Returns the number of bytes not accepted by the tty yet
+ */
+qint64 LinuxSerialTransport::bytesToWrite() const
+{
+    return m_writeBuffer.size();
+}
+
+/**
+ * @brief Blocks until new data is available for reading, and emits readyRead().
+ * @param msecs the maximum time to wait, in milliseconds (-1 waits forever)
+ * @return true if new data has been read; false on timeout or error.
+ */
+bool LinuxSerialTransport::waitForReadyRead(int msecs)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    while(m_fd >= 0) {
+        const int remaining = msecs < 0 ? -1 : qMax(0, msecs - (int)timer.elapsed());
+        struct pollfd pfd;
+        pfd.fd = m_fd;
+        pfd.events = POLLIN | (m_writeBuffer.isEmpty() ? 0 : POLLOUT);
+        pfd.revents = 0;
+
+        const int ret = ::poll(&pfd, 1, remaining);
+        if(ret < 0 && errno == EINTR) {
+            continue;
+        }
+        if(ret <= 0) {
+            return false;
+        }
+        if(pfd.revents & POLLOUT) {
+            writePending();
+        }
+        if(pfd.revents & (POLLIN | POLLERR | POLLHUP)) {
+            if(readBatch() > 0) {
+                emit readyRead();
+                return true;
+            }
+            if(pfd.revents & (POLLERR | POLLHUP)) {
+                return false;
+            }
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Blocks until all the pending bytes have been accepted by the tty, then emits bytesWritten()
+ * @param msecs the maximum time to wait, in milliseconds (-1 waits forever)
+ * @return true if succeeded; false on timeout or error.
+ */
+bool LinuxSerialTransport::waitForBytesWritten(int msecs)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    while(m_fd >= 0 && !m_writeBuffer.isEmpty()) {
+        const int remaining = msecs < 0 ? -1 : qMax(0, msecs - (int)timer.elapsed());
+        struct pollfd pfd;
+        pfd.fd = m_fd;
+        pfd.events = POLLOUT;
+        pfd.revents = 0;
+
+        const int ret = ::poll(&pfd, 1, remaining);
+        if(ret < 0 && errno == EINTR) {
+            continue;
+        }
+        if(ret <= 0 || (pfd.revents & (POLLERR | POLLHUP)) || !writePending()) {
+            return false;
+        }
+    }
+    if(!m_writeBuffer.isEmpty()) {
+        return false;
+    }
+    // The caller waits for the signal: don't leave it to the event loop
+    emitBytesWritten();
+    return true;
+}
+
+/**
+ * @brief Sets the baud rate
+ * @param baudRate
+ * @return true if succeeded; false if the baud rate isn't supported.
+ */
+bool LinuxSerialTransport::setBaudRate(const qint32 baudRate)
+{
+    speed_t speed;
+    if(!toSpeed(baudRate, &speed)) {
+        setError(QSerialPort::UnsupportedOperationError, QString("Unsupported baud rate %1").arg(baudRate));
+        return false;
+    }
+    m_baudRate = baudRate;
+    return applySettings();
+}
+
+/**
+ * @brief Returns the baud rate
+ */
+qint32 LinuxSerialTransport::baudRate() const
+{
+    return m_baudRate;
+}
+
+/**
+ * @brief Sets the data bits
+ * @param dataBits
+ * @return true if succeeded; false otherwise.
+ */
+bool LinuxSerialTransport::setDataBits(const QSerialPort::DataBits dataBits)
+{
+    m_dataBits = dataBits;
+    return applySettings();
+}
+
+/**
+ * @brief Returns the data bits
+ */
+QSerialPort::DataBits LinuxSerialTransport::dataBits() const
+{
+    return m_dataBits;
+}
+
+/**
+ * @brief Sets the parity
+ * @param parity
+ * @return true if succeeded; false otherwise.
+ */
+bool LinuxSerialTransport::setParity(const QSerialPort::Parity parity)
+{
+    m_parity = parity;
+    return applySettings();
+}
+
+/**
+ * @brief Returns the parity
+ */
+QSerialPort::Parity LinuxSerialTransport::parity() const
+{
+    return m_parity;
+}
+
+/**
+ * @brief Sets the stop bits
+ * @param stopBits
+ * @return true if succeeded; false if not supported (QSerialPort::OneAndHalfStop).
+ */
+bool LinuxSerialTransport::setStopBits(const QSerialPort::StopBits stopBits)
+{
+    if(stopBits == QSerialPort::OneAndHalfStop) {
+        setError(QSerialPort::UnsupportedOperationError, "1.5 stop bits are not supported");
+        return false;
+    }
+    m_stopBits = stopBits;
+    return applySettings();
+}
+
+/**
+ * @brief Returns the stop bits
+ */
+QSerialPort::StopBits LinuxSerialTransport::stopBits() const
+{
+    return m_stopBits;
+}
+
+/**
+ * @brief Sets the flow control
+ * @param flowControl
+ * @return true if succeeded; false otherwise.
+ */
+bool LinuxSerialTransport::setFlowControl(const QSerialPort::FlowControl flowControl)
+{
+    m_flowControl = flowControl;
+    return applySettings();
+}
+
+/**
+ * @brief Returns the flow control
+ */
+QSerialPort::FlowControl LinuxSerialTransport::flowControl() const
+{
+    return m_flowControl;
+}
+
+/**
+ * @brief Enables or disables the low-latency settings (ASYNC_LOW_LATENCY and FTDI latency timer)
+ * @param enabled
+ * @note Takes effect on the next open(); the settings are silently skipped when the driver doesn't support them
+ */
+void LinuxSerialTransport::setLowLatency(const bool enabled)
+{
+    m_lowLatency = enabled;
+}
+
+/**
+ * @brief Returns true if the low-latency settings are enabled; false otherwise.
+ */
+bool LinuxSerialTransport::isLowLatency() const
+{
+    return m_lowLatency;
+}
+
+/**
+ * @brief Enables or disables the socket notifiers reading and writing the tty from the event loop.
+ *
+ * Without notifiers, the application polls handle() itself and calls waitForReadyRead(0) when it's readable,
+ * waitForBytesWritten(0) when it's writable and bytesToWrite() isn't 0.
+ * @param enabled true by default
+ * @sa XBee::setPollMode()
+ */
+void LinuxSerialTransport::setNotifiersEnabled(const bool enabled)
+{
+    if(enabled == m_notifiers) {
+        return;
+    }
+    m_notifiers = enabled;
+    if(m_fd >= 0) {
+        if(enabled) {
+            createNotifiers();
+        }
+        else {
+            deleteNotifiers();
+        }
+    }
+}
+
+/**
+ * @brief Returns true if the tty is read and written from the event loop; false otherwise.
+ */
+bool LinuxSerialTransport::notifiersEnabled() const
+{
+    return m_notifiers;
+}
+
+/**
+ * @brief Writes as many pending bytes as possible, without blocking.
+ * @return true if any byte has been written; false otherwise.
+ */
+bool LinuxSerialTransport::flush()
+{
+    return writePending();
+}
+
+/**
+ * @brief Discards the bytes not yet read and not yet written, in both the transport and the tty.
+ * @return true if succeeded; false otherwise.
+ */
+bool LinuxSerialTransport::clear()
+{
+    clearReadBuffer();
+    m_writeBuffer.clear();
+    if(m_writeNotifier) {
+        m_writeNotifier->setEnabled(false);
+    }
+    return m_fd >= 0 && ::tcflush(m_fd, TCIOFLUSH) == 0;
+}
+
+/**
+ * @brief Returns the tty file descriptor; or -1 if closed.
+ */
+int LinuxSerialTransport::handle() const
+{
+    return m_fd;
+}
+
+/**
+ * @brief Returns the time (QtXBee::monotonicTime()) when the tty returned the last read bytes; 0 if none.
+ *
+ * It is taken right after the read() system call, before readyRead() is emitted.
+ * As readAll() may read the tty again, use readStamped() to get the time of each read.
+ */
+qint64 LinuxSerialTransport::readTimestamp() const
+{
+    return m_readTimestamp;
+}
+
+/**
+ * @brief Reads the bytes of the oldest buffered tty read, with the time it was read.
+ *
+ * If no byte is buffered, the tty is read first. Call it until it returns an empty array
+ * to read all the available bytes, each batch with its own time:
+ * @code
+ * qint64 timestamp = 0;
+ * QByteArray data;
+ * while(!(data = transport->readStamped(&timestamp)).isEmpty()) {
+ *     decoder.append(data, timestamp);
+ * }
+ * @endcode
+ * @param timestamp set to the time the bytes were read (see readTimestamp()); 0 if none was read
+ * @return the read bytes; empty if there is none.
+ */
+QByteArray LinuxSerialTransport::readStamped(qint64 *timestamp)
+{
+    Q_ASSERT(timestamp);
+    int end = m_readBuffer.size();
+
+    *timestamp = 0;
+    if(m_readPos >= m_readBuffer.size() && readBatch() <= 0) {
+        return QByteArray();
+    }
+
+    for(int i=m_readMarks.size()-1; i>=0; i--) {
+        if(m_readMarks.at(i).offset <= m_readPos) {
+            *timestamp = m_readMarks.at(i).timestamp;
+            break;
+        }
+        end = m_readMarks.at(i).offset;
+    }
+    return read(end - m_readPos);
+}
+
+qint64 LinuxSerialTransport::readData(char *data, qint64 maxSize)
+{
+    if(m_readPos >= m_readBuffer.size() && readBatch() < 0) {
+        return -1;
+    }
+
+    const qint64 n = qMin(maxSize, (qint64)(m_readBuffer.size() - m_readPos));
+    if(n > 0) {
+        memcpy(data, m_readBuffer.constData() + m_readPos, n);
+        m_readPos += n;
+    }
+    return n;
+}
+
+qint64 LinuxSerialTransport::writeData(const char *data, qint64 maxSize)
+{
+    qint64 n = 0;
+
+    if(m_fd < 0) {
+        return -1;
+    }
+
+    if(m_writeBuffer.isEmpty()) {
+        n = ::write(m_fd, data, maxSize);
+        if(n < 0) {
+            if(errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                setError(QSerialPort::WriteError, QString::fromLocal8Bit(strerror(errno)));
+                return -1;
+            }
+            n = 0;
+        }
+    }
+
+    if(n < maxSize) {
+        m_writeBuffer.append(data + n, maxSize - n);
+        if(m_writeNotifier) {
+            m_writeNotifier->setEnabled(true);
+        }
+    }
+    reportWritten(n);
+    return maxSize;
+}
+
+void LinuxSerialTransport::onReadable()
+{
+    if(readBatch() > 0) {
+        emit readyRead();
+    }
+}
+
+void LinuxSerialTransport::onWritable()
+{
+    writePending();
+}
+
+bool LinuxSerialTransport::applySettings()
+{
+    struct termios tio;
+    speed_t speed = B9600;
+
+    if(m_fd < 0) {
+        return true;
+    }
+
+    if(::tcgetattr(m_fd, &tio) < 0) {
+        setError(QSerialPort::UnsupportedOperationError, QString::fromLocal8Bit(strerror(errno)));
+        return false;
+    }
+
+    ::cfmakeraw(&tio);
+    tio.c_cflag |= CLOCAL | CREAD;
+    // With O_NONBLOCK, VMIN=1 makes an empty read fail with EAGAIN: 0 then only means end of file (hung up tty)
+    tio.c_cc[VMIN] = 1;
+    tio.c_cc[VTIME] = 0;
+
+    tio.c_cflag &= ~CSIZE;
+    switch(m_dataBits) {
+    case QSerialPort::Data5 : tio.c_cflag |= CS5; break;
+    case QSerialPort::Data6 : tio.c_cflag |= CS6; break;
+    case QSerialPort::Data7 : tio.c_cflag |= CS7; break;
+    default                 : tio.c_cflag |= CS8; break;
+    }
+
+    tio.c_cflag &= ~(PARENB | PARODD | CMSPAR);
+    switch(m_parity) {
+    case QSerialPort::EvenParity    : tio.c_cflag |= PARENB;                    break;
+    case QSerialPort::OddParity     : tio.c_cflag |= PARENB | PARODD;           break;
+    case QSerialPort::SpaceParity   : tio.c_cflag |= PARENB | CMSPAR;           break;
+    case QSerialPort::MarkParity    : tio.c_cflag |= PARENB | CMSPAR | PARODD;  break;
+    default                         :                                           break;
+    }
+
+    if(m_stopBits == QSerialPort::TwoStop)
+        tio.c_cflag |= CSTOPB;
+    else
+        tio.c_cflag &= ~CSTOPB;
+
+    tio.c_cflag &= ~CRTSCTS;
+    tio.c_iflag &= ~(IXON | IXOFF | IXANY);
+    if(m_flowControl == QSerialPort::HardwareControl)
+        tio.c_cflag |= CRTSCTS;
+    else if(m_flowControl == QSerialPort::SoftwareControl)
+        tio.c_iflag |= IXON | IXOFF;
+
+    toSpeed(m_baudRate, &speed);
+    ::cfsetispeed(&tio, speed);
+    ::cfsetospeed(&tio, speed);
+
+    if(::tcsetattr(m_fd, TCSANOW, &tio) < 0) {
+        setError(QSerialPort::UnsupportedOperationError, QString::fromLocal8Bit(strerror(errno)));
+        return false;
+    }
+    return true;
+}
+
+void LinuxSerialTransport::applyLowLatency()
+{
+    struct serial_struct serial;
+
+    if(::ioctl(m_fd, TIOCGSERIAL, &serial) == 0) {
+        serial.flags |= ASYNC_LOW_LATENCY;
+        if(::ioctl(m_fd, TIOCSSERIAL, &serial) != 0) {
+            qDebug() << Q_FUNC_INFO << "ASYNC_LOW_LATENCY not supported by" << m_portName;
+        }
+    }
+
+    // FTDI adapters buffer up to 16 ms by default
+    QFile latency(QString("/sys/bus/usb-serial/devices/%1/latency_timer").arg(QFileInfo(QFileInfo(systemLocation()).canonicalFilePath()).fileName()));
+    if(latency.exists()) {
+        if(!latency.open(QIODevice::WriteOnly) || latency.write("1") < 0) {
+            qDebug() << Q_FUNC_INFO << "Can't set" << latency.fileName() << "to 1 ms";
+        }
+    }
+}
+
+qint64 LinuxSerialTransport::readBatch()
+{
+    qint64 total = 0;
+
+    if(m_fd < 0) {
+        return -1;
+    }
+
+    if(m_readPos >= m_readBuffer.size()) {
+        clearReadBuffer();
+    }
+    else if(m_readPos > m_readBuffer.size()/2) {
+        // Drops the consumed reads, the one holding m_readPos excepted
+        int first = 0;
+        while(first + 1 < m_readMarks.size() && m_readMarks.at(first + 1).offset <= m_readPos) {
+            first++;
+        }
+        m_readMarks.remove(0, first);
+        for(int i=0; i<m_readMarks.size(); i++) {
+            m_readMarks[i].offset = qMax(0, m_readMarks.at(i).offset - m_readPos);
+        }
+        m_readBuffer.remove(0, m_readPos);
+        m_readPos = 0;
+    }
+
+    forever {
+        const int size = m_readBuffer.size();
+        m_readBuffer.resize(size + ReadChunkSize);
+        const ssize_t n = ::read(m_fd, m_readBuffer.data() + size, ReadChunkSize);
+        m_readBuffer.resize(size + qMax((ssize_t)0, n));
+
+        if(n > 0) {
+            if(total == 0) {
+                ReadMark mark;
+                mark.offset = size;
+                mark.timestamp = monotonicTime();
+                m_readMarks.append(mark);
+                m_readTimestamp = mark.timestamp;
+            }
+            total += n;
+            if(n < ReadChunkSize) {
+                break;
+            }
+        }
+        else if(n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        else if(n == 0 || errno != EINTR) {
+            // End of file (hung up tty) or EIO: the device is gone (unplugged USB adapter, closed pty master).
+            // The descriptor stays readable: without disabling the notifier, it would fire in a loop.
+            if(m_readNotifier) {
+                m_readNotifier->setEnabled(false);
+            }
+            setError(QSerialPort::ResourceError, n == 0 ? QString("Device hung up") : QString::fromLocal8Bit(strerror(errno)));
+            return total > 0 ? total : -1;
+        }
+    }
+    return total;
+}
+
+bool LinuxSerialTransport::writePending()
+{
+    if(m_fd < 0 || m_writeBuffer.isEmpty()) {
+        return false;
+    }
+
+    const ssize_t n = ::write(m_fd, m_writeBuffer.constData(), m_writeBuffer.size());
+    if(n < 0) {
+        if(errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            if(m_writeNotifier) {
+                m_writeNotifier->setEnabled(false);
+            }
+            setError(QSerialPort::WriteError, QString::fromLocal8Bit(strerror(errno)));
+        }
+        return false;
+    }
+
+    m_writeBuffer.remove(0, n);
+    if(m_writeNotifier) {
+        m_writeNotifier->setEnabled(!m_writeBuffer.isEmpty());
+    }
+    reportWritten(n);
+    return n > 0;
+}
+
+/**
+ * @brief Schedules the bytesWritten() signal for \a n bytes written to the tty
+ *
+ * Like QSerialPort, the signal is emitted from the event loop, never from write() or flush():
+ * a slot writing again would otherwise re-enter writeData() and recurse.
+ * @param n number of bytes the tty accepted
+ */
+void LinuxSerialTransport::reportWritten(const qint64 n)
+{
+    if(n <= 0) {
+        return;
+    }
+    if(m_bytesWritten == 0) {
+        QMetaObject::invokeMethod(this, "emitBytesWritten", Qt::QueuedConnection);
+    }
+    m_bytesWritten += n;
+}
+
+void LinuxSerialTransport::emitBytesWritten()
+{
+    const qint64 n = m_bytesWritten;
+    m_bytesWritten = 0;
+    if(n > 0) {
+        emit bytesWritten(n);
+    }
+}
+
+void LinuxSerialTransport::createNotifiers()
+{
+    m_readNotifier = new QSocketNotifier(m_fd, QSocketNotifier::Read, this);
+    m_writeNotifier = new QSocketNotifier(m_fd, QSocketNotifier::Write, this);
+    m_writeNotifier->setEnabled(!m_writeBuffer.isEmpty());
+    connect(m_readNotifier, SIGNAL(activated(int)), SLOT(onReadable()));
+    connect(m_writeNotifier, SIGNAL(activated(int)), SLOT(onWritable()));
+}
+
+void LinuxSerialTransport::deleteNotifiers()
+{
+    delete m_readNotifier;
+    delete m_writeNotifier;
+    m_readNotifier = NULL;
+    m_writeNotifier = NULL;
+}
+
+void LinuxSerialTransport::setError(const QSerialPort::SerialPortError error, const QString &str)
+{
+    qWarning() << Q_FUNC_INFO << m_portName << str;
+    setErrorString(str);
+    emit errorOccurred(error);
+}
+
+void LinuxSerialTransport::clearReadBuffer()
+{
+    m_readBuffer.clear();
+    m_readPos = 0;
+    m_readMarks.clear();
+}
+
+} // END namespace
@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2015 ThomArmax (Thomas COIN)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * Thomas COIN <esvcorp@gmail.com> 18/04/2015
+ */
+
+
+#ifndef LINUXSERIALTRANSPORT_H
+#define LINUXSERIALTRANSPORT_H
+
+#include <QIODevice>
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+#include <QtSerialPort/QSerialPort>
+
+class QSocketNotifier;
+
+namespace QtXBee {
+
+/**
+ * @brief The LinuxSerialTransport class is a serial port driven directly through its tty file descriptor (Linux only).
+ *
+ * Compared to QSerialPort, it avoids an intermediate buffer and notifier latency:
+ * - the tty is configured with termios (raw mode, VMIN = VTIME = 0) and read in large non-blocking batches
+ *   each time the fd becomes readable;
+ * - the low-latency settings are applied when the driver supports them : ASYNC_LOW_LATENCY (TIOCSSERIAL) and,
+ *   for FTDI adapters, a 1 ms latency timer (sysfs <tt>latency_timer</tt>, which must be writable).
+ *
+ * Any tty can be used, including a pseudo-terminal, which makes it testable without hardware.
+ * The interface mirrors the subset of QSerialPort used by XBee.
+ * @sa XBee::setTransport()
+ */
+class LinuxSerialTransport : public QIODevice
+{
+    Q_OBJECT
+public:
+    explicit                LinuxSerialTransport    (const QString & portName = QString(), QObject *parent = 0);
+                            ~LinuxSerialTransport   ();
+
+    void                    setPortName             (const QString & portName);
+    QString                 portName                () const;
+    QString                 systemLocation          () const;
+
+    virtual bool            open                    (OpenMode mode) Q_DECL_OVERRIDE;
+    virtual void            close                   () Q_DECL_OVERRIDE;
+    virtual bool            isSequential            () const Q_DECL_OVERRIDE;
+    virtual qint64          bytesAvailable          () const Q_DECL_OVERRIDE;
+    virtual qint64          bytesToWrite            () const Q_DECL_OVERRIDE;
+    virtual bool            waitForReadyRead        (int msecs) Q_DECL_OVERRIDE;
+    virtual bool            waitForBytesWritten     (int msecs) Q_DECL_OVERRIDE;
+
+    bool                    setBaudRate             (const qint32 baudRate);
+    qint32                  baudRate                () const;
+    bool                    setDataBits             (const QSerialPort::DataBits dataBits);
+    QSerialPort::DataBits   dataBits                () const;
+    bool                    setParity               (const QSerialPort::Parity parity);
+    QSerialPort::Parity     parity                  () const;
+    bool                    setStopBits             (const QSerialPort::StopBits stopBits);
+    QSerialPort::StopBits   stopBits                () const;
+    bool                    setFlowControl          (const QSerialPort::FlowControl flowControl);
+    QSerialPort::FlowControl flowControl            () const;
+    void                    setLowLatency           (const bool enabled);
+    bool                    isLowLatency            () const;
+    void                    setNotifiersEnabled     (const bool enabled);
+    bool                    notifiersEnabled        () const;
+
+    bool                    flush                   ();
+    bool                    clear                   ();
+    int                     handle                  () const;
+    qint64                  readTimestamp           () const;
+    QByteArray              readStamped             (qint64 * timestamp);
+
+signals:
+    void                    errorOccurred           (QSerialPort::SerialPortError error);  /**< @brief Emitted when the tty fails (eg. USB adapter unplugged) */
+
+protected:
+    virtual qint64          readData                (char * data, qint64 maxSize) Q_DECL_OVERRIDE;
+    virtual qint64          writeData               (const char * data, qint64 maxSize) Q_DECL_OVERRIDE;
+
+private slots:
+    void                    onReadable              ();
+    void                    onWritable              ();
+    void                    emitBytesWritten        ();
+
+private:
+    /**
+     * @brief The ReadMark struct stamps a tty read held in m_readBuffer
+     */
+    struct ReadMark {
+        int                 offset;                 /**< Offset in m_readBuffer of the first byte of the read */
+        qint64              timestamp;
+    };
+
+    bool                    applySettings           ();
+    void                    applyLowLatency         ();
+    void                    createNotifiers         ();
+    void                    deleteNotifiers         ();
+    qint64                  readBatch               ();
+    bool                    writePending            ();
+    void                    reportWritten           (const qint64 n);
+    void                    setError                (const QSerialPort::SerialPortError error, const QString & str);
+    void                    clearReadBuffer         ();
+
+    int                     m_fd;                   /**< tty file descriptor; -1 when closed */
+    QString                 m_portName;
+    qint32                  m_baudRate;
+    QSerialPort::DataBits   m_dataBits;
+    QSerialPort::Parity     m_parity;
+    QSerialPort::StopBits   m_stopBits;
+    QSerialPort::FlowControl m_flowControl;
+    bool                    m_lowLatency;
+    bool                    m_notifiers;            /**< false when the application polls the fd itself */
+    QSocketNotifier *       m_readNotifier;
+    QSocketNotifier *       m_writeNotifier;
+    QByteArray              m_readBuffer;           /**< Read bytes not consumed yet, from m_readPos */
+    int                     m_readPos;
+    qint64                  m_readTimestamp;        /**< monotonicTime() of the last read returning bytes; 0 if none */
+    QVector<ReadMark>       m_readMarks;            /**< Buffered reads, by increasing offset */
+    QByteArray              m_writeBuffer;          /**< Bytes the tty didn't accept yet */
+    qint64                  m_bytesWritten;         /**< Bytes written and not reported by bytesWritten() yet */
+};
+
+} // END namespace
+
+#endif // LINUXSERIALTRANSPORT_H
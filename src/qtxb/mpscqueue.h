@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2015 ThomArmax (Thomas COIN)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * Thomas COIN <esvcorp@gmail.com> 18/04/2015
+ */
+
+
+
+#ifndef MPSCQUEUE_H
+#define MPSCQUEUE_H
+
+#include <QAtomicPointer>
+
+#include <utility>
+
+namespace QtXBee {
+
+/**
+ * @brief The MpscQueue class is a lock-free, unbounded, multiple producers single consumer FIFO.
+ *
+ * Any thread can push() without ever blocking (an atomic exchange and a store);
+ * only one thread at a time may pop(). This is Dmitry Vyukov's intrusive MPSC queue,
+ * with a stub node so that the consumer never touches the producers' end.
+ * @code
+ * // Worker threads
+ * queue.push(frame);
+ * // I/O thread
+ * while(queue.pop(&frame)) {
+ *     ...
+ * }
+ * @endcode
+ * @note pop() may transiently return false while a producer is between its two steps:
+ * the element is then returned by a later pop().
+ */
+template<typename T>
+class MpscQueue
+{
+public:
+    MpscQueue() :
+        m_head(&m_stub),
+        m_tail(&m_stub)
+    {
+    }
+
+    ~MpscQueue()
+    {
+        T value;
+        while(pop(&value)) {
+        }
+        if(m_tail != &m_stub) {
+            delete m_tail;
+        }
+    }
+
+    /**
+     * @brief Pushes a value; may be called from any thread.
+     * @param value
+     */
+    void push(const T & value)
+    {
+        Node * node = new Node(value);
+        Node * previous = m_head.fetchAndStoreOrdered(node);
+        previous->next.storeRelease(node);
+    }
+
+    /**
+     * @brief Pops the oldest value; must only be called from the consumer thread.
+     * @param value the popped value
+     * @return true if a value has been popped; false if the queue is empty.
+     */
+    bool pop(T * value)
+    {
+        Node * tail = m_tail;
+        Node * next = tail->next.loadAcquire();
+
+        if(!next) {
+            return false;
+        }
+        *value = std::move(next->value);
+        next->value = T();
+        m_tail = next;
+        if(tail != &m_stub) {
+            delete tail;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Returns true if the queue looks empty from the consumer thread; false otherwise.
+     */
+    bool isEmpty() const
+    {
+        return m_tail->next.loadAcquire() == nullptr;
+    }
+
+private:
+    struct Node {
+        Node() : next(nullptr) {}
+        explicit Node(const T & v) : next(nullptr), value(v) {}
+        QAtomicPointer<Node> next;
+        T value;
+    };
+
+    MpscQueue(const MpscQueue &) = delete;
+    MpscQueue & operator=(const MpscQueue &) = delete;
+
+    QAtomicPointer<Node>    m_head;                 /**< Last pushed node, swapped by the producers */
+    Node *                  m_tail;                 /**< Last popped node (its value is already taken), consumer only */
+    Node                    m_stub;
+};
+
+} // END namespace
+
+#endif // MPSCQUEUE_H
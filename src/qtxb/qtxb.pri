@@ -6,3 +6,4 @@ INCLUDEPATH += $$PWD/
 DEPENDPATH += $$PWD/
 
 QT += serialport
+CONFIG += c++14
@@ -32,6 +32,19 @@ SOURCES += \
     remoteatcommandresponse.cpp \
     remoteatcommandrequest.cpp \
     byteutils.cpp \
+    atparameter.cpp \
+    framedecoder.cpp \
+    frameidallocator.cpp \
+    frametemplate.cpp \
+    byteslice.cpp \
+    framefilter.cpp \
+    framering.cpp \
+    frametracer.cpp \
+    timerwheel.cpp \
+    wheeltimer.cpp \
+    xbeeprofile.cpp \
+    commandmodeengine.cpp \
+    xbeediscovery.cpp \
     wpan/txrequest16.cpp \
     wpan/txrequest64.cpp \
     wpan/txstatusresponse.cpp \
@@ -62,18 +75,48 @@ CORE_HEADERS += \
     remoteatcommandrequest.h \
     remoteatcommandresponse.h \
     byteutils.h \
+    atparameter.h \
+    framedecoder.h \
+    frameidallocator.h \
+    frametemplate.h \
+    byteslice.h \
+    framefilter.h \
+    framering.h \
+    frametracer.h \
+    mpscqueue.h \
+    xbeeawait.h \
+    timerwheel.h \
+    wheeltimer.h \
+    xbeeprofile.h \
+    commandmodeengine.h \
+    xbeediscovery.h \
     ByteUtils \
     Global \
     XBee \
     ATCommand \
+    ATParameter \
+    FrameDecoder \
+    FrameIdAllocator \
+    FrameTemplate \
+    ByteSlice \
+    FrameFilter \
+    FrameRing \
+    FrameTracer \
+    MpscQueue \
+    XBeeAwait \
+    TimerWheel \
+    WheelTimer \
     ATCommandQueueParam \
     ATCommandResponse \
+    CommandModeEngine \
     ModemStatus \
     NodeDiscoveryResponseParser \
     RemoteATCommandRequest \
     RemoteATCommandResponse \
     RemoteNode \
+    XBeeDiscovery \
     XBeePacket \
+    XBeeProfile \
     XBeeResponse
 
 WPAN_HEADERS += \
@@ -104,10 +147,23 @@ ZB_HEADERS += \
     zigbee/zbtxrequest.h \
     zigbee/zbtxstatusresponse.h
 
+# Qt-free, shared with the firmwares
+CODEC_HEADERS += \
+    codec/xbeecodec.h \
+    codec/XBeeCodec
+
+linux {
+    SOURCES += linuxserialtransport.cpp
+    CORE_HEADERS += \
+        linuxserialtransport.h \
+        LinuxSerialTransport
+}
+
 HEADERS += \
     $$CORE_HEADERS \
     $$WPAN_HEADERS \
-    $$ZB_HEADERS
+    $$ZB_HEADERS \
+    $$CODEC_HEADERS
 
 OTHER_FILES += \
     qtxb.pri \
@@ -123,5 +179,8 @@ unix {
 
     zb_headers.path = /usr/include/QtXbee/zigbee
     zb_headers.files = $$ZB_HEADERS
-    INSTALLS += target core_headers wpan_headers zb_headers
+
+    codec_headers.path = /usr/include/QtXbee/codec
+    codec_headers.files = $$CODEC_HEADERS
+    INSTALLS += target core_headers wpan_headers zb_headers codec_headers
 }
@@ -19,6 +19,7 @@
  */
 
 #include "RemoteATCommandRequest"
+#include "codec/XBeeCodec"
 #include <QDebug>
 
 namespace QtXBee {
@@ -38,25 +39,12 @@ RemoteATCommandRequest::RemoteATCommandRequest(QObject *parent) :
 // Reimplemented from XBeePacket
 void RemoteATCommandRequest::assemblePacket()
 {
-    int i;
-
-    m_packet.clear();
-    m_packet.append(frameType());
-    m_packet.append(frameId());
-    for(i=7; i>=0; i--) {
-        m_packet.append(destinationAddress64() >> (i*8)&0xFF);
-    }
-    for(i=1; i>=0; i--) {
-        m_packet.append(destinationAddress16() >> (i*8)&0xFF);
-    }
-    m_packet.append(commandOptions());
-    m_packet.append(atCommandToByteArray(command()));
-    setLength(m_packet.size());
-    createChecksum(m_packet);
-    m_packet.append(checksum());
-    m_packet.insert(0, startDelimiter());
-    m_packet.insert(1, (length()>>8)&0xFF);
-    m_packet.insert(2, length()&0xFF);
+    const QByteArray at = atCommandToByteArray(command());
+    const QByteArray param = parameter();
+    m_packet.resize(Codec::frameSize(Codec::Layout::RemoteATCommand::Data, param.size()));
+    setEncodedSize(Codec::encodeRemoteATCommand(encodeBuffer(), m_packet.size(), frameId(),
+                                                destinationAddress64(), destinationAddress16(), commandOptions(),
+                                                at.constData(), param.constData(), param.size()));
 }
 
 void RemoteATCommandRequest::clear()
@@ -19,6 +19,7 @@
  */
 
 #include "RemoteATCommandResponse"
+#include "codec/XBeeCodec"
 
 #include <QDebug>
 
@@ -54,11 +55,8 @@ bool RemoteATCommandResponse::parseApiSpecificData(const QByteArray &data)
     setSourceAddress16(data.mid(9, 2).toHex().toUInt(0,16));
     setATCommand((ATCommand::ATCommandType) data.mid(11, 2).toHex().toUInt(0,16));
     setStatus((Status) data.at(13));
-    if(data.size() > 14) {
-        for(int i=14; i < data.size(); i++) {
-            m_data.append(data.at(i));
-        }
-    }
+    // The value is sliced from the packet on access
+    setDataOffset(Codec::Layout::RemoteATCommandResponse::Data);
 
     return true;
 }
@@ -71,8 +69,8 @@ QString RemoteATCommandResponse::toString()
     str.append(QString("Frame type                   : %1 (0x%2)\n").arg(frameTypeToString(frameType())).arg(QString::number(frameType(), 16)));
     str.append(QString("Length                       : %1 bytes\n").arg(length()));
     str.append(QString("Frame id                     : %1\n").arg(frameId()));
-    if(!m_data.isEmpty())
-    str.append(QString("Data                         : 0x%1 (%2)\n").arg(QString(m_data.toHex())).arg(QString(m_data)));
+    if(!payload().isEmpty())
+    str.append(QString("Data                         : 0x%1 (%2)\n").arg(QString(payload().toHex())).arg(QString(data())));
     else
     str.append(QString("Data                         : No data\n"));
     str.append(QString("Source Address 64bits        : 0x%1\n").arg(m_sourceAddress64, 0, 16));
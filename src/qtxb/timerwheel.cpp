@@ -0,0 +1,311 @@
+/*
+ * Copyright (C) 2015 ThomArmax (Thomas COIN)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * Thomas COIN <esvcorp@gmail.com> 18/04/2015
+ */
+
+#include "TimerWheel"
+#include "WheelTimer"
+
+#include <QThreadStorage>
+#include <QTimerEvent>
+#include <QtAlgorithms>
+
+namespace QtXBee {
+
+/**
+ * @brief Returns the wheel of the current thread, created on first call; it's deleted when the thread exits.
+ */
+TimerWheel *TimerWheel::instance()
+{
+    static QThreadStorage<TimerWheel*> wheels;
+
+    if(!wheels.hasLocalData()) {
+        wheels.setLocalData(new TimerWheel());
+    }
+    return wheels.localData();
+}
+
+/**
+ * @brief TimerWheel's constructor
+ * @param parent
+ */
+TimerWheel::TimerWheel(QObject *parent) :
+    QObject(parent),
+    m_now(0),
+    m_wakeUp(-1),
+    m_count(0)
+{
+    for(int level=0; level<Levels; level++) {
+        m_occupied[level] = 0;
+        for(int slot=0; slot<Slots; slot++) {
+            initHead(&m_slots[level][slot]);
+        }
+    }
+    initHead(&m_overflow);
+    m_clock.start();
+}
+
+/**
+ * @brief TimerWheel's destructor; the armed timers are stopped.
+ */
+TimerWheel::~TimerWheel()
+{
+    for(int level=0; level<=Levels; level++) {
+        for(int slot=0; slot<(level < Levels ? Slots : 1); slot++) {
+            Node * head = level < Levels ? &m_slots[level][slot] : &m_overflow;
+            while(head->next != head) {
+                Node * node = head->next;
+                unlink(node);
+                node->owner->m_wheel = NULL;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Returns the current tick of the wheel, in milliseconds.
+ */
+qint64 TimerWheel::now() const
+{
+    return m_now;
+}
+
+/**
+ * @brief Returns the number of armed timers.
+ */
+int TimerWheel::count() const
+{
+    return m_count;
+}
+
+/**
+ * @brief Returns the time before the next timer expires, in milliseconds; -1 if no timer is armed.
+ * @sa XBee::nextTimeout()
+ */
+int TimerWheel::nextTimeout() const
+{
+    const qint64 next = nextEvent();
+
+    if(next < 0) {
+        return -1;
+    }
+    return (int)qMax(Q_INT64_C(0), next - m_clock.elapsed());
+}
+
+/**
+ * @brief Fires the expired timers, without waiting for the system timer.
+ *
+ * For threads without event loop, which call it when nextTimeout() elapsed.
+ * @sa XBee::pump()
+ */
+void TimerWheel::processTimers()
+{
+    advance(m_clock.elapsed());
+    schedule();
+}
+
+void TimerWheel::timerEvent(QTimerEvent *event)
+{
+    if(event->timerId() != m_timer.timerId()) {
+        QObject::timerEvent(event);
+        return;
+    }
+    processTimers();
+}
+
+void TimerWheel::arm(Node *node, const qint64 expiry)
+{
+    if(node->next) {
+        unlink(node);
+        m_count--;
+    }
+    if(m_count == 0) {
+        // Idle: catch up with the clock so that the timer doesn't cascade through stale ticks
+        m_now = qMax(m_now, m_clock.elapsed());
+    }
+
+    node->expiry = qMax(expiry, m_now + 1);
+    insert(node);
+    m_count++;
+
+    if(!m_timer.isActive() || node->expiry < m_wakeUp) {
+        schedule();
+    }
+}
+
+void TimerWheel::disarm(Node *node)
+{
+    if(!node->next) {
+        return;
+    }
+    unlink(node);
+    m_count--;
+    if(m_count == 0) {
+        m_timer.stop();
+    }
+}
+
+void TimerWheel::insert(Node *node)
+{
+    // The level is given by the highest 6 bits group in which the expiry differs from the current tick
+    const quint64 diff = (quint64)(node->expiry ^ m_now);
+    int level = 0;
+
+    while(level < Levels && (diff >> (SlotBits*(level+1))) != 0) {
+        level++;
+    }
+
+    node->level = level;
+    if(level == Levels) {
+        node->slot = 0;
+        append(&m_overflow, node);
+        return;
+    }
+    node->slot = (node->expiry >> (SlotBits*level)) & (Slots-1);
+    append(&m_slots[level][node->slot], node);
+    m_occupied[level] |= Q_UINT64_C(1) << node->slot;
+}
+
+void TimerWheel::unlink(Node *node)
+{
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    node->prev = NULL;
+    node->next = NULL;
+
+    if(node->level >= 0 && node->level < Levels) {
+        const Node * head = &m_slots[node->level][node->slot];
+        if(head->next == head) {
+            m_occupied[node->level] &= ~(Q_UINT64_C(1) << node->slot);
+        }
+    }
+    node->level = -1;
+}
+
+void TimerWheel::reinsert(Node *head)
+{
+    Node nodes;
+    initHead(&nodes);
+
+    // Detached first: an overflow timer still out of range goes back to the same list
+    while(head->next != head) {
+        Node * node = head->next;
+        unlink(node);
+        append(&nodes, node);
+    }
+    while(nodes.next != &nodes) {
+        Node * node = nodes.next;
+        unlink(node);
+        insert(node);
+    }
+}
+
+qint64 TimerWheel::nextEvent() const
+{
+    qint64 next = -1;
+
+    // Nodes of a level are always in a slot after the current one, within the current slot of the upper level
+    for(int level=0; level<Levels; level++) {
+        const int shift = SlotBits*level;
+        const int current = (m_now >> shift) & (Slots-1);
+        const quint64 later = current == Slots-1 ? 0 : m_occupied[level] & (~Q_UINT64_C(0) << (current+1));
+        if(later) {
+            const qint64 base = (m_now >> (shift + SlotBits)) << (shift + SlotBits);
+            const qint64 tick = base + ((qint64)qCountTrailingZeroBits(later) << shift);
+            if(next < 0 || tick < next) {
+                next = tick;
+            }
+        }
+    }
+    if(next < 0 && m_overflow.next != &m_overflow) {
+        next = ((m_now >> (SlotBits*Levels)) + 1) << (SlotBits*Levels);
+    }
+    return next;
+}
+
+void TimerWheel::advance(const qint64 target)
+{
+    Node expired;
+    initHead(&expired);
+
+    forever {
+        const qint64 tick = nextEvent();
+        if(tick < 0 || tick > target) {
+            break;
+        }
+        m_now = tick;
+
+        // Cascade the upper levels reached by this tick, highest first, then expire the level 0 slot
+        if((tick & ((Q_INT64_C(1) << (SlotBits*Levels)) - 1)) == 0) {
+            reinsert(&m_overflow);
+        }
+        for(int level=Levels-1; level>0; level--) {
+            const int shift = SlotBits*level;
+            if((tick & ((Q_INT64_C(1) << shift) - 1)) == 0) {
+                reinsert(&m_slots[level][(tick >> shift) & (Slots-1)]);
+            }
+        }
+
+        Node * head = &m_slots[0][tick & (Slots-1)];
+        while(head->next != head) {
+            Node * node = head->next;
+            unlink(node);
+            append(&expired, node);
+        }
+
+        // The timeouts may arm, stop or delete any timer, expired ones included
+        while(expired.next != &expired) {
+            Node * node = expired.next;
+            unlink(node);
+            m_count--;
+            node->owner->expire();
+        }
+    }
+
+    // A timeout may have processed events, and the wheel, beyond the target
+    m_now = qMax(m_now, target);
+}
+
+void TimerWheel::schedule()
+{
+    const qint64 next = nextEvent();
+
+    if(next < 0) {
+        m_timer.stop();
+        m_wakeUp = -1;
+        return;
+    }
+    m_wakeUp = next;
+    m_timer.start((int)qMax(Q_INT64_C(0), next - m_clock.elapsed()), Qt::PreciseTimer, this);
+}
+
+void TimerWheel::initHead(Node *head)
+{
+    head->prev = head;
+    head->next = head;
+}
+
+void TimerWheel::append(Node *head, Node *node)
+{
+    node->prev = head->prev;
+    node->next = head;
+    head->prev->next = node;
+    head->prev = node;
+}
+
+} // END namespace
@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2015 ThomArmax (Thomas COIN)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * Thomas COIN <esvcorp@gmail.com> 18/04/2015
+ */
+
+
+#ifndef TIMERWHEEL_H
+#define TIMERWHEEL_H
+
+#include <QObject>
+#include <QBasicTimer>
+#include <QElapsedTimer>
+
+namespace QtXBee {
+
+class WheelTimer;
+
+/**
+ * @brief The TimerWheel class runs all the WheelTimer of a thread from a single system timer.
+ *
+ * The timers are kept in a hierarchical timing wheel: 5 levels of 64 slots, with a 1 millisecond tick,
+ * which covers about 12 days (longer timers wait in an overflow list). Arming and cancelling a timer is O(1)
+ * and allocates nothing; a timer moves down one level at most 4 times before expiring.
+ *
+ * The system timer is only armed for the next occupied slot: an idle wheel doesn't wake the thread up,
+ * and thousands of pending timeouts cost a single registration in the event dispatcher.
+ *
+ * There is one wheel per thread, created on first use by TimerWheel::instance().
+ * A thread which doesn't run an event loop drives its wheel with nextTimeout() and processTimers().
+ * @sa WheelTimer
+ */
+class TimerWheel : public QObject
+{
+    Q_OBJECT
+public:
+    static const int        SlotBits = 6;
+    static const int        Slots = 1 << SlotBits;
+    static const int        Levels = 5;
+
+    static TimerWheel *     instance                ();
+
+    explicit                TimerWheel              (QObject * parent = 0);
+                            ~TimerWheel             ();
+
+    qint64                  now                     () const;
+    int                     count                   () const;
+    int                     nextTimeout             () const;
+    void                    processTimers           ();
+
+protected:
+    void                    timerEvent              (QTimerEvent * event) Q_DECL_OVERRIDE;
+
+private:
+    friend class WheelTimer;
+
+    struct Node {
+        Node() : prev(NULL), next(NULL), expiry(0), level(-1), slot(0), owner(NULL) {}
+        Node *              prev;
+        Node *              next;                   /**< NULL if not linked */
+        qint64              expiry;                 /**< Tick at which the timer expires */
+        int                 level;                  /**< Level of the slot holding the node; Levels for the overflow list, -1 if none */
+        int                 slot;
+        WheelTimer *        owner;                  /**< NULL for the list heads */
+    };
+
+    void                    arm                     (Node * node, const qint64 expiry);
+    void                    disarm                  (Node * node);
+    void                    insert                  (Node * node);
+    void                    unlink                  (Node * node);
+    void                    reinsert                (Node * head);
+    qint64                  nextEvent               () const;
+    void                    advance                 (const qint64 target);
+    void                    schedule                ();
+
+    static void             initHead                (Node * head);
+    static void             append                  (Node * head, Node * node);
+
+    QElapsedTimer           m_clock;
+    QBasicTimer             m_timer;                /**< The only system timer of the wheel */
+    qint64                  m_now;                  /**< Last processed tick */
+    qint64                  m_wakeUp;               /**< Tick for which m_timer is armed */
+    int                     m_count;                /**< Armed timers */
+    quint64                 m_occupied[Levels];     /**< Non empty slots, one bit per slot */
+    Node                    m_slots[Levels][Slots];
+    Node                    m_overflow;             /**< Timers beyond the last level */
+};
+
+} // END namespace
+
+#endif // TIMERWHEEL_H
@@ -0,0 +1,167 @@
+/*
+ * Copyright (C) 2015 ThomArmax (Thomas COIN)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * Thomas COIN <esvcorp@gmail.com> 18/04/2015
+ */
+
+#include "WheelTimer"
+
+#include <QEvent>
+#include <QThread>
+#include <QDebug>
+
+namespace QtXBee {
+
+/**
+ * @brief WheelTimer's constructor
+ * @param parent
+ */
+WheelTimer::WheelTimer(QObject *parent) :
+    QObject(parent),
+    m_wheel(NULL),
+    m_interval(0),
+    m_singleShot(false)
+{
+    m_node.owner = this;
+}
+
+/**
+ * @brief WheelTimer's destructor
+ */
+WheelTimer::~WheelTimer()
+{
+    stop();
+}
+
+/**
+ * @brief Sets whether the timer is a single shot timer (false by default).
+ * @param singleShot
+ */
+void WheelTimer::setSingleShot(const bool singleShot)
+{
+    m_singleShot = singleShot;
+}
+
+/**
+ * @brief Returns true if the timer is a single shot timer; false otherwise.
+ */
+bool WheelTimer::isSingleShot() const
+{
+    return m_singleShot;
+}
+
+/**
+ * @brief Sets the timeout interval, in milliseconds; an active timer is restarted.
+ * @param msecs
+ */
+void WheelTimer::setInterval(const int msecs)
+{
+    m_interval = msecs;
+    if(isActive()) {
+        arm(m_interval);
+    }
+}
+
+/**
+ * @brief Returns the timeout interval, in milliseconds.
+ */
+int WheelTimer::interval() const
+{
+    return m_interval;
+}
+
+/**
+ * @brief Returns true if the timer is running; false otherwise.
+ */
+bool WheelTimer::isActive() const
+{
+    return m_node.next != NULL;
+}
+
+/**
+ * @brief Returns the time left before the timeout, in milliseconds; -1 if the timer is inactive.
+ */
+int WheelTimer::remainingTime() const
+{
+    if(!isActive()) {
+        return -1;
+    }
+    return (int)qMax(Q_INT64_C(0), m_node.expiry - m_wheel->m_clock.elapsed());
+}
+
+/**
+ * @brief Starts or restarts the timer with the given interval.
+ * @param msecs
+ */
+void WheelTimer::start(const int msecs)
+{
+    m_interval = msecs;
+    start();
+}
+
+/**
+ * @brief Starts or restarts the timer with its current interval.
+ */
+void WheelTimer::start()
+{
+    if(thread() != QThread::currentThread()) {
+        qWarning() << Q_FUNC_INFO << "Timers cannot be started from another thread";
+        return;
+    }
+    arm(m_interval);
+}
+
+/**
+ * @brief Stops the timer.
+ */
+void WheelTimer::stop()
+{
+    if(m_wheel) {
+        m_wheel->disarm(&m_node);
+    }
+}
+
+bool WheelTimer::event(QEvent *event)
+{
+    if(event->type() == QEvent::ThreadChange) {
+        // Moved to another thread: re-armed in the wheel of that thread, once there
+        if(isActive()) {
+            QMetaObject::invokeMethod(this, "arm", Qt::QueuedConnection, Q_ARG(int, remainingTime()));
+        }
+        stop();
+        m_wheel = NULL;
+    }
+    return QObject::event(event);
+}
+
+void WheelTimer::arm(const int msecs)
+{
+    if(!m_wheel) {
+        m_wheel = TimerWheel::instance();
+    }
+    m_wheel->arm(&m_node, m_wheel->m_clock.elapsed() + qMax(0, msecs));
+}
+
+void WheelTimer::expire()
+{
+    if(!m_singleShot) {
+        m_wheel->arm(&m_node, m_wheel->now() + qMax(1, m_interval));
+    }
+    emit timeout();
+}
+
+} // END namespace
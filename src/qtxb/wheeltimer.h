@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2015 ThomArmax (Thomas COIN)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * Thomas COIN <esvcorp@gmail.com> 18/04/2015
+ */
+
+
+#ifndef WHEELTIMER_H
+#define WHEELTIMER_H
+
+#include <QObject>
+
+#include "TimerWheel"
+
+namespace QtXBee {
+
+/**
+ * @brief The WheelTimer class is a QTimer replacement run by the thread's TimerWheel.
+ *
+ * It has the same interface as QTimer (start(), stop(), setSingleShot(), timeout()...), with a 1 millisecond
+ * resolution, but arming and stopping it is O(1) and doesn't touch the event dispatcher. It backs every timeout
+ * of the library, so that many radios with many requests in flight share one system timer per thread.
+ * @code
+ * m_responseTimer.setSingleShot(true);
+ * connect(&m_responseTimer, SIGNAL(timeout()), SLOT(onResponseTimeout()));
+ * m_responseTimer.start(2000);
+ * @endcode
+ * @note Like QTimer, a WheelTimer must be started and stopped from its thread.
+ * @sa TimerWheel
+ */
+class WheelTimer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit                WheelTimer              (QObject * parent = 0);
+                            ~WheelTimer             ();
+
+    void                    setSingleShot           (const bool singleShot);
+    bool                    isSingleShot            () const;
+    void                    setInterval             (const int msecs);
+    int                     interval                () const;
+    bool                    isActive                () const;
+    int                     remainingTime           () const;
+
+public slots:
+    void                    start                   (const int msecs);
+    void                    start                   ();
+    void                    stop                    ();
+
+signals:
+    void                    timeout                 ();                 /**< @brief Emitted when the timer expires. */
+
+protected:
+    bool                    event                   (QEvent * event) Q_DECL_OVERRIDE;
+
+private slots:
+    void                    arm                     (const int msecs);
+
+private:
+    friend class TimerWheel;
+
+    void                    expire                  ();
+
+    TimerWheel::Node        m_node;
+    TimerWheel *            m_wheel;                /**< Wheel holding m_node; NULL if none */
+    int                     m_interval;
+    bool                    m_singleShot;
+};
+
+} // END namespace
+
+#endif // WHEELTIMER_H
@@ -19,6 +19,7 @@
  */
 
 #include "RxBaseResponse"
+#include "../codec/XBeeCodec"
 
 namespace QtXBee {
 namespace Wpan {
@@ -26,7 +27,9 @@ namespace Wpan {
 RxBaseResponse::RxBaseResponse(QObject *parent) :
     XBeeResponse(parent),
     m_rssi(-1),
-    m_options(0)
+    m_options(0),
+    m_pendingFields(0),
+    m_addressSize(0)
 {
 }
 
@@ -39,6 +42,7 @@ void RxBaseResponse::clear()
     XBeeResponse::clear();
     m_rssi = -1;
     m_options = 0;
+    m_pendingFields = 0;
 }
 
 QString RxBaseResponse::toString()
@@ -54,6 +58,7 @@ QString RxBaseResponse::toString()
 void RxBaseResponse::setRSSI(const qint8 rssi)
 {
     m_rssi = rssi;
+    m_pendingFields &= ~RssiField;
 }
 
 /**
@@ -63,17 +68,53 @@ void RxBaseResponse::setRSSI(const qint8 rssi)
  */
 qint8 RxBaseResponse::rssi() const
 {
+    if(m_pendingFields & RssiField) {
+        m_rssi = -1*(quint8)m_packet.at(Codec::Layout::Rx16Response::Source + m_addressSize);
+        m_pendingFields &= ~RssiField;
+    }
     return m_rssi;
 }
 
 void RxBaseResponse::setOptions(const quint8 options)
 {
     m_options = options;
+    m_pendingFields &= ~OptionsField;
 }
 
 quint8 RxBaseResponse::options() const
 {
+    if(m_pendingFields & OptionsField) {
+        m_options = (quint8)m_packet.at(Codec::Layout::Rx16Response::Source + 1 + m_addressSize);
+        m_pendingFields &= ~OptionsField;
+    }
     return m_options;
 }
 
+/**
+ * @brief Records the layout of the received packet, to decode its fields on first access.
+ *
+ * The packet must hold at least the source address, the RSSI and the options.
+ * @param addressSize size of the source address (2 or 8 bytes)
+ */
+void RxBaseResponse::setFieldsLayout(const int addressSize)
+{
+    m_addressSize = addressSize;
+    m_pendingFields = SourceAddressField | RssiField | OptionsField;
+    setDataOffset(addressSize == 2 ? (int)Codec::Layout::Rx16Response::Data
+                                   : (int)Codec::Layout::Rx64Response::Data);
+}
+
+/**
+ * @brief Decodes the big-endian source address from the packet.
+ */
+quint64 RxBaseResponse::decodeAddress() const
+{
+    quint64 address = 0;
+
+    for(int i=0; i<m_addressSize; i++) {
+        address = (address << 8) | (quint8)m_packet.at(Codec::Layout::Rx16Response::Source + i);
+    }
+    return address;
+}
+
 }} // END namespace
@@ -30,6 +30,9 @@ namespace Wpan {
 
 /**
  * @brief The RxBaseResponse class is the base to implement a Wpan Response
+ *
+ * Received fields are decoded from the packet on first access only, then memoised:
+ * a consumer only forwarding the data doesn't pay for the address, RSSI and options decoding.
  * @todo Handle options
  */
 class RxBaseResponse : public XBeeResponse
@@ -50,8 +53,23 @@ public:
     quint8          options         () const;
 
 protected:
-    qint8           m_rssi;
-    quint8          m_options;
+    /**
+     * @brief The Field enum identifies the fields not decoded yet
+     */
+    enum Field {
+        SourceAddressField  = 0x01,
+        RssiField           = 0x02,
+        OptionsField        = 0x04
+    };
+
+    void            setFieldsLayout (const int addressSize);
+    quint64         decodeAddress   () const;
+
+protected:
+    mutable qint8   m_rssi;
+    mutable quint8  m_options;
+    mutable quint8  m_pendingFields;    /**< Fields not decoded yet (Field flags) */
+    int             m_addressSize;      /**< Size of the source address in the packet */
 
 };
 
@@ -46,12 +46,8 @@ bool RxResponse16::parseApiSpecificData(const QByteArray &data)
         qWarning() << Q_FUNC_INFO << "Invalid data, expected at least 4 bytes, got" << data.size();
         return false;
     }
-    setSourceAddress(data.mid(0, 2).toHex().toULongLong(0, 16));
-    setRSSI(-1*data.mid(2, 1).toHex().toInt(0, 16));
-    setOptions(data.mid(3, 1).toHex().toUInt(0, 16));
-    if(data.size() > 4) {
-        setData(data.mid(4));
-    }
+    // Fields are decoded from the packet on first access
+    setFieldsLayout(2);
 
     return true;
 }
@@ -81,6 +77,7 @@ QString RxResponse16::toString()
 void RxResponse16::setSourceAddress(const quint16 sourceAddress)
 {
     m_sourceAddress = sourceAddress;
+    m_pendingFields &= ~SourceAddressField;
 }
 
 /**
@@ -90,6 +87,10 @@ void RxResponse16::setSourceAddress(const quint16 sourceAddress)
  */
 quint16 RxResponse16::sourceAddress() const
 {
+    if(m_pendingFields & SourceAddressField) {
+        m_sourceAddress = decodeAddress();
+        m_pendingFields &= ~SourceAddressField;
+    }
     return m_sourceAddress;
 }
 
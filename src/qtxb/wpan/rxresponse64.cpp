@@ -44,16 +44,12 @@ void RxResponse64::clear()
 
 bool RxResponse64::parseApiSpecificData(const QByteArray &data)
 {
-    if(data.size() < 9) {
-        qWarning() << Q_FUNC_INFO << "Invalid data, expected at least 9 bytes, got" << data.size();
+    if(data.size() < 10) {
+        qWarning() << Q_FUNC_INFO << "Invalid data, expected at least 10 bytes, got" << data.size();
         return false;
     }
-    setSourceAddress(data.mid(0, 8).toHex().toULongLong(0, 16));
-    setRSSI(-1*data.mid(8, 1).toHex().toInt(0, 16));
-    setOptions(data.mid(9, 1).toHex().toUInt(0, 16));
-    if(data.size() > 10) {
-        setData(data.mid(10));
-    }
+    // Fields are decoded from the packet on first access
+    setFieldsLayout(8);
 
     return true;
 }
@@ -83,6 +79,7 @@ QString RxResponse64::toString()
 void RxResponse64::setSourceAddress(const quint64 sourceAddress)
 {
     m_sourceAddress = sourceAddress;
+    m_pendingFields &= ~SourceAddressField;
 }
 
 /**
@@ -92,6 +89,10 @@ void RxResponse64::setSourceAddress(const quint64 sourceAddress)
  */
 quint64 RxResponse64::sourceAddress() const
 {
+    if(m_pendingFields & SourceAddressField) {
+        m_sourceAddress = decodeAddress();
+        m_pendingFields &= ~SourceAddressField;
+    }
     return m_sourceAddress;
 }
 
@@ -51,7 +51,7 @@ protected:
     virtual bool    parseApiSpecificData(const QByteArray &data) Q_DECL_OVERRIDE;
 
 private:
-    quint64         m_sourceAddress;
+    mutable quint64 m_sourceAddress;
 };
 
 }} // END namespace
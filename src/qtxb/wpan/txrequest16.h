@@ -46,6 +46,8 @@ public:
 
     void            setDestinationAddress   (const quint16 address);
     void            setData                 (const QByteArray & data);
+    void            setData                 (QByteArray && data);
+    void            setData                 (const char * data, const int size);
 
     quint16         destinationAddress      () const;
     QByteArray      data                    () const;
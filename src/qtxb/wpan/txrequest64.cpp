@@ -19,6 +19,9 @@
  */
 
 #include "TxRequest64"
+#include "../codec/XBeeCodec"
+
+#include <utility>
 
 namespace QtXBee {
 namespace Wpan {
@@ -36,30 +39,12 @@ TxRequest64::~TxRequest64()
 
 void TxRequest64::assemblePacket()
 {
-    int i = 0;
-
-    m_packet.clear();
-
-    m_packet.append(frameType());
-    m_packet.append(frameId());
-
-    for(i=7; i>=0; i--) {
-        m_packet.append(m_destinationAddress >> (i*8)&0xFF);
-    }
+    m_packet.resize(Codec::frameSize(Codec::Layout::TxRequest64::Data, m_data.size()));
     /** @todo Handle Options */
-    m_packet.append(QByteArray::number(0));
     /** @todo Check data's size (up to 100 bytes per packet) */
-    for(int i=0; i<m_data.size(); i++) {
-        m_packet.append(m_data.at(i));
-    }
-
-    setLength(m_packet.size());
-    createChecksum(m_packet);
-
-    m_packet.append(checksum());
-    m_packet.insert(0, startDelimiter());
-    m_packet.insert(1, (length()>>8)&0xFF);
-    m_packet.insert(2, length()&0xFF);
+    setEncodedSize(Codec::encodeTxRequest64(encodeBuffer(), m_packet.size(), frameId(),
+                                            m_destinationAddress, 0,
+                                            m_data.constData(), m_data.size()));
 }
 
 void TxRequest64::clear()
@@ -102,6 +87,25 @@ void TxRequest64::setData(const QByteArray &data)
     m_data = data;
 }
 
+/**
+ * @brief Sets the data to be sent (Up to 100 bytes per packet), taking over the given array
+ * @param data the data to be sent
+ */
+void TxRequest64::setData(QByteArray &&data)
+{
+    m_data = std::move(data);
+}
+
+/**
+ * @brief Sets the data to be sent (Up to 100 bytes per packet), copying @a size bytes from @a data
+ * @param data the data to be sent
+ * @param size the number of bytes to send
+ */
+void TxRequest64::setData(const char *data, const int size)
+{
+    m_data = QByteArray(data, size);
+}
+
 /**
  * @brief Returns the data to be sent
  * @return the data to be sent
@@ -46,6 +46,8 @@ public:
 
     void            setDestinationAddress   (const quint64 address);
     void            setData                 (const QByteArray & data);
+    void            setData                 (QByteArray && data);
+    void            setData                 (const char * data, const int size);
 
     quint64         destinationAddress      () const;
     QByteArray      data                    () const;
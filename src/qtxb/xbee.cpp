@@ -18,21 +18,41 @@
  * Thomas COIN <esvcorp@gmail.com> 18/04/2015
  */
 
+#include <QCoreApplication>
 #include <QDebug>
+#include <QElapsedTimer>
+#include <QEvent>
+#include <QRandomGenerator>
+#include <QThread>
 #include <QSerialPort>
 #include <QSerialPortInfo>
 
 #include "XBee"
 #include "Global"
 #include "XBeePacket"
+#include "FrameTemplate"
+#include "FrameTracer"
 #include "ATCommand"
+#include "ATParameter"
 #include "ATCommandQueueParam"
+#include "XBeeProfile"
 #include "RemoteATCommandRequest"
 #include "ATCommandResponse"
 #include "ModemStatus"
 #include "RemoteATCommandResponse"
 #include "RemoteNode"
 #include "NodeDiscoveryResponseParser"
+#include "TimerWheel"
+#ifdef Q_OS_LINUX
+#include "LinuxSerialTransport"
+#include <errno.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+#ifdef Q_OS_UNIX
+#include <poll.h>
+#endif
 
 #include "wpan/TxStatusResponse"
 #include "wpan/RxResponse16"
@@ -47,6 +67,32 @@
 
 namespace QtXBee {
 
+/**
+ * @brief Baud rates supported by the XBee, indexed by their ATBD code
+ */
+static const qint32 XBeeBaudRates[] = {
+    QSerialPort::Baud1200,
+    QSerialPort::Baud2400,
+    QSerialPort::Baud4800,
+    QSerialPort::Baud9600,
+    QSerialPort::Baud19200,
+    QSerialPort::Baud38400,
+    QSerialPort::Baud57600,
+    QSerialPort::Baud115200
+};
+
+static const int RecoveryBaseDelay  = 100;     /**< First reconnection delay, in milliseconds */
+static const int RecoveryMaxDelay   = 5000;    /**< Maximum reconnection delay, in milliseconds */
+static const int AssociationPollInterval    = 10000;    /**< Default ATAI poll interval, in milliseconds */
+static const int AssociationHoldTimeout     = 30000;    /**< Default time data frames are held while disassociated, in milliseconds */
+static const int FrameTimeout               = 10000;    /**< Default time to wait for a frame's response, in milliseconds */
+static const int TransmitWindow             = 4;        /**< Default number of data frames the XBee may be transmitting at once */
+static const int DrrQuantum                 = 128;      /**< Bytes a destination may send per round, larger than any frame */
+static const int BreakerThreshold           = 3;        /**< Consecutive failures before backing off a destination */
+static const int BreakerBaseDelay           = 1000;     /**< First back off delay, in milliseconds */
+static const int BreakerMaxDelay            = 60000;    /**< Maximum back off delay, in milliseconds */
+static const int XBeeBaudRatesCount = sizeof(XBeeBaudRates)/sizeof(XBeeBaudRates[0]);
+
 /**
  * @brief XBee's default constructor.
  *
@@ -59,25 +105,55 @@ namespace QtXBee {
 XBee::XBee(QObject *parent) :
     QObject(parent),
     m_serial(NULL),
+    m_transport(NULL),
+    m_device(NULL),
+    m_transportType(QtSerialPortTransport),
     xbeeFound(false),
     m_mode(API1Mode),
-    m_frameIdCounter(1),
-    m_dh(0),
-    m_dl(0),
-    m_my(0),
-    m_mp(0),
-    m_nc(0),
-    m_sh(0),
-    m_sl(0),
-    m_ni(QString()),
-    m_se(0),
-    m_de(0),
-    m_ci(0),
-    m_to(0),
-    m_np(0),
-    m_dd(0),
-    m_cr(0)
+    m_filteredFrameCount(0),
+    m_frameSignals(true),
+    m_drainScheduled(0),
+    m_nextTicket(0),
+    m_pollMode(false),
+    m_wakeFd(-1),
+    m_queuedCalls(0),
+    m_frameTimeout(FrameTimeout),
+    m_txBusyUntil(0),
+    m_writingFrames(false),
+    m_transmitWindow(TransmitWindow),
+    m_drrIndex(0),
+    m_drrFresh(true),
+    m_lastEviction(0),
+    m_negotiateBaudRate(false),
+    m_maxBaudRate(QSerialPort::Baud115200),
+    m_commandEngine(new CommandModeEngine(this)),
+    m_autoRecovery(true),
+    m_recoveryPolicy(ReplayPending),
+    m_association(AssociationUnknown),
+    m_associationHoldTimeout(AssociationHoldTimeout),
+    m_associationPollInterval(AssociationPollInterval),
+    m_recovering(false),
+    m_synchronizing(false),
+    m_resyncing(false),
+    m_commandCheck(NoCommandCheck),
+    m_commandCheckAp(-1),
+    m_recoveryAttempt(0),
+    m_identity(0),
+    m_nc(0)
 {
+    connect(m_commandEngine, SIGNAL(lineReceived(QByteArray)), SLOT(onCommandLineReceived(QByteArray)));
+    connect(m_commandEngine, SIGNAL(responseReceived(QByteArray,QByteArray)), SLOT(onCommandResponse(QByteArray,QByteArray)));
+    connect(m_commandEngine, SIGNAL(commandsFinished(bool)), SLOT(onCommandsFinished(bool)));
+    m_recoveryTimer.setSingleShot(true);
+    connect(&m_recoveryTimer, SIGNAL(timeout()), SLOT(onRecoveryTimer()));
+    connect(&m_associationTimer, SIGNAL(timeout()), SLOT(onAssociationTimer()));
+    m_frameTimer.setSingleShot(true);
+    connect(&m_frameTimer, SIGNAL(timeout()), SLOT(onFrameTimer()));
+    m_txTimer.setSingleShot(true);
+    connect(&m_txTimer, SIGNAL(timeout()), SLOT(writeQueuedFrames()));
+    qRegisterMetaType<QVector<QByteArray> >("QVector<QByteArray>");
+    qRegisterMetaType<QtXBee::XBee::AssociationState>("QtXBee::XBee::AssociationState");
+    m_clock.start();
 }
 
 /**
@@ -96,27 +172,56 @@ XBee::XBee(QObject *parent) :
 XBee::XBee(const QString &serialPort, QObject *parent) :
     QObject(parent),
     m_serial(NULL),
+    m_transport(NULL),
+    m_device(NULL),
+    m_transportType(QtSerialPortTransport),
     xbeeFound(false),
     m_mode(API1Mode),
-    m_frameIdCounter(1),
-    m_dh(0),
-    m_dl(0),
-    m_my(0),
-    m_mp(0),
-    m_nc(0),
-    m_sh(0),
-    m_sl(0),
-    m_ni(QString()),
-    m_se(0),
-    m_de(0),
-    m_ci(0),
-    m_to(0),
-    m_np(0),
-    m_dd(0),
-    m_cr(0)
-{
-    m_serial = new QSerialPort(serialPort, this);
-    connect(m_serial, SIGNAL(readyRead()), SLOT(readData()));
+    m_filteredFrameCount(0),
+    m_frameSignals(true),
+    m_drainScheduled(0),
+    m_nextTicket(0),
+    m_pollMode(false),
+    m_wakeFd(-1),
+    m_queuedCalls(0),
+    m_frameTimeout(FrameTimeout),
+    m_txBusyUntil(0),
+    m_writingFrames(false),
+    m_transmitWindow(TransmitWindow),
+    m_drrIndex(0),
+    m_drrFresh(true),
+    m_lastEviction(0),
+    m_negotiateBaudRate(false),
+    m_maxBaudRate(QSerialPort::Baud115200),
+    m_commandEngine(new CommandModeEngine(this)),
+    m_autoRecovery(true),
+    m_recoveryPolicy(ReplayPending),
+    m_association(AssociationUnknown),
+    m_associationHoldTimeout(AssociationHoldTimeout),
+    m_associationPollInterval(AssociationPollInterval),
+    m_recovering(false),
+    m_synchronizing(false),
+    m_resyncing(false),
+    m_commandCheck(NoCommandCheck),
+    m_commandCheckAp(-1),
+    m_recoveryAttempt(0),
+    m_identity(0),
+    m_nc(0)
+{
+    connect(m_commandEngine, SIGNAL(lineReceived(QByteArray)), SLOT(onCommandLineReceived(QByteArray)));
+    connect(m_commandEngine, SIGNAL(responseReceived(QByteArray,QByteArray)), SLOT(onCommandResponse(QByteArray,QByteArray)));
+    connect(m_commandEngine, SIGNAL(commandsFinished(bool)), SLOT(onCommandsFinished(bool)));
+    m_recoveryTimer.setSingleShot(true);
+    connect(&m_recoveryTimer, SIGNAL(timeout()), SLOT(onRecoveryTimer()));
+    connect(&m_associationTimer, SIGNAL(timeout()), SLOT(onAssociationTimer()));
+    m_frameTimer.setSingleShot(true);
+    connect(&m_frameTimer, SIGNAL(timeout()), SLOT(onFrameTimer()));
+    m_txTimer.setSingleShot(true);
+    connect(&m_txTimer, SIGNAL(timeout()), SLOT(writeQueuedFrames()));
+    qRegisterMetaType<QVector<QByteArray> >("QVector<QByteArray>");
+    qRegisterMetaType<QtXBee::XBee::AssociationState>("QtXBee::XBee::AssociationState");
+    m_clock.start();
+    createDevice(serialPort);
     applyDefaultSerialPortConfig();
 }
 
@@ -125,42 +230,51 @@ XBee::XBee(const QString &serialPort, QObject *parent) :
  */
 XBee::~XBee()
 {
-    if(m_serial && m_serial->isOpen())
+    if(m_device && m_device->isOpen())
     {
-        m_serial->close();
+        m_device->close();
         qDebug() << "XBEE: Serial Port closed successfully";
     }
+    setPollMode(false);
 }
 
 /**
  * @brief Opens the XBee' serial port
+ *
+ * If enabled, the baud rate is then negotiated (see XBee::setBaudRateNegotiation()).
+ * A failed negotiation doesn't make open() fail, the serial port stays at the baud rate the XBee answers to.
+ * If the XBee doesn't answer in API mode, it is set to API mode through the command mode once open() returned:
+ * XBee::mode() is XBee::CommandMode until then.
  * @return true if succeeded; false otherwise.
  * @sa XBee::close()
  * @sa XBee::setSerialPort()
  */
 bool XBee::open()
 {
-    if(!m_serial)
+    if(!m_device)
     {
         qWarning() << "XBEE: No serial port defined";
         xbeeFound = false;
         return false;
     }
 
-    if(m_serial->open(QIODevice::ReadWrite))
+    if(m_device->open(QIODevice::ReadWrite))
     {
-        if(m_serial->isOpen())
+        if(m_device->isOpen())
         {
             qDebug() << "XBEE: Connected successfully";
-            qDebug() << "XBEE: Serial Port Name: " << m_serial->portName();
+            qDebug() << "XBEE: Serial Port Name: " << devicePortName();
             xbeeFound = true;
-            startupCheck();
+            if(m_negotiateBaudRate) {
+                negotiateBaudRate(m_maxBaudRate, true);
+            }
+            synchronize();
             return true;
         }
     }
     else
     {
-        qDebug() << "XBEE: Serial Port" << m_serial->portName() << "could not be opened";
+        qDebug() << "XBEE: Serial Port" << devicePortName() << "could not be opened";
     }
 
     xbeeFound = false;
@@ -173,10 +287,16 @@ bool XBee::open()
  */
 bool XBee::close()
 {
-    if(m_serial) {
-        m_serial->close();
+    cancelCommandCheck();
+    m_recoveryTimer.stop();
+    m_associationTimer.stop();
+    m_recovering = false;
+    if(m_device) {
+        m_device->close();
     }
     xbeeFound = false;
+    failPending();
+    dropHeldData(true);
     return true;
 }
 
@@ -196,16 +316,8 @@ bool XBee::close()
 bool XBee::setSerialPort(const QString &serialPort)
 {
     bool bRet = false;
-    if(m_serial) {
-        m_serial->close();
-        m_serial->setPortName(serialPort);
-        m_serial->disconnect(this);
-        delete m_serial;
-        m_serial = NULL;
-    }
-    m_serial = new QSerialPort(serialPort, this);
-    connect(m_serial, SIGNAL(readyRead()), SLOT(readData()));
 
+    createDevice(serialPort);
     bRet = applyDefaultSerialPortConfig();
 
     return bRet;
@@ -243,11 +355,20 @@ bool XBee::setSerialPort(const QString &serialPort, const QSerialPort::BaudRate
  */
 bool XBee::setSerialPortConfiguration(const QSerialPort::BaudRate baudRate, const QSerialPort::DataBits dataBits, const QSerialPort::Parity parity, const QSerialPort::StopBits stopBits, const QSerialPort::FlowControl flowControl)
 {
-    if(m_serial == NULL) {
+    if(m_device == NULL) {
         qWarning() << Q_FUNC_INFO << "No serial port has been defined";
         return false;
     }
 
+#ifdef Q_OS_LINUX
+    if(m_transport) {
+        return  m_transport->setBaudRate(baudRate) &&
+                m_transport->setDataBits(dataBits) &&
+                m_transport->setParity(parity) &&
+                m_transport->setStopBits(stopBits) &&
+                m_transport->setFlowControl(flowControl);
+    }
+#endif
     return  m_serial->setBaudRate(baudRate) &&
             m_serial->setDataBits(dataBits) &&
             m_serial->setParity(parity) &&
@@ -270,866 +391,3100 @@ bool XBee::setSerialPortConfiguration(const QSerialPort::BaudRate baudRate, cons
  */
 bool XBee::applyDefaultSerialPortConfig()
 {
-    if(m_serial == NULL) {
+    if(m_device == NULL) {
         qWarning() << "Applying serial port configuration to NULL QSerialPort !";
         return false;
     }
 
-    return  m_serial->setBaudRate(QSerialPort::Baud9600) &&
-            m_serial->setDataBits(QSerialPort::Data8) &&
-            m_serial->setParity(QSerialPort::NoParity) &&
-            m_serial->setStopBits(QSerialPort::OneStop) &&
-            m_serial->setFlowControl(QSerialPort::NoFlowControl);
+    return  setSerialPortConfiguration(QSerialPort::Baud9600,
+                                       QSerialPort::Data8,
+                                       QSerialPort::NoParity,
+                                       QSerialPort::OneStop,
+                                       QSerialPort::NoFlowControl);
 }
 
-void XBee::displayATCommandResponse(ATCommandResponse *digiMeshPacket){
-    qDebug() << "*********************************************";
-    qDebug() << "Received ATCommandResponse: ";
-    qDebug() << qPrintable(digiMeshPacket->toString());
-    qDebug() << "*********************************************";
+/**
+ * @brief Selects the serial transport used to communicate with the XBee.
+ *
+ * XBee::LinuxTransport drives the tty directly through termios (non-blocking reads batched into the frame decoder,
+ * ASYNC_LOW_LATENCY and FTDI latency timer set to 1 ms) and is only available on Linux.
+ * If a serial port is already defined, it is closed and re-created with the new transport and the default configuration.
+ * @param transport
+ * @return true if succeeded; false if the transport isn't available on this platform.
+ * @sa XBee::transport()
+ */
+bool XBee::setTransport(const Transport transport)
+{
+#ifndef Q_OS_LINUX
+    if(transport == LinuxTransport) {
+        qWarning() << Q_FUNC_INFO << "The Linux transport is not available on this platform";
+        return false;
+    }
+#endif
+    if(transport == m_transportType) {
+        return true;
+    }
+    if(m_pollMode && transport != LinuxTransport) {
+        qWarning() << Q_FUNC_INFO << "Only the Linux transport can be driven in poll mode";
+        return false;
+    }
+
+    m_transportType = transport;
+    if(m_device) {
+        setSerialPort(devicePortName());
+    }
+    return true;
 }
-void XBee::displayModemStatus(ModemStatus *digiMeshPacket){
-    qDebug() << "Received ModemStatus: ";
-    qDebug() << qPrintable(digiMeshPacket->toString());
+
+/**
+ * @brief Returns the serial transport used to communicate with the XBee.
+ * @sa XBee::setTransport()
+ */
+XBee::Transport XBee::transport() const
+{
+    return m_transportType;
 }
-void XBee::displayTransmitStatus(ZBTxStatusResponse *digiMeshPacket){
-    qDebug() << "Received TransmitStatus: " << digiMeshPacket->packet().toHex();
+
+/**
+ * @brief Enables or disables the automatic recovery of the serial link (enabled by default).
+ *
+ * When the serial port fails (USB adapter unplugged or re-enumerated, brown out...), XBee::linkLost() is emitted
+ * and the port is re-opened with a jittered exponential backoff (100 ms up to 5 s).
+ * Once re-opened, the XBee is probed again, the configuration written through this object
+ * (XBee::setParameter(), XBee::applyProfile()) is re-applied if the same XBee answers (SH/SL),
+ * then the pending frames are handled according to the recovery policy and XBee::linkRecovered() is emitted.
+ *
+ * A ModemStatus HardwareReset or WatchdogTimerReset triggers the same resynchronization, without re-opening the port.
+ * @param enabled
+ * @sa XBee::setRecoveryPolicy()
+ */
+void XBee::setAutoRecovery(const bool enabled)
+{
+    m_autoRecovery = enabled;
+    if(!enabled && m_recovering) {
+        m_recoveryTimer.stop();
+        m_recovering = false;
+        failPending();
+    }
 }
-void XBee::displayRxIndicator(ZBRxResponse *digiMeshPacket){
-    qDebug() << "Received RxIndicator: " << digiMeshPacket->data().toHex();
+
+/**
+ * @brief Returns true if the automatic recovery of the serial link is enabled; false otherwise.
+ * @sa XBee::setAutoRecovery()
+ */
+bool XBee::autoRecovery() const
+{
+    return m_autoRecovery;
 }
-void XBee::displayRxIndicatorExplicit(ZBExplicitRxResponse *digiMeshPacket){
-    qDebug() << "Received RxIndicatorExplicit: " << digiMeshPacket->packet().toHex();
+
+/**
+ * @brief Sets what happens to the pending frames when the link is recovered (XBee::ReplayPending by default).
+ *
+ * Pending frames are the ones written but not answered yet (in-flight), and the ones sent with
+ * XBee::sendAsync() while the link was down (held).
+ * Frames sent with frame id 0 expect no response, so they are never in-flight.
+ * @param policy
+ * @sa XBee::frameFailed()
+ */
+void XBee::setRecoveryPolicy(const RecoveryPolicy policy)
+{
+    m_recoveryPolicy = policy;
 }
-void XBee::displayNodeIdentificationIndicator(ZBIONodeIdentificationResponse *digiMeshPacket){
-    qDebug() << "Received NodeIdentificationIndicator: " << digiMeshPacket->packet().toHex();
+
+/**
+ * @brief Returns what happens to the pending frames when the link is recovered.
+ * @sa XBee::setRecoveryPolicy()
+ */
+XBee::RecoveryPolicy XBee::recoveryPolicy() const
+{
+    return m_recoveryPolicy;
 }
-void XBee::displayRemoteCommandResponse(RemoteATCommandResponse *digiMeshPacket){
-    qDebug() << "*********************************************";
-    qDebug() << "Received RemoteCommandResponse: ";
-    qDebug() << qPrintable(digiMeshPacket->toString());
-    qDebug() << "*********************************************";
+
+/**
+ * @brief Returns true if the serial link is being recovered; false otherwise.
+ */
+bool XBee::isRecovering() const
+{
+    return m_recovering;
 }
 
 /**
- * @brief Sends asynchronously the given packet
- * @param packet the packet to send.
- * @note A signal (corresponding the given packet) will be emitted when a response is received.
+ * @brief Sets how long the response to a frame sent with XBee::sendAsync() is waited for (10 s by default).
  *
- * For example, if the given packet is an ATCommand, the XBee::receivedATCommandResponse() will be emitted.
+ * Once expired, the frame id is released and XBee::frameFailed() is emitted.
+ * @param msecs the timeout in milliseconds; 0 waits forever (the frame id is only released by the response).
  */
-void XBee::sendAsync(XBeePacket *packet)
+void XBee::setFrameTimeout(const int msecs)
 {
-    if(xbeeFound && m_serial->isOpen())
-    {
-        packet->setFrameId(m_frameIdCounter);
-        if(m_frameIdCounter >= 255)
-            m_frameIdCounter = 1;
-        else m_frameIdCounter++;
-        packet->assemblePacket();
-
-        qDebug() << Q_FUNC_INFO << "Transmit: " << QString("0x").append(packet->packet().toHex());
-        m_serial->write(packet->packet());
-        m_serial->flush();
-    }
-    else
-    {
-        qDebug() << "XBEE: Cannot write to Serial Port" << m_serial->portName();
+    m_frameTimeout = msecs;
+    m_frameTimer.stop();
+    if(msecs > 0 && !m_inFlight.isEmpty()) {
+        onFrameTimer();
     }
 }
 
 /**
- * @brief Sends asynchronously the given command in command mode
- *
- * To put the module in command mode, you need first to send '+++'
- * When a response is received, the signal rawDataReceived() will be emitted.
- * @see http://knowledge.digi.com/articles/Knowledge_Base_Article/The-AT-Command-Set
- * @param command the command to send
- * @return true if succeeded; false otherwise.
- * @note The XBee must be in XBee::CommandMode, @see XBee::setMode()
+ * @brief Returns how long the response to a frame is waited for, in milliseconds; 0 if forever.
+ * @sa XBee::setFrameTimeout()
  */
-bool XBee::sendCommandAsync(const QByteArray &command)
+int XBee::frameTimeout() const
 {
-    if(m_mode != CommandMode)
-        return false;
-    if(!xbeeFound)
-        return false;
-    if(!m_serial)
-        return false;
-    m_serial->write(command);
-    return true;
+    return m_frameTimeout;
 }
 
 /**
- * @brief Sends synchronously the given command using in command mode
- *
- * To put the module in command mode, you need first to send '+++'
- * @see http://knowledge.digi.com/articles/Knowledge_Base_Article/The-AT-Command-Set
- * @param command the command to send
- * @return the response (the read data from the serial port are appended until the last received character is <CR> (0x0D))
- * @note The XBee must be in XBee::CommandMode
- * @see XBee::setMode()
+ * @brief Returns the number of frames waiting for their response (in use frame ids).
  */
-QByteArray XBee::sendCommandSync(const QByteArray &command)
+int XBee::pendingFrameCount() const
 {
-    QByteArray rep;
-    if(m_mode == CommandMode && xbeeFound && m_serial)
-    {
-        m_serial->blockSignals(true);
-        m_serial->write(command);
-        m_serial->flush();
-        while(m_serial->waitForReadyRead(10))
-            rep.append(m_serial->readAll());
-
-        m_serial->blockSignals(false);
+    return m_frameIds.inUseCount();
+}
 
-        if(!rep.isEmpty()) {
-        if(rep.at(rep.size()-1) == 0x0D)
-            rep.remove(rep.size()-1, 1);
-        }
-    }
-    return rep;
+/**
+ * @brief Sets the filter selecting the received frames to deliver.
+ *
+ * Frames rejected by the filter are dropped before being decoded: no response object is built and no signal is emitted.
+ * Pending frames still get their transmit status and AT command responses are still handled, and a response
+ * to a frame in flight (e.g. a RemoteATCommandResponse) is always delivered, whatever its source address.
+ * @param filter an empty filter delivers every frame (default)
+ * @sa FrameFilter
+ */
+void XBee::setFrameFilter(const FrameFilter &filter)
+{
+    m_frameFilter = filter;
 }
 
 /**
- * @brief Sends synchronously the given packet
- * @param packet the packet to send.
- * @retval the associated XBeeResponse in case of success
- * @retval NULL if failed
- * @note XBee don't take the XBeeResponse's ownership, you have to.
+ * @brief Returns the filter selecting the received frames to deliver.
  */
-XBeeResponse * XBee::sendSync(XBeePacket *packet)
+FrameFilter XBee::frameFilter() const
 {
-    XBeeResponse * rep = NULL;
-    QByteArray repPacket;
-    QByteArray tmp;
+    return m_frameFilter;
+}
 
-    if(!xbeeFound) {
-        qWarning() << Q_FUNC_INFO << "No serial configured, can't send packet";
-        return NULL;
-    }
+/**
+ * @brief Returns the number of received frames dropped by the frame filter.
+ * @sa XBee::setFrameFilter()
+ */
+quint64 XBee::filteredFrameCount() const
+{
+    return m_filteredFrameCount;
+}
 
-    if(packet == NULL) {
-        qWarning() << Q_FUNC_INFO << "Invalid argument: null packet";
-        return NULL;
-    }
+/**
+ * @brief Publishes every received frame accepted by the frame filter to the given ring.
+ *
+ * The frames are published before being decoded and dispatched to the XBee's signals,
+ * and the ring's consumers are notified once per received batch.
+ * The ring isn't owned by the XBee.
+ * @code
+ * FrameRing * ring = new FrameRing(4096);
+ * xbee->setFrameRing(ring);
+ * logger->setConsumer(ring, ring->attach(FrameRing::DropOldest));
+ * alarms->setConsumer(ring, ring->attach(FrameRing::Block));
+ * @endcode
+ * @param ring NULL stops publishing
+ * @sa FrameRing
+ */
+void XBee::setFrameRing(FrameRing *ring)
+{
+    m_frameRing = ring;
+}
 
-    packet->setFrameId(m_frameIdCounter);
-    if(m_frameIdCounter >= 255)
-        m_frameIdCounter = 1;
-    else m_frameIdCounter++;
+/**
+ * @brief Returns the ring the received frames are published to; NULL if none.
+ * @sa XBee::setFrameRing()
+ */
+FrameRing *XBee::frameRing() const
+{
+    return m_frameRing;
+}
 
-    packet->assemblePacket();
+/**
+ * @brief Enables or disables the per frame signals for the frames sent by remote nodes.
+ *
+ * All the frames received during a read are delivered at once by XBee::receivedFrames(); the per frame signals
+ * (XBee::receivedRxResponse16(), XBee::receivedRxIndicator()...) are then emitted for each of them.
+ * Consumers only using XBee::receivedFrames() can disable the per frame signals, so that no response object is built.
+ * The local frames (AT command responses, modem status, transmit status) are always processed.
+ * @param enabled true by default
+ */
+void XBee::setFrameSignalsEnabled(const bool enabled)
+{
+    m_frameSignals = enabled;
+}
 
-    m_serial->blockSignals(true);
+/**
+ * @brief Returns true if the per frame signals are emitted for the frames sent by remote nodes; false otherwise.
+ * @sa XBee::setFrameSignalsEnabled()
+ */
+bool XBee::frameSignalsEnabled() const
+{
+    return m_frameSignals;
+}
 
-    m_serial->write(packet->packet());
-    m_serial->flush();
-    while(m_serial->waitForReadyRead(100)) {
-        tmp.append(m_serial->readAll());
+/**
+ * @brief Enables or disables the poll mode, in which the application runs its own loop instead of the Qt event loop.
+ *
+ * In poll mode, the application polls pollDescriptor() for pollEvents() and wakeDescriptor() for POLLIN along with
+ * its other file descriptors, with nextTimeout() as timeout, then calls pump(): the received frames are read, decoded
+ * and dispatched, the pending frames are written and the expired timeouts are processed, without blocking.
+ * @code
+ * xbee->setTransport(XBee::LinuxTransport);
+ * xbee->setPollMode(true);
+ * xbee->setSerialPort("ttyUSB0");
+ * forever {
+ *     struct pollfd fds[3] = {{xbee->pollDescriptor(), xbee->pollEvents(), 0},
+ *                             {xbee->wakeDescriptor(), POLLIN, 0},
+ *                             {socket, POLLIN, 0}};
+ *     ::poll(fds, 3, xbee->nextTimeout());
+ *     xbee->pump();
+ *     ...
+ * }
+ * @endcode
+ * The signals are emitted from pump(), the synchronous methods can still be called.
+ * A QCoreApplication must exist, but doesn't need to run.
+ * Only XBee::LinuxTransport can be driven this way, its socket notifiers are disabled: QSerialPort re-enables its own
+ * on every read.
+ * Frames posted from other threads (XBee::post()) make wakeDescriptor() readable, and are sent on the next pump().
+ * @param enabled false by default
+ * @return true if succeeded; false if the transport isn't XBee::LinuxTransport.
+ */
+bool XBee::setPollMode(const bool enabled)
+{
+#ifdef Q_OS_LINUX
+    if(enabled == m_pollMode) {
+        return true;
     }
-
-    while(!tmp.isEmpty() && (unsigned char)tmp.at(0) != (unsigned char)XBeePacket::StartDelimiter) {
-        tmp.remove(0, 1);
+    if(enabled && m_transportType != LinuxTransport) {
+        qWarning() << Q_FUNC_INFO << "Only the Linux transport can be driven in poll mode";
+        return false;
     }
 
-    repPacket = tmp;
-
-    m_serial->blockSignals(false);
-
-    if(repPacket.size() > 0) {
-        rep = processPacket(repPacket, false);
-        if(!rep) {
-            qDebug() << Q_FUNC_INFO << "Failed to process received response !";
-        }
+    if(enabled) {
+        m_wakeFd.storeRelease(::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC));
     }
     else {
-        qDebug() << Q_FUNC_INFO << "no response to";
-        qDebug() << qPrintable(packet->toString());
+        const int fd = m_wakeFd.fetchAndStoreOrdered(-1);
+        if(fd >= 0) {
+            ::close(fd);
+        }
     }
-    return rep;
+    m_pollMode = enabled;
+    if(m_transport) {
+        m_transport->setNotifiersEnabled(!enabled);
+    }
+    return true;
+#else
+    if(enabled) {
+        qWarning() << Q_FUNC_INFO << "The poll mode is only available on Linux";
+        return false;
+    }
+    return true;
+#endif
 }
 
 /**
- * @brief Sends an ATCommand asynchronously
- *
- * The XBee::receivedATCommandResponse() signal will be emmited when a response to the sent ATCommand is received.
- * @param command
+ * @brief Returns true if the application drives the XBee with pump(); false if the Qt event loop does.
+ * @sa XBee::setPollMode()
  */
-void XBee::sendATCommandAsync(ATCommand *command)
+bool XBee::isPollMode() const
 {
-    sendAsync(command);
+    return m_pollMode;
 }
 
 /**
- * @brief Sends an ATCommand asynchronously
- *
- * The XBee::receivedATCommandResponse() signal will be emmited when a response to the sent ATCommand is received.
- * @param command
- * @note This method is not implemented yet
- * @todo Implement this method
+ * @brief Returns the file descriptor to poll; -1 if the serial port isn't open or not on Linux.
+ * @sa XBee::setPollMode()
  */
-void XBee::sendATCommandAsync(const QByteArray &data)
+int XBee::pollDescriptor() const
 {
-    Q_UNUSED(data);
+    if(!m_device || !m_device->isOpen()) {
+        return -1;
+    }
+#ifdef Q_OS_LINUX
+    if(m_transport) {
+        return m_transport->handle();
+    }
+#endif
+    return -1;
 }
 
-
 /**
- * @brief Sends an ATCommand synchronously
- * @param command
- * @return the corresponding ATCommandResponse; or null.
- * @note XBee don't take the ATCommandResponse's ownership, you have to.
+ * @brief Returns the file descriptor readable when frames are posted from other threads; -1 if not in poll mode.
+ *
+ * pollDescriptor() alone doesn't wake up the application's poll() when XBee::post() is called, this one does.
+ * It's reset by pump().
+ * @sa XBee::setPollMode()
  */
-ATCommandResponse * XBee::sendATCommandSync(ATCommand *command)
+int XBee::wakeDescriptor() const
 {
-    Q_ASSERT(command);
-    ATCommandResponse * rep = NULL;
-    QByteArray repPacket;
-    QByteArray tmp;
+    return m_wakeFd.loadAcquire();
+}
 
-    if(!xbeeFound) {
-        qWarning() << Q_FUNC_INFO << "No serial configured, can't send packet";
-        return NULL;
+/**
+ * @brief Returns the poll events to wait for on pollDescriptor(): POLLIN, and POLLOUT while bytes are waiting to be written.
+ * @sa XBee::setPollMode()
+ */
+short XBee::pollEvents() const
+{
+#ifdef Q_OS_UNIX
+    if(m_device && m_device->bytesToWrite() > 0) {
+        return POLLIN | POLLOUT;
     }
+    return POLLIN;
+#else
+    return 0;
+#endif
+}
 
-    if(command == NULL) {
-        qWarning() << Q_FUNC_INFO << "Invalid argument: null packet";
-        return NULL;
+/**
+ * @brief Processes everything pending without blocking: expired timeouts, received data, deferred work and writes.
+ * @return true if succeeded; false if the serial port isn't open.
+ * @sa XBee::setPollMode()
+ */
+bool XBee::pump()
+{
+#ifdef Q_OS_LINUX
+    const int wakeFd = m_wakeFd.loadAcquire();
+    if(wakeFd >= 0) {
+        quint64 count = 0;
+        if(::read(wakeFd, &count, sizeof(count)) < 0 && errno != EAGAIN) {
+            qWarning() << Q_FUNC_INFO << "Failed to reset the wake up descriptor:" << strerror(errno);
+        }
     }
+#endif
+    TimerWheel::instance()->processTimers();
 
-    command->setFrameId(m_frameIdCounter);
-    if(m_frameIdCounter >= 255)
-        m_frameIdCounter = 1;
-    else m_frameIdCounter++;
-
-    command->assemblePacket();
-
-    m_serial->blockSignals(true);
-
-    m_serial->write(command->packet());
-    m_serial->flush();
-    while(m_serial->waitForReadyRead(100)) {
-        tmp.append(m_serial->readAll());
+    if(!m_submissions.isEmpty()) {
+        drainSubmissions();
     }
 
-    while(!tmp.isEmpty() && (unsigned char)tmp.at(0) != (unsigned char)XBeePacket::StartDelimiter) {
-        tmp.remove(0, 1);
+    if(!m_device || !m_device->isOpen()) {
+        m_queuedCalls.storeRelease(0);
+        QCoreApplication::sendPostedEvents(this, QEvent::MetaCall);
+        return false;
     }
 
-    repPacket = tmp;
+    // Emits readyRead(), so that the data is decoded and dispatched by readData()
+    m_device->waitForReadyRead(0);
 
-    m_serial->blockSignals(false);
-
-    if(repPacket.size() > 0) {
-        rep = new ATCommandResponse();
-        rep->setPacket(repPacket);
+    // What the event loop would have run: queued calls (window, resync) and the received responses' deleteLater()
+    m_queuedCalls.storeRelease(0);
+    QCoreApplication::sendPostedEvents(this, QEvent::MetaCall);
+    if(m_device->bytesToWrite() > 0) {
+        m_device->waitForBytesWritten(0);
     }
-    else {
-        qDebug() << Q_FUNC_INFO << "no response to";
-        qDebug() << qPrintable(command->toString());
-    }
-    return rep;
+    // The transport's deferred bytesWritten(), which writes the next queued frames
+    QCoreApplication::sendPostedEvents(m_device, QEvent::MetaCall);
+    QCoreApplication::sendPostedEvents(NULL, QEvent::DeferredDelete);
+    return true;
 }
 
 /**
- * @brief Sends an ATCommand synchronously
- * @param atcommand
- * @return the corresponding ATCommandResponse; or null.
- * @note XBee don't take the ATCommandResponse's ownership, you have to.
+ * @brief Returns the time after which pump() must be called even if pollDescriptor() isn't ready, in milliseconds;
+ * -1 if none.
+ *
+ * It covers all the timeouts of the current thread (frame responses, transmit pacing, command mode, recovery...),
+ * and is 0 while posted frames or queued calls (e.g. the next write once a transmit status freed the window) are pending.
+ * @sa XBee::setPollMode()
  */
-ATCommandResponse * XBee::sendATCommandSync(const QByteArray &atcommand)
+int XBee::nextTimeout() const
 {
-    ATCommandResponse * rep = NULL;
-    if(atcommand.size() >= 2)
-    {
-        ATCommand at;
-        at.setCommand(atcommand.mid(0, 2));
-        if(atcommand.size() > 2) {
-            at.setParameter(atcommand.mid(2, atcommand.size()-2));
-        }
-        rep = sendATCommandSync(&at);
+    if(!m_submissions.isEmpty() || m_queuedCalls.loadAcquire() > 0) {
+        return 0;
     }
-    else {
-        qWarning() << Q_FUNC_INFO << "bad command" << atcommand;
+    return TimerWheel::instance()->nextTimeout();
+}
+
+/**
+ * @brief Queues a call to the given slot, counted so that nextTimeout() doesn't let the application sleep on it.
+ */
+void XBee::queueCall(const char *method)
+{
+    if(m_pollMode) {
+        m_queuedCalls.ref();
     }
-    return rep;
+    QMetaObject::invokeMethod(this, method, Qt::QueuedConnection);
 }
 
 /**
- * @brief Loads the XBee's addressing properties
- * - DH
- * - DL
- * - MY
- * - MP
- * - NC
- * - SH
- * - SL
- * - NI
- * - SE
- * - DE
- * - CI
- * - TO
- * - NP
- * - DD
- * - CR
+ * @brief Returns the number of frames queued by XBee::sendAsync() and not written yet.
  */
-void XBee::loadAddressingProperties() {
-    ATCommand at;
-    at.setCommand(ATCommand::ATDH); sendATCommandAsync(&at);
-    at.setCommand(ATCommand::ATDL); sendATCommandAsync(&at);
-    at.setCommand(ATCommand::ATMY); sendATCommandAsync(&at);
-    at.setCommand(ATCommand::ATMP); sendATCommandAsync(&at);
-    at.setCommand(ATCommand::ATNC); sendATCommandAsync(&at);
-    at.setCommand(ATCommand::ATSH); sendATCommandAsync(&at);
-    at.setCommand(ATCommand::ATSL); sendATCommandAsync(&at);
-    at.setCommand(ATCommand::ATNI); sendATCommandAsync(&at);
-    at.setCommand(ATCommand::ATSE); sendATCommandAsync(&at);
-    at.setCommand(ATCommand::ATDE); sendATCommandAsync(&at);
-    at.setCommand(ATCommand::ATCI); sendATCommandAsync(&at);
-    at.setCommand(ATCommand::ATTO); sendATCommandAsync(&at);
-    at.setCommand(ATCommand::ATNP); sendATCommandAsync(&at);
-    at.setCommand(ATCommand::ATDD); sendATCommandAsync(&at);
-    at.setCommand(ATCommand::ATCR); sendATCommandAsync(&at);
+int XBee::queuedFrameCount() const
+{
+    int count = m_txQueue.size();
+
+    foreach(const QByteArray & destination, m_activeDestinations) {
+        count += m_destinations.value(destination).frames.size();
+    }
+    return count;
 }
 
-// Adressing
-bool XBee::setDH(const quint32 dh) {
-    ATCommand at;
-    at.setCommand(ATCommand::ATDH);
-    at.setParameter(QByteArray::number(dh));
-    sendATCommandAsync(&at);
-    return true;
+/**
+ * @brief Sets the maximum number of data frames written and waiting for their transmit status (4 by default).
+ *
+ * Further data frames stay queued, where their deadline is still checked, instead of waiting in the XBee's buffer.
+ * Frames sent with XBee::NoStatus don't get a transmit status, so they are only paced by the UART.
+ * @param frames the window size; 0 for no limit
+ */
+void XBee::setTransmitWindow(const int frames)
+{
+    m_transmitWindow = frames;
+    writeQueuedFrames();
 }
 
-bool XBee::setDL(const quint32 dl) {
-    ATCommand at;
-    at.setCommand(ATCommand::ATDL);
-    at.setParameter(QByteArray::number(dl));
-    sendATCommandAsync(&at);
-    return true;
+/**
+ * @brief Returns the maximum number of data frames written and waiting for their transmit status; 0 if unlimited.
+ * @sa XBee::setTransmitWindow()
+ */
+int XBee::transmitWindow() const
+{
+    return m_transmitWindow;
 }
 
-bool XBee::setMY(const quint16 my) {
-    ATCommand at;
-    at.setCommand(ATCommand::ATMY);
-    at.setParameter(QByteArray::number(my));
-    sendATCommandAsync(&at);
-    return true;
+/**
+ * @brief Returns the XBee's association state.
+ *
+ * The state is updated by the ModemStatus frames (Associated, Disassociated, CoordinatorStarted, SynchronizationLost)
+ * and by periodic ATAI polls.
+ * @sa XBee::setAssociationPollInterval()
+ * @sa XBee::associationChanged()
+ */
+XBee::AssociationState XBee::associationState() const
+{
+    return m_association;
 }
 
-bool XBee::setMP(const quint16 mp) {
-    ATCommand at;
-    at.setCommand(ATCommand::ATMP);
-    at.setParameter(QByteArray::number(mp));
-    sendATCommandAsync(&at);
-    return true;
+/**
+ * @brief Sets the ATAI poll interval (10 s by default).
+ *
+ * The polling starts once the XBee answered (see XBee::open()) and stops when it's closed.
+ * @param msecs the interval in milliseconds; 0 disables the polling (ModemStatus frames are still handled).
+ */
+void XBee::setAssociationPollInterval(const int msecs)
+{
+    m_associationPollInterval = qMax(0, msecs);
+    if(m_associationPollInterval == 0) {
+        m_associationTimer.stop();
+    }
+    else if(xbeeFound) {
+        m_associationTimer.start(m_associationPollInterval);
+    }
 }
 
-bool XBee::setNC(const quint32 nc) {
-    ATCommand at;
-    at.setCommand(ATCommand::ATNC);
-    at.setParameter(QByteArray::number(nc));
-    sendATCommandAsync(&at);
-    return true;
+/**
+ * @brief Returns the ATAI poll interval, in milliseconds; 0 if disabled.
+ */
+int XBee::associationPollInterval() const
+{
+    return m_associationPollInterval;
 }
 
-bool XBee::setSH(const quint32 sh) {
-    ATCommand at;
-    at.setCommand(ATCommand::ATSH);
-    at.setParameter(QByteArray::number(sh));
-    sendATCommandAsync(&at);
-    return true;
+/**
+ * @brief Sets how long data frames are held while the XBee is disassociated (30 s by default).
+ *
+ * Data frames (TxRequest16, TxRequest64, ZBTxRequest, ZBExplicitTxRequest) sent with XBee::sendAsync() while the XBee
+ * is disassociated are held, then sent in order as soon as it is associated again.
+ * Frames held for longer than @a msecs are dropped and reported with XBee::frameFailed().
+ * Other frames (AT commands...) are never held.
+ * @param msecs the timeout in milliseconds; -1 holds the frames forever, 0 disables the holding (frames are always sent).
+ */
+void XBee::setAssociationHoldTimeout(const int msecs)
+{
+    m_associationHoldTimeout = msecs;
+    if(msecs == 0) {
+        releaseHeldData();
+    }
 }
 
-bool XBee::setSL(const quint32 sl) {
-    ATCommand at;
-    at.setCommand(ATCommand::ATSL);
-    at.setParameter(QByteArray::number(sl));
-    sendATCommandAsync(&at);
-    return true;
+/**
+ * @brief Returns how long data frames are held while the XBee is disassociated, in milliseconds.
+ * @sa XBee::setAssociationHoldTimeout()
+ */
+int XBee::associationHoldTimeout() const
+{
+    return m_associationHoldTimeout;
 }
 
-bool XBee::setNI(const QString & ni) {
-    ATCommand at;
-    at.setCommand(ATCommand::ATNI);
-    at.setParameter(ni.toUtf8());
-    sendATCommandAsync(&at);
-    return true;
+/**
+ * @brief Enables or disables the baud rate negotiation done by XBee::open().
+ *
+ * When enabled, open() probes the XBee's current baud rate, then raises it to the fastest rate
+ * supported by both the XBee and the host (up to @a maximum) and saves it (WR).
+ * @param enabled
+ * @param maximum the maximum baud rate to negotiate
+ * @sa XBee::negotiateBaudRate()
+ */
+void XBee::setBaudRateNegotiation(const bool enabled, const qint32 maximum)
+{
+    m_negotiateBaudRate = enabled;
+    m_maxBaudRate = maximum;
 }
 
-bool XBee::setSE(const quint8 se) {
-    ATCommand at;
-    at.setCommand(ATCommand::ATSE);
-    at.setParameter(QByteArray::number(se));
-    sendATCommandAsync(&at);
-    return true;
+/**
+ * @brief Looks for the baud rate the XBee currently uses.
+ *
+ * The currently configured baud rate is tried first, then all the rates supported by the XBee.
+ * For each one, a single ATAP frame is sent and the method stops at the first answered one
+ * (the API mode is updated from the response, see XBee::setMode()).
+ * The serial port is left configured to the found baud rate; or to its original baud rate if the probe failed.
+ * @return the found baud rate; or -1 if the XBee doesn't answer.
+ * @note The XBee must be in API mode
+ */
+qint32 XBee::probeBaudRate()
+{
+    if(!xbeeFound || !m_device) {
+        qWarning() << Q_FUNC_INFO << "Serial port not opened";
+        return -1;
+    }
+
+    const qint32 original = deviceBaudRate();
+    QList<qint32> candidates;
+    candidates << original;
+    if(original != QSerialPort::Baud9600) {
+        // The XBee's factory rate
+        candidates << QSerialPort::Baud9600;
+    }
+    for(int i=XBeeBaudRatesCount-1; i>=0; i--) {
+        if(!candidates.contains(XBeeBaudRates[i])) {
+            candidates << XBeeBaudRates[i];
+        }
+    }
+
+    foreach(const qint32 rate, candidates) {
+        if(!setDeviceBaudRate(rate)) {
+            continue;
+        }
+        clearDevice();
+        m_decoder.clear();
+
+        // Long enough for a 10 bytes response at the lowest rates
+        if(probeApiMode(rate >= QSerialPort::Baud9600 ? 50 : 250)) {
+            qDebug() << Q_FUNC_INFO << "XBee answers at" << rate << "bauds";
+            return rate;
+        }
+    }
+
+    qWarning() << Q_FUNC_INFO << "XBee doesn't answer, keeping" << original << "bauds";
+    setDeviceBaudRate(original);
+    clearDevice();
+    m_decoder.clear();
+    return -1;
 }
 
-bool XBee::setDE(const quint8 de) {
-    ATCommand at;
-    at.setCommand(ATCommand::ATDE);
-    at.setParameter(QByteArray::number(de));
-    sendATCommandAsync(&at);
+/**
+ * @brief Raises the XBee's baud rate to the fastest rate supported by both the XBee and the host.
+ *
+ * The current rate is probed (see XBee::probeBaudRate()), then ATBD and AC are sent, the serial port
+ * is reconfigured and the new rate is verified. If the verification fails, the XBee's rate is probed again
+ * so the serial port always ends up configured to the rate the XBee really uses.
+ * @param maximum the maximum baud rate to use
+ * @param persist if true, the new baud rate is saved in the XBee's non-volatile memory (WR)
+ * @return true if the XBee uses the fastest rate; false otherwise.
+ * @note The XBee must be in API mode
+ */
+bool XBee::negotiateBaudRate(const qint32 maximum, const bool persist)
+{
+    const QList<qint32> hostRates = QSerialPortInfo::standardBaudRates();
+    const qint32 current = probeBaudRate();
+    int code = -1;
+    bool bRet = false;
+
+    if(current < 0) {
+        return false;
+    }
+
+    for(int i=XBeeBaudRatesCount-1; i>=0 && code<0; i--) {
+        if(XBeeBaudRates[i] <= maximum && (hostRates.isEmpty() || hostRates.contains(XBeeBaudRates[i]))) {
+            code = i;
+        }
+    }
+    if(code < 0 || XBeeBaudRates[code] <= current) {
+        return code >= 0 && XBeeBaudRates[code] == current;
+    }
+
+    // Ask the XBee to switch, the responses are sent at the current rate
+    QList<ATCommand*> commands;
+    QList<ATCommandResponse*> reps;
+    QByteArray value;
+    ATCommand bd;
+    ATCommand ac;
+    ATParameter::find(ATCommand::ATBD)->encode(code, &value);
+    bd.setCommand(ATCommand::ATBD);
+    bd.setParameter(value);
+    ac.setCommand(ATCommand::ATAC);
+    commands << &bd << &ac;
+    reps = sendATCommandsSync(commands, 250);
+    bRet = reps.size() == 2 && reps.at(0) && reps.at(0)->status() == ATCommandResponse::Ok && reps.at(1);
+    qDeleteAll(reps);
+
+    if(!bRet) {
+        qWarning() << Q_FUNC_INFO << "XBee refused baud rate" << XBeeBaudRates[code];
+        return false;
+    }
+
+    // Follow it and check it answers
+    setDeviceBaudRate(XBeeBaudRates[code]);
+    clearDevice();
+    m_decoder.clear();
+    bRet = false;
+    for(int i=0; i<3 && !bRet; i++) {
+        bRet = probeApiMode(50);
+    }
+
+    if(!bRet) {
+        qWarning() << Q_FUNC_INFO << "No response at" << XBeeBaudRates[code] << "bauds, probing again";
+        probeBaudRate();
+        return false;
+    }
+
+    qDebug() << Q_FUNC_INFO << "Baud rate raised from" << current << "to" << XBeeBaudRates[code];
+    if(persist) {
+        ATCommandResponse * rep = probeATCommand(ATCommand::ATWR, 250);
+        if(!rep || rep->status() != ATCommandResponse::Ok) {
+            qWarning() << Q_FUNC_INFO << "Failed to save the baud rate";
+        }
+        delete rep;
+    }
     return true;
 }
 
-bool XBee::setCI(const quint8 ci) {
-    ATCommand at;
-    at.setCommand(ATCommand::ATCI);
-    at.setParameter(QByteArray::number(ci));
-    sendATCommandAsync(&at);
-    return true;
+void XBee::displayATCommandResponse(ATCommandResponse *digiMeshPacket){
+    qDebug() << "*********************************************";
+    qDebug() << "Received ATCommandResponse: ";
+    qDebug() << qPrintable(digiMeshPacket->toString());
+    qDebug() << "*********************************************";
+}
+void XBee::displayModemStatus(ModemStatus *digiMeshPacket){
+    qDebug() << "Received ModemStatus: ";
+    qDebug() << qPrintable(digiMeshPacket->toString());
+}
+void XBee::displayTransmitStatus(ZBTxStatusResponse *digiMeshPacket){
+    qDebug() << "Received TransmitStatus: " << digiMeshPacket->packet().toHex();
+}
+void XBee::displayRxIndicator(ZBRxResponse *digiMeshPacket){
+    qDebug() << "Received RxIndicator: " << digiMeshPacket->data().toHex();
+}
+void XBee::displayRxIndicatorExplicit(ZBExplicitRxResponse *digiMeshPacket){
+    qDebug() << "Received RxIndicatorExplicit: " << digiMeshPacket->packet().toHex();
+}
+void XBee::displayNodeIdentificationIndicator(ZBIONodeIdentificationResponse *digiMeshPacket){
+    qDebug() << "Received NodeIdentificationIndicator: " << digiMeshPacket->packet().toHex();
+}
+void XBee::displayRemoteCommandResponse(RemoteATCommandResponse *digiMeshPacket){
+    qDebug() << "*********************************************";
+    qDebug() << "Received RemoteCommandResponse: ";
+    qDebug() << qPrintable(digiMeshPacket->toString());
+    qDebug() << "*********************************************";
 }
 
-bool XBee::setTO(const quint8 to) {
-    ATCommand at;
-    at.setCommand(ATCommand::ATTO);
-    at.setParameter(QByteArray::number(to));
-    sendATCommandAsync(&at);
-    return true;
+/**
+ * @brief Sends asynchronously the given packet
+ * @param packet the packet to send.
+ * @param mode with XBee::NoStatus, the packet is sent with frame id 0 and the XBee doesn't answer
+ * (no transmit status, no AT command response), which saves UART bandwidth for unacknowledged telemetry.
+ * @note A signal (corresponding the given packet) will be emitted when a response is received.
+ *
+ * For example, if the given packet is an ATCommand, the XBee::receivedATCommandResponse() will be emitted.
+ *
+ * The packet's frame id stays reserved until its response is received or the frame timeout expires
+ * (see XBee::setFrameTimeout()), so that a response can't be attributed to another packet.
+ * @return true if the packet has been written (or held); false otherwise, in particular if the 255 frame ids
+ * are waiting for their response.
+ */
+bool XBee::sendAsync(XBeePacket *packet, const StatusMode mode)
+{
+    return sendAsync(packet, -1, QByteArray(), mode);
 }
 
-bool XBee::setNP(const quint8 np) {
-    ATCommand at;
-    at.setCommand(ATCommand::ATNP);
-    at.setParameter(QByteArray::number(np));
-    sendATCommandAsync(&at);
-    return true;
+/**
+ * @brief Sends asynchronously the given packet, which is dropped if it can't be written before its deadline.
+ *
+ * Packets are queued, then written to the serial port at the pace the UART and the XBee can handle
+ * (see XBee::setTransmitWindow()); a packet still queued after @a lifetime milliseconds is dropped
+ * before reaching the UART and reported with XBee::frameFailed().
+ *
+ * If @a supersedeKey is not empty, a queued packet with the same key is replaced by this one,
+ * which takes its place in the queue (and its frame id is released, reported with XBee::frameFailed()).
+ * @code
+ * // Only the latest poll matters
+ * xbee->sendAsync(&request, 1000, "poll sensor 2");
+ * @endcode
+ * @param packet the packet to send.
+ * @param lifetime the time the packet may stay queued, in milliseconds; -1 for no deadline
+ * @param supersedeKey the key identifying the packets this one replaces; empty for none
+ * @param mode see XBee::sendAsync(XBeePacket *packet, const StatusMode mode)
+ * @return true if the packet has been queued; false otherwise.
+ */
+bool XBee::sendAsync(XBeePacket *packet, const int lifetime, const QByteArray &supersedeKey, const StatusMode mode)
+{
+    if(QThread::currentThread() != thread()) {
+        return post(packet, lifetime, supersedeKey, mode) != 0;
+    }
+
+    if((xbeeFound && m_device && m_device->isOpen()) || m_recovering)
+    {
+        const quint8 frameId = mode == NoStatus ? 0 : nextFrameId();
+        if(mode != NoStatus && frameId == 0) {
+            return false;
+        }
+        packet->setFrameId(frameId);
+        packet->assemblePacket();
+        return queueFrame(frameId, packet->packet(), lifetime, supersedeKey);
+    }
+
+    qDebug() << "XBEE: Cannot write to Serial Port" << (m_device ? devicePortName() : QString());
+    return false;
 }
 
-bool XBee::setDD(const quint16 dd) {
-    ATCommand at;
-    at.setCommand(ATCommand::ATDD);
-    at.setParameter(QByteArray::number(dd));
-    sendATCommandAsync(&at);
-    return true;
+/**
+ * @brief Sends asynchronously the request cached by the given template.
+ *
+ * Only the frame id and the checksum of the cached frame are updated, the request isn't assembled again.
+ * @code
+ * TxRequest16 request;
+ * request.setDestinationAddress(2);
+ * request.setData("temp");
+ * FrameTemplate poll(&request);
+ * ...
+ * xbee->sendAsync(&poll, 1000, "poll sensor 2");
+ * @endcode
+ * @param frameTemplate the template to send; its frame id is updated
+ * @param lifetime see XBee::sendAsync(XBeePacket *packet, const int lifetime, const QByteArray &supersedeKey, const StatusMode mode)
+ * @param supersedeKey see XBee::sendAsync(XBeePacket *packet, const int lifetime, const QByteArray &supersedeKey, const StatusMode mode)
+ * @param mode see XBee::sendAsync(XBeePacket *packet, const StatusMode mode)
+ * @return true if the frame has been queued; false otherwise.
+ */
+bool XBee::sendAsync(FrameTemplate *frameTemplate, const int lifetime, const QByteArray &supersedeKey, const StatusMode mode)
+{
+    Q_ASSERT(frameTemplate);
+
+    if(!frameTemplate->isValid()) {
+        qWarning() << Q_FUNC_INFO << "Invalid frame template";
+        return false;
+    }
+
+    if(QThread::currentThread() != thread()) {
+        return post(*frameTemplate, lifetime, supersedeKey, mode) != 0;
+    }
+
+    if((xbeeFound && m_device && m_device->isOpen()) || m_recovering)
+    {
+        const quint8 frameId = mode == NoStatus ? 0 : nextFrameId();
+        if(mode != NoStatus && frameId == 0) {
+            return false;
+        }
+        frameTemplate->setFrameId(frameId);
+        return queueFrame(frameId, frameTemplate->frame(), lifetime, supersedeKey);
+    }
+
+    qDebug() << "XBEE: Cannot write to Serial Port" << (m_device ? devicePortName() : QString());
+    return false;
 }
 
-bool XBee::setCR(const quint8 cr) {
-    ATCommand at;
-    at.setCommand(ATCommand::ATCR);
-    at.setParameter(QByteArray::number(cr));
-    sendATCommandAsync(&at);
-    return true;
+/**
+ * @brief Posts the given packet to be sent asynchronously; may be called from any thread.
+ *
+ * The packet is assembled in the calling thread, then handed to the XBee's thread through a lock-free queue:
+ * the caller never blocks, neither on the serial port nor on a lock. The XBee's thread allocates the frame id
+ * and queues the frame as XBee::sendAsync() does.
+ *
+ * XBee::sendAsync() posts by itself when called from another thread; XBee::sendSync() and the other
+ * synchronous methods must still be called from the XBee's thread.
+ * The outcome is reported by XBee::sendCompleted() with the returned ticket; connected from the calling thread,
+ * the signal is delivered in that thread.
+ * @code
+ * // In a worker thread
+ * connect(xbee, SIGNAL(sendCompleted(quint32,bool)), this, SLOT(onSendCompleted(quint32,bool)));
+ * const quint32 ticket = xbee->post(&request);
+ * @endcode
+ * @param packet the packet to send; it's only used during the call
+ * @param lifetime see XBee::sendAsync(XBeePacket *packet, const int lifetime, const QByteArray &supersedeKey, const StatusMode mode)
+ * @param supersedeKey see XBee::sendAsync(XBeePacket *packet, const int lifetime, const QByteArray &supersedeKey, const StatusMode mode)
+ * @param mode see XBee::sendAsync(XBeePacket *packet, const StatusMode mode)
+ * @return the ticket identifying the frame in XBee::sendCompleted(); 0 if the packet isn't a request.
+ */
+quint32 XBee::post(XBeePacket *packet, const int lifetime, const QByteArray &supersedeKey, const StatusMode mode)
+{
+    Q_ASSERT(packet);
+
+    const FrameTemplate frameTemplate(packet);
+    if(!frameTemplate.isValid()) {
+        return 0;
+    }
+    return post(frameTemplate, lifetime, supersedeKey, mode);
 }
 
 /**
- * @brief Sets the XBee's mode
- * @param mode
+ * @brief Posts the request cached by the given template to be sent asynchronously; may be called from any thread.
+ * @param frameTemplate the template to send; it's copied, so the caller can reuse it right away
+ * @param lifetime see XBee::sendAsync(XBeePacket *packet, const int lifetime, const QByteArray &supersedeKey, const StatusMode mode)
+ * @param supersedeKey see XBee::sendAsync(XBeePacket *packet, const int lifetime, const QByteArray &supersedeKey, const StatusMode mode)
+ * @param mode see XBee::sendAsync(XBeePacket *packet, const StatusMode mode)
+ * @return the ticket identifying the frame in XBee::sendCompleted(); 0 if the template is invalid.
+ * @sa XBee::post(XBeePacket *packet, const int lifetime, const QByteArray &supersedeKey, const StatusMode mode)
+ */
+quint32 XBee::post(const FrameTemplate &frameTemplate, const int lifetime, const QByteArray &supersedeKey, const StatusMode mode)
+{
+    if(!frameTemplate.isValid()) {
+        return 0;
+    }
+    return submit(frameTemplate, lifetime, supersedeKey, mode, QByteArray());
+}
+
+/**
+ * @brief Hands the given frame to the XBee's thread, see XBee::post().
+ * @param write the parameter value written by an AT command frame, recorded as a pending write
+ * once the XBee's thread allocated the frame id; empty for other frames
+ */
+quint32 XBee::submit(const FrameTemplate &frameTemplate, const int lifetime, const QByteArray &supersedeKey, const StatusMode mode, const QByteArray &write)
+{
+    Submission submission;
+
+    submission.ticket = m_nextTicket.fetchAndAddOrdered(1) + 1;
+    if(submission.ticket == 0) {
+        // Wrapped around, 0 means no ticket
+        submission.ticket = m_nextTicket.fetchAndAddOrdered(1) + 1;
+    }
+    submission.frame = frameTemplate;
+    submission.lifetime = lifetime;
+    submission.key = supersedeKey;
+    submission.mode = mode;
+    submission.posted = monotonicTime();
+    submission.write = write;
+    m_submissions.push(submission);
+
+    // One wake up for all the frames posted until the XBee's thread drains them
+    if(m_drainScheduled.testAndSetOrdered(0, 1)) {
+        queueCall("drainSubmissions");
+#ifdef Q_OS_LINUX
+        const int wakeFd = m_wakeFd.loadAcquire();
+        const quint64 one = 1;
+        if(wakeFd >= 0 && ::write(wakeFd, &one, sizeof(one)) < 0 && errno != EAGAIN) {
+            qWarning() << Q_FUNC_INFO << "Failed to wake up the poll loop:" << strerror(errno);
+        }
+#endif
+    }
+    return submission.ticket;
+}
+
+/**
+ * @brief Sends asynchronously the given command in command mode
+ *
+ * To put the module in command mode, you need first to send '+++'
+ * When a response is received, the signal rawDataReceived() will be emitted.
+ * @note XBee::commandModeEngine() handles the guard times and the responses parsing.
+ * @see http://knowledge.digi.com/articles/Knowledge_Base_Article/The-AT-Command-Set
+ * @param command the command to send
  * @return true if succeeded; false otherwise.
- * @todo Set the mode into the XBee, not only the class attribute
- * @sa XBee::Mode
- * @sa XBee::mode()
+ * @note The XBee must be in XBee::CommandMode, @see XBee::setMode()
  */
-bool XBee::setMode(const Mode mode)
+bool XBee::sendCommandAsync(const QByteArray &command)
 {
-    m_mode = mode;
-    buffer.clear();
+    if(m_mode != CommandMode)
+        return false;
+    if(!xbeeFound)
+        return false;
+    if(!m_device)
+        return false;
+    m_device->write(command);
     return true;
 }
 
-/**
- * @brief Returns the XBee's mode
- * @return the XBee's mode
- * @sa XBee::setMode()
- * @sa XBee::Mode
- */
-XBee::Mode XBee::mode() const
+/**
+ * @brief Sends synchronously the given command using in command mode
+ *
+ * To put the module in command mode, you need first to send '+++'
+ * @see http://knowledge.digi.com/articles/Knowledge_Base_Article/The-AT-Command-Set
+ * @param command the command to send; it may contain several comma separated commands
+ * @return the response lines, separated by <CR> (0x0D), one per command. Each line is awaited as long as
+ * CommandModeEngine::responseTimeout() (plus the guard time for '+++').
+ * @note The XBee must be in XBee::CommandMode
+ * @see XBee::setMode()
+ * @see XBee::commandModeEngine()
+ */
+QByteArray XBee::sendCommandSync(const QByteArray &command)
+{
+    QByteArray rep;
+    QByteArray line;
+    if(m_mode == CommandMode && xbeeFound && m_device)
+    {
+        const bool sequence = command.startsWith(QByteArray(3, m_commandEngine->sequenceCharacter()));
+        const int timeout = m_commandEngine->responseTimeout() + (sequence ? m_commandEngine->guardTime() : 0);
+        const int lines = command.count(',') + 1;
+
+        m_device->blockSignals(true);
+        m_device->write(command);
+        flushDevice();
+        for(int i=0; i<lines && readCommandLine(&line, timeout); i++) {
+            if(i > 0) {
+                rep.append(0x0D);
+            }
+            rep.append(line);
+        }
+        m_device->blockSignals(false);
+    }
+    return rep;
+}
+
+/**
+ * @brief Sends synchronously the given packet
+ * @param packet the packet to send.
+ * @retval the associated XBeeResponse in case of success
+ * @retval NULL if failed
+ * @note XBee don't take the XBeeResponse's ownership, you have to.
+ */
+XBeeResponse * XBee::sendSync(XBeePacket *packet)
+{
+    XBeeResponse * rep = NULL;
+    QByteArray repPacket;
+    qint64 timestamp = 0;
+
+    if(!xbeeFound) {
+        qWarning() << Q_FUNC_INFO << "No serial configured, can't send packet";
+        return NULL;
+    }
+
+    if(packet == NULL) {
+        qWarning() << Q_FUNC_INFO << "Invalid argument: null packet";
+        return NULL;
+    }
+
+    packet->setFrameId(nextFrameId());
+    if(packet->frameId() == 0) {
+        return NULL;
+    }
+
+    packet->assemblePacket();
+
+    m_device->blockSignals(true);
+
+    m_device->write(encodeFrame(packet->packet()));
+    flushDevice();
+    repPacket = readResponse(packet->frameId(), &timestamp);
+
+    m_device->blockSignals(false);
+    m_frameIds.release(packet->frameId());
+    deliverFrames();
+
+    if(repPacket.size() > 0) {
+        completeFrame(repPacket, timestamp);
+        rep = processPacket(repPacket, false, timestamp);
+        if(!rep) {
+            qDebug() << Q_FUNC_INFO << "Failed to process received response !";
+        }
+    }
+    else {
+        qDebug() << Q_FUNC_INFO << "no response to";
+        qDebug() << qPrintable(packet->toString());
+    }
+    return rep;
+}
+
+/**
+ * @brief Sends an ATCommand asynchronously
+ *
+ * The XBee::receivedATCommandResponse() signal will be emmited when a response to the sent ATCommand is received.
+ * @param command
+ */
+void XBee::sendATCommandAsync(ATCommand *command)
+{
+    sendAsync(command);
+}
+
+/**
+ * @brief Sends an ATCommand asynchronously
+ *
+ * The XBee::receivedATCommandResponse() signal will be emmited when a response to the sent ATCommand is received.
+ * @param command
+ * @note This method is not implemented yet
+ * @todo Implement this method
+ */
+void XBee::sendATCommandAsync(const QByteArray &data)
+{
+    Q_UNUSED(data);
+}
+
+
+/**
+ * @brief Sends an ATCommand synchronously
+ * @param command
+ * @return the corresponding ATCommandResponse; or null.
+ * @note XBee don't take the ATCommandResponse's ownership, you have to.
+ */
+ATCommandResponse * XBee::sendATCommandSync(ATCommand *command)
+{
+    Q_ASSERT(command);
+    ATCommandResponse * rep = NULL;
+    QByteArray repPacket;
+    qint64 timestamp = 0;
+
+    if(!xbeeFound) {
+        qWarning() << Q_FUNC_INFO << "No serial configured, can't send packet";
+        return NULL;
+    }
+
+    if(command == NULL) {
+        qWarning() << Q_FUNC_INFO << "Invalid argument: null packet";
+        return NULL;
+    }
+
+    command->setFrameId(nextFrameId());
+    if(command->frameId() == 0) {
+        return NULL;
+    }
+
+    command->assemblePacket();
+
+    m_device->blockSignals(true);
+
+    m_device->write(encodeFrame(command->packet()));
+    flushDevice();
+    repPacket = readResponse(command->frameId(), &timestamp);
+
+    m_device->blockSignals(false);
+    m_frameIds.release(command->frameId());
+    deliverFrames();
+
+    if(repPacket.size() > 0) {
+        rep = new ATCommandResponse();
+        rep->setPacket(repPacket);
+        rep->setTimestamp(timestamp);
+    }
+    else {
+        qDebug() << Q_FUNC_INFO << "no response to";
+        qDebug() << qPrintable(command->toString());
+    }
+    return rep;
+}
+
+/**
+ * @brief Sends an ATCommand synchronously
+ * @param atcommand
+ * @return the corresponding ATCommandResponse; or null.
+ * @note XBee don't take the ATCommandResponse's ownership, you have to.
+ */
+ATCommandResponse * XBee::sendATCommandSync(const QByteArray &atcommand)
+{
+    ATCommandResponse * rep = NULL;
+    if(atcommand.size() >= 2)
+    {
+        ATCommand at;
+        at.setCommand(atcommand.mid(0, 2));
+        if(atcommand.size() > 2) {
+            at.setParameter(atcommand.mid(2, atcommand.size()-2));
+        }
+        rep = sendATCommandSync(&at);
+    }
+    else {
+        qWarning() << Q_FUNC_INFO << "bad command" << atcommand;
+    }
+    return rep;
+}
+
+/**
+ * @brief Reads until the response to the given frame id is received.
+ *
+ * Other frames received meanwhile are queued to be dispatched as usual by XBee::deliverFrames().
+ * @param frameId the frame id of the request
+ * @param timestamp set to the time the response was read
+ * @return the response frame; empty if the XBee stayed silent for 100 ms without answering.
+ */
+QByteArray XBee::readResponse(const quint8 frameId, qint64 *timestamp)
+{
+    QByteArray frame;
+    qint64 readTime = 0;
+
+    do {
+        readDevice();
+        while(m_decoder.takeFrame(&frame, &readTime)) {
+            if(responseFrameId(frame) == frameId) {
+                *timestamp = readTime;
+                if(m_decoder.bytesAvailable() > 0) {
+                    // Frames received after the response, m_device's readyRead() was blocked
+                    queueCall("readData");
+                }
+                return frame;
+            }
+            if(receiveFrame(frame, readTime)) {
+                m_rxBatch.append(frame);
+                m_rxTimes.append(readTime);
+            }
+        }
+    } while(m_device->waitForReadyRead(100));
+
+    return QByteArray();
+}
+
+/**
+ * @brief Sends the given ATCommand list in a single burst and waits for all the responses.
+ *
+ * Unlike calling sendATCommandSync() for each command, the commands are pipelined :
+ * all the frames are written at once and the method returns as soon as the last response is received.
+ * Other frames received meanwhile are dispatched as usual.
+ * @param commands the commands to send (each one gets a new frame id)
+ * @param timeout the maximum time to wait for all the responses, in milliseconds
+ * @return the responses, in the same order than @a commands; a response is NULL if it hasn't been received before the timeout.
+ * @note XBee don't take the ATCommandResponse's ownership, you have to.
+ */
+QList<ATCommandResponse*> XBee::sendATCommandsSync(const QList<ATCommand*> &commands, const int timeout)
+{
+    QList<ATCommandResponse*> reps;
+    QHash<quint8, int> pending;
+    QByteArray burst;
+    QByteArray frame;
+    QElapsedTimer timer;
+    qint64 timestamp = 0;
+
+    for(int i=0; i<commands.size(); i++) {
+        reps.append(NULL);
+    }
+
+    if(!xbeeFound || !m_device) {
+        qWarning() << Q_FUNC_INFO << "No serial configured, can't send packet";
+        return reps;
+    }
+
+    if(commands.size() > 255 - m_frameIds.inUseCount()) {
+        qWarning() << Q_FUNC_INFO << "Too many commands," << m_frameIds.inUseCount() << "frame ids in use";
+        return reps;
+    }
+
+    for(int i=0; i<commands.size(); i++) {
+        ATCommand * command = commands.at(i);
+        Q_ASSERT(command);
+        command->setFrameId(nextFrameId());
+        command->assemblePacket();
+        pending.insert(command->frameId(), i);
+        burst.append(encodeFrame(command->packet()));
+    }
+
+    m_device->blockSignals(true);
+    m_device->write(burst);
+    flushDevice();
+    timer.start();
+
+    forever {
+        readDevice();
+        while(m_decoder.takeFrame(&frame, &timestamp)) {
+            const quint8 frameId = frame.size() > 4 ? (quint8)frame.at(4) : 0;
+            if((quint8)frame.at(3) == XBeePacket::ATCommandResponseId && pending.contains(frameId)) {
+                ATCommandResponse * rep = new ATCommandResponse(frame);
+                rep->setTimestamp(timestamp);
+                if(rep->status() == ATCommandResponse::Ok) {
+                    updateParameter(rep->atCommand(), rep->data());
+                }
+                reps[pending.take(frameId)] = rep;
+            }
+            else if(receiveFrame(frame, timestamp)) {
+                m_rxBatch.append(frame);
+                m_rxTimes.append(timestamp);
+            }
+        }
+        deliverFrames();
+
+        const int remaining = timeout - timer.elapsed();
+        if(pending.isEmpty() || remaining <= 0 || !m_device->waitForReadyRead(remaining)) {
+            break;
+        }
+    }
+
+    m_device->blockSignals(false);
+    foreach(const ATCommand * command, commands) {
+        m_frameIds.release(command->frameId());
+    }
+
+    if(!pending.isEmpty()) {
+        qDebug() << Q_FUNC_INFO << pending.size() << "response(s) missing";
+    }
+    return reps;
+}
+
+/**
+ * @brief Loads the XBee's addressing properties
+ * - DH
+ * - DL
+ * - MY
+ * - MP
+ * - NC
+ * - SH
+ * - SL
+ * - NI
+ * - SE
+ * - DE
+ * - CI
+ * - TO
+ * - NP
+ * - DD
+ * - CR
+ */
+void XBee::loadAddressingProperties() {
+    ATCommand at;
+    at.setCommand(ATCommand::ATDH); sendATCommandAsync(&at);
+    at.setCommand(ATCommand::ATDL); sendATCommandAsync(&at);
+    at.setCommand(ATCommand::ATMY); sendATCommandAsync(&at);
+    at.setCommand(ATCommand::ATMP); sendATCommandAsync(&at);
+    at.setCommand(ATCommand::ATNC); sendATCommandAsync(&at);
+    at.setCommand(ATCommand::ATSH); sendATCommandAsync(&at);
+    at.setCommand(ATCommand::ATSL); sendATCommandAsync(&at);
+    at.setCommand(ATCommand::ATNI); sendATCommandAsync(&at);
+    at.setCommand(ATCommand::ATSE); sendATCommandAsync(&at);
+    at.setCommand(ATCommand::ATDE); sendATCommandAsync(&at);
+    at.setCommand(ATCommand::ATCI); sendATCommandAsync(&at);
+    at.setCommand(ATCommand::ATTO); sendATCommandAsync(&at);
+    at.setCommand(ATCommand::ATNP); sendATCommandAsync(&at);
+    at.setCommand(ATCommand::ATDD); sendATCommandAsync(&at);
+    at.setCommand(ATCommand::ATCR); sendATCommandAsync(&at);
+}
+
+/**
+ * @brief Sets the value of the given parameter.
+ * @param param the parameter's AT command
+ * @param value the raw value (string or binary parameters), or the already encoded value of a numeric parameter
+ * @return true if the command has been sent; false if the parameter is unknown, read only, if the value is too long or if the XBee isn't opened.
+ * @sa XBee::rawParameter()
+ * @sa ATParameter
+ */
+bool XBee::setParameter(const ATCommand::ATCommandType param, const QByteArray &value)
+{
+    const ATParameter * p = ATParameter::find(param);
+    QByteArray encoded;
+
+    if(!p) {
+        qWarning() << Q_FUNC_INFO << "Unknown parameter" << QString("0x%1").arg(param, 0, 16);
+        return false;
+    }
+
+    if(p->isNumeric()) {
+        quint64 v = 0;
+        if(value.size() > p->width() || !p->decode(value, &v) || !p->encode(v, &encoded)) {
+            qWarning() << Q_FUNC_INFO << "Invalid value for" << ATCommand::atCommandToString(param) << value.toHex();
+            return false;
+        }
+    }
+    else if(!p->encode(value, &encoded)) {
+        return false;
+    }
+
+    return writeParameter(param, encoded);
+}
+
+/**
+ * @brief Sets the value of the given string parameter (e.g. ATCommand::ATNI).
+ * @param param the parameter's AT command
+ * @param value the value
+ * @return true if the command has been sent; false otherwise.
+ */
+bool XBee::setParameter(const ATCommand::ATCommandType param, const QString &value)
+{
+    return setParameter(param, value.toUtf8());
+}
+
+/**
+ * @brief Sets the value of the given string parameter from a UTF-8 string literal (e.g. <tt>setParameter(ATCommand::ATNI, "node")</tt>).
+ * @param param the parameter's AT command
+ * @param value the value
+ * @return true if the command has been sent; false otherwise.
+ */
+bool XBee::setParameter(const ATCommand::ATCommandType param, const char *value)
+{
+    return setParameter(param, QString::fromUtf8(value));
+}
+
+/**
+ * @brief Returns the last known raw value (big-endian for numeric parameters) of the given parameter.
+ * @param param the parameter's AT command
+ * @return the raw value; or an empty QByteArray if unknown.
+ * @sa XBee::parameter()
+ */
+QByteArray XBee::rawParameter(const ATCommand::ATCommandType param) const
+{
+    return m_parameters.value(param);
+}
+
+/**
+ * @brief Returns true if the value of the given parameter is known; false otherwise.
+ *
+ * Volatile parameters (ATParameter::isVolatile()) are never cached, hence never known.
+ * @param param the parameter's AT command
+ * @sa XBee::loadParameter()
+ */
+bool XBee::hasParameter(const ATCommand::ATCommandType param) const
+{
+    return m_parameters.contains(param);
+}
+
+/**
+ * @brief Asks the XBee for the value of the given parameter.
+ *
+ * The XBee::parameterChanged() signal will be emitted when the value is received, if it changed.
+ * @param param the parameter's AT command
+ * @return true if the command has been sent; false otherwise.
+ */
+bool XBee::loadParameter(const ATCommand::ATCommandType param)
+{
+    if(!ATParameter::isKnown(param)) {
+        qWarning() << Q_FUNC_INFO << "Unknown parameter" << QString("0x%1").arg(param, 0, 16);
+        return false;
+    }
+    ATCommand at;
+    at.setCommand(param);
+    return sendAsync(&at);
+}
+
+/**
+ * @brief Applies the given profile, writing only the parameters which differ from the XBee's current values.
+ *
+ * The current values are read in a single pipelined burst and compared to the profile's ones.
+ * The changed parameters are then queued (ATCommandQueueParam), applied at once (AC) and,
+ * if @a persist is true, saved with a single WR. Nothing is written when the XBee already matches the profile.
+ *
+ * Parameters which can't be read back (KY, ...) are always written.
+ * @param profile the profile to apply
+ * @param persist if true, the changes are written to the XBee's non-volatile memory
+ * @param changed if not null, filled with the changed parameters
+ * @return true if succeeded; false otherwise.
+ * @note The XBee must be in API mode
+ * @note If a queued parameter is rejected, AC and WR are not sent, so nothing is applied
+ * @sa XBeeProfile
+ */
+bool XBee::applyProfile(const XBeeProfile &profile, const bool persist, QList<ATCommand::ATCommandType> *changed)
+{
+    QList<ATCommand*> commands;
+    QList<ATCommandResponse*> reps;
+    QList<ATCommand::ATCommandType> diff;
+    const QList<ATCommand::ATCommandType> params = profile.parameters();
+    bool bRet = true;
+
+    if(changed) {
+        changed->clear();
+    }
+
+    if(m_mode == CommandMode) {
+        qWarning() << Q_FUNC_INFO << "The XBee must be in API mode to apply a profile";
+        return false;
+    }
+
+    // Read the current values
+    foreach(const ATCommand::ATCommandType param, params) {
+        ATCommand * at = new ATCommand();
+        at->setCommand(param);
+        commands.append(at);
+    }
+    reps = sendATCommandsSync(commands);
+    for(int i=0; i<params.size(); i++) {
+        const ATParameter * p = ATParameter::find(params.at(i));
+        const ATCommandResponse * rep = reps.at(i);
+        if(!rep) {
+            qWarning() << Q_FUNC_INFO << "No response to" << ATCommand::atCommandToString(params.at(i));
+            bRet = false;
+        }
+        else if(rep->status() != ATCommandResponse::Ok || rep->data().isEmpty() || !p->isEqual(rep->data(), profile.value(params.at(i)))) {
+            diff.append(params.at(i));
+        }
+    }
+    qDeleteAll(commands);
+    qDeleteAll(reps);
+    commands.clear();
+
+    if(!bRet) {
+        return false;
+    }
+    if(changed) {
+        *changed = diff;
+    }
+    if(diff.isEmpty()) {
+        qDebug() << Q_FUNC_INFO << "Profile" << profile.name() << "already applied";
+        rememberConfiguration(profile);
+        return true;
+    }
+
+    // Queue the changed values
+    foreach(const ATCommand::ATCommandType param, diff) {
+        ATCommandQueueParam * at = new ATCommandQueueParam(NULL);
+        at->setCommand(param);
+        at->setParameter(profile.value(param));
+        commands.append(at);
+    }
+    reps = sendATCommandsSync(commands);
+    foreach(const ATCommandResponse * rep, reps) {
+        if(!rep || rep->status() != ATCommandResponse::Ok) {
+            qWarning() << Q_FUNC_INFO << "Failed to queue parameter" << (rep ? rep->statusToString() : QString("(no response)"));
+            bRet = false;
+        }
+    }
+    qDeleteAll(commands);
+    qDeleteAll(reps);
+    commands.clear();
+
+    // Apply and write once
+    if(bRet) {
+        ATCommand ac;
+        ATCommand wr;
+        ac.setCommand(ATCommand::ATAC);
+        wr.setCommand(ATCommand::ATWR);
+        commands.append(&ac);
+        if(persist) {
+            commands.append(&wr);
+        }
+        reps = sendATCommandsSync(commands);
+        foreach(const ATCommandResponse * rep, reps) {
+            if(!rep || rep->status() != ATCommandResponse::Ok) {
+                qWarning() << Q_FUNC_INFO << "Failed to apply profile" << (rep ? rep->statusToString() : QString("(no response)"));
+                bRet = false;
+            }
+        }
+        qDeleteAll(reps);
+    }
+
+    if(bRet) {
+        foreach(const ATCommand::ATCommandType param, diff) {
+            updateParameter(param, profile.value(param));
+        }
+        rememberConfiguration(profile);
+    }
+    return bRet;
+}
+
+// Adressing
+bool XBee::setDH(const quint32 dh) {
+    return setParameter(ATCommand::ATDH, dh);
+}
+
+bool XBee::setDL(const quint32 dl) {
+    return setParameter(ATCommand::ATDL, dl);
+}
+
+bool XBee::setMY(const quint16 my) {
+    return setParameter(ATCommand::ATMY, my);
+}
+
+/**
+ * @deprecated MP is read only: the XBee rejects it, so this always returns false.
+ */
+bool XBee::setMP(const quint16 mp) {
+    return setParameter(ATCommand::ATMP, mp);
+}
+
+/**
+ * @deprecated NC is read only: the XBee rejects it, so this always returns false.
+ */
+bool XBee::setNC(const quint32 nc) {
+    return setParameter(ATCommand::ATNC, nc);
+}
+
+/**
+ * @deprecated SH is read only: the XBee rejects it, so this always returns false.
+ */
+bool XBee::setSH(const quint32 sh) {
+    return setParameter(ATCommand::ATSH, sh);
+}
+
+/**
+ * @deprecated SL is read only: the XBee rejects it, so this always returns false.
+ */
+bool XBee::setSL(const quint32 sl) {
+    return setParameter(ATCommand::ATSL, sl);
+}
+
+bool XBee::setNI(const QString & ni) {
+    return setParameter(ATCommand::ATNI, ni);
+}
+
+bool XBee::setSE(const quint8 se) {
+    return setParameter(ATCommand::ATSE, se);
+}
+
+bool XBee::setDE(const quint8 de) {
+    return setParameter(ATCommand::ATDE, de);
+}
+
+bool XBee::setCI(const quint8 ci) {
+    return setParameter(ATCommand::ATCI, ci);
+}
+
+bool XBee::setTO(const quint8 to) {
+    return setParameter(ATCommand::ATTO, to);
+}
+
+bool XBee::setNP(const quint8 np) {
+    return setParameter(ATCommand::ATNP, np);
+}
+
+bool XBee::setDD(const quint16 dd) {
+    return setParameter(ATCommand::ATDD, dd);
+}
+
+bool XBee::setCR(const quint8 cr) {
+    return setParameter(ATCommand::ATCR, cr);
+}
+
+/**
+ * @brief Sets the XBee's mode
+ * @param mode
+ * @return true if succeeded; false otherwise.
+ * @todo Set the mode into the XBee, not only the class attribute
+ * @sa XBee::Mode
+ * @sa XBee::mode()
+ */
+bool XBee::setMode(const Mode mode)
+{
+    m_mode = mode;
+    if(mode != CommandMode) {
+        m_commandEngine->abort();
+    }
+    m_decoder.clear();
+    m_decoder.setEscaped(mode == API2Mode);
+    return true;
+}
+
+/**
+ * @brief Returns the engine driving the command mode asynchronously
+ *
+ * The engine writes on the XBee's serial port and is fed with the received data while the XBee is in XBee::CommandMode.
+ * @code
+ * xbee.setMode(XBee::CommandMode);
+ * xbee.commandModeEngine()->sendCommands("ATID1234,CH0C,WR,CN");
+ * @endcode
+ * @sa CommandModeEngine
+ */
+CommandModeEngine *XBee::commandModeEngine() const
+{
+    return m_commandEngine;
+}
+
+/**
+ * @brief Returns the XBee's mode
+ * @return the XBee's mode
+ * @sa XBee::setMode()
+ * @sa XBee::Mode
+ */
+XBee::Mode XBee::mode() const
+{
+    return m_mode;
+}
+
+//_________________________________________________________________________________________________
+//___________________________________________PRIVATE API___________________________________________
+//_________________________________________________________________________________________________
+void XBee::readData()
+{
+    qint64 timestamp = 0;
+    QByteArray packet;
+
+    if(m_mode == CommandMode) {
+        m_commandEngine->processData(m_device->readAll());
+    }
+    else {
+        readDevice();
+        while(m_decoder.takeFrame(&packet, &timestamp)) {
+            qDebug() << Q_FUNC_INFO << QString("0x").append(packet.toHex());
+            if(Q_UNLIKELY(FrameTracer::isEnabled())) {
+                FrameTracer::record(FrameTracer::Decode, packet, timestamp, monotonicTime());
+            }
+            if(receiveFrame(packet, timestamp)) {
+                m_rxBatch.append(packet);
+                m_rxTimes.append(timestamp);
+            }
+        }
+        deliverFrames();
+    }
+}
+
+/**
+ * @brief Reads all the available bytes from the device into the frame decoder.
+ *
+ * With the Linux transport, the bytes of each tty read are stamped with the time of that read;
+ * QSerialPort reads in its own notifier, so the closest is now.
+ */
+void XBee::readDevice()
+{
+    if(m_device != m_transport) {
+        const qint64 timestamp = monotonicTime();
+        m_decoder.append(m_device->readAll(), timestamp);
+        return;
+    }
+
+    qint64 timestamp = 0;
+    QByteArray data;
+    while(!(data = m_transport->readStamped(&timestamp)).isEmpty()) {
+        m_decoder.append(data, timestamp);
+    }
+}
+
+/**
+ * @brief Handles the transmit status bookkeeping of a received frame and checks it against the frame filter.
+ * @param frame
+ * @param timestamp the frame's receive time
+ * @return true if the frame must be delivered; false if filtered.
+ */
+bool XBee::receiveFrame(const QByteArray &frame, const qint64 timestamp)
+{
+    // The response to one of our frames was asked for: it bypasses the filter
+    const bool completed = completeFrame(frame, timestamp);
+
+    if(!completed && !m_frameFilter.accepts(frame)) {
+        m_filteredFrameCount++;
+        return false;
+    }
+    if(m_frameRing) {
+        m_frameRing->publish(frame, timestamp);
+    }
+    return true;
+}
+
+/**
+ * @brief Delivers the frames received during the read: once as a batch, then frame by frame.
+ */
+void XBee::deliverFrames()
+{
+    if(m_rxBatch.isEmpty()) {
+        return;
+    }
+    if(m_frameRing) {
+        m_frameRing->notify();
+    }
+
+    // The batch may be received again by a recursive read (sync requests from a slot)
+    const QVector<QByteArray> batch = m_rxBatch;
+    const QVector<qint64> times = m_rxTimes;
+    m_rxBatch.resize(0);
+    m_rxTimes.resize(0);
+
+    emit receivedFrames(batch);
+    for(int i=0; i<batch.size(); i++) {
+        if(Q_UNLIKELY(FrameTracer::isEnabled())) {
+            const qint64 begin = monotonicTime();
+            processPacket(batch.at(i), true, times.at(i));
+            FrameTracer::record(FrameTracer::Dispatch, batch.at(i), begin, monotonicTime());
+        }
+        else {
+            processPacket(batch.at(i), true, times.at(i));
+        }
+    }
+}
+
+void XBee::onCommandLineReceived(const QByteArray &line)
+{
+    emit rawDataReceived(QByteArray(line).append(0x0D));
+}
+
+void XBee::onDeviceError(const QSerialPort::SerialPortError error)
+{
+    switch(error) {
+    case QSerialPort::ResourceError :
+    case QSerialPort::ReadError :
+    case QSerialPort::WriteError :
+        if(m_autoRecovery && xbeeFound) {
+            startRecovery();
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+void XBee::onRecoveryTimer()
+{
+    m_recoveryAttempt++;
+    m_device->close();
+    m_decoder.clear();
+
+    if(!m_device->open(QIODevice::ReadWrite)) {
+        qDebug() << "XBEE: Reconnection attempt" << m_recoveryAttempt << "on" << devicePortName() << "failed";
+        m_recoveryTimer.start(recoveryDelay());
+        return;
+    }
+
+    // Frames sent meanwhile stay held until the session is restored, see XBee::finishSynchronization()
+    xbeeFound = true;
+    synchronize();
+}
+
+void XBee::onAssociationTimer()
+{
+    dropHeldData(false);
+    if(xbeeFound && m_mode != CommandMode && !m_recovering && !m_synchronizing) {
+        loadParameter(ATCommand::ATAI);
+    }
+}
+
+void XBee::onFrameTimer()
+{
+    const qint64 now = m_clock.elapsed();
+
+    // The link recovery replays or fails the in-flight frames by itself
+    if(m_recovering || m_frameTimeout <= 0) {
+        return;
+    }
+
+    while(!m_inFlight.isEmpty() && now - m_inFlight.first().written >= m_frameTimeout) {
+        const PendingFrame pending = m_inFlight.takeFirst();
+        qDebug() << Q_FUNC_INFO << "No response to frame" << pending.frameId;
+        recordDelivery(pending, false);
+        dropFrame(pending);
+    }
+    writeQueuedFrames();
+
+    if(!m_inFlight.isEmpty()) {
+        m_frameTimer.start(qMax((qint64)0, m_inFlight.first().written + m_frameTimeout - now));
+    }
+}
+
+void XBee::resync()
+{
+    if(!xbeeFound || m_recovering || m_synchronizing) {
+        return;
+    }
+
+    qDebug() << "XBEE: The XBee has been reset, resynchronizing";
+    m_resyncing = true;
+    synchronize();
+}
+
+XBeeResponse * XBee::processPacket(QByteArray packet, const bool async, const qint64 timestamp)
+{
+    unsigned packetType = (unsigned char)packet.at(3);
+
+    if(async && !m_frameSignals && FrameFilter::isRemoteFrame(packetType)) {
+        return NULL;
+    }
+
+    switch (packetType) {
+    /********************** WPAN **********************/
+    case XBeePacket::Rx16ResponseId : {
+        Wpan::RxResponse16 * response = new Wpan::RxResponse16();
+        response->setPacket(packet);
+        response->setTimestamp(timestamp);
+        if(async) {
+            emit receivedRxResponse16(response);
+            response->deleteLater();
+        }
+        else {
+            return response;
+        }
+        break;
+    }
+    case XBeePacket::Rx64ResponseId : {
+        Wpan::RxResponse64 * response = new Wpan::RxResponse64();
+        response->setPacket(packet);
+        response->setTimestamp(timestamp);
+        if(async) {
+            emit receivedRxResponse64(response);
+            response->deleteLater();
+        }
+        else {
+            return response;
+        }
+        break;
+    }
+    case XBeePacket::TxStatusResponseId : {
+        Wpan::TxStatusResponse * response = new Wpan::TxStatusResponse();
+        response->setPacket(packet);
+        response->setTimestamp(timestamp);
+        if(async) {
+            emit receivedTransmitStatus(response);
+            response->deleteLater();
+        }
+        else {
+            return response;
+        }
+        break;
+    }
+    /********************** QtXBee **********************/
+    case XBeePacket::ATCommandResponseId : {
+        ATCommandResponse *response = new ATCommandResponse(packet);
+        response->setTimestamp(timestamp);
+        if(async) {
+            processATCommandRespone(response);
+            response->deleteLater();
+        }
+        else {
+            return response;
+        }
+        break;
+    }
+    case XBeePacket::ModemStatusResponseId : {
+        ModemStatus *response = new ModemStatus(packet);
+        response->setTimestamp(timestamp);
+        switch(response->status()) {
+        case ModemStatus::HardwareReset :
+        case ModemStatus::WatchdogTimerReset :
+            // The XBee lost its volatile configuration and the frames it was processing
+            setAssociationState(AssociationUnknown);
+            if(xbeeFound && !m_synchronizing && !m_recovering) {
+                queueCall("resync");
+            }
+            break;
+        case ModemStatus::Associated :
+        case ModemStatus::CoordinatorStarted :
+            setAssociationState(Associated);
+            break;
+        case ModemStatus::Disassociated :
+        case ModemStatus::SynchronizationLost :
+            setAssociationState(Disassociated);
+            break;
+        default:
+            break;
+        }
+        if(async) {
+            emit receivedModemStatus(response);
+            response->deleteLater();
+        }
+        else {
+            return response;
+        }
+        break;
+    }
+    case XBeePacket::RemoteATCommandResponseId : {
+        RemoteATCommandResponse *response = new RemoteATCommandResponse(packet);
+        response->setTimestamp(timestamp);
+        if(async) {
+            emit receivedRemoteCommandResponse(response);
+            response->deleteLater();
+        }
+        else {
+            return response;
+        }
+        break;
+    }
+    /********************** ZigBee **********************/
+    case XBeePacket::ZBTxStatusResponseId : {
+        ZBTxStatusResponse *response = new ZBTxStatusResponse(this);
+        response->readPacket(packet);
+        response->setTimestamp(timestamp);
+        if(async) {
+            emit receivedTransmitStatus(response);
+        }
+        else {
+            return response;
+        }
+        break;
+    }
+    case XBeePacket::ZBRxResponseId : {
+        ZBRxResponse *response = new ZBRxResponse(this);
+        response->readPacket(packet);
+        response->setTimestamp(timestamp);
+        if(async) {
+            emit receivedRxIndicator(response);
+        }
+        else {
+            return response;
+        }
+        break;
+    }
+    case XBeePacket::ZBExplicitRxResponseId : {
+        ZBExplicitRxResponse *response = new ZBExplicitRxResponse(this);
+        response->readPacket(packet);
+        response->setTimestamp(timestamp);
+        if(async) {
+            emit receivedRxIndicatorExplicit(response);
+        }
+        else {
+            return response;
+        }
+        break;
+    }
+    case XBeePacket::ZBIONodeIdentificationId : {
+        ZBIONodeIdentificationResponse *response = new ZBIONodeIdentificationResponse(this);
+        response->setPacket(packet);
+        response->setTimestamp(timestamp);
+        if(async) {
+            emit receivedNodeIdentificationIndicator(response);
+        }
+        else {
+            return response;
+        }
+        break;
+    }
+    default:
+        qDebug() << Q_FUNC_INFO << qPrintable(QString("Error: Unknown or Unhandled Packet (type=%1): 0x%2").
+                                              arg(packetType,0,16).
+                                              arg(QString(packet.toHex())));
+    }
+    return NULL;
+}
+
+void XBee::processATCommandRespone(ATCommandResponse *rep) {
+    Q_ASSERT(rep);
+    ATCommand::ATCommandType at = rep->atCommand();
+    QByteArray data = rep->data();
+    const QByteArray written = m_pendingWrites.take(rep->frameId());
+
+    qDebug() << Q_FUNC_INFO << "AT command" << ATCommand::atCommandToString(at) << QString("0x%1").arg(at , 0, 16) << " : " << data.toHex();
+
+    if(rep->status() == ATCommandResponse::Ok) {
+        // A write is acknowledged with an empty response: the written value becomes the known one
+        updateParameter(at, data.isEmpty() ? written : data);
+        const ATParameter * p = ATParameter::find(at);
+        if(!written.isEmpty() && p && !p->isExecutable()) {
+            m_configuration.setValue(at, written);
+        }
+    }
+
+    if(at == ATCommand::ATND) {
+        RemoteNode * node = NULL;
+        NodeDiscoveryResponseParser nd;
+        if((node = nd.parseData(rep->data())) != NULL) {
+            node->setParent(this);
+            qDebug() << "Discovered node :" << qPrintable(node->toString());
+        }
+    }
+    else if(!ATParameter::isKnown(at)) {
+        qWarning() << Q_FUNC_INFO << "Unhandled AT command" <<  QString("0x%1 (%2)").arg(at , 0, 16).arg(ATCommand::atCommandToString(at));
+    }
+    emit receivedATCommandResponse(rep);
+}
+
+bool XBee::setNumericParameter(const ATCommand::ATCommandType param, const quint64 value)
+{
+    const ATParameter * p = ATParameter::find(param);
+    QByteArray encoded;
+
+    if(!p) {
+        qWarning() << Q_FUNC_INFO << "Unknown parameter" << QString("0x%1").arg(param, 0, 16);
+        return false;
+    }
+    if(!p->encode(value, &encoded)) {
+        return false;
+    }
+    return writeParameter(param, encoded);
+}
+
+quint64 XBee::numericParameter(const ATCommand::ATCommandType param) const
+{
+    const ATParameter * p = ATParameter::find(param);
+    quint64 value = 0;
+
+    if(p && !p->decode(m_parameters.value(param), &value)) {
+        value = 0;
+    }
+    return value;
+}
+
+bool XBee::writeParameter(const ATCommand::ATCommandType param, const QByteArray &encoded)
+{
+    ATCommand at;
+    at.setCommand(param);
+    at.setParameter(encoded);
+    if(QThread::currentThread() != thread()) {
+        // The frame id is only known once the XBee's thread drained the submission, which records the write
+        return submit(FrameTemplate(&at), -1, QByteArray(), RequestStatus, encoded) != 0;
+    }
+    if(!((xbeeFound && m_device && m_device->isOpen()) || m_recovering)) {
+        qDebug() << "XBEE: Cannot write to Serial Port" << (m_device ? devicePortName() : QString());
+        return false;
+    }
+
+    const quint8 frameId = nextFrameId();
+    if(frameId == 0) {
+        return false;
+    }
+    at.setFrameId(frameId);
+    at.assemblePacket();
+    // Recorded before queueing, so that a frame failing right away removes it
+    m_pendingWrites.insert(frameId, encoded);
+    if(!queueFrame(frameId, at.packet(), -1, QByteArray())) {
+        m_pendingWrites.remove(frameId);
+        return false;
+    }
+    return true;
+}
+
+void XBee::updateParameter(const ATCommand::ATCommandType param, const QByteArray &value)
+{
+    const ATParameter * p = ATParameter::find(param);
+
+    if(!p || p->isExecutable() || value.isEmpty()) {
+        return;
+    }
+    if(param == ATCommand::ATAI) {
+        quint64 ai = 0;
+        if(p->decode(value, &ai)) {
+            setAssociationState(ai == 0 ? Associated : Disassociated);
+        }
+    }
+    // A volatile value (RSSI, voltage, ...) is stale as soon as it is read: it is reported, never cached
+    if(p->isVolatile()) {
+        quint64 decoded = 0;
+        if(param == ATCommand::ATNC && p->decode(value, &decoded)) {
+            m_nc = decoded;
+            emit NCChanged(decoded);
+        }
+        return;
+    }
+    if(m_parameters.contains(param) && m_parameters.value(param) == value) {
+        return;
+    }
+    m_parameters.insert(param, value);
+    emit parameterChanged(param);
+
+    switch(param) {
+    // Addressing
+    case ATCommand::ATDH : emit DHChanged(DH()); break;
+    case ATCommand::ATDL : emit DLChanged(DL()); break;
+    case ATCommand::ATMY : emit MYChanged(MY()); break;
+    case ATCommand::ATMP : emit MPChanged(MP()); break;
+    case ATCommand::ATSH : emit SHChanged(SH()); break;
+    case ATCommand::ATSL : emit SLChanged(SL()); break;
+    case ATCommand::ATNI : emit NIChanged(NI()); break;
+    case ATCommand::ATSE : emit SEChanged(SE()); break;
+    case ATCommand::ATDE : emit DEChanged(DE()); break;
+    case ATCommand::ATCI : emit CIChanged(CI()); break;
+    case ATCommand::ATTO : emit TOChanged(TO()); break;
+    case ATCommand::ATNP : emit NPChanged(NO()); break;
+    case ATCommand::ATDD : emit DDChanged(DD()); break;
+    case ATCommand::ATCR : emit CRChanged(CR()); break;
+    default:
+        break;
+    }
+}
+
+/**
+ * @brief Checks that the XBee is in API mode.
+ *
+ * The API mode is probed with a single AP frame. If the XBee doesn't answer, it may be in transparent mode:
+ * the check goes on in command mode, asynchronously through the CommandModeEngine, and ends in
+ * XBee::onCommandsFinished().
+ * @return true if the XBee answered in API mode or if the command mode check started; false otherwise.
+ */
+bool XBee::startupCheck()
+{
+    m_checkClock.start();
+    qDebug() << "****************** XBEE CONFIGURATION CHECKUP ******************";
+
+    if(!xbeeFound) {
+        return false;
+    }
+    if(probeApiMode(50)) {
+        qDebug() << "XBEE: Startup check :" << "XBee in API mode        :" << qPrintable(QString("OK (AP=%1)").arg(m_mode == API2Mode ? 2 : 1));
+        return true;
+    }
+
+    qDebug() << "XBEE: No response in API mode, trying command mode";
+    setMode(CommandMode);
+    m_commandCheck = ReadingAp;
+    m_commandCheckAp = -1;
+    if(!m_commandEngine->sendCommands("ATAP")) {
+        m_commandCheck = NoCommandCheck;
+        setMode(API1Mode);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Reads HV, VR, SH and SL in one burst.
+ *
+ * Only SH/SL identify the XBee (see XBee::restoreSession()); the hardware version is only logged,
+ * any radio answering in API mode is supported.
+ * @return true if the XBee answered SH and SL; false otherwise.
+ */
+bool XBee::identify()
+{
+    QList<ATCommand*> commands;
+    QList<ATCommandResponse*> reps;
+    QString hvStr;
+    ATCommand hv;
+    ATCommand vr;
+    ATCommand sh;
+    ATCommand sl;
+    bool bRet = false;
+
+    hv.setCommand(ATCommand::ATHV);
+    vr.setCommand(ATCommand::ATVR);
+    sh.setCommand(ATCommand::ATSH);
+    sl.setCommand(ATCommand::ATSL);
+    commands << &hv << &vr << &sh << &sl;
+    reps = sendATCommandsSync(commands, 100);
+
+    bRet = reps.at(2) && reps.at(2)->status() == ATCommandResponse::Ok && !reps.at(2)->data().isEmpty() &&
+           reps.at(3) && reps.at(3)->status() == ATCommandResponse::Ok && !reps.at(3)->data().isEmpty();
+
+    if(!reps.at(0) || reps.at(0)->status() != ATCommandResponse::Ok || reps.at(0)->data().isEmpty()) {
+        hvStr = "unknown (HV command failed)";
+    }
+    else {
+        const quint8 hwVersion = reps.at(0)->data().at(0);
+        hvStr = QString("0x%1").arg(QString(reps.at(0)->data().toHex()));
+        if(hwVersion == QtXBee::XBeeSerie1 || hwVersion == QtXBee::XBeeSerie1Pro) {
+            hvStr.append(" (Serie 1/1Pro)");
+        }
+    }
+    qDeleteAll(reps);
+
+    qDebug() << "XBEE: Startup check :" << "Hardware version        :" << qPrintable(hvStr);
+    qDebug() << "XBEE: Startup check :" << "Serial number (SH/SL)   :" << (bRet ? "OK" : "KO (No response to SH/SL commands)");
+    qDebug() << "XBEE: Startup check :" << "Firmware / Address      :"
+             << qPrintable(QString("0x%1 / 0x%2%3").arg(parameter<quint16>(ATCommand::ATVR), 4, 16, QChar('0'))
+                           .arg(SH(), 8, 16, QChar('0'))
+                           .arg(SL(), 8, 16, QChar('0')));
+    return bRet;
+}
+
+quint8 XBee::nextFrameId()
+{
+    const quint8 frameId = m_frameIds.acquire();
+    if(frameId == 0) {
+        qWarning() << Q_FUNC_INFO << "No free frame id, 255 frames are waiting for their response";
+    }
+    return frameId;
+}
+
+/**
+ * @brief Sends a single ATCommand frame which is valid in both API modes and waits for its response.
+ *
+ * The frame id is chosen so that the frame doesn't contain any byte to escape;
+ * the received bytes are decoded both as API mode 1 and API mode 2 frames.
+ */
+ATCommandResponse * XBee::probeATCommand(const ATCommand::ATCommandType param, const int timeout)
+{
+    ATCommandResponse * rep = NULL;
+    ATCommand at;
+    QByteArray raw;
+    QByteArray frame;
+    QElapsedTimer timer;
+
+    at.setCommand(param);
+    forever {
+        at.setFrameId(nextFrameId());
+        if(at.frameId() == 0) {
+            return NULL;
+        }
+        at.assemblePacket();
+        if(!XBeePacket::needsEscaping(at.packet())) {
+            break;
+        }
+        m_frameIds.release(at.frameId());
+    }
+
+    m_device->blockSignals(true);
+    m_device->write(at.packet());
+    flushDevice();
+    timer.start();
+
+    forever {
+        raw.append(m_device->readAll());
+        for(int escaped=0; escaped<2 && !rep; escaped++) {
+            FrameDecoder decoder;
+            decoder.setEscaped(escaped);
+            decoder.append(raw);
+            while(!rep && decoder.takeFrame(&frame)) {
+                if((quint8)frame.at(3) == XBeePacket::ATCommandResponseId && (quint8)frame.at(4) == at.frameId()) {
+                    rep = new ATCommandResponse(frame);
+                }
+            }
+        }
+
+        const int remaining = timeout - timer.elapsed();
+        if(rep || remaining <= 0 || !m_device->waitForReadyRead(remaining)) {
+            break;
+        }
+    }
+
+    m_device->blockSignals(false);
+    m_frameIds.release(at.frameId());
+    return rep;
+}
+
+/**
+ * @brief Probes the API mode with a single ATAP frame and updates the XBee's mode from the response.
+ * @return true if the XBee answered in API mode; false otherwise.
+ */
+bool XBee::probeApiMode(const int timeout)
+{
+    bool bRet = false;
+    ATCommandResponse * rep = probeATCommand(ATCommand::ATAP, timeout);
+
+    if(rep && rep->status() == ATCommandResponse::Ok && !rep->data().isEmpty()) {
+        const quint8 ap = rep->data().at(rep->data().size()-1);
+        if(ap == 1 || ap == 2) {
+            setMode(ap == 2 ? API2Mode : API1Mode);
+            bRet = true;
+        }
+    }
+    delete rep;
+    return bRet;
+}
+
+/**
+ * @brief Returns the given frame as it must be written, escaped in API mode 2.
+ */
+QByteArray XBee::encodeFrame(const QByteArray &frame) const
+{
+    return m_mode == API2Mode ? XBeePacket::escape(frame) : frame;
+}
+
+bool XBee::readCommandLine(QByteArray *line, const int timeout)
+{
+    Q_ASSERT(line);
+    QElapsedTimer timer;
+    char c;
+
+    line->clear();
+    timer.start();
+    forever {
+        while(m_device->getChar(&c)) {
+            if(c == 0x0D) {
+                return true;
+            }
+            if(line->size() < m_commandEngine->maxLineSize()) {
+                line->append(c);
+            }
+        }
+        const int remaining = timeout - timer.elapsed();
+        if(remaining <= 0 || !m_device->waitForReadyRead(remaining)) {
+            return false;
+        }
+    }
+}
+
+void XBee::createDevice(const QString &portName)
+{
+    if(m_device) {
+        m_device->close();
+        m_device->disconnect(this);
+        m_commandEngine->setDevice(NULL);
+        delete m_device;
+    }
+    m_device = NULL;
+    m_serial = NULL;
+    m_transport = NULL;
+
+#ifdef Q_OS_LINUX
+    if(m_transportType == LinuxTransport) {
+        m_transport = new LinuxSerialTransport(portName, this);
+        m_transport->setNotifiersEnabled(!m_pollMode);
+        m_device = m_transport;
+    }
+#endif
+    if(m_device == NULL) {
+        m_serial = new QSerialPort(portName, this);
+        m_device = m_serial;
+    }
+
+    connect(m_device, SIGNAL(readyRead()), SLOT(readData()));
+    connect(m_device, SIGNAL(bytesWritten(qint64)), SLOT(writeQueuedFrames()));
+    connect(m_device, SIGNAL(errorOccurred(QSerialPort::SerialPortError)), SLOT(onDeviceError(QSerialPort::SerialPortError)));
+    m_commandEngine->setDevice(m_device);
+    m_identity = 0;
+}
+
+/**
+ * @brief Checks the XBee's configuration, then identifies it and restores the session.
+ *
+ * The frames sent meanwhile stay queued. If the check goes on in command mode,
+ * the synchronization completes asynchronously.
+ * @sa XBee::finishSynchronization()
+ */
+void XBee::synchronize()
+{
+    m_synchronizing = true;
+    if(!startupCheck()) {
+        finishSynchronization(false);
+    }
+    else if(m_commandCheck == NoCommandCheck) {
+        finishSynchronization(true);
+    }
+}
+
+/**
+ * @brief Ends the synchronization started by XBee::synchronize()
+ *
+ * On success, the XBee is identified and the session restored; a recovered link is reported with XBee::linkRecovered().
+ * On failure, a recovery goes on with its next attempt and a reset XBee starts the recovery.
+ * @param apiMode true if the XBee is in API mode
+ */
+void XBee::finishSynchronization(const bool apiMode)
+{
+    const bool ok = apiMode && identify();
+    const bool resyncing = m_resyncing;
+
+    qDebug() << "XBEE: Startup check :" << "done in" << m_checkClock.elapsed() << "ms";
+    qDebug() << "*****************************************************************";
+    m_synchronizing = false;
+    m_resyncing = false;
+
+    if(ok) {
+        const bool recovered = m_recovering;
+        m_recovering = false;
+        restoreSession();
+        if(m_associationPollInterval > 0) {
+            m_associationTimer.start(m_associationPollInterval);
+        }
+        if(recovered) {
+            qDebug() << "XBEE: Serial link recovered after" << m_recoveryAttempt << "attempt(s)";
+            emit linkRecovered();
+        }
+    }
+    else if(m_recovering) {
+        qDebug() << "XBEE: Reconnection attempt" << m_recoveryAttempt << ": the XBee doesn't answer";
+        m_device->close();
+        xbeeFound = false;
+        m_recoveryTimer.start(recoveryDelay());
+    }
+    else if(resyncing) {
+        if(m_autoRecovery) {
+            startRecovery();
+        }
+        else {
+            failPending();
+        }
+    }
+}
+
+/**
+ * @brief Stops the command mode check of a synchronization, which is dropped.
+ */
+void XBee::cancelCommandCheck()
+{
+    if(m_commandCheck == NoCommandCheck) {
+        return;
+    }
+    // Cleared first: aborting the engine reports the pending commands as failed
+    m_commandCheck = NoCommandCheck;
+    m_synchronizing = false;
+    m_resyncing = false;
+    setMode(API1Mode);
+}
+
+void XBee::onCommandResponse(const QByteArray &command, const QByteArray &response)
+{
+    bool ok = false;
+
+    if(m_commandCheck == ReadingAp && command.toUpper() == "AP") {
+        const int ap = response.trimmed().toInt(&ok, 16);
+        m_commandCheckAp = ok ? ap : -1;
+    }
+}
+
+/**
+ * @brief Goes on with the command mode check of the synchronization, once the XBee answered the sent commands.
+ *
+ * AP is read first; the command mode is left if it is 1 or 2, otherwise AP is set to 1.
+ */
+void XBee::onCommandsFinished(const bool ok)
+{
+    const CommandCheck step = m_commandCheck;
+    const int ap = m_commandCheckAp;
+
+    if(step == NoCommandCheck) {
+        return;
+    }
+
+    if(step == ReadingAp && ok && ap >= 0) {
+        if(ap == 1 || ap == 2) {
+            m_commandCheck = LeavingCommandMode;
+            m_commandEngine->sendCommands("ATCN");
+        }
+        else {
+            qDebug() << "XBee radio is not in API mode. Try to set AP=1";
+            m_commandCheck = SettingAp;
+            m_commandCheckAp = 1;
+            m_commandEngine->sendCommands("ATAP1,CN");
+        }
+        return;
+    }
+
+    m_commandCheck = NoCommandCheck;
+    switch(step) {
+    case ReadingAp :
+        qDebug() << "XBEE: Startup check :" << "XBee in API mode        :" << "KO (No response to AP command in command mode)";
+        break;
+    case LeavingCommandMode :
+        qDebug() << "XBEE: Startup check :" << "XBee in API mode        :" << qPrintable(ok ? QString("OK (AP=%1)").arg(ap) : QString("KO (Failed to leave command mode)"));
+        break;
+    default:
+        qDebug() << "XBEE: Startup check :" << "XBee in API mode        :" << (ok ? "OK (AP set to 1)" : "KO (Failed to set AP=1)");
+        break;
+    }
+    setMode(ok && ap == 2 ? API2Mode : API1Mode);
+    finishSynchronization(ok);
+}
+
+void XBee::restoreSession()
+{
+    const quint64 identity = ((quint64)SH() << 32) | SL();
+
+    if(m_identity != 0 && identity != m_identity) {
+        qWarning() << "XBEE: Another XBee answered" << QString("(0x%1)").arg(identity, 16, 16, QChar('0'))
+                   << ", the configuration is not re-applied";
+        m_identity = identity;
+        failPending();
+        return;
+    }
+    m_identity = identity;
+
+    if(!m_configuration.isEmpty() && !applyProfile(m_configuration, false)) {
+        qWarning() << "XBEE: Failed to re-apply the configuration";
+    }
+
+    if(m_recoveryPolicy == ReplayPending) {
+        replayPending();
+    }
+    else {
+        failPending();
+    }
+
+    if(m_mode != CommandMode) {
+        // Synchronously, so that the response doesn't end up in the application's next sendSync()
+        ATCommand ai;
+        ai.setCommand(ATCommand::ATAI);
+        qDeleteAll(sendATCommandsSync(QList<ATCommand*>() << &ai, 100));
+    }
+}
+
+void XBee::startRecovery()
+{
+    if(m_recovering) {
+        return;
+    }
+
+    qWarning() << "XBEE: Serial link lost on" << devicePortName() << ":" << m_device->errorString();
+    cancelCommandCheck();
+    xbeeFound = false;
+    m_recovering = true;
+    m_recoveryAttempt = 0;
+    m_recoveryTimer.start(recoveryDelay());
+    emit linkLost();
+}
+
+int XBee::recoveryDelay() const
+{
+    // Exponential backoff, half of it randomized so that several XBees don't reconnect in lockstep
+    const int delay = qMin(RecoveryMaxDelay, RecoveryBaseDelay << qMin(m_recoveryAttempt, 6));
+    return delay/2 + QRandomGenerator::global()->bounded(delay/2 + 1);
+}
+
+bool XBee::queueFrame(const quint8 frameId, const QByteArray &frame, const int lifetime, const QByteArray &supersedeKey, const quint32 ticket, const qint64 enqueueTime)
+{
+    PendingFrame pending;
+
+    pending.frameId = frameId;
+    pending.frame = frame;
+    pending.queued = m_clock.elapsed();
+    pending.written = 0;
+    pending.enqueueTime = enqueueTime > 0 ? enqueueTime : monotonicTime();
+    pending.writeTime = 0;
+    pending.deadline = lifetime < 0 ? -1 : pending.queued + lifetime;
+    pending.key = supersedeKey;
+    pending.ticket = ticket;
+    return transmitFrame(pending);
+}
+
+bool XBee::transmitFrame(const PendingFrame &pending)
+{
+    if(m_recovering || m_synchronizing) {
+        if(m_recoveryPolicy == FailPending) {
+            qDebug() << Q_FUNC_INFO << "Link down, frame dropped";
+            m_pendingWrites.remove(pending.frameId);
+            m_frameIds.release(pending.frameId);
+            if(pending.ticket != 0) {
+                emit sendCompleted(pending.ticket, false);
+            }
+            return false;
+        }
+        m_held.append(pending);
+        return true;
+    }
+
+    if(m_association == Disassociated && m_associationHoldTimeout != 0 && isDataFrame(pending.frame)) {
+        qDebug() << Q_FUNC_INFO << "Disassociated, data frame held";
+        m_heldData.append(pending);
+        return true;
+    }
+
+    if(!pending.key.isEmpty() && supersedeFrame(pending)) {
+        return true;
+    }
+
+    enqueueFrame(pending);
+    writeQueuedFrames();
+    return true;
+}
+
+bool XBee::supersedeFrame(const PendingFrame &pending)
+{
+    QList<PendingFrame> * queue = &m_txQueue;
+    const QByteArray destination = destinationOf(pending.frame);
+
+    if(!destination.isEmpty()) {
+        if(!m_destinations.contains(destination)) {
+            return false;
+        }
+        queue = &m_destinations[destination].frames;
+    }
+
+    for(int i=0; i<queue->size(); i++) {
+        if(queue->at(i).key == pending.key) {
+            qDebug() << Q_FUNC_INFO << "Frame" << queue->at(i).frameId << "superseded by" << pending.frameId;
+            dropFrame(queue->at(i));
+            (*queue)[i] = pending;
+            return true;
+        }
+    }
+    return false;
+}
+
+void XBee::enqueueFrame(const PendingFrame &pending)
+{
+    const QByteArray destination = destinationOf(pending.frame);
+
+    if(destination.isEmpty()) {
+        m_txQueue.append(pending);
+        return;
+    }
+
+    evictIdleDestinations(pending.queued);
+    Destination & d = m_destinations[destination];
+    if(d.frames.isEmpty()) {
+        m_activeDestinations.append(destination);
+    }
+    d.frames.append(pending);
+}
+
+void XBee::writeQueuedFrames()
+{
+    const qint32 baudRate = deviceBaudRate();
+    PendingFrame pending;
+
+    // flush() may emit bytesWritten(), connected to this slot: the outer call goes on writing
+    if(m_writingFrames || !xbeeFound || m_recovering || m_synchronizing || !m_device || !m_device->isOpen()) {
+        return;
+    }
+
+    m_writingFrames = true;
+    forever {
+        const qint64 now = m_clock.elapsed();
+        qint64 wakeUp = -1;
+
+        // Wait for the previous frame to leave the UART: the queues, not the driver, hold the backlog
+        if(m_device->bytesToWrite() > 0) {
+            break;
+        }
+        if(now < m_txBusyUntil) {
+            m_txTimer.start(m_txBusyUntil - now);
+            break;
+        }
+        if(!takeNextFrame(&pending, now, &wakeUp)) {
+            // Nothing can be sent now: wake up for a destination to probe or a frame to expire
+            if(wakeUp >= 0) {
+                m_txTimer.start(qMax((qint64)0, wakeUp - now));
+            }
+            break;
+        }
+
+        const QByteArray encoded = encodeFrame(pending.frame);
+
+        qDebug() << Q_FUNC_INFO << "Transmit: " << QString("0x").append(pending.frame.toHex());
+        pending.writeTime = monotonicTime();
+        if(pending.frameId != 0) {
+            pending.written = now;
+            m_inFlight.append(pending);
+            if(!m_frameTimer.isActive() && m_frameTimeout > 0) {
+                m_frameTimer.start(m_frameTimeout);
+            }
+        }
+        // 10 bits per byte on the wire (8N1), set before writing: the write may call back into this slot
+        if(baudRate > 0) {
+            m_txBusyUntil = now + (encoded.size() * 10000 + baudRate - 1) / baudRate;
+        }
+        m_device->write(encoded);
+        flushDevice();
+        if(Q_UNLIKELY(FrameTracer::isEnabled())) {
+            FrameTracer::record(FrameTracer::Enqueue, pending.frame, pending.enqueueTime, pending.writeTime, pending.ticket);
+            FrameTracer::record(FrameTracer::Write, pending.frame, pending.writeTime, monotonicTime(), pending.ticket);
+        }
+
+        // Without frame id, no response will come: the frame is done once written
+        if(pending.frameId == 0 && pending.ticket != 0) {
+            emit frameTimestamps(0, pending.ticket, pending.enqueueTime, pending.writeTime, pending.writeTime);
+            emit sendCompleted(pending.ticket, true);
+        }
+    }
+    m_writingFrames = false;
+}
+
+/**
+ * @brief Queues the frames posted by XBee::post(), in the XBee's thread.
+ */
+void XBee::drainSubmissions()
+{
+    Submission submission;
+
+    // Cleared first: a frame posted while draining schedules a new call
+    m_drainScheduled.storeRelease(0);
+
+    while(m_submissions.pop(&submission)) {
+        if(!(xbeeFound && m_device && m_device->isOpen()) && !m_recovering) {
+            qDebug() << "XBEE: Cannot write to Serial Port" << (m_device ? devicePortName() : QString());
+            emit sendCompleted(submission.ticket, false);
+            continue;
+        }
+
+        const quint8 frameId = submission.mode == NoStatus ? 0 : nextFrameId();
+        if(submission.mode != NoStatus && frameId == 0) {
+            emit sendCompleted(submission.ticket, false);
+            continue;
+        }
+        submission.frame.setFrameId(frameId);
+        if(frameId != 0 && !submission.write.isEmpty()) {
+            m_pendingWrites.insert(frameId, submission.write);
+        }
+        // A frame failing there is reported by queueFrame() itself
+        if(!queueFrame(frameId, submission.frame.frame(), submission.lifetime, submission.key, submission.ticket, submission.posted)) {
+            m_pendingWrites.remove(frameId);
+        }
+    }
+}
+
+bool XBee::takeNextFrame(PendingFrame *pending, const qint64 now, qint64 *wakeUp)
+{
+    Q_ASSERT(pending);
+    Q_ASSERT(wakeUp);
+
+    // Local frames (AT commands...) first, they don't use the air
+    while(!m_txQueue.isEmpty()) {
+        if(isExpired(m_txQueue.first(), now)) {
+            dropFrame(m_txQueue.takeFirst());
+            continue;
+        }
+        *pending = m_txQueue.takeFirst();
+        return true;
+    }
+
+    // Data frames queued before a disassociation wait for the association, remote AT commands are never held
+    const bool holding = m_association == Disassociated && m_associationHoldTimeout != 0;
+    // Don't fill the XBee's buffer with data frames it can't transmit yet
+    if(m_transmitWindow > 0 && inFlightDataCount() >= m_transmitWindow) {
+        return false;
+    }
+
+    // Deficit round robin among the destinations: each one sends up to DrrQuantum bytes per round
+    for(int visits = 2*m_activeDestinations.size() + 1; visits > 0 && !m_activeDestinations.isEmpty(); visits--) {
+        if(m_drrIndex >= m_activeDestinations.size()) {
+            m_drrIndex = 0;
+        }
+        const QByteArray destination = m_activeDestinations.at(m_drrIndex);
+        Destination & d = m_destinations[destination];
+        const bool open = d.failures >= BreakerThreshold;
+
+        // A destination which keeps failing only times out its frames in the background
+        while(!d.frames.isEmpty() && (isExpired(d.frames.first(), now) ||
+                                      (open && m_frameTimeout > 0 && now - d.frames.first().queued >= m_frameTimeout))) {
+            dropFrame(d.frames.takeFirst());
+        }
+
+        if(d.frames.isEmpty()) {
+            m_activeDestinations.removeAt(m_drrIndex);
+            d.deficit = 0;
+            m_drrFresh = true;
+            if(d.failures == 0) {
+                m_destinations.remove(destination);
+            }
+            continue;
+        }
+
+        if(holding && isDataFrame(d.frames.first().frame)) {
+            m_drrIndex++;
+            m_drrFresh = true;
+            continue;
+        }
+
+        if(open && (d.probe != 0 || now < d.retryAt)) {
+            if(d.probe == 0) {
+                *wakeUp = *wakeUp < 0 ? d.retryAt : qMin(*wakeUp, d.retryAt);
+            }
+            if(m_frameTimeout > 0) {
+                const qint64 expiry = d.frames.first().queued + m_frameTimeout;
+                *wakeUp = *wakeUp < 0 ? expiry : qMin(*wakeUp, expiry);
+            }
+            m_drrIndex++;
+            m_drrFresh = true;
+            continue;
+        }
+
+        if(m_drrFresh) {
+            d.deficit += DrrQuantum;
+            m_drrFresh = false;
+        }
+        if(d.frames.first().frame.size() > d.deficit) {
+            m_drrIndex++;
+            m_drrFresh = true;
+            continue;
+        }
+
+        *pending = d.frames.takeFirst();
+        d.deficit -= pending->frame.size();
+        if(open) {
+            // Half-open: this frame probes the destination
+            qDebug() << Q_FUNC_INFO << "Probing destination" << destination.toHex();
+            d.probe = pending->frameId;
+            if(d.probe == 0) {
+                d.retryAt = now + breakerDelay(d.opens);
+            }
+        }
+        if(d.frames.isEmpty()) {
+            m_activeDestinations.removeAt(m_drrIndex);
+            d.deficit = 0;
+            m_drrFresh = true;
+        }
+        return true;
+    }
+    return false;
+}
+
+bool XBee::isExpired(const PendingFrame &pending, const qint64 now)
 {
-    return m_mode;
+    if(pending.deadline >= 0 && now > pending.deadline) {
+        qDebug() << Q_FUNC_INFO << "Frame" << pending.frameId << "expired" << now - pending.deadline << "ms ago, dropped";
+        return true;
+    }
+    return false;
 }
 
-//_________________________________________________________________________________________________
-//___________________________________________PRIVATE API___________________________________________
-//_________________________________________________________________________________________________
-void XBee::readData()
+QList<XBee::PendingFrame> XBee::takeQueuedFrames()
 {
-    unsigned startDelimiter = 0x7E;
+    QList<PendingFrame> frames = m_txQueue;
+
+    m_txQueue.clear();
+    foreach(const QByteArray & destination, m_activeDestinations) {
+        Destination & d = m_destinations[destination];
+        frames.append(d.frames);
+        d.frames.clear();
+        d.deficit = 0;
+        d.probe = 0;
+    }
+    m_activeDestinations.clear();
+    m_drrIndex = 0;
+    m_drrFresh = true;
+    return frames;
+}
 
-    QByteArray data = m_serial->readAll();
-    QByteArray packet;
-    buffer.append(data);
+void XBee::recordDelivery(const PendingFrame &pending, const bool delivered)
+{
+    const QByteArray destination = destinationOf(pending.frame);
+    const qint64 now = m_clock.elapsed();
 
-    if(m_mode == CommandMode) {
-        if(buffer.endsWith(13)) {
-            emit rawDataReceived(buffer);
-            buffer.clear();
-        }
+    evictIdleDestinations(now);
+    if(destination.isEmpty() || (delivered && !m_destinations.contains(destination))) {
+        return;
     }
-    else {
 
-        while(!buffer.isEmpty() && (unsigned char)buffer.at(0) != (unsigned char)startDelimiter) {
-            buffer.remove(0, 1);
+    Destination & d = m_destinations[destination];
+    if(d.probe != 0 && d.probe == pending.frameId) {
+        d.probe = 0;
+    }
+    if(delivered) {
+        if(d.failures >= BreakerThreshold) {
+            qDebug() << Q_FUNC_INFO << "Destination" << destination.toHex() << "is reachable again";
         }
-        if(buffer.size() > 2) {
-            unsigned length = buffer.at(2)+4;
-            if((unsigned char)buffer.size() >= (unsigned char)length) {
-                packet.append(buffer.left(length));
-                qDebug() << Q_FUNC_INFO << QString("0x").append(packet.toHex());
-                processPacket(packet, true);
-                buffer.remove(0, length);
-            }
+        d.failures = 0;
+        d.opens = 0;
+        if(d.frames.isEmpty()) {
+            m_destinations.remove(destination);
         }
+        return;
+    }
+
+    d.failures++;
+    d.lastFailure = now;
+    if(d.failures >= BreakerThreshold) {
+        d.retryAt = now + breakerDelay(d.opens);
+        d.opens++;
+        qDebug() << Q_FUNC_INFO << "Destination" << destination.toHex() << "failed" << d.failures << "times, backing off"
+                 << d.retryAt - now << "ms";
     }
 }
 
-XBeeResponse * XBee::processPacket(QByteArray packet, const bool async)
+/**
+ * @brief Forgets the idle destinations which haven't failed for BreakerMaxDelay, at most once per BreakerBaseDelay.
+ *
+ * Without frames, a destination is only kept for its failure count and back off; past the longest back off,
+ * a new frame would probe it anyway.
+ */
+void XBee::evictIdleDestinations(const qint64 now)
 {
-    unsigned packetType = (unsigned char)packet.at(3);
+    if(now - m_lastEviction < BreakerBaseDelay) {
+        return;
+    }
+    m_lastEviction = now;
 
-    switch (packetType) {
-    /********************** WPAN **********************/
-    case XBeePacket::Rx16ResponseId : {
-        Wpan::RxResponse16 * response = new Wpan::RxResponse16();
-        response->setPacket(packet);
-        if(async) {
-            emit receivedRxResponse16(response);
-            response->deleteLater();
+    QHash<QByteArray, Destination>::iterator it = m_destinations.begin();
+    while(it != m_destinations.end()) {
+        if(it->frames.isEmpty() && it->probe == 0 && now >= it->retryAt && now - it->lastFailure >= BreakerMaxDelay) {
+            it = m_destinations.erase(it);
         }
         else {
-            return response;
+            ++it;
         }
-        break;
     }
-    case XBeePacket::Rx64ResponseId : {
-        Wpan::RxResponse64 * response = new Wpan::RxResponse64();
-        response->setPacket(packet);
-        if(async) {
-            emit receivedRxResponse64(response);
-            response->deleteLater();
+}
+
+int XBee::breakerDelay(const int opens)
+{
+    return qMin(BreakerMaxDelay, BreakerBaseDelay << qMin(opens, 6));
+}
+
+QByteArray XBee::destinationOf(const QByteArray &frame)
+{
+    static const char Unknown64[] = "\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF";
+
+    switch(frame.size() > 3 ? (quint8)frame.at(3) : XBeePacket::UndefinedId) {
+    case XBeePacket::TxRequest16Id :
+        return frame.size() > 6 ? QByteArray("S").append(frame.mid(5, 2)) : QByteArray();
+    case XBeePacket::TxRequest64Id :
+        return frame.size() > 12 ? QByteArray("L").append(frame.mid(5, 8)) : QByteArray();
+    case XBeePacket::ZBTxRequestId :
+    case XBeePacket::ZBExplicitTxRequestId :
+    case XBeePacket::RemoteATCommandRequestId :
+        if(frame.size() <= 14) {
+            return QByteArray();
         }
-        else {
-            return response;
+        // Unknown 64-bit address: the frame is addressed by its 16-bit address
+        if(frame.mid(5, 8) == QByteArray(Unknown64, 8)) {
+            return QByteArray("S").append(frame.mid(13, 2));
         }
-        break;
+        return QByteArray("L").append(frame.mid(5, 8));
+    default:
+        return QByteArray();
     }
-    case XBeePacket::TxStatusResponseId : {
-        Wpan::TxStatusResponse * response = new Wpan::TxStatusResponse();
-        response->setPacket(packet);
-        if(async) {
-            emit receivedTransmitStatus(response);
-            response->deleteLater();
-        }
-        else {
-            return response;
-        }
-        break;
+}
+
+void XBee::dropFrame(const PendingFrame &pending)
+{
+    if(pending.frameId != 0) {
+        m_pendingWrites.remove(pending.frameId);
+        m_frameIds.release(pending.frameId);
+        emit frameFailed(pending.frameId);
     }
-    /********************** QtXBee **********************/
-    case XBeePacket::ATCommandResponseId : {
-        ATCommandResponse *response = new ATCommandResponse(packet);
-        if(async) {
-            processATCommandRespone(response);
-            response->deleteLater();
-        }
-        else {
-            return response;
-        }
-        break;
+    if(pending.ticket != 0) {
+        emit sendCompleted(pending.ticket, false);
     }
-    case XBeePacket::ModemStatusResponseId : {
-        ModemStatus *response = new ModemStatus(packet);
-        if(async) {
-            emit receivedModemStatus(response);
-            response->deleteLater();
-        }
-        else {
-            return response;
+}
+
+int XBee::inFlightDataCount() const
+{
+    int count = 0;
+
+    foreach(const PendingFrame & pending, m_inFlight) {
+        if(isDataFrame(pending.frame)) {
+            count++;
         }
-        break;
     }
-    case XBeePacket::RemoteATCommandResponseId : {
-        RemoteATCommandResponse *response = new RemoteATCommandResponse(packet);
-        if(async) {
-            emit receivedRemoteCommandResponse(response);
-            response->deleteLater();
-        }
-        else {
-            return response;
+    return count;
+}
+
+bool XBee::completeFrame(const QByteArray &frame, const qint64 timestamp)
+{
+    const quint8 frameId = responseFrameId(frame);
+
+    for(int i=0; frameId != 0 && i<m_inFlight.size(); i++) {
+        if(m_inFlight.at(i).frameId == frameId) {
+            const PendingFrame pending = m_inFlight.takeAt(i);
+            const bool delivered = isDelivered(frame);
+            recordDelivery(pending, delivered);
+            m_frameIds.release(frameId);
+            if(Q_UNLIKELY(FrameTracer::isEnabled())) {
+                FrameTracer::record(FrameTracer::Status, frame, pending.writeTime, timestamp, pending.ticket);
+            }
+            emit frameTimestamps(frameId, pending.ticket, pending.enqueueTime, pending.writeTime, timestamp);
+            if(pending.ticket != 0) {
+                emit sendCompleted(pending.ticket, delivered);
+            }
+            // A slot of the transmit window is free
+            queueCall("writeQueuedFrames");
+            return true;
         }
-        break;
     }
-    /********************** ZigBee **********************/
-    case XBeePacket::ZBTxStatusResponseId : {
-        ZBTxStatusResponse *response = new ZBTxStatusResponse(this);
-        response->readPacket(packet);
-        if(async) {
-            emit receivedTransmitStatus(response);
-        }
-        else {
-            return response;
-        }
-        break;
+    return false;
+}
+
+/**
+ * @brief Returns the frame id of the given response (AT command, remote AT command, transmit status); 0 for other frames.
+ */
+quint8 XBee::responseFrameId(const QByteArray &frame)
+{
+    if(frame.size() <= 4) {
+        return 0;
     }
-    case XBeePacket::ZBRxResponseId : {
-        ZBRxResponse *response = new ZBRxResponse(this);
-        response->readPacket(packet);
-        if(async) {
-            emit receivedRxIndicator(response);
-        }
-        else {
-            return response;
-        }
-        break;
+
+    switch((quint8)frame.at(3)) {
+    case XBeePacket::TxStatusResponseId :
+    case XBeePacket::ATCommandResponseId :
+    case XBeePacket::RemoteATCommandResponseId :
+    case XBeePacket::ZBTxStatusResponseId :
+        return (quint8)frame.at(4);
+    default:
+        return 0;
     }
-    case XBeePacket::ZBExplicitRxResponseId : {
-        ZBExplicitRxResponse *response = new ZBExplicitRxResponse(this);
-        response->readPacket(packet);
-        if(async) {
-            emit receivedRxIndicatorExplicit(response);
-        }
-        else {
-            return response;
-        }
-        break;
+}
+
+bool XBee::isDelivered(const QByteArray &frame)
+{
+    switch((quint8)frame.at(3)) {
+    case XBeePacket::TxStatusResponseId :
+        return frame.size() > 5 && frame.at(5) == 0;
+    case XBeePacket::ZBTxStatusResponseId :
+        return frame.size() > 8 && frame.at(8) == 0;
+    case XBeePacket::RemoteATCommandResponseId :
+        // Status 4: remote command transmission failed
+        return frame.size() <= 17 || frame.at(17) != 4;
+    default:
+        return true;
     }
-    case XBeePacket::ZBIONodeIdentificationId : {
-        ZBIONodeIdentificationResponse *response = new ZBIONodeIdentificationResponse(this);
-        response->setPacket(packet);
-        if(async) {
-            emit receivedNodeIdentificationIndicator(response);
-        }
-        else {
-            return response;
-        }
-        break;
+}
+
+void XBee::replayPending()
+{
+    QList<PendingFrame> pending = m_inFlight;
+
+    pending.append(takeQueuedFrames());
+    pending.append(m_held);
+    m_inFlight.clear();
+    m_held.clear();
+
+    if(!pending.isEmpty()) {
+        qDebug() << Q_FUNC_INFO << "Replaying" << pending.size() << "frame(s)";
     }
+    for(int i=0; i<pending.size(); i++) {
+        transmitFrame(pending.at(i));
+    }
+}
+
+void XBee::failPending()
+{
+    QList<PendingFrame> pending = m_inFlight;
+
+    pending.append(takeQueuedFrames());
+    pending.append(m_held);
+    m_inFlight.clear();
+    m_held.clear();
+
+    for(int i=0; i<pending.size(); i++) {
+        dropFrame(pending.at(i));
+    }
+}
+
+bool XBee::isDataFrame(const QByteArray &frame)
+{
+    switch(frame.size() > 3 ? (quint8)frame.at(3) : XBeePacket::UndefinedId) {
+    case XBeePacket::TxRequest64Id :
+    case XBeePacket::TxRequest16Id :
+    case XBeePacket::ZBTxRequestId :
+    case XBeePacket::ZBExplicitTxRequestId :
+        return true;
     default:
-        qDebug() << Q_FUNC_INFO << qPrintable(QString("Error: Unknown or Unhandled Packet (type=%1): 0x%2").
-                                              arg(packetType,0,16).
-                                              arg(QString(packet.toHex())));
+        return false;
     }
-    return NULL;
 }
 
-void XBee::processATCommandRespone(ATCommandResponse *rep) {
-    Q_ASSERT(rep);
-    ATCommand::ATCommandType at = rep->atCommand();
-    QByteArray data = rep->data().toHex();
-    quint32 dataInt = QString(data).toInt(0, 16);
+void XBee::setAssociationState(const AssociationState state)
+{
+    if(state == m_association) {
+        return;
+    }
 
-    qDebug() << Q_FUNC_INFO << "AT command" << ATCommand::atCommandToString(at) << QString("0x%1").arg(at , 0, 16) << " : " << data << dataInt;
+    qDebug() << "XBEE: Association state" << m_association << "->" << state;
+    m_association = state;
+    emit associationChanged(state);
 
-    switch(at) {
-    // Addressing
-    case ATCommand::ATDH : m_dh = dataInt; emit DHChanged(m_dh); break;
-    case ATCommand::ATDL : m_dl = dataInt; emit DLChanged(m_dl); break;
-    case ATCommand::ATMY : m_my = dataInt; emit MYChanged(m_my); break;
-    case ATCommand::ATMP : m_mp = dataInt; emit MPChanged(m_mp); break;
-    case ATCommand::ATNC : m_nc = dataInt; emit NCChanged(m_nc); break;
-    case ATCommand::ATSH : m_sh = dataInt; emit SHChanged(m_sh); break;
-    case ATCommand::ATSL : m_sl = dataInt; emit SLChanged(m_sl); break;
-    case ATCommand::ATNI : m_ni = data; emit NIChanged(m_ni); break;
-    case ATCommand::ATSE : m_se = dataInt; emit SEChanged(m_se); break;
-    case ATCommand::ATDE : m_de = dataInt; emit DEChanged(m_de); break;
-    case ATCommand::ATCI : m_ci = dataInt; emit CIChanged(m_ci); break;
-    case ATCommand::ATTO : m_to = dataInt; emit TOChanged(m_to); break;
-    case ATCommand::ATNP : m_np = dataInt; emit NPChanged(m_np); break;
-    case ATCommand::ATDD : m_dd = dataInt; emit DDChanged(m_dd); break;
-    case ATCommand::ATCR : m_cr = dataInt; emit CRChanged(m_cr); break;
-
-    case ATCommand::ATND : {
-        RemoteNode * node = NULL;
-        NodeDiscoveryResponseParser nd;
-        if((node = nd.parseData(rep->data())) != NULL) {
-            node->setParent(this);
-            qDebug() << "Discovered node :" << qPrintable(node->toString());
-        }
+    if(state != Disassociated) {
+        releaseHeldData();
+    }
+}
 
-        break;
+void XBee::releaseHeldData()
+{
+    QList<PendingFrame> held;
+
+    dropHeldData(false);
+    held = m_heldData;
+    m_heldData.clear();
+
+    if(!held.isEmpty()) {
+        qDebug() << Q_FUNC_INFO << "Releasing" << held.size() << "data frame(s)";
     }
-    default:
-        qWarning() << Q_FUNC_INFO << "Unhandled AT command" <<  QString("0x%1 (%2)").arg(at , 0, 16).arg(ATCommand::atCommandToString(at));
+    for(int i=0; i<held.size(); i++) {
+        transmitFrame(held.at(i));
     }
-    emit receivedATCommandResponse(rep);
 }
 
-bool XBee::startupCheck()
+void XBee::dropHeldData(const bool all)
 {
-    return true;
-    bool bRet = false;
-    ATCommand at;
-    ATCommandResponse * rep = NULL;
-    QString errorStr;
-    Mode currentMode;
+    const qint64 now = m_clock.elapsed();
 
-    qDebug() << "****************** XBEE CONFIGURATION CHECKUP ******************";
-    if(xbeeFound)
-    {
-        // Go in command mode
-        if(enterInCommandMode()) {
-            QByteArray r;
-            r = synchronousCmd(QByteArray("ATAP").append(0x0d));
-            if(!r.isEmpty()) {
-                currentMode = (Mode) r.toInt();
-                if(currentMode != API1Mode) {
-                    qDebug() << "XBee radio is not in API mode without escape characters (AP=1). Try to set AP=1";
-                    r = synchronousCmd(QByteArray("ATAP1").append(0x0d));
-                    if(r == "OK") {
-                        errorStr = "OK";
-                    }
-                    errorStr = "KO (Failed to set AP=1)";
-                }
-                else {
-                    errorStr = "OK";
-                }
-            }
-            else {
-                errorStr = "KO (No response to AP command";
-            }
+    for(int i=0; i<m_heldData.size();) {
+        const PendingFrame & pending = m_heldData.at(i);
+        if(all || (m_associationHoldTimeout > 0 && now - pending.queued > m_associationHoldTimeout)
+                || (pending.deadline >= 0 && now > pending.deadline)) {
+            dropFrame(m_heldData.takeAt(i));
         }
         else {
-            errorStr = "KO (Failed to enter in command mode)";
-        }
-        exitCommandMode();
-        // Check AP mode
-//        at.setCommand("AP");
-//        rep = sendATCommandSync(&at);
-//        if(rep)
-//        {
-//            if(rep->commandStatus() == ATCommandResponse::Ok) {
-//                bool ok = false;
-//                currentMode = (Mode)rep->data().toHex().toInt(&ok,16);
-//                if(ok) {
-//                    if(currentMode != API1Mode) {
-//                        qDebug() << Q_FUNC_INFO << "XBee radio is not in API mode without escape characters (AP=1). Try to set AP=1";
-//                        at.clear();
-//                        at.setCommand("AP");
-//                        at.setParameter("1");
-//                        at.assemblePacket();
-//                        if(currentMode == 2) at.escapePacket();
-//                        delete rep;
-//                        rep = sendATCommandSync(&at);
-//                        if(currentMode == 2) at.unescapePacket();
-//                        if(rep) {
-//                            if(rep->commandStatus() == ATCommandResponse::Ok) {
-//                                errorStr = "OK";
-//                                bRet = true;
-//                                delete rep;
-//                                rep = NULL;
-//                            }
-//                            else {
-//                                errorStr = QString("KO (Failed to set AP=1, %1)").arg(rep->statusToString(rep->commandStatus()));
-//                                qDebug() << Q_FUNC_INFO << "rep" << rep->packet().toHex();
-//                            }
-//                        }
-//                        else {
-//                            errorStr = "KO (No response to AP command)";
-//                        }
-//                    }
-//                    else {
-//                        errorStr = "OK";
-//                        bRet = true;
-//                    }
-//                }
-//                else {
-//                    errorStr = "KO (Failed to get AP parameter)";
-//                }
-//            }
-//            else {
-//                errorStr = "KO (AP command failed)";
-//            }
-//        }
-//        else
-//        {
-//            errorStr = "KO (No response to AP command)";
-//        }
-        qDebug() << "XBEE: Startup check :" << "XBee in API mode (AP=1) :" << qPrintable(errorStr);
-
-        // Check HardWare Rev
-        at.clear();
-        at.setCommand("HV");
-        rep = sendATCommandSync(&at);
-        if(rep)
-        {
-            if(rep->status() == ATCommandResponse::Ok) {
-                bool ok = false;
-                int hv = rep->data().left(1).toHex().toInt(&ok,16);
-                if(ok) {
-                    if(hv == QtXBee::XBeeSerie1 || hv == QtXBee::XBeeSerie1Pro) {
-                        errorStr = QString("OK (0x%1)").arg(QString(rep->data().toHex()));
-                        bRet &= true;
-                    }
-                    else {
-                        errorStr = QString("KO (Unsuported hardware version 0x%1)").arg(QString(rep->data().toHex()));
-                        bRet = false;
-                    }
-                }
-                else {
-                    errorStr = "KO (Failed to retreive HV parameter from received response)";
-                    bRet = false;
-                }
-            }
-            else {
-                errorStr = "KO (HV command failed)";
-                bRet = false;
-            }
-        }
-        else
-        {
-            errorStr = "KO (No response to HV command)";
-            bRet = false;
+            i++;
         }
+    }
+}
 
+void XBee::rememberConfiguration(const XBeeProfile &profile)
+{
+    if(&profile == &m_configuration) {
+        return;
     }
-    if(rep) {
-        delete rep;
+    foreach(const ATCommand::ATCommandType param, profile.parameters()) {
+        m_configuration.setValue(param, profile.value(param));
     }
-    qDebug() << "XBEE: Startup check :" << "XBee Serie 1/1Pro       :" << qPrintable(errorStr);
-    qDebug() << "*****************************************************************";
-    return bRet;
 }
 
-QByteArray XBee::synchronousCmd(QByteArray cmd)
+bool XBee::setDeviceBaudRate(const qint32 baudRate)
 {
-    QByteArray rep;
-    m_serial->blockSignals(true);
-    m_serial->write(cmd);
-    m_serial->flush();
-    while(m_serial->waitForReadyRead(10))
-        rep.append(m_serial->readAll());
-
-    m_serial->blockSignals(false);
-
-    if(!rep.isEmpty()) {
-    if(rep.at(rep.size()-1) == 0x0D)
-        rep.remove(rep.size()-1, 1);
+#ifdef Q_OS_LINUX
+    if(m_transport) {
+        return m_transport->setBaudRate(baudRate);
     }
-    return rep;
+#endif
+    return m_serial && m_serial->setBaudRate(baudRate);
 }
 
-bool XBee::enterInCommandMode()
+qint32 XBee::deviceBaudRate() const
 {
-    bool bRet = false;
-    QByteArray rep;
+#ifdef Q_OS_LINUX
+    if(m_transport) {
+        return m_transport->baudRate();
+    }
+#endif
+    return m_serial ? m_serial->baudRate() : 0;
+}
 
-    m_serial->blockSignals(true);
-    m_serial->write("+++");
-    m_serial->flush();
-    while(m_serial->waitForReadyRead(2000))
-        rep.append(m_serial->readAll());
-    m_serial->blockSignals(false);
-    if(rep == QByteArray("OK").append(0x0D)) {
-        bRet = true;
-        qDebug() << "XBee entering in command mode ...";
-        QThread::sleep(2);
+QString XBee::devicePortName() const
+{
+#ifdef Q_OS_LINUX
+    if(m_transport) {
+        return m_transport->portName();
     }
-    else {
-        qWarning() << "XBee failed to enter in Command Mode (" << rep << ")";
+#endif
+    return m_serial ? m_serial->portName() : QString();
+}
+
+bool XBee::flushDevice()
+{
+#ifdef Q_OS_LINUX
+    if(m_transport) {
+        return m_transport->flush();
     }
-    return bRet;
+#endif
+    return m_serial && m_serial->flush();
 }
 
-bool XBee::exitCommandMode()
+bool XBee::clearDevice()
 {
-    QByteArray rep;
-    rep = synchronousCmd(QByteArray("ATCN").append(0x0D));
-    if(rep == "OK")
-        qDebug() << "XBee exiting from command mode ...";
-    else
-        qDebug() << "XBee failed to exit from command mode";
-    return rep == "OK";
+#ifdef Q_OS_LINUX
+    if(m_transport) {
+        return m_transport->clear();
+    }
+#endif
+    return m_serial && m_serial->clear();
 }
 
 } // END namepsace
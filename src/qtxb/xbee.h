@@ -22,15 +22,32 @@
 #define XBEE_H
 
 #include <QObject>
+#include <QHash>
+#include <QElapsedTimer>
+#include <QPointer>
+#include <QVector>
 #include <QtSerialPort/QSerialPort>
 #include <QtSerialPort/QSerialPortInfo>
 
+#include <type_traits>
+
+#include "ATCommand"
+#include "FrameDecoder"
+#include "FrameIdAllocator"
+#include "FrameFilter"
+#include "FrameRing"
+#include "FrameTemplate"
+#include "MpscQueue"
+#include "WheelTimer"
+#include "CommandModeEngine"
+#include "XBeeProfile"
+
 namespace QtXBee {
 class XBeePacket;
 class XBeeResponse;
 class ATCommandResponse;
-class ATCommand;
 class ModemStatus;
+class LinuxSerialTransport;
 class RemoteATCommandResponse;
 
 namespace Wpan {
@@ -59,6 +76,28 @@ public:
         API2Mode
     };
 
+    enum Transport {
+        QtSerialPortTransport,  /**< QSerialPort (default, all platforms) */
+        LinuxTransport          /**< termios, Linux only (see LinuxSerialTransport) */
+    };
+
+    enum StatusMode {
+        RequestStatus,          /**< The frame gets a frame id, the XBee answers with a response / transmit status */
+        NoStatus                /**< The frame is sent with frame id 0, the XBee doesn't answer */
+    };
+
+    enum RecoveryPolicy {
+        ReplayPending,          /**< Pending frames are sent again, with the same frame id, once the link is recovered */
+        FailPending             /**< Pending frames are dropped and reported with XBee::frameFailed() */
+    };
+
+    enum AssociationState {
+        AssociationUnknown,     /**< Not known yet (startup, reset), frames are not held */
+        Associated,             /**< Associated (or coordinator started), frames are sent */
+        Disassociated           /**< Out of the network, data frames are held */
+    };
+    Q_ENUM(AssociationState)
+
     explicit            XBee                                (QObject *parent = 0);
                         XBee                                (const QString & serialPort, QObject * parent = 0);
                         ~XBee                               ();
@@ -69,14 +108,32 @@ public:
     XBeeResponse *      sendSync                            (XBeePacket * packet);
     ATCommandResponse * sendATCommandSync                   (ATCommand * command);
     ATCommandResponse * sendATCommandSync                   (const QByteArray & atcommand);
+    QList<ATCommandResponse*> sendATCommandsSync            (const QList<ATCommand*> & commands, const int timeout = 1000);
 
     QByteArray          sendCommandSync                     (const QByteArray & command);
-    void                sendAsync                           (XBeePacket * packet);
+    bool                sendAsync                           (XBeePacket * packet, const StatusMode mode = RequestStatus);
+    bool                sendAsync                           (XBeePacket * packet,
+                                                             const int lifetime,
+                                                             const QByteArray & supersedeKey = QByteArray(),
+                                                             const StatusMode mode = RequestStatus);
+    bool                sendAsync                           (FrameTemplate * frameTemplate,
+                                                             const int lifetime = -1,
+                                                             const QByteArray & supersedeKey = QByteArray(),
+                                                             const StatusMode mode = RequestStatus);
+    quint32             post                                (XBeePacket * packet,
+                                                             const int lifetime = -1,
+                                                             const QByteArray & supersedeKey = QByteArray(),
+                                                             const StatusMode mode = RequestStatus);
+    quint32             post                                (const FrameTemplate & frameTemplate,
+                                                             const int lifetime = -1,
+                                                             const QByteArray & supersedeKey = QByteArray(),
+                                                             const StatusMode mode = RequestStatus);
     void                sendATCommandAsync                  (ATCommand *command);
     void                sendATCommandAsync                  (const QByteArray & data);
 
     bool                setMode                             (const Mode mode);
     Mode                mode                                () const;
+    CommandModeEngine * commandModeEngine                   () const;
 
     bool                setSerialPort                       (const QString & serialPort);
     bool                setSerialPort                       (const QString &serialPort,
@@ -90,15 +147,65 @@ public:
                                                              const QSerialPort::Parity parity,
                                                              const QSerialPort::StopBits stopBits,
                                                              const QSerialPort::FlowControl flowControl);
+    bool                setTransport                        (const Transport transport);
+    Transport           transport                           () const;
+    void                setBaudRateNegotiation              (const bool enabled, const qint32 maximum = QSerialPort::Baud115200);
+    qint32              probeBaudRate                       ();
+    void                setAutoRecovery                     (const bool enabled);
+    bool                autoRecovery                        () const;
+    void                setRecoveryPolicy                   (const RecoveryPolicy policy);
+    RecoveryPolicy      recoveryPolicy                      () const;
+    bool                isRecovering                        () const;
+    void                setFrameTimeout                     (const int msecs);
+    int                 frameTimeout                        () const;
+    int                 pendingFrameCount                   () const;
+    int                 queuedFrameCount                    () const;
+    void                setFrameFilter                      (const FrameFilter & filter);
+    FrameFilter         frameFilter                         () const;
+    quint64             filteredFrameCount                  () const;
+    void                setFrameRing                        (FrameRing * ring);
+    FrameRing *         frameRing                           () const;
+    void                setFrameSignalsEnabled              (const bool enabled);
+    bool                frameSignalsEnabled                 () const;
+    bool                setPollMode                         (const bool enabled);
+    bool                isPollMode                          () const;
+    int                 pollDescriptor                      () const;
+    int                 wakeDescriptor                      () const;
+    short               pollEvents                          () const;
+    bool                pump                                ();
+    int                 nextTimeout                         () const;
+    void                setTransmitWindow                   (const int frames);
+    int                 transmitWindow                      () const;
+    AssociationState    associationState                    () const;
+    void                setAssociationPollInterval          (const int msecs);
+    int                 associationPollInterval             () const;
+    void                setAssociationHoldTimeout           (const int msecs);
+    int                 associationHoldTimeout              () const;
+    bool                negotiateBaudRate                   (const qint32 maximum = QSerialPort::Baud115200, const bool persist = true);
+
+    // Parameters
+    template<typename T, typename = typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value>::type>
+    bool                setParameter                        (const ATCommand::ATCommandType param, const T value);
+    bool                setParameter                        (const ATCommand::ATCommandType param, const QByteArray & value);
+    bool                setParameter                        (const ATCommand::ATCommandType param, const QString & value);
+    bool                setParameter                        (const ATCommand::ATCommandType param, const char * value);
+    template<typename T>
+    T                   parameter                           (const ATCommand::ATCommandType param) const;
+    QByteArray          rawParameter                        (const ATCommand::ATCommandType param) const;
+    bool                hasParameter                        (const ATCommand::ATCommandType param) const;
+    bool                loadParameter                       (const ATCommand::ATCommandType param);
+    bool                applyProfile                        (const XBeeProfile & profile,
+                                                             const bool persist = true,
+                                                             QList<ATCommand::ATCommandType> * changed = 0);
 
     // Adressing
     bool                setDH                               (const quint32 dh);
     bool                setDL                               (const quint32 dl);
     bool                setMY                               (const quint16 my);
-    bool                setMP                               (const quint16 mp);
-    bool                setNC                               (const quint32 nc);
-    bool                setSH                               (const quint32 sh);
-    bool                setSL                               (const quint32 sl);
+    Q_DECL_DEPRECATED bool setMP                            (const quint16 mp);
+    Q_DECL_DEPRECATED bool setNC                            (const quint32 nc);
+    Q_DECL_DEPRECATED bool setSH                            (const quint32 sh);
+    Q_DECL_DEPRECATED bool setSL                            (const quint32 sl);
     bool                setNI                               (const QString & ni);
     bool                setSE                               (const quint8 se);
     bool                setDE                               (const quint8 de);
@@ -108,24 +215,25 @@ public:
     bool                setDD                               (const quint16 dd);
     bool                setCR                               (const quint8 cr);
 
-    quint32             DH                                  () const { return m_dh;}
-    quint32             DL                                  () const { return m_dl;}
-    quint16             MY                                  () const { return m_my;}
-    quint16             MP                                  () const { return m_mp;}
-    quint32             NC                                  () const { return m_nc;}
-    quint32             SH                                  () const { return m_sh;}
-    quint32             SL                                  () const { return m_sl;}
-    QString             NI                                  () const { return m_ni;}
-    quint8              SE                                  () const { return m_se;}
-    quint8              DE                                  () const { return m_de;}
-    quint8              CI                                  () const { return m_ci;}
-    quint8              TO                                  () const { return m_to;}
-    quint8              NO                                  () const { return m_np;}
-    quint16             DD                                  () const { return m_dd;}
-    quint8              CR                                  () const {return m_cr;}
+    quint32             DH                                  () const { return parameter<quint32>(ATCommand::ATDH);}
+    quint32             DL                                  () const { return parameter<quint32>(ATCommand::ATDL);}
+    quint16             MY                                  () const { return parameter<quint16>(ATCommand::ATMY);}
+    quint16             MP                                  () const { return parameter<quint16>(ATCommand::ATMP);}
+    quint32             NC                                  () const { return m_nc;} /**< @brief Last NC read: NC is volatile, use NCChanged() to follow it */
+    quint32             SH                                  () const { return parameter<quint32>(ATCommand::ATSH);}
+    quint32             SL                                  () const { return parameter<quint32>(ATCommand::ATSL);}
+    QString             NI                                  () const { return QString(rawParameter(ATCommand::ATNI));}
+    quint8              SE                                  () const { return parameter<quint8>(ATCommand::ATSE);}
+    quint8              DE                                  () const { return parameter<quint8>(ATCommand::ATDE);}
+    quint8              CI                                  () const { return parameter<quint8>(ATCommand::ATCI);}
+    quint8              TO                                  () const { return parameter<quint8>(ATCommand::ATTO);}
+    quint8              NO                                  () const { return parameter<quint8>(ATCommand::ATNP);}
+    quint16             DD                                  () const { return parameter<quint16>(ATCommand::ATDD);}
+    quint8              CR                                  () const { return parameter<quint8>(ATCommand::ATCR);}
 
 signals:
     void                rawDataReceived                     (const QByteArray & data);
+    void                receivedFrames                      (const QVector<QByteArray> & frames);               /**< @brief Emitted once per read with all the received frames, before the per frame signals. @sa XBee::setFrameSignalsEnabled()*/
     void                receivedATCommandResponse           (QtXBee::ATCommandResponse *response);
     void                receivedModemStatus                 (QtXBee::ModemStatus *response);
     void                receivedRemoteCommandResponse       (QtXBee::RemoteATCommandResponse *response);
@@ -136,12 +244,13 @@ signals:
     void                receivedTransmitStatus              (QtXBee::Wpan::TxStatusResponse *response);
     void                receivedRxResponse16                (QtXBee::Wpan::RxResponse16 * response);
     void                receivedRxResponse64                (QtXBee::Wpan::RxResponse64 * response);
+    void                parameterChanged                    (QtXBee::ATCommand::ATCommandType param);          /**< @brief Emitted when a cached parameter changes. @sa XBee::parameter() @sa XBee::setParameter()*/
     // Addressing signals
     void                DHChanged                           (const quint32 dh);                                 /**< @brief Emitted when DH property changes. @sa XBee::setDH() @sa XBee::DH()*/
     void                DLChanged                           (const quint32 dl);                                 /**< @brief Emitted when DL property changes. @sa XBee::setDL() @sa XBee::DL()*/
     void                MYChanged                           (const quint16 my);                                 /**< @brief Emitted when MY property changes. @sa XBee::setMY() @sa XBee::MY()*/
     void                MPChanged                           (const quint16 mp);                                 /**< @brief Emitted when MP property changes. @sa XBee::setMP() @sa XBee::MP()*/
-    void                NCChanged                           (const quint32 nc);                                 /**< @brief Emitted when NC property changes. @sa XBee::setNC() @sa XBee::NC()*/
+    void                NCChanged                           (const quint32 nc);                                 /**< @brief Emitted each time NC is read (NC is volatile, hence not cached). @sa XBee::loadParameter()*/
     void                SHChanged                           (const quint32 sh);                                 /**< @brief Emitted when SH property changes. @sa XBee::setSH() @sa XBee::SH()*/
     void                SLChanged                           (const quint32 sl);                                 /**< @brief Emitted when SL property changes. @sa XBee::setSL() @sa XBee::SL()*/
     void                NIChanged                           (const QString & ni);                               /**< @brief Emitted when NI property changes. @sa XBee::setNI() @sa XBee::NI()*/
@@ -152,6 +261,15 @@ signals:
     void                NPChanged                           (const quint8 np);                                  /**< @brief Emitted when NP property changes. @sa XBee::setNP() @sa XBee::NP()*/
     void                DDChanged                           (const quint16 dd);                                 /**< @brief Emitted when DD property changes. @sa XBee::setDD() @sa XBee::DD()*/
     void                CRChanged                           (const quint8 cr);                                  /**< @brief Emitted when CR property changes. @sa XBee::setCR() @sa XBee::CR()*/
+    // Link recovery signals
+    void                linkLost                            ();                                                 /**< @brief Emitted when the serial link is lost, before reconnecting. @sa XBee::setAutoRecovery()*/
+    void                linkRecovered                       ();                                                 /**< @brief Emitted when the serial link has been recovered and the XBee resynchronized. @sa XBee::setAutoRecovery()*/
+    void                sendCompleted                       (const quint32 ticket, const bool delivered);      /**< @brief Emitted when a frame sent with XBee::post() is acknowledged, written (XBee::NoStatus), or dropped. @sa XBee::post()*/
+    void                frameTimestamps                     (const quint8 frameId, const quint32 ticket,
+                                                             const qint64 enqueued, const qint64 written,
+                                                             const qint64 completed);                           /**< @brief Emitted when a frame is acknowledged, or written (XBee::NoStatus), with its QtXBee::monotonicTime() timestamps. written - enqueued is the time spent in the queues, completed - written the UART and RF time.*/
+    void                frameFailed                         (const quint8 frameId);                             /**< @brief Emitted when a pending frame is dropped (link recovery, association hold timeout, response timeout). @sa XBee::setRecoveryPolicy() @sa XBee::setFrameTimeout()*/
+    void                associationChanged                  (const QtXBee::XBee::AssociationState state);       /**< @brief Emitted when the association state changes. @sa XBee::associationState()*/
 
 public slots:
     void                loadAddressingProperties();
@@ -168,40 +286,219 @@ public slots:
 
 private slots:
     void                readData                            ();
+    void                onDeviceError                       (const QSerialPort::SerialPortError error);
+    void                onRecoveryTimer                     ();
+    void                resync                              ();
+    void                onAssociationTimer                  ();
+    void                onFrameTimer                        ();
+    void                writeQueuedFrames                   ();
+    void                drainSubmissions                    ();
+    void                onCommandLineReceived               (const QByteArray & line);
+    void                onCommandResponse                   (const QByteArray & command, const QByteArray & response);
+    void                onCommandsFinished                  (const bool ok);
 
 private:
-    XBeeResponse *      processPacket                       (QByteArray packet, const bool async);
+    /**
+     * @brief The CommandCheck enum defines the steps of the startup check in command mode
+     */
+    enum CommandCheck {
+        NoCommandCheck,                                     /**< Not running */
+        ReadingAp,                                          /**< ATAP sent */
+        LeavingCommandMode,                                 /**< ATCN sent, AP being 1 or 2 */
+        SettingAp                                           /**< ATAP1,CN sent */
+    };
+
+    struct PendingFrame {
+        quint8          frameId;
+        QByteArray      frame;                              /**< API frame, not escaped */
+        qint64          queued;                             /**< m_clock time when sent by the application, in milliseconds */
+        qint64          written;                            /**< m_clock time when written to the serial port, in milliseconds */
+        qint64          enqueueTime;                        /**< monotonicTime() when sent by the application */
+        qint64          writeTime;                          /**< monotonicTime() when written to the serial port; 0 if not written yet */
+        qint64          deadline;                           /**< m_clock time after which the frame is dropped if not written; -1 if none */
+        QByteArray      key;                                /**< Supersede key; empty if none */
+        quint32         ticket;                             /**< XBee::post() ticket; 0 if none */
+    };
+
+    struct Submission {
+        quint32         ticket;
+        FrameTemplate   frame;                              /**< Assembled by the posting thread */
+        int             lifetime;
+        QByteArray      key;
+        StatusMode      mode;
+        qint64          posted;                             /**< monotonicTime() when posted */
+        QByteArray      write;                              /**< Parameter value written by an AT command, see XBee::writeParameter() */
+    };
+
+    struct Destination {
+        Destination() : deficit(0), failures(0), opens(0), retryAt(0), lastFailure(0), probe(0) {}
+        QList<PendingFrame> frames;                         /**< Queued frames, in sending order */
+        int             deficit;                            /**< Deficit round robin counter, in bytes */
+        int             failures;                           /**< Consecutive delivery failures */
+        int             opens;                              /**< Consecutive back offs, sets the back off delay */
+        qint64          retryAt;                            /**< m_clock time when a backed off destination may be probed */
+        qint64          lastFailure;                        /**< m_clock time of the last delivery failure */
+        quint8          probe;                              /**< Frame id of the probe in flight; 0 if none */
+    };
+
+    void                readDevice                          ();
+    QByteArray          readResponse                        (const quint8 frameId, qint64 * timestamp);
+    void                queueCall                           (const char * method);
+    bool                receiveFrame                        (const QByteArray & frame, const qint64 timestamp);
+    void                deliverFrames                       ();
+    XBeeResponse *      processPacket                       (QByteArray packet, const bool async, const qint64 timestamp = 0);
     void                processATCommandRespone             (ATCommandResponse *rep);
     bool                startupCheck                        ();
-    QByteArray          synchronousCmd                      (QByteArray cmd);
-    bool                enterInCommandMode                  ();
-    bool                exitCommandMode                     ();
+    bool                identify                            ();
+    quint8              nextFrameId                         ();
+    ATCommandResponse * probeATCommand                      (const ATCommand::ATCommandType param, const int timeout);
+    bool                probeApiMode                        (const int timeout);
+    QByteArray          encodeFrame                         (const QByteArray & frame) const;
+    bool                readCommandLine                     (QByteArray * line, const int timeout);
+    bool                setNumericParameter                 (const ATCommand::ATCommandType param, const quint64 value);
+    quint64             numericParameter                    (const ATCommand::ATCommandType param) const;
+    bool                writeParameter                      (const ATCommand::ATCommandType param, const QByteArray & encoded);
+    quint32             submit                              (const FrameTemplate & frameTemplate,
+                                                             const int lifetime,
+                                                             const QByteArray & supersedeKey,
+                                                             const StatusMode mode,
+                                                             const QByteArray & write);
+    void                updateParameter                     (const ATCommand::ATCommandType param, const QByteArray & value);
+    void                createDevice                        (const QString & portName);
+    void                synchronize                         ();
+    void                finishSynchronization               (const bool apiMode);
+    void                cancelCommandCheck                  ();
+    void                restoreSession                      ();
+    void                startRecovery                       ();
+    int                 recoveryDelay                       () const;
+    bool                queueFrame                          (const quint8 frameId, const QByteArray & frame, const int lifetime, const QByteArray & supersedeKey, const quint32 ticket = 0, const qint64 enqueueTime = 0);
+    bool                transmitFrame                       (const PendingFrame & pending);
+    bool                supersedeFrame                      (const PendingFrame & pending);
+    void                enqueueFrame                        (const PendingFrame & pending);
+    bool                takeNextFrame                       (PendingFrame * pending, const qint64 now, qint64 * wakeUp);
+    QList<PendingFrame> takeQueuedFrames                    ();
+    void                recordDelivery                      (const PendingFrame & pending, const bool delivered);
+    void                evictIdleDestinations               (const qint64 now);
+    static bool         isExpired                           (const PendingFrame & pending, const qint64 now);
+    static quint8       responseFrameId                     (const QByteArray & frame);
+    static bool         isDelivered                         (const QByteArray & frame);
+    static int          breakerDelay                        (const int opens);
+    static QByteArray   destinationOf                       (const QByteArray & frame);
+    void                dropFrame                           (const PendingFrame & pending);
+    int                 inFlightDataCount                   () const;
+    bool                completeFrame                       (const QByteArray & frame, const qint64 timestamp);
+    void                replayPending                       ();
+    void                rememberConfiguration               (const XBeeProfile & profile);
+    static bool         isDataFrame                         (const QByteArray & frame);
+    void                setAssociationState                 (const AssociationState state);
+    void                releaseHeldData                     ();
+    void                dropHeldData                        (const bool all);
+    void                failPending                         ();
+    bool                setDeviceBaudRate                   (const qint32 baudRate);
+    qint32              deviceBaudRate                      () const;
+    QString             devicePortName                      () const;
+    bool                flushDevice                         ();
+    bool                clearDevice                         ();
 
 private:
     QSerialPort *       m_serial;
+    LinuxSerialTransport * m_transport;
+    QIODevice *         m_device;                           /**< m_serial or m_transport */
+    Transport           m_transportType;
     bool                xbeeFound;
     Mode                m_mode;
-    QByteArray          buffer;
-    quint16             m_frameIdCounter;
+    FrameDecoder        m_decoder;
+    FrameIdAllocator    m_frameIds;
+    FrameFilter         m_frameFilter;
+    quint64             m_filteredFrameCount;               /**< Received frames dropped by m_frameFilter */
+    QPointer<FrameRing> m_frameRing;                        /**< Receives a copy of every delivered frame; not owned */
+    QVector<QByteArray> m_rxBatch;                          /**< Frames received during the current read */
+    QVector<qint64>     m_rxTimes;                          /**< Receive time of each frame of m_rxBatch */
+    bool                m_frameSignals;
+    MpscQueue<Submission> m_submissions;                    /**< Frames posted by any thread, drained by the XBee's thread */
+    QAtomicInt          m_drainScheduled;                   /**< A drainSubmissions() call is queued */
+    QAtomicInteger<quint32> m_nextTicket;
+    bool                m_pollMode;                         /**< The application polls pollDescriptor() and calls pump() */
+    QAtomicInt          m_wakeFd;                           /**< eventfd written by post() in poll mode; -1 otherwise */
+    QAtomicInt          m_queuedCalls;                      /**< Queued calls to this XBee not run yet, in poll mode */
+    int                 m_frameTimeout;
+    WheelTimer          m_frameTimer;
+    WheelTimer          m_txTimer;
+    qint64              m_txBusyUntil;                      /**< m_clock time when the UART is expected to be idle */
+    bool                m_writingFrames;                    /**< writeQueuedFrames() is running: a re-entrant call returns */
+    int                 m_transmitWindow;
+    int                 m_drrIndex;                         /**< Current destination in m_activeDestinations */
+    bool                m_drrFresh;                         /**< The current destination hasn't got its quantum for this round yet */
+    qint64              m_lastEviction;                     /**< m_clock time of the last evictIdleDestinations() sweep */
+    bool                m_negotiateBaudRate;
+    qint32              m_maxBaudRate;
+    CommandModeEngine * m_commandEngine;
+    bool                m_autoRecovery;
+    RecoveryPolicy      m_recoveryPolicy;
+    AssociationState    m_association;
+    int                 m_associationHoldTimeout;
+    int                 m_associationPollInterval;          /**< ATAI poll interval, in milliseconds; 0 if disabled */
+    WheelTimer          m_associationTimer;
+    QElapsedTimer       m_clock;
+    bool                m_recovering;
+    bool                m_synchronizing;
+    bool                m_resyncing;                        /**< The running synchronization follows a reset, see XBee::resync() */
+    CommandCheck        m_commandCheck;                     /**< Step of the startup check in command mode */
+    int                 m_commandCheckAp;                   /**< AP read in command mode; -1 if none */
+    QElapsedTimer       m_checkClock;                       /**< Started with the startup check, for its log */
+    int                 m_recoveryAttempt;
+    WheelTimer          m_recoveryTimer;
+    quint64             m_identity;                         /**< SH/SL of the synchronized XBee; 0 if unknown */
+    XBeeProfile         m_configuration;                    /**< Parameters written through this object, re-applied after a reset */
 
-    // Adressing
-    quint32             m_dh;
-    quint32             m_dl;
-    quint16             m_my;
-    quint16             m_mp;
-    quint32             m_nc;
-    quint32             m_sh;
-    quint32             m_sl;
-    QString             m_ni;
-    quint8              m_se;
-    quint8              m_de;
-    quint8              m_ci;
-    quint8              m_to;
-    quint8              m_np;
-    quint16             m_dd;
-    quint8              m_cr;
+    QHash<quint16, QByteArray> m_parameters;               /**< Cached parameter values (raw big-endian), by AT command */
+    quint32             m_nc;                               /**< Last NC read, for NC(): volatile, hence not in m_parameters */
+    QHash<quint8, QByteArray>  m_pendingWrites;            /**< Written parameter values waiting for their response, by frame id */
+    QList<PendingFrame>        m_txQueue;                  /**< Local frames (AT commands...) waiting to be written, in sending order */
+    QHash<QByteArray, Destination> m_destinations;         /**< Data frames waiting to be written and delivery health, by destination address */
+    QList<QByteArray>          m_activeDestinations;       /**< Destinations with queued frames, in round robin order */
+    QList<PendingFrame>        m_inFlight;                 /**< Frames written and waiting for their response, in sending order */
+    QList<PendingFrame>        m_held;                     /**< Frames held while the link is recovering, in sending order */
+    QList<PendingFrame>        m_heldData;                 /**< Data frames held while the XBee is disassociated, in sending order */
 };
 
+/**
+ * @brief Sets the given numeric parameter.
+ *
+ * The value is range-checked and encoded in binary big-endian, according to the ATParameter table.
+ * @code
+ * xbee.setParameter(ATCommand::ATCH, 0x0C);
+ * xbee.setParameter(ATCommand::ATMY, quint16(0x1234));
+ * @endcode
+ * @param param the parameter's AT command
+ * @param value the value (integral type)
+ * @return true if the command has been sent; false if the parameter is unknown, read only, if the value is out of range or if the XBee isn't opened.
+ * @sa XBee::parameter()
+ * @sa ATParameter
+ */
+template<typename T, typename>
+bool XBee::setParameter(const ATCommand::ATCommandType param, const T value)
+{
+    return setNumericParameter(param, std::is_signed<T>::value ? (quint64)(qint64)value : (quint64)value);
+}
+
+/**
+ * @brief Returns the last known value of the given numeric parameter.
+ *
+ * The value is updated each time an ATCommandResponse is received for this parameter.
+ * Volatile parameters (ATParameter::isVolatile()) are not cached: read them with XBee::loadParameter() and
+ * XBee::receivedATCommandResponse().
+ * @param param the parameter's AT command
+ * @return the parameter's value; or 0 if unknown.
+ * @sa XBee::loadParameter()
+ * @sa XBee::rawParameter()
+ */
+template<typename T>
+T XBee::parameter(const ATCommand::ATCommandType param) const
+{
+    return static_cast<T>(numericParameter(param));
+}
+
 } //END namespace
 
 #endif
@@ -0,0 +1,512 @@
+/*
+ * Copyright (C) 2015 ThomArmax (Thomas COIN)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * Thomas COIN <esvcorp@gmail.com> 18/04/2015
+ */
+
+
+#ifndef XBEEAWAIT_H
+#define XBEEAWAIT_H
+
+// Coroutines need a C++20 compiler: CONFIG += c++2a (and QMAKE_CXXFLAGS += -fcoroutines with GCC 10)
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+
+#include <QDebug>
+#include <QObject>
+#include <QThread>
+#include <QTimer>
+#include <QVector>
+
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <utility>
+
+#include "XBee"
+#include "ATCommand"
+#include "ATCommandResponse"
+#include "FrameTemplate"
+#include "RemoteATCommandRequest"
+#include "RemoteATCommandResponse"
+#include "WheelTimer"
+
+namespace QtXBee {
+
+/**
+ * @brief Reports an exception nobody can catch any more (thrown by a detached Task) and terminates.
+ */
+[[noreturn]] inline void terminateOnUnhandledException(const std::exception_ptr & exception)
+{
+    try {
+        std::rethrow_exception(exception);
+    }
+    catch(const std::exception & e) {
+        qWarning() << "QtXBee::Task: unhandled exception:" << e.what();
+    }
+    catch(...) {
+        qWarning() << "QtXBee::Task: unhandled exception";
+    }
+    std::terminate();
+}
+
+template<typename T>
+struct TaskResult
+{
+    void return_value(T v) { value = std::move(v); }
+    T take() { return std::move(value); }
+    T value;
+};
+
+template<>
+struct TaskResult<void>
+{
+    void return_void() {}
+    void take() {}
+};
+
+/**
+ * @brief The Task class is the return type of the coroutines awaiting XBee operations.
+ *
+ * The coroutine starts right away and runs until its first co_await, which returns to the caller:
+ * the rest of the coroutine runs from the event loop, as the awaited operations complete.
+ * A Task may be awaited by another coroutine, or dropped: the coroutine then runs on its own until it returns.
+ * An exception escaping the coroutine is rethrown by co_await. If the Task has been dropped, nobody can catch it:
+ * it is reported with qWarning() and terminates the application, as an exception escaping a thread would.
+ * @code
+ * QtXBee::Task<> commission(QtXBee::XBee * xbee)
+ * {
+ *     const QtXBee::CommandResult sh = co_await QtXBee::awaitATCommand(xbee, QtXBee::ATCommand::ATSH);
+ *     const QtXBee::CommandResult sl = co_await QtXBee::awaitATCommand(xbee, QtXBee::ATCommand::ATSL);
+ *     if(!sh.ok || !sl.ok) {
+ *         co_return;
+ *     }
+ *     co_await QtXBee::awaitATCommand(xbee, QtXBee::ATCommand::ATID, QByteArray::fromHex("1234"));
+ *     if(co_await QtXBee::awaitAssociation(xbee, 30000)) {
+ *         ...
+ *     }
+ * }
+ * @endcode
+ * @note T must be default constructible.
+ */
+template<typename T = void>
+class Task
+{
+public:
+    struct promise_type;
+
+    struct FinalAwaiter
+    {
+        bool await_ready() const noexcept { return false; }
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept
+        {
+            promise_type & promise = handle.promise();
+            if(promise.continuation) {
+                return promise.continuation;
+            }
+            if(promise.detached) {
+                handle.destroy();
+            }
+            return std::noop_coroutine();
+        }
+        void await_resume() const noexcept {}
+    };
+
+    struct promise_type : TaskResult<T>
+    {
+        Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_never initial_suspend() noexcept { return std::suspend_never(); }
+        FinalAwaiter final_suspend() noexcept { return FinalAwaiter(); }
+        void unhandled_exception()
+        {
+            if(detached) {
+                terminateOnUnhandledException(std::current_exception());
+            }
+            exception = std::current_exception();
+        }
+
+        std::coroutine_handle<> continuation;   /**< Coroutine awaiting this one; null if none */
+        bool                    detached = false;
+        std::exception_ptr      exception;
+    };
+
+    Task(Task && other) noexcept : m_handle(std::exchange(other.m_handle, nullptr)) {}
+    ~Task()
+    {
+        if(!m_handle) {
+            return;
+        }
+        if(m_handle.done()) {
+            const std::exception_ptr exception = m_handle.promise().exception;
+            m_handle.destroy();
+            if(exception) {
+                // Dropped without being awaited
+                terminateOnUnhandledException(exception);
+            }
+        }
+        else {
+            // Still running: the coroutine frees itself when it returns
+            m_handle.promise().detached = true;
+        }
+    }
+
+    bool isDone() const { return !m_handle || m_handle.done(); }
+
+    bool await_ready() const { return isDone(); }
+    void await_suspend(std::coroutine_handle<> handle) { m_handle.promise().continuation = handle; }
+    T await_resume()
+    {
+        if(m_handle.promise().exception) {
+            std::rethrow_exception(std::exchange(m_handle.promise().exception, nullptr));
+        }
+        return m_handle.promise().take();
+    }
+
+private:
+    explicit Task(std::coroutine_handle<promise_type> handle) : m_handle(handle) {}
+    Task(const Task &) = delete;
+    Task & operator=(const Task &) = delete;
+
+    std::coroutine_handle<promise_type> m_handle;
+};
+
+/**
+ * @brief The result of an awaited AT command, local or remote.
+ */
+struct CommandResult
+{
+    bool                        ok = false;                 /**< True if the response has been received with the Ok status */
+    bool                        timedOut = true;            /**< True if no response has been received */
+    ATCommandResponse::Status   status = ATCommandResponse::Error;
+    QByteArray                  value;                      /**< The returned value (parameter read) */
+};
+
+/**
+ * @brief The XBeeOperation class is the base of the awaitable XBee operations.
+ *
+ * The operation starts when awaited. It completes on its event, on timeout, or when the XBee is destroyed;
+ * the coroutine is then resumed from the event loop, never from within an XBee signal.
+ * The state is shared with the connections, so that a late signal never touches a resumed operation.
+ */
+template<typename R>
+class XBeeOperation
+{
+public:
+    bool await_ready() const { return false; }
+    bool await_suspend(std::coroutine_handle<> handle)
+    {
+        StatePointer state = m_state;
+
+        if(!m_xbee) {
+            return false;
+        }
+        Q_ASSERT_X(QThread::currentThread() == m_xbee->thread(), Q_FUNC_INFO, "XBee operations must be awaited from the XBee's thread");
+
+        state->handle = handle;
+        state->context = new QObject;
+        QObject::connect(m_xbee, &QObject::destroyed, state->context, [state]() { complete(state); });
+        if(m_timeout >= 0) {
+            WheelTimer * timer = new WheelTimer(state->context);
+            timer->setSingleShot(true);
+            QObject::connect(timer, &WheelTimer::timeout, state->context, [state]() { complete(state); });
+            timer->start(m_timeout);
+        }
+
+        if(!start(m_xbee, state)) {
+            // Completed, or failed, without waiting: don't suspend
+            delete state->context;
+            state->context = nullptr;
+            return false;
+        }
+        return true;
+    }
+    R await_resume() { return std::move(m_state->result); }
+
+protected:
+    struct State
+    {
+        R                       result;
+        bool                    done = false;
+        std::coroutine_handle<> handle;
+        QObject *               context = nullptr;  /**< Receiver of the connections, deleted on completion */
+    };
+    typedef std::shared_ptr<State> StatePointer;
+
+    XBeeOperation(XBee * xbee, const int timeout) :
+        m_state(std::make_shared<State>()),
+        m_xbee(xbee),
+        m_timeout(timeout)
+    {
+    }
+    virtual ~XBeeOperation() {}
+
+    /**
+     * @brief Starts the operation, connecting its signals to state->context.
+     * @return true to wait for the completion; false if state->result is already final.
+     */
+    virtual bool start(XBee * xbee, const StatePointer & state) = 0;
+
+    static void complete(const StatePointer & state)
+    {
+        if(state->done) {
+            return;
+        }
+        state->done = true;
+        state->context->deleteLater();
+        state->context = nullptr;
+
+        const std::coroutine_handle<> handle = state->handle;
+        QTimer::singleShot(0, [handle]() { handle.resume(); });
+    }
+
+    StatePointer            m_state;
+
+private:
+    QPointer<XBee>          m_xbee;
+    int                     m_timeout;
+};
+
+/**
+ * @brief Sends a request and awaits its transmit status (or response); results in true if delivered.
+ * @sa XBee::post() @sa XBee::sendCompleted()
+ */
+class SendOperation : public XBeeOperation<bool>
+{
+public:
+    SendOperation(XBee * xbee, XBeePacket * request, const int timeout) :
+        XBeeOperation<bool>(xbee, timeout),
+        m_frame(request)
+    {
+        m_state->result = false;
+    }
+
+protected:
+    bool start(XBee * xbee, const StatePointer & state) Q_DECL_OVERRIDE
+    {
+        const quint32 ticket = xbee->post(m_frame);
+        if(ticket == 0) {
+            return false;
+        }
+        QObject::connect(xbee, &XBee::sendCompleted, state->context, [state, ticket](const quint32 t, const bool delivered) {
+            if(t == ticket) {
+                state->result = delivered;
+                complete(state);
+            }
+        });
+        return true;
+    }
+
+private:
+    FrameTemplate           m_frame;
+};
+
+/**
+ * @brief Sends a local or remote AT command and awaits its response.
+ *
+ * The response is matched on its API id and frame id, from XBee::receivedFrames().
+ */
+template<typename Response>
+class CommandOperation : public XBeeOperation<CommandResult>
+{
+public:
+    CommandOperation(XBee * xbee, XBeePacket * command, const XBeePacket::ApiId responseId, const int timeout) :
+        XBeeOperation<CommandResult>(xbee, timeout),
+        m_frame(command),
+        m_responseId(responseId)
+    {
+    }
+
+protected:
+    bool start(XBee * xbee, const StatePointer & state) Q_DECL_OVERRIDE
+    {
+        if(!xbee->sendAsync(&m_frame)) {
+            return false;
+        }
+        const quint8 frameId = m_frame.frameId();
+        const quint8 responseId = m_responseId;
+
+        QObject::connect(xbee, &XBee::receivedFrames, state->context, [state, frameId, responseId](const QVector<QByteArray> & frames) {
+            for(const QByteArray & frame : frames) {
+                if(frame.size() > 4 && (quint8)frame.at(3) == responseId && (quint8)frame.at(4) == frameId) {
+                    Response response(frame);
+                    state->result.timedOut = false;
+                    state->result.status = response.status();
+                    state->result.ok = response.status() == ATCommandResponse::Ok;
+                    state->result.value = response.data();
+                    complete(state);
+                    return;
+                }
+            }
+        });
+        QObject::connect(xbee, &XBee::frameFailed, state->context, [state, frameId](const quint8 id) {
+            if(id == frameId) {
+                complete(state);
+            }
+        });
+        return true;
+    }
+
+private:
+    FrameTemplate           m_frame;
+    XBeePacket::ApiId       m_responseId;
+};
+
+/**
+ * @brief Awaits a received frame matching a predicate; results in the frame (not escaped), empty on timeout.
+ */
+class FrameOperation : public XBeeOperation<QByteArray>
+{
+public:
+    FrameOperation(XBee * xbee, const std::function<bool(const QByteArray &)> & predicate, const int timeout) :
+        XBeeOperation<QByteArray>(xbee, timeout),
+        m_predicate(predicate)
+    {
+    }
+
+protected:
+    bool start(XBee * xbee, const StatePointer & state) Q_DECL_OVERRIDE
+    {
+        const std::function<bool(const QByteArray &)> predicate = m_predicate;
+
+        QObject::connect(xbee, &XBee::receivedFrames, state->context, [state, predicate](const QVector<QByteArray> & frames) {
+            for(const QByteArray & frame : frames) {
+                if(predicate(frame)) {
+                    state->result = frame;
+                    complete(state);
+                    return;
+                }
+            }
+        });
+        return true;
+    }
+
+private:
+    std::function<bool(const QByteArray &)> m_predicate;
+};
+
+/**
+ * @brief Awaits the association of the XBee; results in true if associated.
+ * @sa XBee::associationState()
+ */
+class AssociationOperation : public XBeeOperation<bool>
+{
+public:
+    AssociationOperation(XBee * xbee, const int timeout) :
+        XBeeOperation<bool>(xbee, timeout)
+    {
+        m_state->result = false;
+    }
+
+protected:
+    bool start(XBee * xbee, const StatePointer & state) Q_DECL_OVERRIDE
+    {
+        if(xbee->associationState() == XBee::Associated) {
+            state->result = true;
+            return false;
+        }
+        QObject::connect(xbee, &XBee::associationChanged, state->context, [state](const XBee::AssociationState association) {
+            if(association == XBee::Associated) {
+                state->result = true;
+                complete(state);
+            }
+        });
+        return true;
+    }
+};
+
+/**
+ * @brief Sends the given request and awaits its transmit status.
+ * @param xbee
+ * @param request the request to send; it's only used during the call
+ * @param timeout in milliseconds; -1 to only rely on XBee::setFrameTimeout()
+ * @return an operation resulting in true if the request has been delivered; false otherwise.
+ */
+inline SendOperation awaitSend(XBee * xbee, XBeePacket * request, const int timeout = 5000)
+{
+    return SendOperation(xbee, request, timeout);
+}
+
+/**
+ * @brief Sends the given AT command to the local XBee and awaits its response.
+ * @param xbee
+ * @param command the AT command
+ * @param parameter the parameter to set; empty to read the parameter
+ * @param timeout in milliseconds
+ */
+inline CommandOperation<ATCommandResponse> awaitATCommand(XBee * xbee,
+                                                          const ATCommand::ATCommandType command,
+                                                          const QByteArray & parameter = QByteArray(),
+                                                          const int timeout = 1000)
+{
+    ATCommand at;
+    at.setCommand(command);
+    at.setParameter(parameter);
+    return CommandOperation<ATCommandResponse>(xbee, &at, XBeePacket::ATCommandResponseId, timeout);
+}
+
+/**
+ * @brief Sends the given AT command to a remote XBee and awaits its response.
+ * @param xbee
+ * @param address64 the 64-bit address of the remote XBee
+ * @param command the AT command
+ * @param parameter the parameter to set; empty to read the parameter
+ * @param timeout in milliseconds
+ */
+inline CommandOperation<RemoteATCommandResponse> awaitRemoteATCommand(XBee * xbee,
+                                                                      const quint64 address64,
+                                                                      const ATCommand::ATCommandType command,
+                                                                      const QByteArray & parameter = QByteArray(),
+                                                                      const int timeout = 5000)
+{
+    RemoteATCommandRequest at;
+    at.setDestinationAddress64(address64);
+    at.setDestinationAddress16(0xFFFE);
+    at.setCommand(command);
+    at.setParameter(parameter);
+    return CommandOperation<RemoteATCommandResponse>(xbee, &at, XBeePacket::RemoteATCommandResponseId, timeout);
+}
+
+/**
+ * @brief Awaits the first received frame for which @a predicate returns true.
+ * @code
+ * // Next modem status
+ * const QByteArray frame = co_await QtXBee::awaitFrame(xbee, [](const QByteArray & f) { return (quint8)f.at(3) == 0x8A; });
+ * @endcode
+ * @param xbee
+ * @param predicate called with each received frame, as emitted by XBee::receivedFrames()
+ * @param timeout in milliseconds; -1 for none
+ */
+inline FrameOperation awaitFrame(XBee * xbee, const std::function<bool(const QByteArray &)> & predicate, const int timeout = -1)
+{
+    return FrameOperation(xbee, predicate, timeout);
+}
+
+/**
+ * @brief Awaits the association of the XBee (immediately true if already associated).
+ * @param xbee
+ * @param timeout in milliseconds; -1 for none
+ */
+inline AssociationOperation awaitAssociation(XBee * xbee, const int timeout = -1)
+{
+    return AssociationOperation(xbee, timeout);
+}
+
+} // END namespace
+
+#endif // __cpp_impl_coroutine
+
+#endif // XBEEAWAIT_H
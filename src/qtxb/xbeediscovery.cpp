@@ -0,0 +1,584 @@
+/*
+ * Copyright (C) 2015 ThomArmax (Thomas COIN)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * Thomas COIN <esvcorp@gmail.com> 18/04/2015
+ */
+
+
+#include "XBeeDiscovery"
+#include "XBeePacket"
+#include "ATCommand"
+#include "ATCommandResponse"
+#include "ATParameter"
+#include "FrameDecoder"
+
+#include <QDebug>
+#include <QEventLoop>
+#include <QSerialPort>
+#include <QSerialPortInfo>
+
+namespace QtXBee {
+
+/**
+ * @brief Holds the state of a port being probed
+ */
+struct XBeeDiscovery::Probe {
+    enum Step {
+        ApiMode,            /**< ATAP frame sent */
+        ApiIdentify,        /**< HV, VR, SH and SL frames sent */
+        CommandGuard,       /**< Waiting the guard time before "+++" */
+        CommandWaitOk,      /**< "+++" sent */
+        CommandIdentify     /**< "ATAP,HV,VR,SH,SL,CN" sent */
+    };
+
+    Probe() : port(NULL), timer(NULL), step(ApiMode), baudIndex(0), commandMode(false), frameId(0), retries(0) {}
+
+    QString                 name;               /**< Probed port's name, as given to startProbe() */
+    QSerialPort *           port;
+    WheelTimer *            timer;
+    Step                    step;
+    int                     baudIndex;
+    bool                    commandMode;
+    quint8                  frameId;            /**< ATAP frame id */
+    int                     retries;            /**< Identification bursts left to send at the current baud rate */
+    QByteArray              raw;                /**< Received bytes for the current step */
+    QHash<quint8, ATCommand::ATCommandType> pending;   /**< Identification frames waiting for their response */
+    QHash<quint16, QByteArray> values;          /**< Identification values, by AT command */
+    Radio                   radio;
+};
+
+static const int GuardTime = 1000;
+static const int IdentifyRetries = 2;   /**< Identification bursts resent after a timeout, once AP answered */
+
+static int responseTimeout(const qint32 baudRate)
+{
+    return baudRate >= QSerialPort::Baud9600 ? 50 : 250;
+}
+
+static quint64 decodeValue(const ATCommand::ATCommandType param, const QByteArray &data)
+{
+    quint64 value = 0;
+    ATParameter::find(param)->decode(data, &value);
+    return value;
+}
+
+/**
+ * @brief XBeeDiscovery's constructor
+ *
+ * The default baud rates are 9600, 115200, 57600, 38400 and 19200; the command mode probe is enabled.
+ * @param parent parent object
+ */
+XBeeDiscovery::XBeeDiscovery(QObject *parent) :
+    QObject(parent),
+    m_commandMode(true)
+{
+    qRegisterMetaType<QtXBee::XBeeDiscovery::Radio>();
+    m_baudRates << QSerialPort::Baud9600
+                << QSerialPort::Baud115200
+                << QSerialPort::Baud57600
+                << QSerialPort::Baud38400
+                << QSerialPort::Baud19200;
+    connect(&m_refreshTimer, SIGNAL(timeout()), SLOT(onRefresh()));
+}
+
+/**
+ * @brief Stops the running probes and closes their serial ports
+ */
+XBeeDiscovery::~XBeeDiscovery()
+{
+    stop();
+}
+
+/**
+ * @brief Sets the baud rates to probe, in probing order
+ * @param baudRates
+ */
+void XBeeDiscovery::setBaudRates(const QList<qint32> &baudRates)
+{
+    m_baudRates = baudRates;
+}
+
+/**
+ * @brief Returns the baud rates to probe
+ */
+QList<qint32> XBeeDiscovery::baudRates() const
+{
+    return m_baudRates;
+}
+
+/**
+ * @brief Enables or disables the command mode probe, done when a port doesn't answer in API mode.
+ *
+ * The command mode probe is slow (two guard times per baud rate), but finds radios in transparent mode (AP=0).
+ * @param enabled
+ */
+void XBeeDiscovery::setCommandModeEnabled(const bool enabled)
+{
+    m_commandMode = enabled;
+}
+
+/**
+ * @brief Returns true if the command mode probe is enabled; false otherwise.
+ */
+bool XBeeDiscovery::isCommandModeEnabled() const
+{
+    return m_commandMode;
+}
+
+/**
+ * @brief Restricts the discovery to the given serial ports (names or paths, e.g. "ttyUSB0" or "/dev/ttyUSB0").
+ *
+ * The given ports are always considered plugged. If @a names is empty, all the host's serial ports are probed.
+ * @param names
+ */
+void XBeeDiscovery::setPortNames(const QStringList &names)
+{
+    m_portNames = names;
+}
+
+/**
+ * @brief Returns the serial ports the discovery is restricted to; or an empty list if all the ports are probed.
+ */
+QStringList XBeeDiscovery::portNames() const
+{
+    return m_portNames;
+}
+
+/**
+ * @brief Enables or disables the periodic refresh of the serial ports list (hotplug).
+ *
+ * Newly plugged ports are probed; the radios of unplugged ports are removed (radioLost()).
+ * @param enabled
+ * @param interval the polling interval, in milliseconds
+ */
+void XBeeDiscovery::setAutoRefresh(const bool enabled, const int interval)
+{
+    if(enabled) {
+        m_refreshTimer.start(interval);
+    }
+    else {
+        m_refreshTimer.stop();
+    }
+}
+
+/**
+ * @brief Returns true if the serial ports list is periodically refreshed; false otherwise.
+ */
+bool XBeeDiscovery::autoRefresh() const
+{
+    return m_refreshTimer.isActive();
+}
+
+/**
+ * @brief Returns true if ports are being probed; false otherwise.
+ */
+bool XBeeDiscovery::isRunning() const
+{
+    return !m_probes.isEmpty();
+}
+
+/**
+ * @brief Waits until all the ports have been probed
+ * @param msecs the maximum time to wait, in milliseconds
+ * @return true if the discovery finished; false if timed out.
+ */
+bool XBeeDiscovery::waitForFinished(const int msecs)
+{
+    if(!isRunning()) {
+        return true;
+    }
+
+    QEventLoop loop;
+    WheelTimer timer;
+    timer.setSingleShot(true);
+    connect(this, SIGNAL(finished()), &loop, SLOT(quit()));
+    connect(&timer, SIGNAL(timeout()), &loop, SLOT(quit()));
+    timer.start(msecs);
+    loop.exec();
+    return !isRunning();
+}
+
+/**
+ * @brief Returns the found radios, by serial number
+ */
+QHash<quint64, XBeeDiscovery::Radio> XBeeDiscovery::radios() const
+{
+    return m_radios;
+}
+
+/**
+ * @brief Returns the radio having the given serial number; or an invalid Radio if not found.
+ * @param serialNumber the radio's serial number (SH << 32 | SL)
+ */
+XBeeDiscovery::Radio XBeeDiscovery::radio(const quint64 serialNumber) const
+{
+    return m_radios.value(serialNumber);
+}
+
+/**
+ * @brief Returns the name of the serial port on which the radio having the given serial number is plugged;
+ * or an empty string if not found.
+ * @param serialNumber the radio's serial number (SH << 32 | SL)
+ */
+QString XBeeDiscovery::portName(const quint64 serialNumber) const
+{
+    return m_radios.value(serialNumber).portName;
+}
+
+/**
+ * @brief Probes the serial ports which haven't been probed yet or where no radio was found,
+ * and forgets the radios of the removed ports.
+ *
+ * The finished() signal is emitted when all the ports have been probed.
+ * @note Probing writes AT frames and command sequences on the candidate ports.
+ * Ports which can't be opened (already in use) are skipped and tried again on the next refresh.
+ */
+void XBeeDiscovery::start()
+{
+    const QStringList ports = candidatePorts();
+
+    foreach(const QString & name, m_ports.keys()) {
+        if(!ports.contains(name)) {
+            const quint64 serialNumber = m_ports.take(name);
+            if(serialNumber != 0 && m_radios.value(serialNumber).portName == name) {
+                m_radios.remove(serialNumber);
+                emit radioLost(serialNumber);
+            }
+        }
+    }
+
+    foreach(const QString & name, ports) {
+        if(!m_ports.contains(name)) {
+            startProbe(name);
+        }
+    }
+
+    if(!isRunning()) {
+        emit finished();
+    }
+}
+
+/**
+ * @brief Forgets all the found radios and probes all the serial ports again
+ */
+void XBeeDiscovery::rescan()
+{
+    stop();
+    m_ports.clear();
+    m_radios.clear();
+    start();
+}
+
+/**
+ * @brief Aborts the running probes
+ */
+void XBeeDiscovery::stop()
+{
+    QList<Probe*> probes;
+    foreach(Probe * probe, m_probes.values()) {
+        if(!probes.contains(probe)) {
+            probes.append(probe);
+        }
+    }
+    foreach(Probe * probe, probes) {
+        m_ports.remove(probe->name);
+        m_probes.remove(probe->port);
+        m_probes.remove(probe->timer);
+        probe->port->close();
+        delete probe->port;
+        delete probe->timer;
+        delete probe;
+    }
+}
+
+void XBeeDiscovery::onReadyRead()
+{
+    Probe * probe = m_probes.value(sender());
+    if(!probe) {
+        return;
+    }
+
+    probe->raw.append(probe->port->readAll());
+    if(probe->commandMode) {
+        processCommandData(probe);
+    }
+    else {
+        processApiData(probe);
+    }
+}
+
+void XBeeDiscovery::onTimeout()
+{
+    Probe * probe = m_probes.value(sender());
+    if(!probe) {
+        return;
+    }
+
+    if(probe->step == Probe::CommandGuard) {
+        probe->port->write("+++");
+        probe->step = Probe::CommandWaitOk;
+        probe->timer->start(GuardTime + 500);
+    }
+    else if(probe->step == Probe::ApiIdentify && probe->retries > 0) {
+        // AP answered at this baud rate: the identification frames were lost, not sent at the wrong speed
+        qDebug() << Q_FUNC_INFO << "Identification timed out on" << probe->name << ", retrying";
+        probe->retries--;
+        sendIdentify(probe);
+    }
+    else {
+        nextStep(probe);
+    }
+}
+
+void XBeeDiscovery::onRefresh()
+{
+    start();
+}
+
+void XBeeDiscovery::startProbe(const QString &portName)
+{
+    Probe * probe = new Probe();
+    probe->name = portName;
+    probe->port = new QSerialPort(portName);
+
+    if(!probe->port->open(QIODevice::ReadWrite) ||
+            !probe->port->setDataBits(QSerialPort::Data8) ||
+            !probe->port->setParity(QSerialPort::NoParity) ||
+            !probe->port->setStopBits(QSerialPort::OneStop) ||
+            !probe->port->setFlowControl(QSerialPort::NoFlowControl)) {
+        qDebug() << Q_FUNC_INFO << "Can't open" << portName;
+        delete probe->port;
+        delete probe;
+        return;
+    }
+
+    m_ports.insert(portName, 0);
+    probe->timer = new WheelTimer();
+    probe->timer->setSingleShot(true);
+    connect(probe->port, SIGNAL(readyRead()), SLOT(onReadyRead()));
+    connect(probe->timer, SIGNAL(timeout()), SLOT(onTimeout()));
+    m_probes.insert(probe->port, probe);
+    m_probes.insert(probe->timer, probe);
+
+    startBaudRate(probe);
+}
+
+void XBeeDiscovery::nextStep(Probe *probe)
+{
+    probe->baudIndex++;
+    if(probe->baudIndex >= m_baudRates.size()) {
+        if(probe->commandMode || !m_commandMode) {
+            finishProbe(probe, false);
+            return;
+        }
+        probe->commandMode = true;
+        probe->baudIndex = 0;
+    }
+    startBaudRate(probe);
+}
+
+void XBeeDiscovery::startBaudRate(Probe *probe)
+{
+    const qint32 baudRate = m_baudRates.at(probe->baudIndex);
+
+    probe->port->setBaudRate(baudRate);
+    probe->port->clear();
+    probe->raw.clear();
+    probe->pending.clear();
+    probe->values.clear();
+
+    if(probe->commandMode) {
+        probe->step = Probe::CommandGuard;
+        probe->timer->start(GuardTime);
+        return;
+    }
+
+    // Single ATAP frame which doesn't need escaping, so it's valid in both API modes
+    ATCommand at;
+    at.setCommand(ATCommand::ATAP);
+    quint8 frameId = 5;
+    do {
+        at.setFrameId(frameId++);
+        at.assemblePacket();
+    } while(XBeePacket::needsEscaping(at.packet()));
+
+    probe->frameId = at.frameId();
+    probe->step = Probe::ApiMode;
+    probe->port->write(at.packet());
+    probe->timer->start(responseTimeout(baudRate));
+}
+
+void XBeeDiscovery::processApiData(Probe *probe)
+{
+    QByteArray frame;
+
+    if(probe->step == Probe::ApiMode) {
+        for(int escaped=0; escaped<2; escaped++) {
+            FrameDecoder decoder;
+            decoder.setEscaped(escaped);
+            decoder.append(probe->raw);
+            while(decoder.takeFrame(&frame)) {
+                if((quint8)frame.at(3) != XBeePacket::ATCommandResponseId || (quint8)frame.at(4) != probe->frameId) {
+                    continue;
+                }
+                ATCommandResponse rep(frame);
+                const int ap = rep.data().isEmpty() ? 0 : (quint8)rep.data().at(rep.data().size()-1);
+                if(rep.status() != ATCommandResponse::Ok || (ap != 1 && ap != 2)) {
+                    continue;
+                }
+
+                // Identify the radio in one burst
+                const ATCommand::ATCommandType commands[] = { ATCommand::ATHV, ATCommand::ATVR, ATCommand::ATSH, ATCommand::ATSL };
+                probe->radio.mode = ap == 2 ? XBee::API2Mode : XBee::API1Mode;
+                for(int i=0; i<4; i++) {
+                    probe->pending.insert(i+1, commands[i]);
+                }
+                probe->raw.clear();
+                probe->retries = IdentifyRetries;
+                sendIdentify(probe);
+                return;
+            }
+        }
+    }
+    else if(probe->step == Probe::ApiIdentify) {
+        FrameDecoder decoder;
+        decoder.setEscaped(probe->radio.mode == XBee::API2Mode);
+        decoder.append(probe->raw);
+        while(decoder.takeFrame(&frame)) {
+            if((quint8)frame.at(3) != XBeePacket::ATCommandResponseId || !probe->pending.contains(frame.at(4))) {
+                continue;
+            }
+            ATCommandResponse rep(frame);
+            probe->values.insert(probe->pending.take(frame.at(4)), rep.data());
+        }
+        if(probe->pending.isEmpty()) {
+            finishProbe(probe, true);
+        }
+    }
+}
+
+/**
+ * @brief Sends the identification frames still waiting for their response, in one burst.
+ */
+void XBeeDiscovery::sendIdentify(Probe *probe)
+{
+    QByteArray burst;
+
+    foreach(const quint8 frameId, probe->pending.keys()) {
+        ATCommand at;
+        at.setCommand(probe->pending.value(frameId));
+        at.setFrameId(frameId);
+        at.assemblePacket();
+        burst.append(probe->radio.mode == XBee::API2Mode ? XBeePacket::escape(at.packet()) : at.packet());
+    }
+    probe->step = Probe::ApiIdentify;
+    probe->port->write(burst);
+    probe->timer->start(2*responseTimeout(m_baudRates.at(probe->baudIndex)));
+}
+
+void XBeeDiscovery::processCommandData(Probe *probe)
+{
+    if(probe->step == Probe::CommandWaitOk) {
+        if(probe->raw.contains("OK\r")) {
+            probe->raw.clear();
+            probe->step = Probe::CommandIdentify;
+            probe->port->write("ATAP,HV,VR,SH,SL,CN\r");
+            probe->timer->start(GuardTime);
+        }
+    }
+    else if(probe->step == Probe::CommandIdentify) {
+        const QList<QByteArray> lines = probe->raw.split('\r');
+        // The radio stops at the first failing command, which stays in command mode
+        foreach(const QByteArray & line, lines) {
+            if(line.trimmed() == "ERROR") {
+                qDebug() << Q_FUNC_INFO << "Identification failed on" << probe->name;
+                probe->port->write("ATCN\r");
+                nextStep(probe);
+                return;
+            }
+        }
+        // AP, HV, VR, SH, SL and CN's OK, plus what follows the last CR
+        if(lines.size() < 7) {
+            return;
+        }
+        const ATCommand::ATCommandType commands[] = { ATCommand::ATAP, ATCommand::ATHV, ATCommand::ATVR, ATCommand::ATSH, ATCommand::ATSL };
+        for(int i=0; i<5; i++) {
+            QByteArray value = lines.at(i).trimmed();
+            if(value.size() % 2) {
+                value.prepend('0');
+            }
+            probe->values.insert(commands[i], QByteArray::fromHex(value));
+        }
+        const quint64 ap = decodeValue(ATCommand::ATAP, probe->values.value(ATCommand::ATAP));
+        probe->radio.mode = ap == 2 ? XBee::API2Mode : ap == 1 ? XBee::API1Mode : XBee::CommandMode;
+        finishProbe(probe, true);
+    }
+}
+
+void XBeeDiscovery::finishProbe(Probe *probe, const bool found)
+{
+    const QString name = probe->name;
+
+    m_probes.remove(probe->port);
+    m_probes.remove(probe->timer);
+    probe->timer->stop();
+    probe->port->close();
+    probe->port->deleteLater();
+    probe->timer->deleteLater();
+
+    if(found) {
+        Radio & radio = probe->radio;
+        radio.portName = name;
+        radio.baudRate = m_baudRates.at(probe->baudIndex);
+        radio.hardwareVersion = decodeValue(ATCommand::ATHV, probe->values.value(ATCommand::ATHV));
+        radio.firmwareVersion = decodeValue(ATCommand::ATVR, probe->values.value(ATCommand::ATVR));
+        radio.serialNumber = (decodeValue(ATCommand::ATSH, probe->values.value(ATCommand::ATSH)) << 32) |
+                              decodeValue(ATCommand::ATSL, probe->values.value(ATCommand::ATSL));
+    }
+
+    if(found && probe->radio.isValid()) {
+        qDebug() << Q_FUNC_INFO << "XBee" << QString("0x%1").arg(probe->radio.serialNumber, 16, 16, QChar('0'))
+                 << "found on" << name << "at" << probe->radio.baudRate << "bauds";
+        m_ports.insert(name, probe->radio.serialNumber);
+        m_radios.insert(probe->radio.serialNumber, probe->radio);
+        emit radioFound(probe->radio);
+    }
+    else {
+        // Probed again on the next scan: the radio may have been busy or still booting
+        m_ports.remove(name);
+    }
+    delete probe;
+
+    if(m_probes.isEmpty()) {
+        emit finished();
+    }
+}
+
+QStringList XBeeDiscovery::candidatePorts() const
+{
+    if(!m_portNames.isEmpty()) {
+        return m_portNames;
+    }
+
+    QStringList ports;
+    foreach(const QSerialPortInfo & info, QSerialPortInfo::availablePorts()) {
+        ports.append(info.portName());
+    }
+    return ports;
+}
+
+} // END namespace
@@ -0,0 +1,134 @@
+/*
+ * Copyright (C) 2015 ThomArmax (Thomas COIN)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * Thomas COIN <esvcorp@gmail.com> 18/04/2015
+ */
+
+
+#ifndef XBEEDISCOVERY_H
+#define XBEEDISCOVERY_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+#include "XBee"
+#include "WheelTimer"
+
+class QSerialPort;
+
+namespace QtXBee {
+
+/**
+ * @brief The XBeeDiscovery class looks for the XBee radios plugged on the host's serial ports.
+ *
+ * All the candidate ports are probed concurrently (each port is driven by its own asynchronous state machine),
+ * so a discovery lasts as long as the slowest port, whatever the number of ports.
+ * Each port is probed at the baud rates given by setBaudRates(), first in API mode (a single ATAP frame,
+ * then HV, VR, SH and SL in one burst), then, if enabled, in command mode.
+ *
+ * The found radios are identified by their serial number (SH/SL), which doesn't change when ports are renumbered:
+ * @code
+ * XBeeDiscovery discovery;
+ * discovery.start();
+ * discovery.waitForFinished(5000);
+ * XBee xbee(discovery.portName(0x0013A20040A1B2C3));
+ * @endcode
+ * The results are cached; with setAutoRefresh(), the port list is polled and only the plugged ports are probed,
+ * the radios of unplugged ports being removed. The ports where no radio was found are probed again on each scan.
+ */
+class XBeeDiscovery : public QObject
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief The Radio struct describes a found radio
+     */
+    struct Radio {
+        Radio() : baudRate(0), mode(XBee::API1Mode), serialNumber(0), hardwareVersion(0), firmwareVersion(0) {}
+        bool        isValid         () const { return serialNumber != 0; }
+
+        QString     portName;           /**< Serial port's name */
+        qint32      baudRate;           /**< Baud rate the radio answers to */
+        XBee::Mode  mode;               /**< API mode (AP); XBee::CommandMode if the radio is in transparent mode (AP=0) */
+        quint64     serialNumber;       /**< SH/SL */
+        quint16     hardwareVersion;    /**< HV */
+        quint16     firmwareVersion;    /**< VR */
+    };
+
+    explicit                XBeeDiscovery           (QObject *parent = 0);
+                            ~XBeeDiscovery          ();
+
+    void                    setBaudRates            (const QList<qint32> & baudRates);
+    QList<qint32>           baudRates               () const;
+    void                    setCommandModeEnabled   (const bool enabled);
+    bool                    isCommandModeEnabled    () const;
+    void                    setPortNames            (const QStringList & names);
+    QStringList             portNames               () const;
+    void                    setAutoRefresh          (const bool enabled, const int interval = 2000);
+    bool                    autoRefresh             () const;
+
+    bool                    isRunning               () const;
+    bool                    waitForFinished         (const int msecs = 30000);
+
+    QHash<quint64, Radio>   radios                  () const;
+    Radio                   radio                   (const quint64 serialNumber) const;
+    QString                 portName                (const quint64 serialNumber) const;
+
+public slots:
+    void                    start                   ();
+    void                    rescan                  ();
+    void                    stop                    ();
+
+signals:
+    void                    radioFound              (const QtXBee::XBeeDiscovery::Radio & radio);  /**< @brief Emitted when a radio is found on a newly probed port */
+    void                    radioLost               (quint64 serialNumber);                         /**< @brief Emitted when the port of a known radio disappeared */
+    void                    finished                ();                                             /**< @brief Emitted when all the ports have been probed */
+
+private slots:
+    void                    onReadyRead             ();
+    void                    onTimeout               ();
+    void                    onRefresh               ();
+
+private:
+    struct Probe;
+
+    void                    startProbe              (const QString & portName);
+    void                    nextStep                (Probe * probe);
+    void                    startBaudRate           (Probe * probe);
+    void                    processApiData          (Probe * probe);
+    void                    sendIdentify            (Probe * probe);
+    void                    processCommandData      (Probe * probe);
+    void                    finishProbe             (Probe * probe, const bool found);
+    QStringList             candidatePorts          () const;
+
+    QList<qint32>           m_baudRates;
+    bool                    m_commandMode;
+    QStringList             m_portNames;            /**< Ports to probe; all the serial ports if empty */
+    QHash<QObject*, Probe*> m_probes;               /**< Running probes, by serial port and by timer */
+    QHash<quint64, Radio>   m_radios;               /**< Found radios, by serial number */
+    QHash<QString, quint64> m_ports;                /**< Probed ports and the serial number of their radio (0 if none) */
+    WheelTimer              m_refreshTimer;
+};
+
+} // END namespace
+
+Q_DECLARE_METATYPE(QtXBee::XBeeDiscovery::Radio)
+
+#endif // XBEEDISCOVERY_H
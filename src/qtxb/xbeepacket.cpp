@@ -19,6 +19,7 @@
  */
 
 #include "XBeePacket"
+#include "codec/XBeeCodec"
 #include <QDebug>
 
 namespace QtXBee {
@@ -33,7 +34,8 @@ XBeePacket::XBeePacket(QObject *parent) :
     m_length(0),
     m_frameType(UndefinedId),
     m_frameId(0),
-    m_checksum(0)
+    m_checksum(0),
+    m_timestamp(0)
 {
 }
 
@@ -143,6 +145,27 @@ unsigned XBeePacket::checksum() const
     return m_checksum;
 }
 
+/**
+ * @brief Sets the time the frame was received
+ * @param timestamp
+ * @sa XBeePacket::timestamp()
+ */
+void XBeePacket::setTimestamp(const qint64 timestamp)
+{
+    m_timestamp = timestamp;
+}
+
+/**
+ * @brief Returns the time (QtXBee::monotonicTime(), in nanoseconds) the frame's start delimiter was read from the serial port.
+ *
+ * Set by XBee on the responses it creates; 0 if unknown (packets created by the application).
+ * @sa XBeePacket::setTimestamp()
+ */
+qint64 XBeePacket::timestamp() const
+{
+    return m_timestamp;
+}
+
 /**
  * @brief Computes the checksum of the given QByteArray, and set it.
  * @param array
@@ -151,22 +174,34 @@ unsigned XBeePacket::checksum() const
  */
 void XBeePacket::createChecksum(QByteArray array)
 {
-    int len = array.size();
-    unsigned int sum = 0x00;
-    unsigned int ff = 0xFF;
-    unsigned int fe = 0xFE;
-    for(int i=0;i<len;i++)
-    {
-        unsigned int a = array.at(i);
-        if (a == (unsigned int)4294967295){
-            a = ff;
-        } else if (a == (unsigned int)4294967294){
-            a = fe;
-        }
-
-        sum += a;
+    setChecksum(Codec::checksum((const quint8*)array.constData(), array.size()));
+}
+
+/**
+ * @brief Records the frame encoded by the codec in m_packet.
+ *
+ * The packet is truncated to @a size, and the length and checksum are read back from it.
+ * @param size the size returned by the codec; 0 if the encoding failed, the packet is then cleared.
+ * @sa Codec::FrameWriter
+ */
+void XBeePacket::setEncodedSize(const int size)
+{
+    if(size <= 0) {
+        qWarning() << Q_FUNC_INFO << "Failed to encode" << frameTypeToString(frameType());
+        m_packet.clear();
+        return;
     }
-    setChecksum((ff - sum) & 0x000000FF);
+    m_packet.resize(size);
+    setLength(size - Codec::FrameOverhead);
+    setChecksum((quint8)m_packet.at(size - 1));
+}
+
+/**
+ * @brief Returns the packet's buffer, for the codec to encode into.
+ */
+quint8 *XBeePacket::encodeBuffer()
+{
+    return (quint8*)m_packet.data();
 }
 
 /**
@@ -206,9 +241,7 @@ bool XBeePacket::setPacket(const QByteArray &packet)
     }
 
     if(packet.size() > 5) {
-        for(int i=apiSpecificOffset; i< packet.size()-1; i++) {
-            specificData.append(packet.at(i));
-        }
+        specificData = packet.mid(apiSpecificOffset, packet.size() - apiSpecificOffset - 1);
         parseApiSpecificData(specificData);
     }
     setChecksum(packet.at(packet.size()-1));
@@ -259,6 +292,7 @@ void XBeePacket::clear()
     m_length = 0;
     m_frameId = -1;
     m_checksum = -1;
+    m_timestamp = 0;
 }
 
 /**
@@ -318,88 +352,80 @@ QString XBeePacket::frameTypeToString(const ApiId type)
     return str;
 }
 
+/**
+ * @brief Escapes the packet, as required in API mode 2 (AP=2)
+ * @sa XBeePacket::escape()
+ */
 void XBeePacket::escapePacket()
 {
-    int escapeBytes = 0;
-    QByteArray escapedPacked;
-    int i;
-
-    // Skip byte 0 (start delimiter)
-    for (i=1; i<m_packet.size(); i++) {
-        if (isSpecialByte(m_packet.at(i))) {
-            qDebug() << Q_FUNC_INFO << "packet requires escaping for byte" << i << "(" <<QByteArray().append(m_packet.at(i)).toHex() << ")";
-            escapeBytes++;
-        }
-    }
-
-    if (escapeBytes == 0) {
-        qDebug() << "No need to escape packet" << m_packet.toHex();
-        return;
-    }
-    else {
-        qDebug() << Q_FUNC_INFO << "packet need to be escaped";
-
-        int pos = 1;
-
-        escapedPacked.reserve(m_packet.size() + escapeBytes);
-        escapedPacked[0] = startDelimiter();
-
-        for (i = 1; i < m_packet.size(); i++) {
-            if (isSpecialByte(m_packet[i])) {
-                escapedPacked[pos] = StartDelimiter;
-                escapedPacked[++pos] = 0x20 ^ m_packet[i];
-
-                qDebug() << Q_FUNC_INFO << "xor'd byte is" << QString("0x%1").arg(escapedPacked[pos]);
-            } else {
-                escapedPacked[pos] = m_packet[i];
-            }
-            pos++;
-        }
-        qDebug() << Q_FUNC_INFO << m_packet.toHex() << "===>" << escapedPacked.toHex();
-        m_packet.clear();
-        m_packet = escapedPacked;
-    }
+    m_packet = escape(m_packet);
 }
 
+/**
+ * @brief Un-escapes the packet received in API mode 2 (AP=2)
+ * @return true if succeeded; false if the packet ends with an escape byte.
+ * @sa XBeePacket::unescape()
+ */
 bool XBeePacket::unescapePacket()
 {
-    QByteArray unEscapedPacket;
-    int escapeBytes = 0;
-    int i = 0;
-    int pos = 0;
-
-    for(i=0; i<m_packet.size(); i++) {
-        if(m_packet.at(i) == Escape) {
-            escapeBytes++;
-        }
-    }
+    bool ok = false;
+    m_packet = unescape(m_packet, &ok);
+    return ok;
+}
+
+/**
+ * @brief Returns the given packet with its special bytes escaped, as required in API mode 2 (AP=2).
+ *
+ * The start delimiter (first byte) isn't escaped.
+ * @param packet the assembled packet
+ */
+QByteArray XBeePacket::escape(const QByteArray &packet)
+{
+    const quint8 * data = (const quint8*)packet.constData();
+    const int size = Codec::escapedSize(data, packet.size());
 
-    if (escapeBytes == 0) {
-        return true;
+    if(size == packet.size()) {
+        return packet;
     }
 
-    unEscapedPacket.reserve(m_packet.size() - escapeBytes);
+    QByteArray escaped(size, Qt::Uninitialized);
+    Codec::escape(data, packet.size(), (quint8*)escaped.data(), size);
+    return escaped;
+}
 
-    for(i = 0; i<m_packet.size(); i++) {
-        if (m_packet[i] == (char)Escape) {
-            // discard escape byte and un-escape following byte
-            unEscapedPacket[pos] = 0x20 ^ m_packet[++i];
-        } else {
-            unEscapedPacket[pos] = m_packet[i];
-        }
-        pos++;
+/**
+ * @brief Returns the given data with its escaped bytes restored.
+ * @param data the escaped data
+ * @param ok if not null, set to false if the data ends with an escape byte
+ */
+QByteArray XBeePacket::unescape(const QByteArray &data, bool *ok)
+{
+    if(ok) *ok = true;
+    if(!data.contains((char)Escape)) {
+        return data;
     }
 
-    qDebug() << Q_FUNC_INFO << m_packet.toHex() << "====>" << unEscapedPacket.toHex();
-    return true;
+    QByteArray unescaped(data.size(), Qt::Uninitialized);
+    unescaped.resize(Codec::unescape((const quint8*)data.constData(), data.size(), (quint8*)unescaped.data(), ok));
+    return unescaped;
 }
 
+/**
+ * @brief Returns true if the given packet contains bytes (after the start delimiter) which must be escaped in API mode 2; false otherwise.
+ * @param packet the assembled packet
+ */
+bool XBeePacket::needsEscaping(const QByteArray &packet)
+{
+    return Codec::escapedSize((const quint8*)packet.constData(), packet.size()) != (size_t)packet.size();
+}
+
+/**
+ * @brief Returns true if the given byte must be escaped in API mode 2; false otherwise.
+ * @param c
+ */
 bool XBeePacket::isSpecialByte(const char c)
 {
-    return  c == StartDelimiter ||
-            c == Escape ||
-            c == XON ||
-            c == XOFF;
+    return Codec::isSpecialByte((quint8)c);
 }
 
 } // END namepsace
@@ -94,6 +94,7 @@ public:
     void            setFrameId              (quint8 id);
     void            setChecksum             (unsigned cs);
     bool            setPacket               (const QByteArray & packet);
+    void            setTimestamp            (const qint64 timestamp);
 
     QByteArray      packet                  () const;
     unsigned        startDelimiter          () const;
@@ -101,6 +102,7 @@ public:
     ApiId           frameType               () const;
     quint8          frameId                 () const;
     unsigned        checksum                () const;
+    qint64          timestamp               () const;
 
     virtual void    assemblePacket          ();
     virtual void    clear                   ();
@@ -110,12 +112,16 @@ public:
     void            escapePacket            ();
     bool            unescapePacket          ();
 
-private:
-    bool            isSpecialByte           (const char c);
+    static QByteArray escape                (const QByteArray & packet);
+    static QByteArray unescape              (const QByteArray & data, bool * ok = 0);
+    static bool     needsEscaping           (const QByteArray & packet);
+    static bool     isSpecialByte           (const char c);
 
 protected:
     virtual bool    parseApiSpecificData    (const QByteArray & data);
     void            createChecksum          (QByteArray array);
+    void            setEncodedSize          (const int size);
+    quint8 *        encodeBuffer            ();
 
 protected:
     QByteArray      m_packet;               /**< Contains the packet's data (sent or received)*/
@@ -125,6 +131,7 @@ private:
     ApiId           m_frameType;            /**< The frame's type */
     quint8          m_frameId;              /**< The frame's id */
     unsigned        m_checksum;             /**< Packet checksum */
+    qint64          m_timestamp;            /**< Receive time, see XBeePacket::timestamp() */
 };
 
 } // END namepsace
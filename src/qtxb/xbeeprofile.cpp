@@ -0,0 +1,277 @@
+/*
+ * Copyright (C) 2015 ThomArmax (Thomas COIN)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * Thomas COIN <esvcorp@gmail.com> 18/04/2015
+ */
+
+
+#include "XBeeProfile"
+#include "ATParameter"
+
+#include <QDebug>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonValue>
+
+namespace QtXBee {
+
+/**
+ * @brief XBeeProfile's default constructor
+ *
+ * Creates an empty profile.
+ */
+XBeeProfile::XBeeProfile()
+{
+}
+
+/**
+ * @brief Creates a profile from the given JSON document.
+ *
+ * The parameters of a "parameters" object are loaded in alphabetical order (QJsonObject sorts its keys),
+ * those of a "parameters" array in the array's order.
+ * @param json the JSON document (see XBeeProfile for the format)
+ * @param ok if not null, set to false if the document or one of its values is invalid
+ * @return the loaded profile; or an empty profile in case of error.
+ */
+XBeeProfile XBeeProfile::fromJson(const QByteArray &json, bool *ok)
+{
+    XBeeProfile profile;
+    QJsonParseError error;
+    QJsonDocument doc = QJsonDocument::fromJson(json, &error);
+    bool bRet = true;
+
+    if(!doc.isObject()) {
+        qWarning() << Q_FUNC_INFO << "Invalid profile:" << error.errorString();
+        if(ok) *ok = false;
+        return profile;
+    }
+
+    const QJsonObject root = doc.object();
+    const QJsonValue params = root.value("parameters");
+    profile.setName(root.value("name").toString());
+
+    if(params.isArray()) {
+        foreach(const QJsonValue & entry, params.toArray()) {
+            const QJsonObject param = entry.toObject();
+            if(param.size() != 1) {
+                qWarning() << Q_FUNC_INFO << "Invalid parameter entry, expected a single parameter per object";
+                bRet = false;
+            }
+            if(!bRet || !(bRet = profile.loadValue(param.constBegin().key(), param.constBegin().value()))) {
+                break;
+            }
+        }
+    }
+    else {
+        const QJsonObject object = params.toObject();
+        for(QJsonObject::const_iterator it = object.constBegin(); bRet && it != object.constEnd(); ++it) {
+            bRet = profile.loadValue(it.key(), it.value());
+        }
+    }
+
+    if(!bRet) {
+        profile.clear();
+    }
+    if(ok) *ok = bRet;
+    return profile;
+}
+
+/**
+ * @brief Sets the given parameter from its JSON value.
+ * @return true if succeeded; false if the parameter is unknown or the value invalid.
+ */
+bool XBeeProfile::loadValue(const QString &key, const QJsonValue &v)
+{
+    const ATCommand::ATCommandType param = ATCommand::atCommandFromByteArray(key.toLatin1());
+    const ATParameter * p = ATParameter::find(param);
+    bool bRet = false;
+
+    if(!p) {
+        qWarning() << Q_FUNC_INFO << "Unknown parameter" << key;
+        return false;
+    }
+
+    if(p->isNumeric()) {
+        bool converted = v.isDouble();
+        quint64 value = 0;
+        if(v.isDouble()) {
+            value = p->isSigned() ? (quint64)(qint64)v.toDouble() : (quint64)v.toDouble();
+        }
+        else if(v.isString()) {
+            value = v.toString().toULongLong(&converted, 0);
+        }
+        bRet = converted && setValue(param, value);
+    }
+    else if(p->isString() && v.isString()) {
+        bRet = setValue(param, v.toString().toUtf8());
+    }
+    else if(p->isBinary() && v.isString()) {
+        QString hex = v.toString();
+        if(hex.startsWith("0x")) {
+            hex.remove(0, 2);
+        }
+        bRet = setValue(param, QByteArray::fromHex(hex.toLatin1()));
+    }
+
+    if(!bRet) {
+        qWarning() << Q_FUNC_INFO << "Invalid value for" << key;
+    }
+    return bRet;
+}
+
+/**
+ * @brief Creates a profile from the given JSON file.
+ * @param path the JSON file's path
+ * @param ok if not null, set to false if the file can't be read or is invalid
+ * @return the loaded profile; or an empty profile in case of error.
+ * @sa XBeeProfile::fromJson()
+ */
+XBeeProfile XBeeProfile::fromFile(const QString &path, bool *ok)
+{
+    QFile file(path);
+    if(!file.open(QIODevice::ReadOnly)) {
+        qWarning() << Q_FUNC_INFO << "Failed to open" << path;
+        if(ok) *ok = false;
+        return XBeeProfile();
+    }
+    return fromJson(file.readAll(), ok);
+}
+
+/**
+ * @brief Sets the profile's name
+ * @param name
+ */
+void XBeeProfile::setName(const QString &name)
+{
+    m_name = name;
+}
+
+/**
+ * @brief Returns the profile's name
+ */
+QString XBeeProfile::name() const
+{
+    return m_name;
+}
+
+/**
+ * @brief Sets the value of the given numeric parameter.
+ * @param param the parameter's AT command
+ * @param value the value (two's complement representation for signed parameters)
+ * @return true if succeeded; false if the parameter is unknown, not writable or if the value is out of range.
+ */
+bool XBeeProfile::setValue(const ATCommand::ATCommandType param, const quint64 value)
+{
+    const ATParameter * p = ATParameter::find(param);
+    QByteArray encoded;
+
+    if(!p || !p->encode(value, &encoded)) {
+        return false;
+    }
+    if(!m_values.contains(param)) {
+        m_parameters.append(param);
+    }
+    m_values.insert(param, encoded);
+    return true;
+}
+
+/**
+ * @brief Sets the value of the given string or binary parameter.
+ * @param param the parameter's AT command
+ * @param value the value
+ * @return true if succeeded; false if the parameter is unknown, not writable or if the value is too long.
+ */
+bool XBeeProfile::setValue(const ATCommand::ATCommandType param, const QByteArray &value)
+{
+    const ATParameter * p = ATParameter::find(param);
+    QByteArray encoded;
+
+    if(!p || !p->encode(value, &encoded)) {
+        return false;
+    }
+    if(!m_values.contains(param)) {
+        m_parameters.append(param);
+    }
+    m_values.insert(param, encoded);
+    return true;
+}
+
+/**
+ * @brief Returns the encoded value of the given parameter; or an empty QByteArray if the profile doesn't contain it.
+ * @param param the parameter's AT command
+ */
+QByteArray XBeeProfile::value(const ATCommand::ATCommandType param) const
+{
+    return m_values.value(param);
+}
+
+/**
+ * @brief Returns true if the profile contains the given parameter; false otherwise.
+ * @param param the parameter's AT command
+ */
+bool XBeeProfile::contains(const ATCommand::ATCommandType param) const
+{
+    return m_values.contains(param);
+}
+
+/**
+ * @brief Removes the given parameter from the profile
+ * @param param the parameter's AT command
+ */
+void XBeeProfile::remove(const ATCommand::ATCommandType param)
+{
+    if(m_values.remove(param)) {
+        m_parameters.removeAll(param);
+    }
+}
+
+/**
+ * @brief Returns the profile's parameters, in insertion order
+ */
+QList<ATCommand::ATCommandType> XBeeProfile::parameters() const
+{
+    return m_parameters;
+}
+
+/**
+ * @brief Returns the number of parameters in the profile
+ */
+int XBeeProfile::size() const
+{
+    return m_parameters.size();
+}
+
+/**
+ * @brief Returns true if the profile doesn't contain any parameter; false otherwise.
+ */
+bool XBeeProfile::isEmpty() const
+{
+    return m_parameters.isEmpty();
+}
+
+/**
+ * @brief Removes all the profile's parameters
+ */
+void XBeeProfile::clear()
+{
+    m_parameters.clear();
+    m_values.clear();
+}
+
+} // END namespace
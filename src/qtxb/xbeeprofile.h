@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2015 ThomArmax (Thomas COIN)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ * Thomas COIN <esvcorp@gmail.com> 18/04/2015
+ */
+
+
+#ifndef XBEEPROFILE_H
+#define XBEEPROFILE_H
+
+#include "ATCommand"
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QString>
+
+class QJsonValue;
+
+namespace QtXBee {
+
+/**
+ * @brief The XBeeProfile class holds a set of parameter values to apply to an XBee.
+ *
+ * Profiles are usually loaded from JSON:
+ * @code
+ * {
+ *     "name": "gateway",
+ *     "parameters": {
+ *         "ID": "0x3332",
+ *         "CH": 12,
+ *         "NI": "GATEWAY",
+ *         "KY": "000102030405060708090a0b0c0d0e0f"
+ *     }
+ * }
+ * @endcode
+ * The parameters are applied in the order they are loaded. As QJsonObject sorts its keys, the parameters
+ * of an object are loaded in alphabetical order; when the order matters, "parameters" can be an array
+ * of single parameter objects instead:
+ * @code
+ * "parameters": [ { "ID": "0x3332" }, { "CH": 12 }, { "WR": 0 } ]
+ * @endcode
+ * Numeric parameters accept a JSON number, or a string holding a decimal or "0x" prefixed hexadecimal value.
+ * String parameters (NI) take a JSON string, binary parameters (KY, NK) a hexadecimal string.
+ *
+ * All values are validated and encoded through ATParameter when loaded.
+ * @sa XBee::applyProfile()
+ */
+class XBeeProfile
+{
+public:
+    explicit                XBeeProfile             ();
+
+    static XBeeProfile      fromJson                (const QByteArray & json, bool * ok = 0);
+    static XBeeProfile      fromFile                (const QString & path, bool * ok = 0);
+
+    void                    setName                 (const QString & name);
+    QString                 name                    () const;
+
+    bool                    setValue                (const ATCommand::ATCommandType param, const quint64 value);
+    bool                    setValue                (const ATCommand::ATCommandType param, const QByteArray & value);
+    QByteArray              value                   (const ATCommand::ATCommandType param) const;
+    bool                    contains                (const ATCommand::ATCommandType param) const;
+    void                    remove                  (const ATCommand::ATCommandType param);
+
+    QList<ATCommand::ATCommandType> parameters      () const;
+    int                     size                    () const;
+    bool                    isEmpty                 () const;
+    void                    clear                   ();
+
+private:
+    bool                    loadValue               (const QString & key, const QJsonValue & value);
+
+    QString                 m_name;
+    QList<ATCommand::ATCommandType> m_parameters;   /**< Parameters, in insertion order */
+    QHash<quint16, QByteArray> m_values;            /**< Encoded values, by AT command */
+};
+
+} // END namespace
+
+#endif // XBEEPROFILE_H
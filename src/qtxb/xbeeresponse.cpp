@@ -20,6 +20,8 @@
 
 #include "XBeeResponse"
 
+#include <utility>
+
 namespace QtXBee {
 
 /**
@@ -27,7 +29,8 @@ namespace QtXBee {
  * @param parent
  */
 XBeeResponse::XBeeResponse(QObject *parent) :
-    XBeePacket(parent)
+    XBeePacket(parent),
+    m_dataOffset(-1)
 {
 
 }
@@ -43,12 +46,30 @@ XBeeResponse::~XBeeResponse()
 /**
  * @brief Returns the response's data
  * @return the response's data
+ * @note The received data is copied out of the packet on first call; use XBeeResponse::payload() to avoid the copy.
  */
 QByteArray XBeeResponse::data() const
 {
+    if(m_dataOffset >= 0) {
+        m_data = payload().toByteArray();
+        m_dataOffset = -1;
+    }
     return m_data;
 }
 
+/**
+ * @brief Returns the response's data as a slice of the received packet, without copying it.
+ * @return the response's data
+ * @sa XBeeResponse::data()
+ */
+ByteSlice XBeeResponse::payload() const
+{
+    if(m_dataOffset >= 0) {
+        return ByteSlice(m_packet, m_dataOffset, m_packet.size() - m_dataOffset - 1);
+    }
+    return ByteSlice(m_data);
+}
+
 /**
  * @brief Sets the response's data
  * @param data
@@ -57,12 +78,37 @@ void XBeeResponse::setData(const QByteArray &data)
 {
     m_data.clear();
     m_data = data;
+    m_dataOffset = -1;
+}
+
+/**
+ * @brief Sets the response's data, taking over the given array
+ * @param data
+ */
+void XBeeResponse::setData(QByteArray &&data)
+{
+    m_data = std::move(data);
+    m_dataOffset = -1;
+}
+
+/**
+ * @brief Sets the response's data as the bytes of the packet between @a offset and the checksum.
+ *
+ * The data is extracted on the first call to XBeeResponse::data(), so consumers that never
+ * look at it don't pay for the copy.
+ * @param offset offset of the data in the packet
+ */
+void XBeeResponse::setDataOffset(const int offset)
+{
+    m_data.clear();
+    m_dataOffset = offset < m_packet.size() - 1 ? offset : -1;
 }
 
 void XBeeResponse::clear()
 {
     XBeePacket::clear();
     m_data.clear();
+    m_dataOffset = -1;
 }
 
 } // END namepsace
@@ -22,6 +22,7 @@
 #define XBEERESPONSE_H
 
 #include "XBeePacket"
+#include "ByteSlice"
 #include <QObject>
 #include <QDebug>
 
@@ -41,10 +42,16 @@ public:
     virtual void    clear           () Q_DECL_OVERRIDE;
 
     void            setData         (const QByteArray & data);
+    void            setData         (QByteArray && data);
     QByteArray      data            () const;
+    ByteSlice       payload         () const;
 
 protected:
-    QByteArray      m_data;
+    void            setDataOffset   (const int offset);
+
+protected:
+    mutable QByteArray m_data;
+    mutable int     m_dataOffset;   /**< Offset of the data in the packet, until decoded; -1 if none */
 };
 
 } // END namepsace
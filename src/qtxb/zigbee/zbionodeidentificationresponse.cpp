@@ -23,160 +23,163 @@
 namespace QtXBee {
 namespace ZigBee {
 
+static const int NodeIdentifierOffset  = 25; /**< Offset of the node identifier in the packet */
+static const int TrailerSize           = 8;  /**< Parent address, device type, source event, profile and manufacturer ids */
+
 ZBIONodeIdentificationResponse::ZBIONodeIdentificationResponse(QObject *parent) :
     XBeeResponse(parent),
-    m_senderAddr64          (0),
-    m_senderAddr16          (0),
-    m_receiveOptions        (0),
-    m_remoteAddr16          (0),
-    m_remoteAddr64          (0),
-    m_nodeIdentifier        (QString()),
-    m_remoteParent16        (0),
-    m_deviceType            (0),
-    m_sourceEvent           (0),
-    m_digiProfileId         (0),
-    m_digiManufacturerId    (0)
+    m_trailerOffset(0)
 {
     setFrameType(ZBIONodeIdentificationId);
 }
 
-bool ZBIONodeIdentificationResponse::setPacket(const QByteArray &packet)
-{
-    qDebug() << Q_FUNC_INFO << QString(packet.toHex());
-    qDebug() << Q_FUNC_INFO << "packet size" << packet.size();
-    bool bRet  = false;
-    int count = 0;
-    int pow = 0;
-    int packetSize = packet.size();
-    int niOffset =  0;
-    // Reset all data
-    m_packet.clear();
-    m_senderAddr64          = 0;
-    m_senderAddr16          = 0;
-    m_receiveOptions        = 0;
-    m_remoteAddr16          = 0;
-    m_remoteAddr64          = 0;
-    m_nodeIdentifier        = "";
-    m_remoteParent16        = 0;
-    m_deviceType            = 0;
-    m_sourceEvent           = 0;
-    m_digiProfileId         = 0;
-    m_digiManufacturerId    = 0;
-
-    m_packet = packet;
-
-    if(packetSize < 33) {
-        qWarning() << Q_FUNC_INFO << "Warning : bad packet size (got"
-                   << QString("got %1, expecter %2)").arg(packet.size()).arg(33);
-        goto exit;
+void ZBIONodeIdentificationResponse::clear()
+{
+    XBeeResponse::clear();
+    m_trailerOffset = 0;
+}
+
+bool ZBIONodeIdentificationResponse::parseApiSpecificData(const QByteArray &data)
+{
+    // Fixed part: sender addresses, options, remote addresses and at least the node identifier terminator
+    if(data.size() < NodeIdentifierOffset - 4 + 1 + TrailerSize) {
+        qWarning() << Q_FUNC_INFO << "Invalid data, expected at least" << NodeIdentifierOffset - 4 + 1 + TrailerSize
+                   << "bytes, got" << data.size();
+        return false;
+    }
+    // Fields are decoded from the packet on first access
+    m_trailerOffset = 0;
+    setDataOffset(4);
+
+    return true;
+}
+
+/**
+ * @brief Reads the big-endian field at the given packet's offset
+ * @param offset
+ * @param size
+ * @return the field's value; 0 if the packet is too short.
+ */
+quint64 ZBIONodeIdentificationResponse::readField(const int offset, const int size) const
+{
+    quint64 value = 0;
+
+    if(offset < 0 || offset + size > m_packet.size() - 1) {
+        return 0;
+    }
+    for(int i=0; i<size; i++) {
+        value = (value << 8) | (quint8)m_packet.at(offset + i);
+    }
+    return value;
+}
+
+/**
+ * @brief Returns the offset of the fields following the node identifier, walking the node identifier on first call.
+ * @return the offset; -1 if the node identifier isn't terminated or the trailing fields are missing.
+ */
+int ZBIONodeIdentificationResponse::trailerOffset() const
+{
+    if(m_trailerOffset == 0) {
+        const int end = m_packet.indexOf('\0', NodeIdentifierOffset);
+        m_trailerOffset = (end >= 0 && end + 1 + TrailerSize <= m_packet.size() - 1) ? end + 1 : -1;
     }
+    return m_trailerOffset;
+}
+
+/**
+ * @brief Returns the 64-bits address of the node which sent the indicator
+ */
+quint64 ZBIONodeIdentificationResponse::senderAddress64() const
+{
+    return readField(4, 8);
+}
+
+/**
+ * @brief Returns the 16-bits address of the node which sent the indicator
+ */
+quint16 ZBIONodeIdentificationResponse::senderAddress16() const
+{
+    return readField(12, 2);
+}
+
+/**
+ * @brief Returns the receive options
+ */
+quint8 ZBIONodeIdentificationResponse::receiveOptions() const
+{
+    return readField(14, 1);
+}
+
+/**
+ * @brief Returns the 16-bits address of the identified node
+ */
+quint16 ZBIONodeIdentificationResponse::remoteAddress16() const
+{
+    return readField(15, 2);
+}
 
-    qDebug() << Q_FUNC_INFO << "start delimiter" << QString("0x%1").arg(QString::number(packet.at(0), 16));
-    setStartDelimiter(packet.at(0));
-    setLength(packet.at(2) + (packet.at(1)<<8));
-    if(packetSize == packet.at(2)+4) {
-        int ft = packet.at(3)&0xFF;
-        // Check the frame type
-        if(ft != frameType()) {
-            qWarning() << Q_FUNC_INFO << "Warning : bad frame type"
-                       << qPrintable(QString("(got 0x%1, 0x%2 expected)").arg(ft,0, 16).arg(frameType(), 0, 16));
-            //goto exit;
-        }
-        count = 4;
-
-        // Get specific raw data
-        while(count < packetSize-1) {
-            m_data.append(packet.at(count));
-            count++;
-        }
-
-        // Get Sender 64 Bits Address
-        count = 11;
-        pow = 0;
-        while(count > 3) {
-            m_senderAddr64 += QString(packet.at(count)).toInt() << pow*8;
-            count--;
-            pow++;
-        }
-
-        // Get Sender 16 Bits Address
-        count = 13;
-        pow = 0;
-        while(count > 11) {
-            m_senderAddr16 += QString(packet.at(count)).toInt()<< pow*8;
-            count--;
-            pow++;
-        }
-        m_receiveOptions = packet.at(14);
-
-        // Get Remote 16 Bits Address
-        count = 16;
-        pow = 0;
-        while(count > 14) {
-            m_senderAddr16 += QString(packet.at(count)).toInt() << pow*8;
-            count--;
-            pow++;
-        }
-
-        // Get Remote 64 Bits Address
-        count = 24;
-        pow = 0;
-        while(count > 16) {
-            m_senderAddr64 += QString(packet.at(count)).toInt() << pow*8;
-            count--;
-            pow++;
-        }
-
-        // Get Node Identifier
-        count = 25;
-        qDebug() << Q_FUNC_INFO << "packet[25]=" << packet.at(count);
-        while(packet.at(count) != 0x00) {
-            qDebug() << Q_FUNC_INFO << packet.at(count);
-            m_nodeIdentifier.append(packet.at(count));
-
-            count ++;
-        }
-        niOffset = 25 + m_nodeIdentifier.size();
-
-        // Get Remote Parent 16 Bits Address
-        count = niOffset+2;
-        pow = 0;
-        while(count > niOffset) {
-            m_remoteParent16 += QString(packet.at(count)).toInt() << pow*8;
-            count--;
-            pow++;
-        }
-
-        // Get Device Type
-        m_deviceType = packet.at(niOffset+3);
-
-        // Get Source Event
-        m_sourceEvent = packet.at(niOffset+4);
-
-        // Get Digi Profile ID
-        count = niOffset+6;
-        pow = 0;
-        while(count > niOffset+4) {
-            m_digiProfileId += QString(packet.at(count)).toInt() << pow*8;
-            count--;
-            pow++;
-        }
-
-        // Get Digi Manufacturer ID
-        count = niOffset + 8;
-        pow = 0;
-        while(count > niOffset+6) {
-            m_digiManufacturerId += QString(packet.at(count)).toInt() << pow*8;
-            count--;
-            pow++;
-        }
-
-        // Get Checksum
-        setChecksum(packet.at(packetSize-1));
+/**
+ * @brief Returns the 64-bits address of the identified node
+ */
+quint64 ZBIONodeIdentificationResponse::remoteAddress64() const
+{
+    return readField(17, 8);
+}
+
+/**
+ * @brief Returns the node identifier (NI) of the identified node
+ */
+QString ZBIONodeIdentificationResponse::nodeIdentifier() const
+{
+    const int offset = trailerOffset();
+    if(offset < 0) {
+        return QString();
     }
+    return QString::fromLatin1(m_packet.constData() + NodeIdentifierOffset, offset - 1 - NodeIdentifierOffset);
+}
+
+/**
+ * @brief Returns the 16-bits address of the identified node's parent
+ */
+quint16 ZBIONodeIdentificationResponse::remoteParentAddress16() const
+{
+    return readField(trailerOffset(), 2);
+}
+
+/**
+ * @brief Returns the device type (0: coordinator, 1: router, 2: end device)
+ */
+quint8 ZBIONodeIdentificationResponse::deviceType() const
+{
+    const int offset = trailerOffset();
+    return offset < 0 ? 0 : readField(offset + 2, 1);
+}
 
-exit:
-    return bRet;
+/**
+ * @brief Returns the event which triggered the indicator (1: button, 2: joining, 3: power cycle)
+ */
+quint8 ZBIONodeIdentificationResponse::sourceEvent() const
+{
+    const int offset = trailerOffset();
+    return offset < 0 ? 0 : readField(offset + 3, 1);
+}
+
+/**
+ * @brief Returns the Digi profile id
+ */
+quint16 ZBIONodeIdentificationResponse::digiProfileId() const
+{
+    const int offset = trailerOffset();
+    return offset < 0 ? 0 : readField(offset + 4, 2);
+}
+
+/**
+ * @brief Returns the Digi manufacturer id
+ */
+quint16 ZBIONodeIdentificationResponse::digiManufacturerId() const
+{
+    const int offset = trailerOffset();
+    return offset < 0 ? 0 : readField(offset + 6, 2);
 }
 
 QString ZBIONodeIdentificationResponse::toString() {
@@ -185,21 +188,21 @@ QString ZBIONodeIdentificationResponse::toString() {
     str.append(QString("Start delimiter              : 0x%1\n").arg(QString::number(startDelimiter(), 16)));
     str.append(QString("Frame type                   : %1 (0x%2)\n").arg(frameTypeToString(frameType())).arg(QString::number(frameType(), 16)));
     str.append(QString("Length                       : %1 bytes\n").arg(length()));
-    if(!m_data.isEmpty())
-    str.append(QString("Data                         : 0x%1\n").arg(QString(m_data.toHex())));
+    if(!data().isEmpty())
+    str.append(QString("Data                         : 0x%1\n").arg(QString(data().toHex())));
     else
     str.append(QString("Data                         : No data\n"));
-    str.append(QString("Sender Address 64bits        : 0x%1\n").arg(m_senderAddr64, 0, 16));
-    str.append(QString("Sender Address 16bits        : 0x%1\n").arg(m_senderAddr16, 0, 16));
-    str.append(QString("Receive Options              : 0x%1\n").arg(m_receiveOptions, 0, 16));
-    str.append(QString("Remote Address 16bits        : 0x%1\n").arg(m_remoteAddr16, 0, 16));
-    str.append(QString("Remote Address 64bits        : 0x%1\n").arg(m_remoteAddr64, 0, 16));
-    str.append(QString("Node Identifier              : %1\n").arg(m_nodeIdentifier));
-    str.append(QString("Remote Parent Address 16bits : 0x%1\n").arg(m_remoteParent16, 0, 16));
-    str.append(QString("Device Type                  : 0x%1\n").arg(m_deviceType, 0, 16));
-    str.append(QString("Source Event                 : 0x%1\n").arg(m_sourceEvent, 0, 16));
-    str.append(QString("Digi Profile ID              : 0x%1\n").arg(m_digiProfileId, 0, 16));
-    str.append(QString("Digi Manufacturer ID         : 0x%1\n").arg(m_digiManufacturerId, 0, 16));
+    str.append(QString("Sender Address 64bits        : 0x%1\n").arg(senderAddress64(), 0, 16));
+    str.append(QString("Sender Address 16bits        : 0x%1\n").arg(senderAddress16(), 0, 16));
+    str.append(QString("Receive Options              : 0x%1\n").arg(receiveOptions(), 0, 16));
+    str.append(QString("Remote Address 16bits        : 0x%1\n").arg(remoteAddress16(), 0, 16));
+    str.append(QString("Remote Address 64bits        : 0x%1\n").arg(remoteAddress64(), 0, 16));
+    str.append(QString("Node Identifier              : %1\n").arg(nodeIdentifier()));
+    str.append(QString("Remote Parent Address 16bits : 0x%1\n").arg(remoteParentAddress16(), 0, 16));
+    str.append(QString("Device Type                  : 0x%1\n").arg(deviceType(), 0, 16));
+    str.append(QString("Source Event                 : 0x%1\n").arg(sourceEvent(), 0, 16));
+    str.append(QString("Digi Profile ID              : 0x%1\n").arg(digiProfileId(), 0, 16));
+    str.append(QString("Digi Manufacturer ID         : 0x%1\n").arg(digiManufacturerId(), 0, 16));
     str.append(QString("Checksum                     : %1\n").arg(checksum()));
 
     return str;
@@ -31,28 +31,41 @@ namespace ZigBee {
  * transmits a node identification message to identify itself (when AO=0).
  *
  * The data portion of this frame is similar to a network discovery response frame (see ND command).
+ *
+ * Fields are decoded from the packet on first access only. The node identifier is variable length:
+ * it is walked once, then the fields located after it are read at the memoised offset.
  */
 class ZBIONodeIdentificationResponse : public XBeeResponse
 {
     Q_OBJECT
 public:
     explicit ZBIONodeIdentificationResponse(QObject *parent = 0);
-    virtual bool setPacket(const QByteArray &packet);
 
-    virtual QString toString() Q_DECL_OVERRIDE;
+    // Reimplemented from XBeePacket
+    virtual void    clear                   () Q_DECL_OVERRIDE;
+    virtual QString toString                () Q_DECL_OVERRIDE;
+
+    quint64         senderAddress64         () const;
+    quint16         senderAddress16         () const;
+    quint8          receiveOptions          () const;
+    quint16         remoteAddress16         () const;
+    quint64         remoteAddress64         () const;
+    QString         nodeIdentifier          () const;
+    quint16         remoteParentAddress16   () const;
+    quint8          deviceType              () const;
+    quint8          sourceEvent             () const;
+    quint16         digiProfileId           () const;
+    quint16         digiManufacturerId      () const;
+
+protected:
+    virtual bool    parseApiSpecificData    (const QByteArray &data) Q_DECL_OVERRIDE;
+
+private:
+    quint64         readField               (const int offset, const int size) const;
+    int             trailerOffset           () const;
 
 private:
-    quint64 m_senderAddr64;
-    quint16 m_senderAddr16;
-    quint8 m_receiveOptions;
-    quint16 m_remoteAddr16;
-    quint64 m_remoteAddr64;
-    QString m_nodeIdentifier;
-    quint16 m_remoteParent16;
-    quint8 m_deviceType;
-    quint8 m_sourceEvent;
-    quint16 m_digiProfileId;
-    quint16 m_digiManufacturerId;
+    mutable int     m_trailerOffset;        /**< Offset of the fields following the node identifier; 0 if not walked yet, -1 if invalid */
 };
 
 } } // END namepsace
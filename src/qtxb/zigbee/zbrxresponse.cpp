@@ -19,6 +19,7 @@
  */
 
 #include "zbrxresponse.h"
+#include "../codec/XBeeCodec"
 #include <QDebug>
 
 namespace QtXBee {
@@ -29,17 +30,11 @@ ZBRxResponse::ZBRxResponse(QObject *parent) :
 {
     setFrameType(ZBRxResponseId);
 }
-void ZBRxResponse::setSrcAddr64(QByteArray sa64) {
-    m_srcAddr64.clear();
-    m_srcAddr64.append(sa64);
+void ZBRxResponse::setSrcAddr64(const QByteArray &sa64) {
+    m_srcAddr64 = sa64;
 }
-void ZBRxResponse::setSrcAddr16(QByteArray sa16) {
-    m_srcAddr16.clear();
-    m_srcAddr16.append(sa16);
-}
-void ZBRxResponse::setData(QByteArray d) {
-    m_data.clear();
-    m_data.append(d);
+void ZBRxResponse::setSrcAddr16(const QByteArray &sa16) {
+    m_srcAddr16 = sa16;
 }
 QByteArray ZBRxResponse::srcAddr64() const {
     return m_srcAddr64;
@@ -53,32 +48,18 @@ void ZBRxResponse::setReceiveOptions(unsigned ro) {
 unsigned ZBRxResponse::receiveOptions() const {
     return m_receiveOptions;
 }
-QByteArray ZBRxResponse::data() const {
-    return m_data;
-}
 void ZBRxResponse::readPacket(QByteArray rx) {
     setPacket(rx);
     setStartDelimiter(rx.at(0));
     setLength(rx.at(2));
     if(rx.size() == rx.at(2)+4 && rx.size() > 15) {
         setFrameType((ApiId)rx.at(3));
-        m_srcAddr64.append(rx.at(4));
-        m_srcAddr64.append(rx.at(5));
-        m_srcAddr64.append(rx.at(6));
-        m_srcAddr64.append(rx.at(7));
-        m_srcAddr64.append(rx.at(8));
-        m_srcAddr64.append(rx.at(9));
-        m_srcAddr64.append(rx.at(10));
-        m_srcAddr64.append(rx.at(11));
-        m_srcAddr16.append(rx.at(12));
-        m_srcAddr16.append(rx.at(13));
+        m_srcAddr64 = rx.mid(4, 8);
+        m_srcAddr16 = rx.mid(12, 2);
         setReceiveOptions(rx.at(14));
-        int count = 15;
-        while(count < rx.size()-1) {
-            m_data.append(rx.at(count));
-            count++;
-        }
-        setChecksum(rx.at(count));
+        // The data is sliced from the packet on access
+        setDataOffset(Codec::Layout::ZBRxResponse::Data);
+        setChecksum(rx.at(rx.size()-1));
     }else{
 
         qDebug()<< "Invalid Packet Received!";
@@ -19,6 +19,9 @@
  */
 
 #include "zbtxrequest.h"
+#include "../codec/XBeeCodec"
+
+#include <utility>
 
 namespace QtXBee {
 namespace ZigBee {
@@ -51,17 +54,20 @@ void ZBTxRequest::setBroadcastRadius(int rad){
 void ZBTxRequest::setTransmitOptions(unsigned to){
     m_transmitOptions = to;
 }
-void ZBTxRequest::setDestAddr64(QByteArray da64){
-    m_destAddr64.clear();
-    m_destAddr64.append(da64);
+void ZBTxRequest::setDestAddr64(const QByteArray &da64){
+    m_destAddr64 = da64;
+}
+void ZBTxRequest::setDestAddr16(const QByteArray &da16){
+    m_destAddr16 = da16;
+}
+void ZBTxRequest::setData(const QByteArray &d){
+    m_data = d;
 }
-void ZBTxRequest::setDestAddr16(QByteArray da16){
-    m_destAddr16.clear();
-    m_destAddr16.append(da16);
+void ZBTxRequest::setData(QByteArray &&d){
+    m_data = std::move(d);
 }
-void ZBTxRequest::setData(QByteArray d){
-    m_data.clear();
-    m_data.append(d);
+void ZBTxRequest::setData(const char *d, const int size){
+    m_data = QByteArray(d, size);
 }
 QByteArray ZBTxRequest::destAddr64() const{
     return m_destAddr64;
@@ -79,20 +85,18 @@ QByteArray ZBTxRequest::getData() const{
     return m_data;
 }
 void ZBTxRequest::assemblePacket(){
-    m_packet.clear();
-    m_packet.append(frameType());
-    m_packet.append(frameId());
-    m_packet.append(destAddr64());
-    m_packet.append(destAddr16());
-    m_packet.append(broadcastRadius());
-    m_packet.append(transmitOptions());
-    m_packet.append(getData());
-    setLength(m_packet.size());
-    createChecksum(m_packet);
-    m_packet.append(checksum());
-    m_packet.insert(0, startDelimiter());
-    m_packet.insert(1, (length()>>8)&0xFF);
-    m_packet.insert(2, length()&0xFF);
+    const QByteArray data = getData();
+    const int dataOffset = Codec::Layout::ZBTxRequest::Data - Codec::Layout::ZBTxRequest::Destination64
+            + destAddr64().size() + destAddr16().size();
+    m_packet.resize(Codec::frameSize(dataOffset, data.size()));
+    setEncodedSize(Codec::FrameWriter(encodeBuffer(), m_packet.size())
+                   .begin(frameType(), frameId())
+                   .put(destAddr64().constData(), destAddr64().size())
+                   .put(destAddr16().constData(), destAddr16().size())
+                   .put8(broadcastRadius())
+                   .put8(transmitOptions())
+                   .put(data.constData(), data.size())
+                   .finish());
 }
 
 } } // END namepsace
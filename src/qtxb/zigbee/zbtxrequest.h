@@ -54,9 +54,11 @@ public:
 
     void        setBroadcastRadius  (int rad);
     void        setTransmitOptions  (unsigned to);
-    void        setDestAddr64       (QByteArray da64);
-    void        setDestAddr16       (QByteArray da16);
-    void        setData             (QByteArray d);
+    void        setDestAddr64       (const QByteArray & da64);
+    void        setDestAddr16       (const QByteArray & da16);
+    void        setData             (const QByteArray & d);
+    void        setData             (QByteArray && d);
+    void        setData             (const char * d, const int size);
 
     QByteArray  destAddr64          () const;
     QByteArray  destAddr16          () const;
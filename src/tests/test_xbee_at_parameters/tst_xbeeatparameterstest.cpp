@@ -0,0 +1,89 @@
+#include <QString>
+#include <QtTest>
+#include <QCoreApplication>
+
+#include <ATCommand>
+#include <ATParameter>
+
+using namespace QtXBee;
+
+class XbeeATParametersTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    XbeeATParametersTest();
+
+private Q_SLOTS:
+    void testLookup();
+    void testStringConversion();
+    void testEncode();
+    void testDecode();
+};
+
+XbeeATParametersTest::XbeeATParametersTest()
+{
+}
+
+void XbeeATParametersTest::testLookup()
+{
+    static_assert(ATParameter::isKnown(ATCommand::ATDH), "DH must be known at compile time");
+    static_assert(ATParameter::find(ATCommand::ATSH)->isReadOnly(), "SH must be read only");
+
+    for(int i=0; i<ATParameters::Count; i++) {
+        const ATParameter & p = ATParameters::table[i];
+        QVERIFY2(ATParameter::find(p.command()) == &p,
+                 QString("Lookup failed for 0x%1").arg(p.command(), 0, 16).toStdString().c_str());
+    }
+
+    QVERIFY2(ATParameter::find(0x4142) == NULL, "Unknown command found");
+    QVERIFY2(ATParameter::commandFromCode(0x4142) == ATCommand::ATUndefined, "Unknown command must be ATUndefined");
+    QVERIFY2(ATParameter::find(ATCommand::ATDH)->width() == 4, "DH width must be 4 bytes");
+    QVERIFY2(ATParameter::find(ATCommand::ATWR)->isExecutable(), "WR must be executable");
+}
+
+void XbeeATParametersTest::testStringConversion()
+{
+    QVERIFY2(ATCommand::atCommandFromByteArray("CH") == ATCommand::ATCH, "Bad CH conversion");
+    QVERIFY2(ATCommand::atCommandFromByteArray("1S") == ATCommand::AT1S, "Bad 1S conversion");
+    QVERIFY2(ATCommand::atCommandFromByteArray("ZZ") == ATCommand::ATUndefined, "ZZ must be undefined");
+    QVERIFY2(ATCommand::atCommandFromByteArray("CHX") == ATCommand::ATUndefined, "Bad size must be undefined");
+    QVERIFY2(ATCommand::atCommandToString(ATCommand::ATNI) == "NI", "Bad NI conversion");
+    QVERIFY2(ATCommand::atCommandToString(ATCommand::ATUndefined).isEmpty(), "ATUndefined must be empty");
+}
+
+void XbeeATParametersTest::testEncode()
+{
+    QByteArray out;
+
+    QVERIFY2(ATParameter::find(ATCommand::ATDH)->encode(0x0013A200, &out), "Failed to encode DH");
+    QVERIFY2(out == QByteArray::fromHex("0013a200"), "Bad DH encoding");
+
+    QVERIFY2(ATParameter::find(ATCommand::ATMY)->encode(0x1234, &out), "Failed to encode MY");
+    QVERIFY2(out == QByteArray::fromHex("1234"), "Bad MY encoding");
+
+    QVERIFY2(!ATParameter::find(ATCommand::ATCH)->encode(0x30, &out), "CH out of range accepted");
+    QVERIFY2(!ATParameter::find(ATCommand::ATSH)->encode(0, &out), "Read only SH accepted");
+    QVERIFY2(!ATParameter::find(ATCommand::ATNI)->encode(0, &out), "Numeric NI accepted");
+
+    QVERIFY2(ATParameter::find(ATCommand::ATNI)->encode(QByteArray("ROUTER"), &out), "Failed to encode NI");
+    QVERIFY2(out == "ROUTER", "Bad NI encoding");
+    QVERIFY2(!ATParameter::find(ATCommand::ATNI)->encode(QByteArray(21, 'A'), &out), "Too long NI accepted");
+}
+
+void XbeeATParametersTest::testDecode()
+{
+    quint64 value = 0;
+
+    QVERIFY2(ATParameter::find(ATCommand::ATSL)->decode(QByteArray::fromHex("40a1b2c3"), &value), "Failed to decode SL");
+    QVERIFY2(value == 0x40A1B2C3, "Bad SL decoding");
+
+    QVERIFY2(ATParameter::find(ATCommand::ATDH)->decode(QByteArray::fromHex("01"), &value), "Failed to decode short DH");
+    QVERIFY2(value == 1, "Bad short DH decoding");
+
+    QVERIFY2(!ATParameter::find(ATCommand::ATNI)->decode(QByteArray("ROUTER"), &value), "String NI decoded as numeric");
+}
+
+QTEST_APPLESS_MAIN(XbeeATParametersTest)
+
+#include "tst_xbeeatparameterstest.moc"
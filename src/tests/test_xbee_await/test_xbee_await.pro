@@ -0,0 +1,25 @@
+#-------------------------------------------------
+#
+# Project created by QtCreator 2015-06-09T16:35:48
+#
+#-------------------------------------------------
+
+QT       += testlib
+QT       -= gui
+
+include(../tests.pri)
+
+TARGET = tst_xbeeawaittest
+CONFIG   += console
+CONFIG   -= app_bundle
+
+# The awaitable operations need C++20 coroutines
+CONFIG   -= c++14
+CONFIG   += c++2a
+*g++*: QMAKE_CXXFLAGS += -fcoroutines
+
+TEMPLATE = app
+
+
+SOURCES += tst_xbeeawaittest.cpp
+DEFINES += SRCDIR=\\\"$$PWD/\\\"
@@ -0,0 +1,218 @@
+#include <QString>
+#include <QtTest>
+#include <QCoreApplication>
+
+#include <XBee>
+#include <XBeeAwait>
+
+#include <stdexcept>
+
+using namespace QtXBee;
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#define HAS_COROUTINES
+
+// Modem status frame (coordinator started)
+static const QByteArray ModemStatus = QByteArray::fromHex("7e00028a066f");
+
+static bool isModemStatus(const QByteArray & frame)
+{
+    return frame.size() > 3 && (quint8)frame.at(3) == 0x8A;
+}
+
+static Task<int> answer()
+{
+    co_return 42;
+}
+
+static Task<int> nextModemStatusSize(XBee * xbee, const int timeout)
+{
+    const QByteArray frame = co_await awaitFrame(xbee, isModemStatus, timeout);
+    co_return frame.size();
+}
+
+static Task<int> failing(XBee * xbee)
+{
+    co_await awaitFrame(xbee, isModemStatus, 10);
+    throw std::runtime_error("failed");
+}
+
+static Task<> storeAnswer(int * out)
+{
+    *out = co_await answer();
+}
+
+static Task<> storeModemStatusSize(XBee * xbee, const int timeout, int * out)
+{
+    *out = co_await nextModemStatusSize(xbee, timeout);
+}
+
+static Task<> catchFailure(XBee * xbee, bool * caught)
+{
+    try {
+        co_await failing(xbee);
+    }
+    catch(const std::runtime_error &) {
+        *caught = true;
+    }
+}
+
+static Task<> storeCommand(XBee * xbee, CommandResult * out)
+{
+    *out = co_await awaitATCommand(xbee, ATCommand::ATVR);
+}
+
+static Task<> storeAssociation(XBee * xbee, const int timeout, int * out)
+{
+    *out = co_await awaitAssociation(xbee, timeout);
+}
+#endif
+
+class XbeeAwaitTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    XbeeAwaitTest();
+
+private Q_SLOTS:
+    void testValue();
+    void testResume();
+    void testTimeout();
+    void testException();
+    void testDetached();
+    void testXBeeDestroyed();
+    void testWithoutDevice();
+};
+
+XbeeAwaitTest::XbeeAwaitTest()
+{
+}
+
+/**
+ * A coroutine which doesn't suspend completes within the call.
+ */
+void XbeeAwaitTest::testValue()
+{
+#ifdef HAS_COROUTINES
+    int value = 0;
+    Task<> task = storeAnswer(&value);
+
+    QVERIFY2(task.isDone(), "Task not done");
+    QVERIFY2(value == 42, "Bad value");
+#else
+    QSKIP("No C++20 coroutine support");
+#endif
+}
+
+/**
+ * The coroutine is resumed from the event loop, not from within the signal.
+ */
+void XbeeAwaitTest::testResume()
+{
+#ifdef HAS_COROUTINES
+    XBee xbee;
+    int size = -1;
+    Task<> task = storeModemStatusSize(&xbee, -1, &size);
+
+    QVERIFY2(!task.isDone(), "Task done before the frame");
+    emit xbee.receivedFrames(QVector<QByteArray>() << QByteArray::fromHex("7e000389010075") << ModemStatus);
+    QVERIFY2(size == -1, "Coroutine resumed from within the signal");
+    QTRY_VERIFY2(task.isDone(), "Task not resumed");
+    QVERIFY2(size == ModemStatus.size(), "Bad frame");
+#else
+    QSKIP("No C++20 coroutine support");
+#endif
+}
+
+void XbeeAwaitTest::testTimeout()
+{
+#ifdef HAS_COROUTINES
+    XBee xbee;
+    int size = -1;
+    Task<> task = storeModemStatusSize(&xbee, 20, &size);
+
+    QTRY_VERIFY2(task.isDone(), "Operation not timed out");
+    QVERIFY2(size == 0, "Frame returned on timeout");
+#else
+    QSKIP("No C++20 coroutine support");
+#endif
+}
+
+/**
+ * An exception thrown after a suspension is rethrown to the awaiting coroutine.
+ */
+void XbeeAwaitTest::testException()
+{
+#ifdef HAS_COROUTINES
+    XBee xbee;
+    bool caught = false;
+    Task<> task = catchFailure(&xbee, &caught);
+
+    QTRY_VERIFY2(task.isDone(), "Task not done");
+    QVERIFY2(caught, "Exception not rethrown by co_await");
+#else
+    QSKIP("No C++20 coroutine support");
+#endif
+}
+
+/**
+ * A dropped Task keeps running until it returns.
+ */
+void XbeeAwaitTest::testDetached()
+{
+#ifdef HAS_COROUTINES
+    XBee xbee;
+    int size = -1;
+
+    storeModemStatusSize(&xbee, -1, &size);
+    emit xbee.receivedFrames(QVector<QByteArray>() << ModemStatus);
+    QTRY_VERIFY2(size == 6, "Dropped task not resumed");
+#else
+    QSKIP("No C++20 coroutine support");
+#endif
+}
+
+/**
+ * Destroying the XBee completes its pending operations.
+ */
+void XbeeAwaitTest::testXBeeDestroyed()
+{
+#ifdef HAS_COROUTINES
+    XBee * xbee = new XBee();
+    int size = -1;
+    Task<> task = storeModemStatusSize(xbee, -1, &size);
+
+    delete xbee;
+    QTRY_VERIFY2(task.isDone(), "Operation not completed by the XBee's destruction");
+    QVERIFY2(size == 0, "Frame returned");
+#else
+    QSKIP("No C++20 coroutine support");
+#endif
+}
+
+/**
+ * Without serial port, commands fail right away and the association times out.
+ */
+void XbeeAwaitTest::testWithoutDevice()
+{
+#ifdef HAS_COROUTINES
+    XBee xbee;
+    CommandResult result;
+    int associated = -1;
+
+    result.timedOut = false;
+    storeCommand(&xbee, &result);
+    QVERIFY2(result.timedOut && !result.ok, "Command without device succeeded");
+
+    Task<> task = storeAssociation(&xbee, 20, &associated);
+    QTRY_VERIFY2(task.isDone(), "Association not timed out");
+    QVERIFY2(associated == 0, "Associated without device");
+#else
+    QSKIP("No C++20 coroutine support");
+#endif
+}
+
+QTEST_GUILESS_MAIN(XbeeAwaitTest)
+
+#include "tst_xbeeawaittest.moc"
@@ -0,0 +1,207 @@
+#include <QString>
+#include <QtTest>
+#include <QCoreApplication>
+
+#include <ByteSlice>
+#include <ATCommandResponse>
+#include <RemoteATCommandResponse>
+#include <wpan/RxResponse16>
+#include <wpan/RxResponse64>
+#include <zigbee/zbrxresponse.h>
+
+using namespace QtXBee;
+
+class XbeeByteSliceTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    XbeeByteSliceTest();
+
+private Q_SLOTS:
+    void testConstruction();
+    void testBounds();
+    void testMid();
+    void testSharing();
+    void testCompare();
+    void testATCommandResponsePayload();
+    void testRemoteATCommandResponsePayload();
+    void testRxResponsePayload();
+    void testZBRxResponsePayload();
+    void testEmptyPayload();
+    void testPayloadOutlivesResponse();
+};
+
+/**
+ * Builds an API frame around the given payload (API id included).
+ */
+static QByteArray frame(const QByteArray & payload)
+{
+    QByteArray f;
+    quint8 sum = 0;
+
+    f.append((char)0x7E);
+    f.append((char)((payload.size() >> 8) & 0xFF));
+    f.append((char)(payload.size() & 0xFF));
+    f.append(payload);
+    for(int i=0; i<payload.size(); i++) {
+        sum += (quint8)payload.at(i);
+    }
+    f.append((char)(0xFF - sum));
+    return f;
+}
+
+XbeeByteSliceTest::XbeeByteSliceTest()
+{
+}
+
+void XbeeByteSliceTest::testConstruction()
+{
+    const QByteArray bytes("0123456789");
+
+    QVERIFY2(ByteSlice().isEmpty(), "Default slice not empty");
+    QVERIFY2(ByteSlice().size() == 0, "Bad default slice size");
+
+    const ByteSlice whole(bytes);
+    QVERIFY2(whole.size() == 10, "Bad whole slice size");
+    QVERIFY2(whole.toByteArray() == bytes, "Bad whole slice content");
+
+    const ByteSlice part(bytes, 2, 3);
+    QVERIFY2(part.size() == 3, "Bad slice size");
+    QVERIFY2(part.at(0) == '2' && part.at(2) == '4', "Bad slice content");
+    QVERIFY2(part.toByteArray() == "234", "Bad slice copy");
+    QVERIFY2(part.toHex() == "323334", "Bad slice hex");
+    QVERIFY2(part.end() - part.begin() == 3, "Bad slice iterators");
+
+    const ByteSlice tail(bytes, 7);
+    QVERIFY2(tail.toByteArray() == "789", "Slice without size doesn't run to the end");
+}
+
+/**
+ * Out of range offsets and sizes are clamped to the storage.
+ */
+void XbeeByteSliceTest::testBounds()
+{
+    const QByteArray bytes("0123456789");
+
+    QVERIFY2(ByteSlice(bytes, 8, 10).toByteArray() == "89", "Size not clamped");
+    QVERIFY2(ByteSlice(bytes, 12, 2).isEmpty(), "Offset past the end not clamped");
+    QVERIFY2(ByteSlice(bytes, 10).isEmpty(), "Slice at the end not empty");
+    QVERIFY2(ByteSlice(bytes, -3, 2).toByteArray() == "01", "Negative offset not clamped");
+}
+
+void XbeeByteSliceTest::testMid()
+{
+    const QByteArray bytes("0123456789");
+    const ByteSlice slice(bytes, 2, 6);   // "234567"
+
+    QVERIFY2(slice.mid(1, 2).toByteArray() == "34", "Bad mid");
+    QVERIFY2(slice.mid(4).toByteArray() == "67", "Mid without size doesn't stop at the slice's end");
+    QVERIFY2(slice.mid(4, 10).toByteArray() == "67", "Mid size not clamped to the slice");
+    QVERIFY2(slice.mid(8).isEmpty(), "Mid past the slice's end not empty");
+    QVERIFY2(slice.mid(1).mid(1, 1).toByteArray() == "4", "Bad nested mid");
+}
+
+/**
+ * Slices view the storage without copying it and keep it alive.
+ */
+void XbeeByteSliceTest::testSharing()
+{
+    QByteArray bytes("0123456789");
+    const char * data = bytes.constData();
+
+    const ByteSlice whole(bytes);
+    const ByteSlice part(bytes, 4, 2);
+    QVERIFY2(part.constData() == data + 4, "Slice copied the bytes");
+    QVERIFY2(part.mid(1).constData() == data + 5, "Mid copied the bytes");
+    QVERIFY2(whole.toByteArray().constData() == data, "Whole slice copied on conversion");
+    QVERIFY2(part.storage().constData() == data, "Storage not shared");
+
+    bytes[4] = 'x';
+    bytes.clear();
+    QVERIFY2(part.toByteArray() == "45", "Slice changed with its source array");
+}
+
+void XbeeByteSliceTest::testCompare()
+{
+    const QByteArray bytes("abcabc");
+
+    QVERIFY2(ByteSlice(bytes, 0, 3) == ByteSlice(bytes, 3, 3), "Equal slices not equal");
+    QVERIFY2(ByteSlice(bytes, 0, 3) != ByteSlice(bytes, 1, 3), "Different slices equal");
+    QVERIFY2(ByteSlice(bytes, 0, 2) != ByteSlice(bytes, 0, 3), "Slices of different sizes equal");
+    QVERIFY2(ByteSlice(bytes, 6) == ByteSlice(), "Empty slices not equal");
+}
+
+void XbeeByteSliceTest::testATCommandResponsePayload()
+{
+    // NI response: frame id 1, OK, "ROUTER"
+    const QByteArray packet = frame(QByteArray::fromHex("88" "01" "4e49" "00") + "ROUTER");
+    ATCommandResponse rep(packet);
+
+    QVERIFY2(rep.payload().toByteArray() == "ROUTER", "Bad payload");
+    QVERIFY2(rep.payload().constData() == rep.packet().constData() + 8, "Payload not sliced from the packet");
+    QVERIFY2(rep.data() == "ROUTER", "Bad data");
+}
+
+void XbeeByteSliceTest::testRemoteATCommandResponsePayload()
+{
+    // Remote DB response: frame id 1, OK, 0x28
+    const QByteArray packet = frame(QByteArray::fromHex("97" "01" "0013a20040a1b2c3" "fffe" "4442" "00" "28"));
+    RemoteATCommandResponse rep(packet);
+
+    QVERIFY2(rep.payload().toHex() == "28", "Bad payload");
+    QVERIFY2(rep.payload().constData() == rep.packet().constData() + 18, "Payload not sliced from the packet");
+}
+
+void XbeeByteSliceTest::testRxResponsePayload()
+{
+    RxResponse16 rx16;
+    RxResponse64 rx64;
+
+    QVERIFY2(rx16.setPacket(frame(QByteArray::fromHex("81" "0002" "28" "00" "0102"))), "Failed to set packet");
+    QVERIFY2(rx16.payload().toHex() == "0102", "Bad Rx16 payload");
+    QVERIFY2(rx16.payload().constData() == rx16.packet().constData() + 8, "Rx16 payload not sliced from the packet");
+
+    QVERIFY2(rx64.setPacket(frame(QByteArray::fromHex("80" "0013a20040a1b2c3" "28" "00" "0102"))), "Failed to set packet");
+    QVERIFY2(rx64.payload().toHex() == "0102", "Bad Rx64 payload");
+    QVERIFY2(rx64.payload().constData() == rx64.packet().constData() + 14, "Rx64 payload not sliced from the packet");
+}
+
+void XbeeByteSliceTest::testZBRxResponsePayload()
+{
+    ZBRxResponse rx(NULL);
+
+    rx.readPacket(frame(QByteArray::fromHex("90" "0013a20040a1b2c3" "1234" "01" "0a0b0c")));
+    QVERIFY2(rx.payload().toHex() == "0a0b0c", "Bad payload");
+    QVERIFY2(rx.payload().constData() == rx.packet().constData() + 15, "Payload not sliced from the packet");
+}
+
+/**
+ * The checksum is never part of the payload, even when there is no data.
+ */
+void XbeeByteSliceTest::testEmptyPayload()
+{
+    ATCommandResponse rep(frame(QByteArray::fromHex("88" "01" "4e49" "00")));
+    RxResponse16 rx;
+
+    QVERIFY2(rep.payload().isEmpty(), "Checksum in the payload");
+    QVERIFY2(rep.data().isEmpty(), "Checksum in the data");
+
+    QVERIFY2(rx.setPacket(frame(QByteArray::fromHex("81" "0002" "28" "00"))), "Failed to set packet");
+    QVERIFY2(rx.payload().isEmpty(), "Checksum in the payload");
+}
+
+void XbeeByteSliceTest::testPayloadOutlivesResponse()
+{
+    ByteSlice payload;
+    {
+        RxResponse16 rx;
+        rx.setPacket(frame(QByteArray::fromHex("81" "0002" "28" "00") + "kept"));
+        payload = rx.payload();
+    }
+    QVERIFY2(payload.toByteArray() == "kept", "Payload lost with its response");
+}
+
+QTEST_GUILESS_MAIN(XbeeByteSliceTest)
+
+#include "tst_xbeebyteslicetest.moc"
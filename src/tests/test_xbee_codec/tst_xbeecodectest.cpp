@@ -0,0 +1,241 @@
+#include <QString>
+#include <QtTest>
+#include <QCoreApplication>
+
+#include <codec/XBeeCodec>
+#include <XBeePacket>
+#include <ATCommand>
+#include <RemoteATCommandRequest>
+#include <wpan/TxRequest16>
+
+using namespace QtXBee;
+
+class XbeeCodecTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    XbeeCodecTest();
+
+private Q_SLOTS:
+    void testTxRequest16();
+    void testATCommand();
+    void testRemoteATCommand();
+    void testOverflow();
+    void testEscape();
+    void testParser();
+    void testParserEscaped();
+    void testParserOversize();
+    void testFrameView();
+
+private:
+    QByteArray parse(const QByteArray & stream, bool escaped, int * frames, quint32 * errors);
+};
+
+XbeeCodecTest::XbeeCodecTest()
+{
+}
+
+/**
+ * Pushes the given stream into a parser, returns the concatenation of the frames extracted.
+ */
+QByteArray XbeeCodecTest::parse(const QByteArray &stream, bool escaped, int *frames, quint32 *errors)
+{
+    Codec::FrameParser<64> parser;
+    QByteArray out;
+
+    *frames = 0;
+    parser.setEscaped(escaped);
+    for(int i=0; i<stream.size(); i++) {
+        if(parser.push((quint8)stream.at(i))) {
+            out.append((const char*)parser.frame(), parser.frameSize());
+            (*frames)++;
+        }
+    }
+    *errors = parser.errorCount();
+    return out;
+}
+
+void XbeeCodecTest::testTxRequest16()
+{
+    const QByteArray expected = QByteArray::fromHex("7e0009010100020074656d7045");
+    quint8 buffer[Codec::frameSize(Codec::Layout::TxRequest16::Data, 4)];
+
+    const size_t size = Codec::encodeTxRequest16(buffer, sizeof(buffer), 0x01, 0x0002, 0, "temp", 4);
+    QCOMPARE(QByteArray((const char*)buffer, size), expected);
+
+    Wpan::TxRequest16 tx;
+    tx.setFrameId(0x01);
+    tx.setDestinationAddress(0x0002);
+    tx.setData("temp");
+    tx.assemblePacket();
+    QCOMPARE(tx.packet(), expected);
+    QCOMPARE((int)tx.length(), expected.size() - 4);
+    QCOMPARE(tx.checksum(), 0x45u);
+}
+
+void XbeeCodecTest::testATCommand()
+{
+    const QByteArray expected = QByteArray::fromHex("7e000a08014e49524f55544552");
+    quint8 buffer[32];
+
+    const size_t size = Codec::encodeATCommand(buffer, sizeof(buffer), 0x01, "NI", "ROUTER", 6);
+    QByteArray frame((const char*)buffer, size);
+    QCOMPARE(frame.left(frame.size() - 1), expected);
+    QCOMPARE((quint8)frame.at(frame.size() - 1),
+             Codec::checksum((const quint8*)frame.constData() + 3, frame.size() - 4));
+
+    ATCommand at;
+    at.setFrameId(0x01);
+    at.setCommand(ATCommand::ATNI);
+    at.setParameter("ROUTER");
+    at.assemblePacket();
+    QCOMPARE(at.packet(), frame);
+}
+
+void XbeeCodecTest::testRemoteATCommand()
+{
+    const QByteArray expected = QByteArray::fromHex("7e001017010013a20040a1b2c3fffe0244300564");
+    quint8 buffer[32];
+    const quint8 parameter = 0x05;
+
+    const size_t size = Codec::encodeRemoteATCommand(buffer, sizeof(buffer), 0x01,
+                                                     Q_UINT64_C(0x0013A20040A1B2C3), 0xFFFE,
+                                                     RemoteATCommandRequest::ApplyChanges,
+                                                     "D0", &parameter, 1);
+    QCOMPARE(QByteArray((const char*)buffer, size), expected);
+
+    RemoteATCommandRequest at;
+    at.setFrameId(0x01);
+    at.setDestinationAddress64(Q_UINT64_C(0x0013A20040A1B2C3));
+    at.setDestinationAddress16(0xFFFE);
+    at.setCommandOptions(RemoteATCommandRequest::ApplyChanges);
+    at.setCommand(ATCommand::ATD0);
+    at.setParameter(QByteArray(1, parameter));
+    at.assemblePacket();
+    QCOMPARE(at.packet(), expected);
+}
+
+void XbeeCodecTest::testOverflow()
+{
+    quint8 buffer[Codec::frameSize(Codec::Layout::TxRequest16::Data, 4)];
+
+    QCOMPARE(Codec::encodeTxRequest16(buffer, sizeof(buffer) - 1, 0x01, 0x0002, 0, "temp", 4), (size_t)0);
+    QCOMPARE(Codec::encodeTxRequest16(buffer, 3, 0x01, 0x0002, 0, "temp", 4), (size_t)0);
+    QCOMPARE(Codec::encodeTxRequest16(buffer, sizeof(buffer), 0x01, 0x0002, 0, "temp", 4), sizeof(buffer));
+
+    Codec::FrameWriter writer(buffer, sizeof(buffer));
+    writer.begin(Codec::TxRequest16Id, 0x01).put("0123456789", 10);
+    QVERIFY(writer.hasOverflowed());
+    QCOMPARE(writer.finish(), (size_t)0);
+}
+
+void XbeeCodecTest::testEscape()
+{
+    // Frame id 0x7D, data holding every special byte
+    quint8 frame[32];
+    const size_t size = Codec::encodeTxRequest16(frame, sizeof(frame), 0x7D, 0x1113, 0, "\x7e\x7d\x11\x13", 4);
+    const QByteArray raw((const char*)frame, size);
+
+    quint8 escaped[64];
+    const size_t escapedSize = Codec::escape(frame, size, escaped, sizeof(escaped));
+    QCOMPARE(escapedSize, Codec::escapedSize(frame, size));
+    QCOMPARE(QByteArray((const char*)escaped, escapedSize), XBeePacket::escape(raw));
+    QCOMPARE(escaped[0], (quint8)Codec::StartDelimiter);
+    QCOMPARE(Codec::escape(frame, size, escaped, escapedSize - 1), (size_t)0);
+
+    // In place
+    bool ok = false;
+    QCOMPARE(Codec::unescape(escaped, escapedSize, escaped, &ok), size);
+    QVERIFY(ok);
+    QCOMPARE(QByteArray((const char*)escaped, size), raw);
+
+    const quint8 truncated[] = { 0x01, Codec::Escape };
+    Codec::unescape(truncated, sizeof(truncated), escaped, &ok);
+    QVERIFY(!ok);
+}
+
+void XbeeCodecTest::testParser()
+{
+    const QByteArray good = QByteArray::fromHex("7e0009811234280074656d705a");
+    QByteArray bad = good;
+    bad[bad.size() - 1] = 0x00;
+
+    int frames = 0;
+    quint32 errors = 0;
+    const QByteArray out = parse(QByteArray("garbage") + good + bad + good, false, &frames, &errors);
+    QCOMPARE(frames, 2);
+    QCOMPARE(errors, 1u);
+    QCOMPARE(out, good + good);
+
+    // Split reads
+    Codec::FrameParser<64> parser;
+    const size_t half = good.size() / 2;
+    QCOMPARE(parser.feed((const quint8*)good.constData(), half), half);
+    QVERIFY(!parser.hasFrame());
+    QCOMPARE(parser.feed((const quint8*)good.constData() + half, good.size() - half), good.size() - half);
+    QVERIFY(parser.hasFrame());
+    QVERIFY(parser.view().isValid());
+}
+
+void XbeeCodecTest::testParserEscaped()
+{
+    quint8 frame[32];
+    const size_t size = Codec::encodeTxRequest16(frame, sizeof(frame), 0x7D, 0x1113, 0, "\x7e\x7d\x11\x13", 4);
+    const QByteArray raw((const char*)frame, size);
+    const QByteArray escaped = XBeePacket::escape(raw);
+
+    int frames = 0;
+    quint32 errors = 0;
+    // A truncated frame, ended by the next start delimiter
+    QByteArray out = parse(escaped.left(6) + escaped + escaped, true, &frames, &errors);
+    QCOMPARE(frames, 2);
+    QCOMPARE(errors, 1u);
+    QCOMPARE(out, raw + raw);
+
+    // Escaped frames given to a parser in API mode 1
+    out = parse(escaped, false, &frames, &errors);
+    QCOMPARE(frames, 0);
+}
+
+void XbeeCodecTest::testParserOversize()
+{
+    const QByteArray good = QByteArray::fromHex("7e0009811234280074656d705a");
+    quint8 large[64];
+    const size_t size = Codec::encodeTxRequest16(large, sizeof(large), 0x01, 0x0002, 0,
+                                                 "0123456789012345678901234567890123456789", 40);
+
+    Codec::FrameParser<16> parser;
+    int frames = 0;
+    const QByteArray stream = QByteArray((const char*)large, size) + good;
+    for(int i=0; i<stream.size(); i++) {
+        if(parser.push((quint8)stream.at(i))) {
+            QCOMPARE(QByteArray((const char*)parser.frame(), parser.frameSize()), good);
+            frames++;
+        }
+    }
+    QCOMPARE(frames, 1);
+    QCOMPARE(parser.errorCount(), 1u);
+}
+
+void XbeeCodecTest::testFrameView()
+{
+    const QByteArray rx = QByteArray::fromHex("7e0009811234280074656d705a");
+    const Codec::FrameView view((const quint8*)rx.constData(), rx.size());
+
+    QVERIFY(view.isValid());
+    QCOMPARE(view.apiId(), (quint8)Codec::Rx16ResponseId);
+    QCOMPARE(view.u16(Codec::Layout::Rx16Response::Source), (quint16)0x1234);
+    QCOMPARE(view.u8(Codec::Layout::Rx16Response::Rssi), (quint8)0x28);
+    QCOMPARE(view.u8(Codec::Layout::Rx16Response::Options), (quint8)0x00);
+    QCOMPARE(QByteArray((const char*)view.data(Codec::Layout::Rx16Response::Data),
+                        view.dataSize(Codec::Layout::Rx16Response::Data)), QByteArray("temp"));
+
+    // Reads past the end
+    QCOMPARE(view.u64(rx.size() - 4), Q_UINT64_C(0));
+    QVERIFY(!Codec::FrameView((const quint8*)rx.constData(), rx.size() - 1).isValid());
+}
+
+QTEST_APPLESS_MAIN(XbeeCodecTest)
+
+#include "tst_xbeecodectest.moc"
@@ -0,0 +1,20 @@
+#-------------------------------------------------
+#
+# Project created by QtCreator 2015-06-09T16:35:48
+#
+#-------------------------------------------------
+
+QT       += testlib
+QT       -= gui
+
+include(../tests.pri)
+
+TARGET = tst_xbeeframefiltertest
+CONFIG   += console
+CONFIG   -= app_bundle
+
+TEMPLATE = app
+
+
+SOURCES += tst_xbeeframefiltertest.cpp
+DEFINES += SRCDIR=\\\"$$PWD/\\\"
@@ -0,0 +1,185 @@
+#include <QString>
+#include <QtTest>
+#include <QCoreApplication>
+
+#include <FrameFilter>
+
+using namespace QtXBee;
+
+static QByteArray frame(const QByteArray & payload)
+{
+    QByteArray f;
+    quint8 sum = 0;
+
+    f.append((char)0x7E);
+    f.append((char)((payload.size() >> 8) & 0xFF));
+    f.append((char)(payload.size() & 0xFF));
+    f.append(payload);
+    for(int i=0; i<payload.size(); i++) {
+        sum += (quint8)payload.at(i);
+    }
+    f.append((char)(0xFF - sum));
+    return f;
+}
+
+// Rx16 (0x81) from the given source, RSSI 0x28
+static QByteArray rx16(const quint16 source, const quint8 options, const QByteArray & data)
+{
+    QByteArray payload = QByteArray::fromHex("81");
+    payload.append((char)(source >> 8)).append((char)(source & 0xFF));
+    payload.append((char)0x28).append((char)options).append(data);
+    return frame(payload);
+}
+
+class XbeeFrameFilterTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    XbeeFrameFilterTest();
+
+private Q_SLOTS:
+    void testEmpty();
+    void testFrameType();
+    void testAddresses();
+    void testOptions();
+    void testPrefix();
+    void testTruncated();
+    void testFromString();
+    void testFromStringInvalid();
+};
+
+XbeeFrameFilterTest::XbeeFrameFilterTest()
+{
+}
+
+void XbeeFrameFilterTest::testEmpty()
+{
+    FrameFilter filter;
+
+    QVERIFY2(filter.isEmpty(), "New filter not empty");
+    QVERIFY2(filter.accepts(rx16(0x0002, 0, "temp")), "Empty filter rejected a frame");
+
+    filter.addFrameType(0x81);
+    QVERIFY2(!filter.isEmpty(), "Filter with a frame type empty");
+    filter.clear();
+    QVERIFY2(filter.isEmpty(), "Cleared filter not empty");
+}
+
+void XbeeFrameFilterTest::testFrameType()
+{
+    FrameFilter filter;
+    filter.addFrameType(0x81);
+
+    QVERIFY2(filter.accepts(rx16(0x0002, 0, "temp")), "Rx16 rejected");
+    QVERIFY2(!filter.accepts(frame(QByteArray::fromHex("800013a20040a1b2c3280074656d70"))), "Rx64 accepted");
+    // Local frames are always delivered
+    QVERIFY2(filter.accepts(frame(QByteArray::fromHex("88014e4900"))), "AT command response rejected");
+    QVERIFY2(filter.accepts(frame(QByteArray::fromHex("8a02"))), "Modem status rejected");
+    QVERIFY2(filter.accepts(frame(QByteArray::fromHex("890100"))), "Transmit status rejected");
+    QVERIFY2(FrameFilter::isRemoteFrame(0x97) && !FrameFilter::isRemoteFrame(0x88), "Bad remote frame types");
+}
+
+void XbeeFrameFilterTest::testAddresses()
+{
+    FrameFilter filter;
+    filter.addSourceAddress16(0x0002);
+
+    QVERIFY2(filter.accepts(rx16(0x0002, 0, "temp")), "Rx16 from 0002 rejected");
+    QVERIFY2(!filter.accepts(rx16(0x0003, 0, "temp")), "Rx16 from 0003 accepted");
+    QVERIFY2(!filter.accepts(frame(QByteArray::fromHex("800013a20040a1b2c3280074656d70"))),
+             "Rx64 accepted by a 16-bit address");
+
+    filter.addSourceAddress64(Q_UINT64_C(0x0013a20040a1b2c3));
+    QVERIFY2(filter.accepts(frame(QByteArray::fromHex("800013a20040a1b2c3280074656d70"))), "Rx64 from the 64-bit address rejected");
+    QVERIFY2(!filter.accepts(frame(QByteArray::fromHex("800013a20040a1b2c4280074656d70"))), "Rx64 from another address accepted");
+    QVERIFY2(filter.accepts(rx16(0x0002, 0, "temp")), "Rx16 from 0002 rejected once a 64-bit address is added");
+}
+
+void XbeeFrameFilterTest::testOptions()
+{
+    FrameFilter filter;
+    filter.setOptions(0x02, 0x02);
+
+    QVERIFY2(filter.accepts(rx16(0x0002, 0x02, "temp")), "Broadcast frame rejected");
+    QVERIFY2(!filter.accepts(rx16(0x0002, 0x00, "temp")), "Unicast frame accepted");
+    QVERIFY2(!filter.accepts(frame(QByteArray::fromHex("97010013a20040a1b2c4fffe4e4900"))),
+             "Frame without receive options accepted");
+
+    filter.setOptions(0, 0);
+    QVERIFY2(filter.isEmpty(), "Null options mask must remove the criterion");
+}
+
+void XbeeFrameFilterTest::testPrefix()
+{
+    FrameFilter filter;
+    filter.addPayloadPrefix("temp");
+    filter.addPayloadPrefix("hum");
+
+    QVERIFY2(filter.accepts(rx16(0x0002, 0, "temp=21")), "temp rejected");
+    QVERIFY2(filter.accepts(rx16(0x0002, 0, "hum=40")), "hum rejected");
+    QVERIFY2(!filter.accepts(rx16(0x0002, 0, "tension")), "Same first byte accepted");
+    QVERIFY2(!filter.accepts(rx16(0x0002, 0, "te")), "Payload shorter than the prefix accepted");
+    QVERIFY2(!filter.accepts(rx16(0x0002, 0, "")), "Empty payload accepted");
+
+    filter.addPayloadPrefix(QByteArray());
+    QVERIFY2(filter.accepts(rx16(0x0002, 0, "")), "Empty prefix must accept every payload");
+}
+
+void XbeeFrameFilterTest::testTruncated()
+{
+    FrameFilter filter;
+    filter.addSourceAddress16(0x0002);
+
+    // Rx16 cut before its receive options
+    QVERIFY2(!filter.accepts(frame(QByteArray::fromHex("81000228"))), "Truncated frame accepted");
+}
+
+void XbeeFrameFilterTest::testFromString()
+{
+    bool ok = false;
+    FrameFilter filter = FrameFilter::fromString("  TYPE=81,90   src16=0002,0003 options=02/00 prefix=74656d70 ", &ok);
+
+    QVERIFY2(ok, "Valid expression rejected");
+    QVERIFY2(filter.accepts(rx16(0x0003, 0x00, "temp")), "Matching frame rejected");
+    QVERIFY2(!filter.accepts(rx16(0x0004, 0x00, "temp")), "Bad address accepted");
+    QVERIFY2(!filter.accepts(rx16(0x0002, 0x02, "temp")), "Bad options accepted");
+    QVERIFY2(!filter.accepts(rx16(0x0002, 0x00, "hum")), "Bad prefix accepted");
+    QVERIFY2(!filter.accepts(frame(QByteArray::fromHex("800013a20040a1b2c3280074656d70"))), "Bad type accepted");
+
+    filter = FrameFilter::fromString("src64=0013a20040a1b2c3", &ok);
+    QVERIFY2(ok && filter.accepts(frame(QByteArray::fromHex("800013a20040a1b2c3280074656d70"))), "src64 clause not applied");
+
+    filter = FrameFilter::fromString("", &ok);
+    QVERIFY2(ok && filter.isEmpty(), "Empty expression must give an empty filter");
+}
+
+void XbeeFrameFilterTest::testFromStringInvalid()
+{
+    const char * expressions[] = {
+        "type=1ff",
+        "type=",
+        "src16=10000",
+        "src64=zz",
+        "options=02",
+        "options=02/00,04/04",
+        "options=100/00",
+        "prefix=abc",
+        "prefix=",
+        "=81",
+        "type",
+        "color=red",
+        "type=81 src16=0002 prefix=xyz"
+    };
+
+    for(size_t i=0; i<sizeof(expressions)/sizeof(expressions[0]); i++) {
+        bool ok = true;
+        const FrameFilter filter = FrameFilter::fromString(expressions[i], &ok);
+        QVERIFY2(!ok, QString("Invalid expression accepted: %1").arg(expressions[i]).toStdString().c_str());
+        QVERIFY2(filter.isEmpty(), QString("Invalid expression gave a filter: %1").arg(expressions[i]).toStdString().c_str());
+    }
+}
+
+QTEST_GUILESS_MAIN(XbeeFrameFilterTest)
+
+#include "tst_xbeeframefiltertest.moc"
@@ -0,0 +1,107 @@
+#include <QString>
+#include <QtTest>
+#include <QCoreApplication>
+
+#include <FrameIdAllocator>
+
+using namespace QtXBee;
+
+class XbeeFrameIdAllocatorTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    XbeeFrameIdAllocatorTest();
+
+private Q_SLOTS:
+    void testRoundRobin();
+    void testExhaustion();
+    void testWrapAround();
+    void testRelease();
+};
+
+XbeeFrameIdAllocatorTest::XbeeFrameIdAllocatorTest()
+{
+}
+
+/**
+ * A released id isn't handed out again before the others.
+ */
+void XbeeFrameIdAllocatorTest::testRoundRobin()
+{
+    FrameIdAllocator allocator;
+
+    QVERIFY2(allocator.acquire() == 1, "First id must be 1");
+    QVERIFY2(allocator.acquire() == 2, "Ids not handed out in order");
+    QVERIFY2(allocator.release(1), "Failed to release 1");
+    QVERIFY2(allocator.acquire() == 3, "Released id reused right away");
+    QVERIFY2(allocator.inUseCount() == 2, "Bad in use count");
+}
+
+void XbeeFrameIdAllocatorTest::testExhaustion()
+{
+    FrameIdAllocator allocator;
+
+    for(int i=1; i<=255; i++) {
+        QVERIFY2(allocator.acquire() == i, QString("Bad id, %1 expected").arg(i).toStdString().c_str());
+    }
+    QVERIFY2(allocator.isExhausted(), "Not exhausted after 255 ids");
+    QVERIFY2(allocator.inUseCount() == 255, "Bad in use count");
+    QVERIFY2(allocator.acquire() == 0, "Id acquired while exhausted");
+    QVERIFY2(!allocator.isInUse(0), "Id 0 must never be in use");
+
+    QVERIFY2(allocator.release(42), "Failed to release 42");
+    QVERIFY2(!allocator.isExhausted(), "Still exhausted after a release");
+    QVERIFY2(allocator.acquire() == 42, "Only free id not found");
+    QVERIFY2(allocator.acquire() == 0, "Id acquired while exhausted");
+}
+
+/**
+ * The search wraps around after 255 (never giving 0) and skips the full words.
+ */
+void XbeeFrameIdAllocatorTest::testWrapAround()
+{
+    FrameIdAllocator allocator;
+
+    for(int i=1; i<=255; i++) {
+        allocator.acquire();
+    }
+    allocator.release(7);
+    QVERIFY2(allocator.acquire() == 7, "Wrapped search failed");
+
+    allocator.release(3);
+    allocator.release(200);
+    QVERIFY2(allocator.acquire() == 200, "Id after the last acquired one not preferred");
+    QVERIFY2(allocator.acquire() == 3, "Search didn't wrap around to 3");
+    QVERIFY2(allocator.acquire() == 0, "Id acquired while exhausted");
+
+    // Lone free id in the last word
+    allocator.release(255);
+    QVERIFY2(allocator.acquire() == 255, "Id 255 not found");
+    allocator.release(1);
+    QVERIFY2(allocator.acquire() == 1, "Id 1 not found after 255");
+}
+
+void XbeeFrameIdAllocatorTest::testRelease()
+{
+    FrameIdAllocator allocator;
+
+    QVERIFY2(!allocator.release(5), "Released an unused id");
+    QVERIFY2(!allocator.release(0), "Released id 0");
+
+    const quint8 id = allocator.acquire();
+    QVERIFY2(allocator.isInUse(id), "Acquired id not in use");
+    QVERIFY2(allocator.release(id), "Failed to release an acquired id");
+    QVERIFY2(!allocator.release(id), "Id released twice");
+    QVERIFY2(allocator.inUseCount() == 0, "Bad in use count");
+
+    allocator.acquire();
+    allocator.acquire();
+    allocator.clear();
+    QVERIFY2(allocator.inUseCount() == 0 && !allocator.isInUse(1), "Ids not released by clear()");
+    QVERIFY2(allocator.acquire() == 1, "clear() didn't restart from 1");
+}
+
+QTEST_GUILESS_MAIN(XbeeFrameIdAllocatorTest)
+
+#include "tst_xbeeframeidallocatortest.moc"
@@ -0,0 +1,216 @@
+#include <QString>
+#include <QtTest>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+
+#include <FrameRing>
+
+#include <thread>
+
+using namespace QtXBee;
+
+class XbeeFrameRingTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    XbeeFrameRingTest();
+
+private Q_SLOTS:
+    void testCapacity();
+    void testBroadcast();
+    void testDropOldest();
+    void testBlock();
+    void testBlockTimeout();
+    void testAttach();
+    void testNotify();
+};
+
+XbeeFrameRingTest::XbeeFrameRingTest()
+{
+}
+
+void XbeeFrameRingTest::testCapacity()
+{
+    QVERIFY2(FrameRing(5).capacity() == 8, "Capacity not rounded up to a power of two");
+    QVERIFY2(FrameRing(8).capacity() == 8, "Power of two capacity changed");
+    QVERIFY2(FrameRing(1).capacity() == 2, "Capacity below 2");
+}
+
+/**
+ * Every consumer reads every frame, with its timestamp.
+ */
+void XbeeFrameRingTest::testBroadcast()
+{
+    FrameRing ring(16);
+    QVector<QByteArray> frames;
+    QVector<qint64> timestamps;
+
+    ring.publish("before");
+    const int a = ring.attach();
+    const int b = ring.attach();
+    QVERIFY2(a >= 0 && b >= 0 && a != b, "Failed to attach");
+
+    for(int i=0; i<5; i++) {
+        ring.publish(QByteArray::number(i), 1000 + i);
+    }
+    QVERIFY2(ring.publishedCount() == 6, "Bad published count");
+    QVERIFY2(ring.available(a) == 5, "Bad available count");
+
+    QVERIFY2(ring.read(a, &frames, &timestamps, 2) == 2, "Max not honoured");
+    QVERIFY2(frames.at(0) == "0" && frames.at(1) == "1", "Bad frames");
+    QVERIFY2(timestamps.size() == 2 && timestamps.at(0) == 1000 && timestamps.at(1) == 1001, "Bad timestamps");
+    QVERIFY2(ring.read(a, &frames, &timestamps) == 3, "Bad remaining count");
+    QVERIFY2(frames.at(0) == "2" && timestamps.at(2) == 1004, "Bad remaining frames");
+
+    // The other consumer isn't affected
+    QVERIFY2(ring.read(b, &frames) == 5 && frames.first() == "0", "Frames consumed by another consumer");
+    QVERIFY2(ring.read(b, &frames) == 0 && frames.isEmpty(), "Frames read twice");
+}
+
+/**
+ * A DropOldest consumer lapped by the producer skips the overwritten frames,
+ * the timestamps staying those of the read frames.
+ */
+void XbeeFrameRingTest::testDropOldest()
+{
+    FrameRing ring(4);
+    QVector<QByteArray> frames;
+    QVector<qint64> timestamps;
+    const int consumer = ring.attach(FrameRing::DropOldest);
+
+    for(int i=0; i<10; i++) {
+        ring.publish(QByteArray::number(i), 100 + i);
+    }
+    QVERIFY2(ring.available(consumer) == 4, "Available not capped to the capacity");
+    QVERIFY2(ring.read(consumer, &frames, &timestamps) == 4, "Bad frame count");
+    QVERIFY2(frames.first() == "6" && frames.last() == "9", "Oldest frames not dropped");
+    QVERIFY2(timestamps.size() == 4 && timestamps.first() == 106 && timestamps.last() == 109, "Timestamps not those of the read frames");
+    QVERIFY2(ring.droppedCount(consumer) == 6, "Bad dropped count");
+
+    // Without timestamp, a frame is stamped 0
+    ring.publish("unknown");
+    QVERIFY2(ring.read(consumer, &frames, &timestamps) == 1 && timestamps.first() == 0, "Bad default timestamp");
+}
+
+/**
+ * A Block consumer reading from another thread gets every frame.
+ */
+void XbeeFrameRingTest::testBlock()
+{
+    FrameRing ring(4);
+    const int consumer = ring.attach(FrameRing::Block);
+    const int count = 200;
+    QVector<QByteArray> received;
+
+    QVERIFY2(ring.setBlockTimeout(FrameRing::MaxBlockTimeout), "Failed to set the block timeout");
+    std::thread reader([&]() {
+        QVector<QByteArray> frames;
+        while(received.size() < count && ring.waitForFrames(consumer, 2000)) {
+            ring.read(consumer, &frames);
+            received += frames;
+        }
+    });
+    for(int i=0; i<count; i++) {
+        ring.publish(QByteArray::number(i));
+        ring.notify();
+    }
+    reader.join();
+
+    QVERIFY2(received.size() == count, "Frames missed");
+    for(int i=0; i<count; i++) {
+        QVERIFY2(received.at(i) == QByteArray::number(i), "Frames out of order");
+    }
+    QVERIFY2(ring.droppedCount(consumer) == 0, "Frames dropped for a blocking consumer");
+}
+
+/**
+ * The producer never waits more than the block timeout, which is always bounded.
+ */
+void XbeeFrameRingTest::testBlockTimeout()
+{
+    FrameRing ring(4);
+    QVector<QByteArray> frames;
+    const int consumer = ring.attach(FrameRing::Block);
+    QElapsedTimer timer;
+
+    QVERIFY2(!ring.setBlockTimeout(-1), "Infinite block timeout accepted");
+    QVERIFY2(!ring.setBlockTimeout(FrameRing::MaxBlockTimeout + 1), "Too long block timeout accepted");
+    QVERIFY2(ring.blockTimeout() == 100, "Block timeout changed by a refused value");
+    QVERIFY2(ring.setBlockTimeout(20), "Failed to set the block timeout");
+
+    for(int i=0; i<4; i++) {
+        ring.publish(QByteArray::number(i));
+    }
+    timer.start();
+    ring.publish("4");
+    QVERIFY2(timer.elapsed() >= 15, "Producer didn't wait for the blocking consumer");
+    QVERIFY2(timer.elapsed() < 1000, "Producer waited past the block timeout");
+
+    QVERIFY2(ring.read(consumer, &frames) == 4 && frames.first() == "1", "Oldest frame not overwritten");
+    QVERIFY2(ring.droppedCount(consumer) == 1, "Bad dropped count");
+
+    // A detached blocking consumer no longer holds the producer
+    ring.detach(consumer);
+    ring.setBlockTimeout(FrameRing::MaxBlockTimeout);
+    timer.start();
+    for(int i=0; i<8; i++) {
+        ring.publish("x");
+    }
+    QVERIFY2(timer.elapsed() < FrameRing::MaxBlockTimeout, "Producer held by a detached consumer");
+}
+
+void XbeeFrameRingTest::testAttach()
+{
+    FrameRing ring(4);
+    QVector<QByteArray> frames;
+    QList<int> consumers;
+
+    for(int i=0; i<FrameRing::MaxConsumers; i++) {
+        consumers.append(ring.attach());
+        QVERIFY2(consumers.last() >= 0, "Failed to attach");
+    }
+    QVERIFY2(ring.attach() == -1, "Too many consumers attached");
+
+    ring.detach(consumers.at(3));
+    ring.publish("frame");
+    QVERIFY2(ring.read(consumers.at(3), &frames) == 0, "Detached consumer read a frame");
+    QVERIFY2(ring.available(consumers.at(3)) == 0, "Detached consumer has frames");
+    QVERIFY2(ring.attach() == consumers.at(3), "Consumer id not reused");
+    QVERIFY2(ring.read(consumers.at(3), &frames) == 0, "New consumer read a frame published before it attached");
+    QVERIFY2(ring.read(-1, &frames) == 0 && ring.read(FrameRing::MaxConsumers, &frames) == 0, "Bad consumer id accepted");
+}
+
+/**
+ * A batch of frames is notified once; waiting consumers are woken up.
+ */
+void XbeeFrameRingTest::testNotify()
+{
+    FrameRing ring(16);
+    QSignalSpy spy(&ring, SIGNAL(framesAvailable()));
+    const int consumer = ring.attach();
+
+    QVERIFY2(!ring.waitForFrames(consumer, 10), "No frame, but the wait succeeded");
+
+    ring.publish("a");
+    ring.publish("b");
+    ring.notify();
+    ring.notify();
+    QVERIFY2(spy.count() == 1, "Batch not notified once");
+    QVERIFY2(ring.waitForFrames(consumer, 10), "Frames available, but the wait failed");
+
+    bool woken = false;
+    QVector<QByteArray> frames;
+    ring.read(consumer, &frames);
+    std::thread waiter([&]() { woken = ring.waitForFrames(consumer, 2000); });
+    QThread::msleep(20);
+    ring.publish("c");
+    ring.notify();
+    waiter.join();
+    QVERIFY2(woken, "Waiting consumer not woken up");
+    QVERIFY2(spy.count() == 2, "Second batch not notified");
+}
+
+QTEST_GUILESS_MAIN(XbeeFrameRingTest)
+
+#include "tst_xbeeframeringtest.moc"
@@ -0,0 +1,120 @@
+#include <QString>
+#include <QtTest>
+#include <QCoreApplication>
+
+#include <FrameTemplate>
+#include <ATCommand>
+#include <RemoteATCommandRequest>
+#include <ModemStatus>
+#include <wpan/TxRequest16>
+#include <wpan/TxRequest64>
+#include <zigbee/zbtxrequest.h>
+
+using namespace QtXBee;
+
+class XbeeFrameTemplateTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    XbeeFrameTemplateTest();
+
+private Q_SLOTS:
+    void testATCommand();
+    void testRemoteATCommandRequest();
+    void testTxRequest16();
+    void testTxRequest64();
+    void testZBTxRequest();
+    void testInvalid();
+
+private:
+    void verifyPatching(XBeePacket * request, const QString & name);
+};
+
+XbeeFrameTemplateTest::XbeeFrameTemplateTest()
+{
+}
+
+/**
+ * Every frame id patched into the template must give the same frame as
+ * the request assembled from scratch with that frame id.
+ */
+void XbeeFrameTemplateTest::verifyPatching(XBeePacket *request, const QString &name)
+{
+    request->setFrameId(1);
+    FrameTemplate t(request);
+    QVERIFY2(t.isValid(), QString("%1 rejected").arg(name).toStdString().c_str());
+
+    for(int id=0; id<=0xFF; id++) {
+        t.setFrameId(id);
+        request->setFrameId(id);
+        request->assemblePacket();
+        QVERIFY2(t.frameId() == id, QString("%1: bad frame id %2").arg(name).arg(id).toStdString().c_str());
+        QVERIFY2(t.frame() == request->packet(),
+                 QString("%1: frame id %2 gives 0x%3 instead of 0x%4")
+                 .arg(name).arg(id)
+                 .arg(QString(t.frame().toHex()))
+                 .arg(QString(request->packet().toHex())).toStdString().c_str());
+    }
+}
+
+void XbeeFrameTemplateTest::testATCommand()
+{
+    ATCommand at;
+    at.setCommand(ATCommand::ATNI);
+    at.setParameter("ROUTER");
+    verifyPatching(&at, "ATCommand");
+}
+
+void XbeeFrameTemplateTest::testRemoteATCommandRequest()
+{
+    RemoteATCommandRequest at;
+    at.setDestinationAddress64(Q_UINT64_C(0x0013A20040A1B2C3));
+    at.setDestinationAddress16(0xFFFE);
+    at.setCommand(ATCommand::ATD0);
+    at.setParameter(QByteArray(1, 0x05));
+    verifyPatching(&at, "RemoteATCommandRequest");
+}
+
+void XbeeFrameTemplateTest::testTxRequest16()
+{
+    Wpan::TxRequest16 tx;
+    tx.setDestinationAddress(0x0002);
+    tx.setData("temp");
+    verifyPatching(&tx, "TxRequest16");
+}
+
+void XbeeFrameTemplateTest::testTxRequest64()
+{
+    Wpan::TxRequest64 tx;
+    tx.setDestinationAddress(Q_UINT64_C(0x0013A20040A1B2C3));
+    tx.setData(QByteArray::fromHex("7e7d1113ff00"));
+    verifyPatching(&tx, "TxRequest64");
+}
+
+void XbeeFrameTemplateTest::testZBTxRequest()
+{
+    ZigBee::ZBTxRequest tx;
+    tx.setDestAddr64(QByteArray::fromHex("0013a20040a1b2c3"));
+    tx.setDestAddr16(QByteArray::fromHex("fffe"));
+    tx.setData("hello");
+    verifyPatching(&tx, "ZBTxRequest");
+}
+
+void XbeeFrameTemplateTest::testInvalid()
+{
+    FrameTemplate empty;
+    QVERIFY2(!empty.isValid(), "Default template must be invalid");
+    QVERIFY2(empty.apiId() == XBeePacket::UndefinedId, "Invalid template must have an undefined API id");
+
+    ModemStatus status(NULL);
+    FrameTemplate response(&status);
+    QVERIFY2(!response.isValid(), "Response accepted as template");
+
+    QVERIFY2(FrameTemplate::isRequest(XBeePacket::TxRequest16Id), "TxRequest16 must be a request");
+    QVERIFY2(!FrameTemplate::isRequest(XBeePacket::Rx16ResponseId), "RxResponse16 must not be a request");
+}
+
+QTEST_APPLESS_MAIN(XbeeFrameTemplateTest)
+
+#include "tst_xbeeframetemplatetest.moc"
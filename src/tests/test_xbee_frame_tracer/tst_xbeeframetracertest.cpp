@@ -0,0 +1,162 @@
+#include <QString>
+#include <QtTest>
+#include <QCoreApplication>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <FrameTracer>
+
+#include <thread>
+
+using namespace QtXBee;
+
+class XbeeFrameTracerTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    XbeeFrameTracerTest();
+
+private Q_SLOTS:
+    void init();
+    void testChromeTrace();
+    void testOverwrite();
+    void testExportWhileRecording();
+    void testThreadBufferReuse();
+
+private:
+    static QJsonArray events(const QByteArray & json, const QString & phase);
+};
+
+XbeeFrameTracerTest::XbeeFrameTracerTest()
+{
+}
+
+void XbeeFrameTracerTest::init()
+{
+    FrameTracer::clear();
+}
+
+QJsonArray XbeeFrameTracerTest::events(const QByteArray &json, const QString &phase)
+{
+    QJsonParseError error;
+    const QJsonDocument doc = QJsonDocument::fromJson(json, &error);
+    QJsonArray events;
+
+    if(error.error != QJsonParseError::NoError) {
+        qWarning() << "Invalid JSON:" << error.errorString();
+        return events;
+    }
+    foreach(const QJsonValue & event, doc.object().value("traceEvents").toArray()) {
+        if(event.toObject().value("ph").toString() == phase) {
+            events.append(event);
+        }
+    }
+    return events;
+}
+
+void XbeeFrameTracerTest::testChromeTrace()
+{
+    // TxRequest16, frame id 5
+    const QByteArray frame = QByteArray::fromHex("7e00090105000200") + "temp" + QByteArray(1, 0);
+
+    FrameTracer::setEnabled(true);
+    QVERIFY2(FrameTracer::isEnabled(), "Tracer not enabled");
+    FrameTracer::record(FrameTracer::Enqueue, frame, 1000, 3500, 42);
+    FrameTracer::record(FrameTracer::Status, frame, 3500, 1003500);
+    FrameTracer::setEnabled(false);
+
+    const QJsonArray spans = events(FrameTracer::toChromeTrace(), "X");
+    QVERIFY2(spans.size() == 2, qPrintable(QString("Expected 2 spans, got %1").arg(spans.size())));
+
+    const QJsonObject enqueue = spans.at(0).toObject();
+    QVERIFY2(enqueue.value("name").toString() == "enqueue", "Bad span name");
+    QVERIFY2(enqueue.value("cat").toString() == "xbee", "Bad category");
+    QVERIFY2(enqueue.value("ts").toDouble() == 1.0 && enqueue.value("dur").toDouble() == 2.5, "Bad span timing");
+    QVERIFY2(enqueue.value("args").toObject().value("frameId").toInt() == 5, "Bad frame id");
+    QVERIFY2(enqueue.value("args").toObject().value("apiId").toString() == "0x01", "Bad API id");
+    QVERIFY2(enqueue.value("args").toObject().value("ticket").toInt() == 42, "Bad ticket");
+
+    const QJsonObject status = spans.at(1).toObject();
+    QVERIFY2(status.value("name").toString() == "status", "Bad span name");
+    QVERIFY2(status.value("dur").toDouble() == 1000.0, "Bad span duration");
+    QVERIFY2(!status.value("args").toObject().contains("ticket"), "Ticket exported without post()");
+    QVERIFY2(status.value("tid") == enqueue.value("tid"), "Spans of a thread on several tracks");
+
+    QVERIFY2(!events(FrameTracer::toChromeTrace(), "M").isEmpty(), "Thread name not exported");
+    FrameTracer::clear();
+    QVERIFY2(events(FrameTracer::toChromeTrace(), "X").isEmpty(), "Spans left by clear()");
+}
+
+/**
+ * Once the ring is full, the oldest spans are overwritten and not exported,
+ * nor is the slot the next span may be writing to.
+ */
+void XbeeFrameTracerTest::testOverwrite()
+{
+    const QByteArray frame = QByteArray::fromHex("7e0004080141449b");
+
+    for(int i=0; i<FrameTracer::BufferSize + 10; i++) {
+        FrameTracer::record(FrameTracer::Write, frame, (qint64)i * 1000, (qint64)i * 1000, i + 1);
+    }
+
+    const QJsonArray spans = events(FrameTracer::toChromeTrace(), "X");
+    QVERIFY2(spans.size() == FrameTracer::BufferSize - 1,
+             qPrintable(QString("Expected %1 spans, got %2").arg(FrameTracer::BufferSize - 1).arg(spans.size())));
+    QVERIFY2(spans.first().toObject().value("args").toObject().value("ticket").toInt() == 12, "Overwritten span exported");
+    QVERIFY2(spans.last().toObject().value("args").toObject().value("ticket").toInt() == FrameTracer::BufferSize + 10,
+             "Last span missing");
+}
+
+/**
+ * A thread recording during the export never gets a torn span exported:
+ * each span's timestamp matches its ticket.
+ */
+void XbeeFrameTracerTest::testExportWhileRecording()
+{
+    const QByteArray frame = QByteArray::fromHex("7e0004080141449b");
+    QAtomicInt stop(0);
+
+    std::thread recorder([&stop, &frame]() {
+        for(quint32 i=1; !stop.loadAcquire(); i++) {
+            FrameTracer::record(FrameTracer::Write, frame, (qint64)i * 1000, (qint64)i * 1000, i);
+        }
+    });
+
+    for(int n=0; n<20; n++) {
+        foreach(const QJsonValue & value, events(FrameTracer::toChromeTrace(), "X")) {
+            const QJsonObject span = value.toObject();
+            const int ticket = span.value("args").toObject().value("ticket").toInt();
+            if(ticket != 0 && span.value("ts").toDouble() != ticket) {
+                stop.storeRelease(1);
+                recorder.join();
+                QFAIL(qPrintable(QString("Torn span exported: ticket %1 at %2 us").arg(ticket).arg(span.value("ts").toDouble())));
+            }
+        }
+    }
+    stop.storeRelease(1);
+    recorder.join();
+}
+
+/**
+ * The buffer of an exited thread is reused by the next thread instead of being leaked.
+ */
+void XbeeFrameTracerTest::testThreadBufferReuse()
+{
+    const QByteArray frame = QByteArray::fromHex("7e0004080141449b");
+
+    std::thread first([&frame]() { FrameTracer::record(FrameTracer::Write, frame, 0, 0); });
+    first.join();
+    const int threads = events(FrameTracer::toChromeTrace(), "M").size();
+
+    for(int i=0; i<3; i++) {
+        std::thread next([&frame]() { FrameTracer::record(FrameTracer::Write, frame, 0, 0); });
+        next.join();
+    }
+    QVERIFY2(events(FrameTracer::toChromeTrace(), "M").size() == threads, "Buffers of exited threads not reused");
+}
+
+QTEST_GUILESS_MAIN(XbeeFrameTracerTest)
+
+#include "tst_xbeeframetracertest.moc"
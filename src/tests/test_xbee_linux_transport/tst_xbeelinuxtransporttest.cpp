@@ -0,0 +1,1415 @@
+#include <QString>
+#include <QtTest>
+#include <QCoreApplication>
+
+#include <FrameDecoder>
+#include <FrameFilter>
+#include <FrameRing>
+#include <Global>
+#include <LinuxSerialTransport>
+#include <RemoteATCommandRequest>
+#include <XBee>
+#include <XBeeDiscovery>
+#include <wpan/TxRequest16>
+
+#include <QHash>
+#include <QMutex>
+#include <QThread>
+
+#include <poll.h>
+#include <pty.h>
+#include <termios.h>
+#include <unistd.h>
+
+using namespace QtXBee;
+
+static QByteArray frame(const QByteArray & payload)
+{
+    QByteArray f;
+    quint8 sum = 0;
+
+    f.append((char)0x7E);
+    f.append((char)((payload.size() >> 8) & 0xFF));
+    f.append((char)(payload.size() & 0xFF));
+    f.append(payload);
+    for(int i=0; i<payload.size(); i++) {
+        sum += (quint8)payload.at(i);
+    }
+    f.append((char)(0xFF - sum));
+    return f;
+}
+
+// XBee's ATBD codes
+static const qint32 BaudRates[] = { 1200, 2400, 4800, 9600, 19200, 38400, 57600, 115200 };
+
+/*
+ * Returns the baud rate the pty's slave is configured to, read from its master.
+ */
+static qint32 ptyBaudRate(const int master)
+{
+    struct termios tio;
+
+    if(::tcgetattr(master, &tio) != 0) {
+        return -1;
+    }
+    switch(cfgetospeed(&tio)) {
+    case B1200      : return 1200;
+    case B2400      : return 2400;
+    case B4800      : return 4800;
+    case B9600      : return 9600;
+    case B19200     : return 19200;
+    case B38400     : return 38400;
+    case B57600     : return 57600;
+    case B115200    : return 115200;
+    default         : return -1;
+    }
+}
+
+/*
+ * Stands for an XBee in API mode 1 on the pty master: answers the AT
+ * commands from a parameter table, the TxRequest16 frames with the
+ * transmit status set for their destination (success by default) and
+ * the remote AT commands with OK. Injected frames are written before
+ * the next response. With AP=0, answers "+++" and the AT command lines
+ * (reads and writes) in command mode instead. Once given a baud rate, ignores the bytes
+ * written while the pty is configured to another one, as line noise;
+ * ATBD then ATAC change it.
+ */
+class FakeXBee : public QThread
+{
+public:
+    explicit FakeXBee(const int master) :
+        m_master(master),
+        m_stop(0),
+        m_baudRate(0),
+        m_maxBaudRate(115200),
+        m_silent(false),
+        m_commandMode(false)
+    {
+        m_parameters.insert("AP", QByteArray::fromHex("01"));
+        m_parameters.insert("HV", QByteArray::fromHex("1744"));
+        m_parameters.insert("VR", QByteArray::fromHex("10ef"));
+        m_parameters.insert("SH", QByteArray::fromHex("0013a200"));
+        m_parameters.insert("SL", QByteArray::fromHex("40a1b2c3"));
+        m_parameters.insert("AI", QByteArray::fromHex("00"));
+    }
+
+    ~FakeXBee()
+    {
+        m_stop.storeRelease(1);
+        wait();
+    }
+
+    void setParameter(const QByteArray & command, const QByteArray & value)
+    {
+        QMutexLocker lock(&m_mutex);
+        m_parameters.insert(command, value);
+    }
+
+    QByteArray parameter(const QByteArray & command) const
+    {
+        QMutexLocker lock(&m_mutex);
+        return m_parameters.value(command);
+    }
+
+    void removeParameter(const QByteArray & command)
+    {
+        QMutexLocker lock(&m_mutex);
+        m_parameters.remove(command);
+    }
+
+    void setBaudRate(const qint32 baudRate)
+    {
+        QMutexLocker lock(&m_mutex);
+        m_baudRate = baudRate;
+    }
+
+    qint32 baudRate() const
+    {
+        QMutexLocker lock(&m_mutex);
+        return m_baudRate;
+    }
+
+    // ATBD above this rate is refused
+    void setMaxBaudRate(const qint32 baudRate)
+    {
+        QMutexLocker lock(&m_mutex);
+        m_maxBaudRate = baudRate;
+    }
+
+    // Records the received frames without answering them
+    void setSilent(const bool silent)
+    {
+        QMutexLocker lock(&m_mutex);
+        m_silent = silent;
+    }
+
+    // Doesn't answer the next requests of the given command
+    void drop(const QByteArray & command, const int count)
+    {
+        QMutexLocker lock(&m_mutex);
+        m_drop.insert(command, count);
+    }
+
+    void inject(const QByteArray & f)
+    {
+        QMutexLocker lock(&m_mutex);
+        m_inject.append(f);
+    }
+
+    void setTxStatus(const quint16 destination, const quint8 status)
+    {
+        QMutexLocker lock(&m_mutex);
+        m_txStatus.insert(destination, status);
+    }
+
+    void send(const QByteArray & f)
+    {
+        QMutexLocker lock(&m_mutex);
+        write(f);
+    }
+
+    int count(const QByteArray & command) const
+    {
+        QMutexLocker lock(&m_mutex);
+        return m_commands.count(command);
+    }
+
+    // Received frames of the given API id, without their frame id
+    QList<QByteArray> frames(const quint8 apiId) const
+    {
+        QMutexLocker lock(&m_mutex);
+        QList<QByteArray> frames;
+        foreach(const QByteArray & payload, m_frames) {
+            if((quint8)payload.at(0) == apiId) {
+                frames.append(payload.mid(2));
+            }
+        }
+        return frames;
+    }
+
+protected:
+    void run() Q_DECL_OVERRIDE
+    {
+        FrameDecoder decoder;
+        QByteArray f;
+        char buffer[256];
+
+        while(!m_stop.loadAcquire()) {
+            struct pollfd pfd = { m_master, POLLIN, 0 };
+            if(::poll(&pfd, 1, 10) <= 0 || !(pfd.revents & POLLIN)) {
+                continue;
+            }
+            const ssize_t n = ::read(m_master, buffer, sizeof(buffer));
+            if(n <= 0) {
+                return;
+            }
+            if(!isAtBaudRate()) {
+                decoder.clear();
+                continue;
+            }
+            if(isTransparent()) {
+                processText(QByteArray(buffer, n));
+                continue;
+            }
+            decoder.append(QByteArray(buffer, n));
+            while(decoder.takeFrame(&f)) {
+                process(f.mid(3, f.size() - 4));
+            }
+        }
+    }
+
+private:
+    void write(const QByteArray & f)
+    {
+        if(::write(m_master, f.constData(), f.size()) != f.size()) {
+            qWarning() << "FakeXBee: failed to write to the pty master";
+        }
+    }
+
+    bool isAtBaudRate() const
+    {
+        QMutexLocker lock(&m_mutex);
+        return m_baudRate == 0 || ptyBaudRate(m_master) == m_baudRate;
+    }
+
+    bool isTransparent() const
+    {
+        QMutexLocker lock(&m_mutex);
+        return m_parameters.value("AP") == QByteArray(1, (char)0x00);
+    }
+
+    void processText(const QByteArray & data)
+    {
+        QMutexLocker lock(&m_mutex);
+
+        m_text.append(data);
+        if(!m_commandMode) {
+            if(m_text.endsWith("+++")) {
+                m_commandMode = true;
+                m_text.clear();
+                write("OK\r");
+            }
+            return;
+        }
+
+        int end = -1;
+        while((end = m_text.indexOf('\r')) >= 0) {
+            const QByteArray line = m_text.left(end).trimmed();
+            m_text.remove(0, end + 1);
+            if(!line.startsWith("AT")) {
+                continue;
+            }
+            // Comma separated commands, the first failing one ends the line
+            foreach(const QByteArray & command, line.mid(2).split(',')) {
+                m_commands.append(command);
+                if(command == "CN") {
+                    m_commandMode = false;
+                    write("OK\r");
+                }
+                else if(m_parameters.contains(command)) {
+                    write(m_parameters.value(command).toHex().toUpper() + "\r");
+                }
+                else if(command.size() > 2 && m_parameters.contains(command.left(2))) {
+                    m_parameters.insert(command.left(2), QByteArray::fromHex(command.mid(2)));
+                    write("OK\r");
+                }
+                else {
+                    write("ERROR\r");
+                    break;
+                }
+            }
+        }
+    }
+
+    void process(const QByteArray & payload)
+    {
+        QMutexLocker lock(&m_mutex);
+
+        if(payload.size() < 4) {
+            return;
+        }
+        m_frames.append(payload);
+        if(m_silent) {
+            return;
+        }
+        if((quint8)payload.at(0) == 0x01 && payload.at(1) != 0) {
+            const quint16 destination = ((quint8)payload.at(2) << 8) | (quint8)payload.at(3);
+            write(m_inject + frame(QByteArray(1, (char)0x89).append(payload.at(1)).append((char)m_txStatus.value(destination, 0))));
+            m_inject.clear();
+            return;
+        }
+        if((quint8)payload.at(0) == 0x17 && payload.size() >= 15 && payload.at(1) != 0) {
+            write(m_inject + frame(QByteArray(1, (char)0x97).append(payload.mid(1, 11)).append(payload.mid(13, 2)).append((char)0x00)));
+            m_inject.clear();
+            return;
+        }
+        if((quint8)payload.at(0) != 0x08) {
+            return;
+        }
+        const QByteArray command = payload.mid(2, 2);
+        const QByteArray value = payload.mid(4);
+        QByteArray response = QByteArray(1, (char)0x88) + payload.mid(1, 3);
+
+        m_commands.append(command);
+        if(m_drop.value(command) > 0) {
+            m_drop[command]--;
+            return;
+        }
+        if(command == "BD" && !value.isEmpty()
+                && ((quint8)value.at(value.size()-1) >= 8 || BaudRates[(quint8)value.at(value.size()-1)] > m_maxBaudRate)) {
+            response.append((char)0x03);
+        }
+        else if(!value.isEmpty()) {
+            m_parameters.insert(command, value);
+            response.append((char)0x00);
+        }
+        else if(command == "AC" || command == "WR") {
+            response.append((char)0x00);
+        }
+        else if(m_parameters.contains(command)) {
+            response.append((char)0x00).append(m_parameters.value(command));
+        }
+        else {
+            response.append((char)0x02);
+        }
+        if(payload.at(1) != 0) {
+            write(m_inject + frame(response));
+            m_inject.clear();
+        }
+        // The response is sent at the previous rate
+        if(command == "AC" && m_baudRate != 0 && m_parameters.contains("BD")) {
+            const QByteArray bd = m_parameters.value("BD");
+            m_baudRate = BaudRates[(quint8)bd.at(bd.size()-1)];
+        }
+    }
+
+    int                             m_master;
+    QAtomicInt                      m_stop;
+    qint32                          m_baudRate;
+    qint32                          m_maxBaudRate;
+    mutable QMutex                  m_mutex;
+    QHash<QByteArray,QByteArray>    m_parameters;
+    QList<QByteArray>               m_commands;
+    QList<QByteArray>               m_frames;
+    QHash<quint16,quint8>           m_txStatus;
+    QHash<QByteArray,int>           m_drop;
+    QByteArray                      m_inject;
+    QByteArray                      m_text;
+    bool                            m_silent;
+    bool                            m_commandMode;
+};
+
+/*
+ * Sets a parameter from its own thread, as a worker thread of the application would.
+ */
+class ParameterWriter : public QThread
+{
+public:
+    ParameterWriter(XBee * xbee, const ATCommand::ATCommandType param, const QByteArray & value) :
+        m_xbee(xbee),
+        m_param(param),
+        m_value(value),
+        m_ok(false)
+    {
+    }
+
+    bool isOk() const { return m_ok; }
+
+protected:
+    void run() Q_DECL_OVERRIDE
+    {
+        m_ok = m_xbee->setParameter(m_param, m_value);
+    }
+
+private:
+    XBee *                  m_xbee;
+    ATCommand::ATCommandType m_param;
+    QByteArray              m_value;
+    bool                    m_ok;
+};
+
+class XbeeLinuxTransportTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    XbeeLinuxTransportTest();
+
+private Q_SLOTS:
+    void init();
+    void cleanup();
+    void testOpen();
+    void testRead();
+    void testReadTimestamps();
+    void testReadStamped();
+    void testWrite();
+    void testBytesWrittenDeferred();
+    void testHangup();
+    void testHangupNotifier();
+    void testSynchronizeNonSerie1();
+    void testProbeBaudRate();
+    void testNegotiateBaudRate();
+    void testResync();
+    void testCommandModeCheck();
+    void testWriteParameterFromThread();
+    void testVolatileParameter();
+    void testSyncResponseMatching();
+    void testAssociationPoll();
+    void testAssociationHold();
+    void testPump();
+    void testFrameTimestamps();
+    void testDeficitRoundRobin();
+    void testDeadline();
+    void testSupersede();
+    void testPacing();
+    void testBreaker();
+    void testRemoteCommandNotHeld();
+    void testFilterInFlightResponse();
+    void testDiscovery();
+    void testDiscoveryIdentifyRetry();
+    void testDiscoveryCommandMode();
+
+private:
+    static bool send(XBee * xbee, const quint16 destination, const int size);
+
+    int m_master;
+    QString m_slave;
+};
+
+XbeeLinuxTransportTest::XbeeLinuxTransportTest() :
+    m_master(-1)
+{
+}
+
+void XbeeLinuxTransportTest::init()
+{
+    int slave = -1;
+    char name[64];
+
+    QVERIFY2(::openpty(&m_master, &slave, name, NULL, NULL) == 0, "openpty failed");
+    ::close(slave);
+    m_slave = QString::fromLocal8Bit(name);
+}
+
+void XbeeLinuxTransportTest::cleanup()
+{
+    if(m_master >= 0) {
+        ::close(m_master);
+        m_master = -1;
+    }
+}
+
+void XbeeLinuxTransportTest::testOpen()
+{
+    LinuxSerialTransport transport(m_slave);
+
+    QVERIFY2(transport.open(QIODevice::ReadWrite), "Failed to open the pty");
+    QVERIFY2(transport.handle() >= 0, "Bad file descriptor");
+    QVERIFY2(transport.isSequential(), "A tty must be sequential");
+    QVERIFY2(transport.setBaudRate(115200), "Failed to set 115200 bauds");
+    QVERIFY2(!transport.setBaudRate(12345), "Non standard baud rate accepted");
+    QVERIFY2(transport.baudRate() == 115200, "Baud rate changed by a failed setBaudRate()");
+    transport.close();
+    QVERIFY2(transport.handle() < 0, "File descriptor not closed");
+
+    LinuxSerialTransport missing("ttyQtXBeeMissing");
+    QVERIFY2(!missing.open(QIODevice::ReadWrite), "Missing tty opened");
+}
+
+void XbeeLinuxTransportTest::testRead()
+{
+    LinuxSerialTransport transport(m_slave);
+    FrameDecoder decoder;
+    QByteArray data;
+    QByteArray f;
+    int count = 0;
+
+    QVERIFY2(transport.open(QIODevice::ReadWrite), "Failed to open the pty");
+
+    data.append(frame(QByteArray::fromHex("8801424400")));
+    data.append(frame(QByteArray::fromHex("8a00")));
+    data.append(frame(QByteArray::fromHex("8802565200104a")));
+    QVERIFY2(::write(m_master, data.constData(), data.size()) == data.size(), "Failed to write to the pty master");
+
+    QSignalSpy spy(&transport, SIGNAL(readyRead()));
+    QVERIFY2(transport.waitForReadyRead(1000), "No data received");
+    QVERIFY2(spy.count() == 1, "readyRead() not emitted");
+    QVERIFY2(transport.bytesAvailable() == data.size(), "Frames not read in a single batch");
+
+    decoder.append(transport.readAll());
+    while(decoder.takeFrame(&f)) {
+        count++;
+    }
+    QVERIFY2(count == 3, QString("Expected 3 frames, got %1").arg(count).toStdString().c_str());
+    QVERIFY2(transport.bytesAvailable() == 0, "Bytes left after readAll()");
+    QVERIFY2(!transport.waitForReadyRead(50), "Unexpected data");
+}
+
+/**
+ * The transport stamps each read, and the decoder gives a frame the stamp
+ * of the read holding its start delimiter.
+ */
+void XbeeLinuxTransportTest::testReadTimestamps()
+{
+    LinuxSerialTransport transport(m_slave);
+    FrameDecoder decoder;
+    const QByteArray data = frame(QByteArray::fromHex("8a00"));
+    QByteArray f;
+    qint64 timestamp = 0;
+
+    QVERIFY2(transport.open(QIODevice::ReadWrite), "Failed to open the pty");
+    QVERIFY2(transport.readTimestamp() == 0, "Timestamp before any read");
+
+    const qint64 before = monotonicTime();
+    QVERIFY2(::write(m_master, data.constData(), data.size()) == data.size(), "Failed to write to the pty master");
+    QVERIFY2(transport.waitForReadyRead(1000), "No data received");
+    const qint64 read = transport.readTimestamp();
+    QVERIFY2(read >= before && read <= monotonicTime(), "Read timestamp out of the read call");
+
+    decoder.append(transport.readAll(), read);
+    QVERIFY2(decoder.takeFrame(&f, &timestamp), "No frame decoded");
+    QVERIFY2(timestamp == read, "Frame not stamped with its read");
+
+    // A frame split over two reads, following a complete one
+    decoder.append(data + data.left(3), 100);
+    decoder.append(data.mid(3), 200);
+    decoder.append(data, 300);
+    QVERIFY2(decoder.takeFrame(&f, &timestamp) && timestamp == 100, "Bad timestamp for the first frame");
+    QVERIFY2(decoder.takeFrame(&f, &timestamp) && timestamp == 100, "Split frame not stamped with its start delimiter read");
+    QVERIFY2(decoder.takeFrame(&f, &timestamp) && timestamp == 300, "Bad timestamp for the last frame");
+}
+
+/**
+ * Bytes of several reads buffered together keep the time of their own read.
+ */
+void XbeeLinuxTransportTest::testReadStamped()
+{
+    LinuxSerialTransport transport(m_slave);
+    const QByteArray first = frame(QByteArray::fromHex("8a00"));
+    const QByteArray second = frame(QByteArray::fromHex("8a02"));
+    const QByteArray third = frame(QByteArray::fromHex("8a03"));
+    qint64 timestamp = -1;
+
+    QVERIFY2(transport.open(QIODevice::ReadWrite), "Failed to open the pty");
+    QVERIFY2(transport.readStamped(&timestamp).isEmpty() && timestamp == 0, "Bytes read from a silent tty");
+
+    QVERIFY2(::write(m_master, first.constData(), first.size()) == first.size(), "Failed to write to the pty master");
+    QVERIFY2(transport.waitForReadyRead(1000), "No data received");
+    const qint64 firstRead = transport.readTimestamp();
+    QTest::qSleep(20);
+    QVERIFY2(::write(m_master, second.constData(), second.size()) == second.size(), "Failed to write to the pty master");
+    QVERIFY2(transport.waitForReadyRead(1000), "No data received");
+    const qint64 secondRead = transport.readTimestamp();
+    QVERIFY2(secondRead > firstRead, "Reads not stamped separately");
+    QVERIFY2(transport.bytesAvailable() == first.size() + second.size(), "Reads not buffered together");
+
+    // Not read yet when the first bytes are consumed: read by readStamped() once the buffer is empty
+    QTest::qSleep(20);
+    const qint64 beforeThird = monotonicTime();
+    QVERIFY2(::write(m_master, third.constData(), third.size()) == third.size(), "Failed to write to the pty master");
+    QTest::qSleep(20);
+
+    QVERIFY2(transport.readStamped(&timestamp) == first, "First read not returned alone");
+    QVERIFY2(timestamp == firstRead, "First read stamped with another read's time");
+    QVERIFY2(transport.readStamped(&timestamp) == second, "Second read not returned alone");
+    QVERIFY2(timestamp == secondRead, "Second read stamped with another read's time");
+    QVERIFY2(transport.readStamped(&timestamp) == third, "Third read not returned");
+    QVERIFY2(timestamp >= beforeThird && timestamp == transport.readTimestamp(), "Third read badly stamped");
+    QVERIFY2(transport.readStamped(&timestamp).isEmpty() && timestamp == 0, "Bytes left after the last read");
+}
+
+void XbeeLinuxTransportTest::testWrite()
+{
+    LinuxSerialTransport transport(m_slave);
+    const QByteArray f = frame(QByteArray::fromHex("0801424400"));
+    QByteArray received;
+    char buffer[64];
+
+    QVERIFY2(transport.open(QIODevice::ReadWrite), "Failed to open the pty");
+    QVERIFY2(transport.write(f) == f.size(), "Failed to write the frame");
+    QVERIFY2(transport.waitForBytesWritten(1000), "Frame not written");
+    QVERIFY2(transport.bytesToWrite() == 0, "Bytes left to write");
+
+    while(received.size() < f.size()) {
+        const ssize_t n = ::read(m_master, buffer, sizeof(buffer));
+        QVERIFY2(n > 0, "Failed to read from the pty master");
+        received.append(buffer, n);
+    }
+    QVERIFY2(received == f, "Bad frame received by the pty master");
+}
+
+/**
+ * bytesWritten() comes from the event loop: a slot writing again must not re-enter write().
+ */
+void XbeeLinuxTransportTest::testBytesWrittenDeferred()
+{
+    LinuxSerialTransport transport(m_slave);
+    const QByteArray f = frame(QByteArray::fromHex("0801424400"));
+    qint64 written = 0;
+
+    QVERIFY2(transport.open(QIODevice::ReadWrite), "Failed to open the pty");
+    QSignalSpy spy(&transport, SIGNAL(bytesWritten(qint64)));
+
+    QVERIFY2(transport.write(f) == f.size(), "Failed to write the frame");
+    QVERIFY2(transport.write(f) == f.size(), "Failed to write the frame");
+    QVERIFY2(transport.flush() || transport.bytesToWrite() == 0, "Failed to flush");
+    QVERIFY2(spy.count() == 0, "bytesWritten() emitted from write()");
+
+    QTRY_VERIFY2(spy.count() == 1, "bytesWritten() not emitted once for both writes");
+    written = spy.at(0).at(0).toLongLong();
+    QVERIFY2(written == 2 * f.size(), "Bad number of bytes written");
+}
+
+void XbeeLinuxTransportTest::testHangup()
+{
+    LinuxSerialTransport transport(m_slave);
+
+    qRegisterMetaType<QSerialPort::SerialPortError>("QSerialPort::SerialPortError");
+    QVERIFY2(transport.open(QIODevice::ReadWrite), "Failed to open the pty");
+    QSignalSpy spy(&transport, SIGNAL(errorOccurred(QSerialPort::SerialPortError)));
+
+    ::close(m_master);
+    m_master = -1;
+
+    QVERIFY2(!transport.waitForReadyRead(1000), "Data received from a closed pty");
+    QVERIFY2(spy.count() == 1, "errorOccurred() not emitted on hangup");
+}
+
+/**
+ * A hung up tty stays readable: the read notifier must be disabled after the first error.
+ */
+void XbeeLinuxTransportTest::testHangupNotifier()
+{
+    LinuxSerialTransport transport(m_slave);
+
+    qRegisterMetaType<QSerialPort::SerialPortError>("QSerialPort::SerialPortError");
+    QVERIFY2(transport.open(QIODevice::ReadWrite), "Failed to open the pty");
+    QSignalSpy spy(&transport, SIGNAL(errorOccurred(QSerialPort::SerialPortError)));
+
+    ::close(m_master);
+    m_master = -1;
+
+    QTRY_VERIFY2(spy.count() >= 1, "errorOccurred() not emitted on hangup");
+    QTest::qWait(100);
+    QVERIFY2(spy.count() == 1, "Read notifier still enabled after the hangup");
+    QVERIFY2(spy.first().first().value<QSerialPort::SerialPortError>() == QSerialPort::ResourceError,
+             "Hangup not reported as a resource error");
+}
+
+/**
+ * Any radio answering in API mode is supported: the hardware version is
+ * only logged, the session is restored once SH/SL answered.
+ */
+void XbeeLinuxTransportTest::testSynchronizeNonSerie1()
+{
+    FakeXBee radio(m_master);
+    XBee xbee;
+
+    radio.setParameter("HV", QByteArray::fromHex("1e42"));
+    radio.start();
+
+    QVERIFY2(xbee.setTransport(XBee::LinuxTransport), "Failed to select the Linux transport");
+    QVERIFY2(xbee.setSerialPort(m_slave), "Failed to set the serial port");
+    QVERIFY2(xbee.open(), "Failed to open the XBee");
+    QVERIFY2(radio.count("HV") == 1, "Hardware version not read");
+    QVERIFY2(xbee.SH() == 0x0013a200 && xbee.SL() == 0x40a1b2c3, "XBee not identified");
+    QVERIFY2(radio.count("AI") == 1, "Session not restored for a non Serie 1 radio");
+    QVERIFY2(xbee.associationState() == XBee::Associated, "Association state not read");
+    xbee.close();
+}
+
+/**
+ * A parameter set from another thread is posted to the XBee's thread,
+ * which records the pending write under the frame id it allocates.
+ */
+/**
+ * The XBee's rate is found whatever the serial port's one, which is left at the found rate;
+ * or at its original rate if the XBee doesn't answer.
+ */
+void XbeeLinuxTransportTest::testProbeBaudRate()
+{
+    FakeXBee radio(m_master);
+    XBee xbee;
+
+    radio.setBaudRate(57600);
+    radio.start();
+    QVERIFY2(xbee.setTransport(XBee::LinuxTransport), "Failed to select the Linux transport");
+    QVERIFY2(xbee.setSerialPort(m_slave), "Failed to set the serial port");
+    xbee.setBaudRateNegotiation(true, 57600);
+    QVERIFY2(xbee.open(), "Failed to open the XBee");
+    QVERIFY2(ptyBaudRate(m_master) == 57600, "Serial port not set to the XBee's rate");
+    QVERIFY2(xbee.SH() == 0x0013a200 && xbee.SL() == 0x40a1b2c3, "XBee not identified at its rate");
+    QVERIFY2(radio.count("BD") == 0, "Baud rate changed while already the fastest allowed");
+
+    // Changed behind the application's back
+    radio.setBaudRate(19200);
+    QVERIFY2(xbee.probeBaudRate() == 19200, "XBee's new rate not found");
+    QVERIFY2(ptyBaudRate(m_master) == 19200, "Serial port not set to the found rate");
+
+    radio.setSilent(true);
+    QVERIFY2(xbee.probeBaudRate() == -1, "Rate found for a silent XBee");
+    QVERIFY2(ptyBaudRate(m_master) == 19200, "Serial port not restored to its original rate");
+    xbee.close();
+}
+
+/**
+ * The rate is raised to the fastest one accepted by the XBee, up to the given maximum.
+ */
+void XbeeLinuxTransportTest::testNegotiateBaudRate()
+{
+    FakeXBee radio(m_master);
+    XBee xbee;
+
+    radio.setBaudRate(9600);
+    radio.setMaxBaudRate(38400);
+    radio.start();
+    QVERIFY2(xbee.setTransport(XBee::LinuxTransport), "Failed to select the Linux transport");
+    QVERIFY2(xbee.setSerialPort(m_slave), "Failed to set the serial port");
+    QVERIFY2(xbee.open(), "Failed to open the XBee");
+
+    // Refused: both stay at the current rate
+    QVERIFY2(!xbee.negotiateBaudRate(115200), "Refused rate negotiated");
+    QVERIFY2(radio.count("BD") == 1, "ATBD not sent");
+    QVERIFY2(radio.baudRate() == 9600 && ptyBaudRate(m_master) == 9600, "Rate changed by a refused negotiation");
+    QVERIFY2(xbee.probeBaudRate() == 9600, "XBee lost after a refused negotiation");
+
+    QVERIFY2(xbee.negotiateBaudRate(38400, false), "Failed to negotiate 38400 bauds");
+    QVERIFY2(radio.baudRate() == 38400, "XBee's rate not changed");
+    QVERIFY2(ptyBaudRate(m_master) == 38400, "Serial port's rate not changed");
+    QVERIFY2(radio.count("WR") == 0, "Rate saved while not asked");
+
+    // Already the fastest: nothing sent but the probe
+    QVERIFY2(xbee.negotiateBaudRate(38400), "Current rate not reported as negotiated");
+    QVERIFY2(radio.count("BD") == 2, "Rate changed while already the fastest");
+
+    radio.setMaxBaudRate(115200);
+    QVERIFY2(xbee.negotiateBaudRate(115200, true), "Failed to negotiate 115200 bauds");
+    QVERIFY2(radio.baudRate() == 115200 && ptyBaudRate(m_master) == 115200, "Rate not raised to 115200 bauds");
+    QVERIFY2(radio.count("WR") == 1, "Rate not saved");
+    QVERIFY2(xbee.probeBaudRate() == 115200, "XBee not answering at the new rate");
+    xbee.close();
+}
+
+/**
+ * A reset XBee is synchronized again and given back the configuration written through the XBee object,
+ * unless another XBee answers.
+ */
+void XbeeLinuxTransportTest::testResync()
+{
+    FakeXBee radio(m_master);
+    XBee xbee;
+
+    radio.start();
+    QVERIFY2(xbee.setTransport(XBee::LinuxTransport), "Failed to select the Linux transport");
+    QVERIFY2(xbee.setSerialPort(m_slave), "Failed to set the serial port");
+    QVERIFY2(xbee.open(), "Failed to open the XBee");
+    QVERIFY2(radio.count("HV") == 1, "XBee not synchronized on open");
+
+    QVERIFY2(xbee.setParameter(ATCommand::ATNI, "ROUTER"), "Failed to write NI");
+    QTRY_VERIFY2(xbee.rawParameter(ATCommand::ATNI) == "ROUTER", "Written NI not acknowledged");
+
+    // Reset: the volatile configuration is lost
+    radio.setParameter("NI", " ");
+    radio.send(frame(QByteArray::fromHex("8a00")));
+    QTRY_VERIFY2(radio.count("HV") == 2, "XBee not synchronized after a hardware reset");
+    QTRY_VERIFY2(radio.parameter("NI") == "ROUTER", "Configuration not re-applied");
+    // Read to compare, then written
+    QVERIFY2(radio.count("NI") == 3, "Configuration not re-applied once");
+
+    // Replaced by another XBee
+    radio.setParameter("NI", " ");
+    radio.setParameter("SL", QByteArray::fromHex("40d4e5f6"));
+    radio.send(frame(QByteArray::fromHex("8a01")));
+    QTRY_VERIFY2(radio.count("HV") == 3, "XBee not synchronized after a watchdog reset");
+    QTRY_VERIFY2(xbee.SL() == 0x40d4e5f6, "New XBee not identified");
+    QTest::qWait(100);
+    QVERIFY2(radio.count("NI") == 3, "Configuration applied to another XBee");
+    QVERIFY2(radio.parameter("NI") == " ", "Configuration applied to another XBee");
+    xbee.close();
+}
+
+/**
+ * An XBee in transparent mode is set to API mode through the command mode, without blocking open().
+ */
+void XbeeLinuxTransportTest::testCommandModeCheck()
+{
+    FakeXBee radio(m_master);
+    XBee xbee;
+    QElapsedTimer timer;
+
+    radio.setParameter("AP", QByteArray::fromHex("00"));
+    radio.start();
+    QVERIFY2(xbee.setTransport(XBee::LinuxTransport), "Failed to select the Linux transport");
+    QVERIFY2(xbee.setSerialPort(m_slave), "Failed to set the serial port");
+    xbee.commandModeEngine()->setGuardTime(200);
+
+    timer.start();
+    QVERIFY2(xbee.open(), "Failed to open the XBee");
+    QVERIFY2(timer.elapsed() < 200, "open() waited for the guard time");
+    QVERIFY2(xbee.mode() == XBee::CommandMode, "Command mode check not started");
+
+    QTRY_VERIFY2(xbee.mode() == XBee::API1Mode, "XBee not set to API mode");
+    QTRY_VERIFY2(xbee.SL() == 0x40a1b2c3, "XBee not identified after the command mode check");
+    QVERIFY2(radio.parameter("AP") == QByteArray::fromHex("01"), "AP not written");
+    QVERIFY2(radio.count("AP1") == 1 && radio.count("CN") == 1, "Bad command lines");
+    xbee.close();
+}
+
+void XbeeLinuxTransportTest::testWriteParameterFromThread()
+{
+    FakeXBee radio(m_master);
+    XBee xbee;
+
+    radio.start();
+    QVERIFY2(xbee.setTransport(XBee::LinuxTransport), "Failed to select the Linux transport");
+    QVERIFY2(xbee.setSerialPort(m_slave), "Failed to set the serial port");
+    QVERIFY2(xbee.open(), "Failed to open the XBee");
+
+    ParameterWriter writer(&xbee, ATCommand::ATNI, "ROUTER");
+    writer.start();
+    QVERIFY2(writer.wait(1000), "Writer thread blocked");
+    QVERIFY2(writer.isOk(), "Parameter not posted");
+
+    QTRY_VERIFY2(radio.count("NI") == 1, "NI not written");
+    QTRY_VERIFY2(xbee.rawParameter(ATCommand::ATNI) == "ROUTER", "Written NI not cached");
+    xbee.close();
+}
+
+/**
+ * A volatile parameter is reported when read, but never cached; NC() keeps the last value read.
+ */
+void XbeeLinuxTransportTest::testVolatileParameter()
+{
+    FakeXBee radio(m_master);
+    XBee xbee;
+
+    radio.setParameter("DB", QByteArray::fromHex("28"));
+    radio.setParameter("NC", QByteArray::fromHex("05"));
+    radio.start();
+    QVERIFY2(xbee.setTransport(XBee::LinuxTransport), "Failed to select the Linux transport");
+    QVERIFY2(xbee.setSerialPort(m_slave), "Failed to set the serial port");
+    QVERIFY2(xbee.open(), "Failed to open the XBee");
+    QVERIFY2(!xbee.hasParameter(ATCommand::ATAI), "Association indicator cached");
+
+    QSignalSpy spy(&xbee, SIGNAL(receivedATCommandResponse(QtXBee::ATCommandResponse*)));
+    QVERIFY2(xbee.loadParameter(ATCommand::ATDB), "Failed to read DB");
+    QTRY_VERIFY2(spy.count() == 1, "DB response not reported");
+    QVERIFY2(!xbee.hasParameter(ATCommand::ATDB), "RSSI cached");
+    QVERIFY2(xbee.rawParameter(ATCommand::ATDB).isEmpty(), "RSSI cached");
+
+    QSignalSpy nc(&xbee, SIGNAL(NCChanged(quint32)));
+    QVERIFY2(xbee.loadParameter(ATCommand::ATNC), "Failed to read NC");
+    QTRY_VERIFY2(nc.count() == 1, "NC not reported");
+    QVERIFY2(xbee.NC() == 5, "Last NC read not kept");
+    xbee.close();
+}
+
+/**
+ * A synchronous command returns its own response; frames received
+ * before it are dispatched as usual.
+ */
+void XbeeLinuxTransportTest::testSyncResponseMatching()
+{
+    FakeXBee radio(m_master);
+    XBee xbee;
+
+    radio.start();
+    QVERIFY2(xbee.setTransport(XBee::LinuxTransport), "Failed to select the Linux transport");
+    QVERIFY2(xbee.setSerialPort(m_slave), "Failed to set the serial port");
+    QVERIFY2(xbee.open(), "Failed to open the XBee");
+    QVERIFY2(xbee.associationState() == XBee::Associated, "Association state not read");
+
+    QSignalSpy spy(&xbee, SIGNAL(associationChanged(QtXBee::XBee::AssociationState)));
+    // Disassociated modem status, then an AT response with a foreign frame id
+    radio.inject(frame(QByteArray::fromHex("8a03")) + frame(QByteArray::fromHex("88ee4944000000")));
+
+    ATCommandResponse * rep = xbee.sendATCommandSync(QByteArray("VR"));
+    QVERIFY2(rep != NULL, "No response");
+    QVERIFY2(rep->atCommand() == ATCommand::ATVR, "Response to another frame returned");
+    QVERIFY2(rep->data() == QByteArray::fromHex("10ef"), "Bad VR response");
+    delete rep;
+
+    QVERIFY2(spy.count() == 1, "Modem status not dispatched");
+    QVERIFY2(xbee.associationState() == XBee::Disassociated, "Modem status not handled");
+    xbee.close();
+}
+
+/**
+ * The ATAI poll only starts once the XBee answered, and stops when it's closed.
+ */
+void XbeeLinuxTransportTest::testAssociationPoll()
+{
+    FakeXBee radio(m_master);
+    XBee xbee;
+
+    QVERIFY2(QMetaType::type("QtXBee::XBee::AssociationState") != QMetaType::UnknownType,
+             "AssociationState not registered");
+
+    xbee.setAssociationPollInterval(20);
+    QVERIFY2(xbee.associationPollInterval() == 20, "Bad poll interval");
+    QTest::qWait(100);
+
+    radio.start();
+    QVERIFY2(xbee.setTransport(XBee::LinuxTransport), "Failed to select the Linux transport");
+    QVERIFY2(xbee.setSerialPort(m_slave), "Failed to set the serial port");
+    QVERIFY2(xbee.open(), "Failed to open the XBee");
+    QVERIFY2(radio.count("AI") == 1, "XBee polled before it was opened");
+
+    QTRY_VERIFY2(radio.count("AI") >= 3, "XBee not polled");
+
+    xbee.close();
+    const int polls = radio.count("AI");
+    QTest::qWait(100);
+    QVERIFY2(radio.count("AI") == polls, "XBee polled once closed");
+}
+
+/**
+ * In poll mode, a frame posted from another thread wakes the application's
+ * poll() up, and pump() sends it and dispatches its response.
+ */
+/**
+ * Data frames sent while the XBee is disassociated are held until it associates,
+ * and dropped once held for longer than the hold timeout; AT commands are never held.
+ */
+void XbeeLinuxTransportTest::testAssociationHold()
+{
+    FakeXBee radio(m_master);
+    XBee xbee;
+
+    radio.setParameter("AI", QByteArray::fromHex("21"));
+    radio.start();
+    QVERIFY2(xbee.setTransport(XBee::LinuxTransport), "Failed to select the Linux transport");
+    QVERIFY2(xbee.setSerialPort(m_slave), "Failed to set the serial port");
+    QVERIFY2(xbee.open(), "Failed to open the XBee");
+    QVERIFY2(xbee.associationState() == XBee::Disassociated, "Association state not read");
+
+    QSignalSpy failed(&xbee, SIGNAL(frameFailed(quint8)));
+    QVERIFY2(send(&xbee, 0x0001, 4), "Failed to send while disassociated");
+    QVERIFY2(xbee.loadParameter(ATCommand::ATDB), "Failed to send an AT command while disassociated");
+    QTRY_VERIFY2(radio.count("DB") == 1, "AT command held");
+    QTest::qWait(50);
+    QVERIFY2(radio.frames(0x01).isEmpty(), "Data frame sent while disassociated");
+
+    // Associated: the held frame is sent
+    radio.setParameter("AI", QByteArray::fromHex("00"));
+    radio.send(frame(QByteArray::fromHex("8a02")));
+    QTRY_VERIFY2(xbee.associationState() == XBee::Associated, "Association not reported");
+    QTRY_VERIFY2(radio.frames(0x01).size() == 1, "Held frame not sent once associated");
+
+    // Disassociated for longer than the hold timeout: the frame is dropped
+    xbee.setAssociationHoldTimeout(100);
+    xbee.setAssociationPollInterval(20);
+    radio.setParameter("AI", QByteArray::fromHex("21"));
+    radio.send(frame(QByteArray::fromHex("8a03")));
+    QTRY_VERIFY2(xbee.associationState() == XBee::Disassociated, "Disassociation not reported");
+    QVERIFY2(send(&xbee, 0x0001, 4), "Failed to send while disassociated");
+    QTRY_VERIFY2(failed.count() == 1, "Held frame not dropped after the hold timeout");
+    QVERIFY2(failed.count() == 1 && radio.frames(0x01).size() == 1, "Dropped frame sent");
+
+    radio.setParameter("AI", QByteArray::fromHex("00"));
+    QTRY_VERIFY2(xbee.associationState() == XBee::Associated, "Association not polled");
+    QTest::qWait(50);
+    QVERIFY2(radio.frames(0x01).size() == 1, "Dropped frame sent once associated");
+    xbee.close();
+}
+
+void XbeeLinuxTransportTest::testPump()
+{
+    FakeXBee radio(m_master);
+    XBee xbee;
+    QElapsedTimer timer;
+
+    QVERIFY2(!xbee.setPollMode(true), "Poll mode enabled over QSerialPort");
+    QVERIFY2(xbee.setTransport(XBee::LinuxTransport), "Failed to select the Linux transport");
+    QVERIFY2(xbee.setPollMode(true), "Failed to enable the poll mode");
+    QVERIFY2(!xbee.setTransport(XBee::QtSerialPortTransport), "QSerialPort selected in poll mode");
+
+    radio.start();
+    QVERIFY2(xbee.setSerialPort(m_slave), "Failed to set the serial port");
+    QVERIFY2(xbee.open(), "Failed to open the XBee");
+    QVERIFY2(xbee.pollDescriptor() >= 0, "No descriptor to poll");
+    QVERIFY2(xbee.wakeDescriptor() >= 0, "No wake up descriptor");
+
+    ParameterWriter writer(&xbee, ATCommand::ATNI, "ROUTER");
+    writer.start();
+    QVERIFY2(writer.wait(1000) && writer.isOk(), "Parameter not posted");
+
+    struct pollfd wake = { xbee.wakeDescriptor(), POLLIN, 0 };
+    QVERIFY2(::poll(&wake, 1, 1000) == 1, "poll() not woken up by a posted frame");
+    QVERIFY2(xbee.nextTimeout() == 0, "Posted frame not pending");
+
+    timer.start();
+    while(xbee.rawParameter(ATCommand::ATNI) != "ROUTER" && timer.elapsed() < 2000) {
+        struct pollfd fds[2] = {{xbee.pollDescriptor(), xbee.pollEvents(), 0},
+                                {xbee.wakeDescriptor(), POLLIN, 0}};
+        const int timeout = xbee.nextTimeout();
+        ::poll(fds, 2, timeout < 0 || timeout > 100 ? 100 : timeout);
+        QVERIFY2(xbee.pump(), "pump() failed");
+    }
+    QVERIFY2(radio.count("NI") == 1, "NI not written");
+    QVERIFY2(xbee.rawParameter(ATCommand::ATNI) == "ROUTER", "Response not dispatched by pump()");
+
+    wake.revents = 0;
+    QVERIFY2(::poll(&wake, 1, 0) == 0, "Wake up descriptor not reset by pump()");
+    xbee.close();
+}
+
+bool XbeeLinuxTransportTest::send(XBee *xbee, const quint16 destination, const int size)
+{
+    TxRequest16 request;
+
+    request.setDestinationAddress(destination);
+    request.setData(QByteArray(size, 'x'));
+    return xbee->sendAsync(&request);
+}
+
+/**
+ * An acknowledged frame is reported with its enqueue, write and acknowledge times,
+ * and the received frames are published to the frame ring with their receive time.
+ */
+void XbeeLinuxTransportTest::testFrameTimestamps()
+{
+    FakeXBee radio(m_master);
+    XBee xbee;
+    FrameRing ring(16);
+    TxRequest16 request;
+    QVector<QByteArray> frames;
+    QVector<qint64> timestamps;
+
+    radio.start();
+    QVERIFY2(xbee.setTransport(XBee::LinuxTransport), "Failed to select the Linux transport");
+    QVERIFY2(xbee.setSerialPort(m_slave), "Failed to set the serial port");
+    QVERIFY2(xbee.open(), "Failed to open the XBee");
+    xbee.setFrameRing(&ring);
+    const int consumer = ring.attach(FrameRing::DropOldest);
+    QVERIFY2(consumer >= 0, "Failed to attach to the ring");
+
+    QSignalSpy spy(&xbee, SIGNAL(frameTimestamps(quint8,quint32,qint64,qint64,qint64)));
+    const qint64 before = monotonicTime();
+    request.setDestinationAddress(0x0001);
+    request.setData("T");
+    QVERIFY2(xbee.sendAsync(&request), "Failed to send");
+    QTRY_VERIFY2(spy.count() == 1, "Frame timestamps not reported");
+    const qint64 after = monotonicTime();
+
+    const QList<QVariant> args = spy.takeFirst();
+    const qint64 enqueued = args.at(2).toLongLong();
+    const qint64 written = args.at(3).toLongLong();
+    const qint64 completed = args.at(4).toLongLong();
+    QVERIFY2(args.at(0).toInt() == request.frameId(), "Timestamps of another frame");
+    QVERIFY2(before <= enqueued && enqueued <= written && written <= completed && completed <= after,
+             "Timestamps out of order");
+
+    // The transmit status is the delivered frame
+    QVERIFY2(ring.read(consumer, &frames, &timestamps) == 1, "Transmit status not published");
+    QVERIFY2((quint8)frames.at(0).at(3) == 0x89, "Bad published frame");
+    QVERIFY2(timestamps.at(0) == completed, "Published frame not stamped with its receive time");
+
+    // Received apart, stamped apart
+    radio.send(frame(QByteArray::fromHex("81000128004131")));
+    QTRY_VERIFY2(ring.available(consumer) == 1, "First frame not published");
+    QTest::qWait(30);
+    radio.send(frame(QByteArray::fromHex("81000128004132")));
+    QTRY_VERIFY2(ring.available(consumer) == 2, "Second frame not published");
+    QVERIFY2(ring.read(consumer, &frames, &timestamps) == 2, "Frames not read");
+    QVERIFY2(timestamps.at(0) >= completed && timestamps.at(1) - timestamps.at(0) >= Q_INT64_C(30000000), "Frames not stamped when received");
+    QVERIFY2(timestamps.at(1) <= monotonicTime(), "Frame stamped in the future");
+    xbee.close();
+}
+
+/**
+ * Queued data frames are sent round robin among their destinations, by
+ * quantum of bytes: a destination with large frames doesn't starve another.
+ */
+void XbeeLinuxTransportTest::testDeficitRoundRobin()
+{
+    FakeXBee radio(m_master);
+    XBee xbee;
+    QList<QByteArray> order;
+
+    radio.start();
+    QVERIFY2(xbee.setTransport(XBee::LinuxTransport), "Failed to select the Linux transport");
+    QVERIFY2(xbee.setSerialPort(m_slave), "Failed to set the serial port");
+    QVERIFY2(xbee.open(), "Failed to open the XBee");
+    xbee.setTransmitWindow(1);
+
+    // The first frame fills the window, the others stay queued until its transmit status
+    for(int i=0; i<4; i++) {
+        QVERIFY2(send(&xbee, 0x0001, 100), "Failed to queue a frame to 0x0001");
+    }
+    QVERIFY2(send(&xbee, 0x0002, 10), "Failed to queue a frame to 0x0002");
+    QVERIFY2(xbee.queuedFrameCount() == 4, "Frames not queued behind the transmit window");
+
+    QTRY_VERIFY2(radio.frames(0x01).size() == 5, "Frames not sent");
+    foreach(const QByteArray & f, radio.frames(0x01)) {
+        order.append(f.left(2).toHex());
+    }
+    QVERIFY2(order == QList<QByteArray>() << "0001" << "0001" << "0002" << "0001" << "0001",
+             qPrintable(QString("Bad sending order: %1").arg(QString(QByteArray("0x").append(order.join(" 0x"))))));
+    xbee.close();
+}
+
+/**
+ * A queued frame past its deadline is dropped instead of being written.
+ */
+void XbeeLinuxTransportTest::testDeadline()
+{
+    FakeXBee radio(m_master);
+    XBee xbee;
+    TxRequest16 a, b, c;
+
+    radio.start();
+    QVERIFY2(xbee.setTransport(XBee::LinuxTransport), "Failed to select the Linux transport");
+    QVERIFY2(xbee.setSerialPort(m_slave), "Failed to set the serial port");
+    QVERIFY2(xbee.open(), "Failed to open the XBee");
+    xbee.setTransmitWindow(1);
+    xbee.setFrameTimeout(200);
+    radio.setSilent(true);
+
+    QSignalSpy spy(&xbee, SIGNAL(frameFailed(quint8)));
+    a.setDestinationAddress(0x0001);
+    a.setData("A");
+    b.setDestinationAddress(0x0001);
+    b.setData("B");
+    c.setDestinationAddress(0x0001);
+    c.setData("C");
+    QVERIFY2(xbee.sendAsync(&a), "Failed to send A");
+    QVERIFY2(xbee.sendAsync(&b, 50), "Failed to queue B");
+    QVERIFY2(xbee.sendAsync(&c, -1), "Failed to queue C");
+    QVERIFY2(xbee.queuedFrameCount() == 2, "Frames not queued behind the transmit window");
+
+    // A times out after B's deadline: B is dropped, C written
+    QTRY_VERIFY2(radio.frames(0x01).size() == 2, "C not written");
+    QVERIFY2(radio.frames(0x01).at(1).mid(3) == "C", "Expired frame written");
+    QVERIFY2(spy.count() == 2, "Bad failed frame count");
+    QVERIFY2(spy.at(0).at(0).toInt() == a.frameId() && spy.at(1).at(0).toInt() == b.frameId(),
+             "Timed out and expired frames not reported");
+    xbee.close();
+}
+
+/**
+ * A queued frame is replaced by a frame with the same key; a frame already written isn't.
+ */
+void XbeeLinuxTransportTest::testSupersede()
+{
+    FakeXBee radio(m_master);
+    XBee xbee;
+    TxRequest16 a, b, c, d;
+
+    radio.start();
+    QVERIFY2(xbee.setTransport(XBee::LinuxTransport), "Failed to select the Linux transport");
+    QVERIFY2(xbee.setSerialPort(m_slave), "Failed to set the serial port");
+    QVERIFY2(xbee.open(), "Failed to open the XBee");
+    xbee.setTransmitWindow(1);
+
+    QSignalSpy spy(&xbee, SIGNAL(frameFailed(quint8)));
+    a.setDestinationAddress(0x0001);
+    a.setData("A");
+    b.setDestinationAddress(0x0001);
+    b.setData("B");
+    c.setDestinationAddress(0x0001);
+    c.setData("C");
+    d.setDestinationAddress(0x0001);
+    d.setData("D");
+    QVERIFY2(xbee.sendAsync(&a, -1, "poll"), "Failed to send A");
+    QVERIFY2(xbee.sendAsync(&b, -1, "poll"), "Failed to queue B");
+    QVERIFY2(xbee.sendAsync(&c, -1, "poll"), "Failed to queue C");
+    QVERIFY2(xbee.sendAsync(&d, -1, "other"), "Failed to queue D");
+    QVERIFY2(xbee.queuedFrameCount() == 2, "Bad queued frame count");
+    QVERIFY2(spy.count() == 1 && spy.first().first().toInt() == b.frameId(), "B not superseded");
+
+    QTRY_VERIFY2(radio.frames(0x01).size() == 3, "Frames not sent");
+    const QList<QByteArray> frames = radio.frames(0x01);
+    QVERIFY2(frames.at(0).mid(3) == "A" && frames.at(1).mid(3) == "C" && frames.at(2).mid(3) == "D",
+             "Superseding frame didn't take the superseded one's place");
+    QVERIFY2(spy.count() == 1, "Frame in flight superseded");
+    xbee.close();
+}
+
+/**
+ * With the default transmit window, frames without frame id are only held by the
+ * UART pacing: a frame expiring while the UART is busy is dropped, a superseded one replaced.
+ */
+void XbeeLinuxTransportTest::testPacing()
+{
+    FakeXBee radio(m_master);
+    XBee xbee;
+    TxRequest16 a, b, c, d, e;
+
+    radio.start();
+    QVERIFY2(xbee.setTransport(XBee::LinuxTransport), "Failed to select the Linux transport");
+    QVERIFY2(xbee.setSerialPort(m_slave), "Failed to set the serial port");
+    QVERIFY2(xbee.open(), "Failed to open the XBee");
+
+    // About 110 ms each on the wire at 9600 bauds
+    a.setDestinationAddress(0x0001);
+    a.setData(QByteArray(100, 'A'));
+    b.setDestinationAddress(0x0001);
+    b.setData(QByteArray(100, 'B'));
+    c.setDestinationAddress(0x0001);
+    c.setData(QByteArray(100, 'C'));
+    d.setDestinationAddress(0x0001);
+    d.setData(QByteArray(100, 'D'));
+    e.setDestinationAddress(0x0001);
+    e.setData(QByteArray(100, 'E'));
+    QVERIFY2(xbee.sendAsync(&a, -1, QByteArray(), XBee::NoStatus), "Failed to send A");
+    QVERIFY2(xbee.sendAsync(&b, 50, QByteArray(), XBee::NoStatus), "Failed to queue B");
+    QVERIFY2(xbee.sendAsync(&c, -1, QByteArray(), XBee::NoStatus), "Failed to queue C");
+    QVERIFY2(xbee.sendAsync(&d, -1, "poll", XBee::NoStatus), "Failed to queue D");
+    QVERIFY2(xbee.sendAsync(&e, -1, "poll", XBee::NoStatus), "Failed to queue E");
+    QVERIFY2(xbee.queuedFrameCount() == 3, "Frames not held by the UART pacing");
+
+    QTRY_VERIFY2(radio.frames(0x01).size() == 3, "Frames not sent");
+    QTest::qWait(150);
+    const QList<QByteArray> frames = radio.frames(0x01);
+    QVERIFY2(frames.size() == 3, "Expired or superseded frame written");
+    QVERIFY2(frames.at(0).mid(3) == QByteArray(100, 'A') && frames.at(1).mid(3) == QByteArray(100, 'C') &&
+             frames.at(2).mid(3) == QByteArray(100, 'E'), "Frames not paced in order");
+    xbee.close();
+}
+
+/**
+ * A destination failing BreakerThreshold times in a row is backed off, the
+ * others still get their frames; once the delay elapsed a single probe goes out.
+ */
+void XbeeLinuxTransportTest::testBreaker()
+{
+    FakeXBee radio(m_master);
+    XBee xbee;
+
+    radio.setTxStatus(0x0002, 0x01);
+    radio.start();
+    QVERIFY2(xbee.setTransport(XBee::LinuxTransport), "Failed to select the Linux transport");
+    QVERIFY2(xbee.setSerialPort(m_slave), "Failed to set the serial port");
+    QVERIFY2(xbee.open(), "Failed to open the XBee");
+
+    QSignalSpy failed(&xbee, SIGNAL(frameFailed(quint8)));
+    for(int i=0; i<3; i++) {
+        QVERIFY2(send(&xbee, 0x0002, 10), "Failed to queue a frame to 0x0002");
+        QTRY_VERIFY2(radio.frames(0x01).size() == i+1, "Frame to 0x0002 not sent");
+    }
+    QTest::qWait(50);
+
+    // Open: 0x0002 waits for its back off, 0x0001 doesn't
+    QVERIFY2(send(&xbee, 0x0002, 10) && send(&xbee, 0x0002, 10), "Failed to queue frames to 0x0002");
+    QVERIFY2(send(&xbee, 0x0001, 10), "Failed to queue a frame to 0x0001");
+    QTRY_VERIFY2(radio.frames(0x01).size() == 4, "Frame to 0x0001 blocked by 0x0002");
+    QVERIFY2(radio.frames(0x01).last().left(2) == QByteArray::fromHex("0001"), "Frame to 0x0002 not backed off");
+
+    // Half-open: a probe, which succeeds and closes the breaker for the next frame
+    radio.setTxStatus(0x0002, 0x00);
+    QTRY_VERIFY2_WITH_TIMEOUT(radio.frames(0x01).size() == 6, "Destination not probed", 3000);
+    QVERIFY2(radio.frames(0x01).at(4).left(2) == QByteArray::fromHex("0002") &&
+             radio.frames(0x01).at(5).left(2) == QByteArray::fromHex("0002"), "Backed off frames not sent");
+    QVERIFY2(failed.isEmpty(), "Frame dropped");
+    xbee.close();
+}
+
+/**
+ * While the XBee is disassociated, data frames are held but remote AT
+ * commands, which go through the same destination queues, are sent.
+ */
+void XbeeLinuxTransportTest::testRemoteCommandNotHeld()
+{
+    FakeXBee radio(m_master);
+    XBee xbee;
+    RemoteATCommandRequest remote;
+
+    radio.start();
+    QVERIFY2(xbee.setTransport(XBee::LinuxTransport), "Failed to select the Linux transport");
+    QVERIFY2(xbee.setSerialPort(m_slave), "Failed to set the serial port");
+    QVERIFY2(xbee.open(), "Failed to open the XBee");
+
+    radio.send(frame(QByteArray::fromHex("8a03")));
+    QTRY_VERIFY2(xbee.associationState() == XBee::Disassociated, "Disassociation not handled");
+
+    QVERIFY2(send(&xbee, 0x0001, 10), "Failed to hold a data frame");
+    remote.setDestinationAddress64(0x0013A20040A1B2C4ULL);
+    remote.setDestinationAddress16(0xFFFE);
+    remote.setCommand(ATCommand::ATNI);
+    QVERIFY2(xbee.sendAsync(&remote), "Failed to send the remote AT command");
+
+    QTRY_VERIFY2(radio.frames(0x17).size() == 1, "Remote AT command held");
+    QVERIFY2(radio.frames(0x01).isEmpty(), "Data frame sent while disassociated");
+
+    radio.send(frame(QByteArray::fromHex("8a02")));
+    QTRY_VERIFY2(radio.frames(0x01).size() == 1, "Data frame not released once associated");
+    xbee.close();
+}
+
+/**
+ * The response to a remote AT command in flight bypasses the frame filter,
+ * an unsolicited one from the same node doesn't.
+ */
+void XbeeLinuxTransportTest::testFilterInFlightResponse()
+{
+    FakeXBee radio(m_master);
+    XBee xbee;
+    RemoteATCommandRequest remote;
+
+    radio.start();
+    QVERIFY2(xbee.setTransport(XBee::LinuxTransport), "Failed to select the Linux transport");
+    QVERIFY2(xbee.setSerialPort(m_slave), "Failed to set the serial port");
+    QVERIFY2(xbee.open(), "Failed to open the XBee");
+    xbee.setFrameFilter(FrameFilter::fromString("src16=0002"));
+
+    QSignalSpy spy(&xbee, SIGNAL(receivedRemoteCommandResponse(QtXBee::RemoteATCommandResponse*)));
+    remote.setDestinationAddress64(0x0013A20040A1B2C4ULL);
+    remote.setDestinationAddress16(0xFFFE);
+    remote.setCommand(ATCommand::ATNI);
+    QVERIFY2(xbee.sendAsync(&remote), "Failed to send the remote AT command");
+    QTRY_VERIFY2(spy.count() == 1, "Response to a frame in flight filtered");
+
+    radio.send(frame(QByteArray::fromHex("97330013a20040a1b2c4fffe4e4900")));
+    QTRY_VERIFY2(xbee.filteredFrameCount() == 1, "Unsolicited response not filtered");
+    QVERIFY2(spy.count() == 1, "Unsolicited response delivered");
+    xbee.close();
+}
+
+/**
+ * A port without radio is probed again on the next scan.
+ */
+void XbeeLinuxTransportTest::testDiscovery()
+{
+    FakeXBee radio(m_master);
+    XBeeDiscovery discovery;
+
+    discovery.setPortNames(QStringList() << m_slave);
+    discovery.setBaudRates(QList<qint32>() << 9600);
+    discovery.setCommandModeEnabled(false);
+
+    discovery.start();
+    QVERIFY2(discovery.waitForFinished(2000), "Discovery not finished");
+    QVERIFY2(discovery.radios().isEmpty(), "Radio found on a silent port");
+
+    radio.start();
+    QSignalSpy spy(&discovery, SIGNAL(radioFound(QtXBee::XBeeDiscovery::Radio)));
+    discovery.start();
+    QVERIFY2(discovery.waitForFinished(2000), "Discovery not finished");
+    QVERIFY2(spy.count() == 1, "Failed port not probed again");
+
+    const XBeeDiscovery::Radio found = discovery.radio(Q_UINT64_C(0x0013a20040a1b2c3));
+    QVERIFY2(found.isValid(), "Radio not found");
+    QVERIFY2(found.portName == m_slave, "Bad port name");
+    QVERIFY2(found.baudRate == 9600, "Bad baud rate");
+    QVERIFY2(found.mode == XBee::API1Mode, "Bad API mode");
+    QVERIFY2(found.hardwareVersion == 0x1744 && found.firmwareVersion == 0x10ef, "Bad versions");
+
+    // Found ports aren't probed again
+    discovery.start();
+    QVERIFY2(!discovery.isRunning(), "Found port probed again");
+}
+
+/**
+ * Once AP answered, lost identification frames are sent again at the same baud rate.
+ */
+void XbeeLinuxTransportTest::testDiscoveryIdentifyRetry()
+{
+    FakeXBee radio(m_master);
+    XBeeDiscovery discovery;
+
+    radio.drop("SH", 1);
+    radio.start();
+    discovery.setPortNames(QStringList() << m_slave);
+    discovery.setBaudRates(QList<qint32>() << 9600 << 115200);
+    discovery.setCommandModeEnabled(false);
+
+    discovery.start();
+    QVERIFY2(discovery.waitForFinished(2000), "Discovery not finished");
+    QVERIFY2(radio.count("SH") == 2, "Identification not sent again");
+    QVERIFY2(radio.count("AP") == 1, "Next baud rate probed");
+    QVERIFY2(discovery.radio(Q_UINT64_C(0x0013a20040a1b2c3)).baudRate == 9600, "Radio not found at 9600 bauds");
+}
+
+/**
+ * In command mode, an ERROR line fails the probe; the radio is then taken out of command mode.
+ */
+void XbeeLinuxTransportTest::testDiscoveryCommandMode()
+{
+    FakeXBee radio(m_master);
+    XBeeDiscovery discovery;
+
+    radio.setParameter("AP", QByteArray::fromHex("00"));
+    radio.removeParameter("VR");
+    radio.start();
+    discovery.setPortNames(QStringList() << m_slave);
+    discovery.setBaudRates(QList<qint32>() << 9600);
+
+    discovery.start();
+    QVERIFY2(discovery.waitForFinished(5000), "Discovery not finished");
+    QVERIFY2(discovery.radios().isEmpty(), "Radio found despite an ERROR");
+    QVERIFY2(radio.count("CN") == 1, "Command mode not left");
+
+    radio.setParameter("VR", QByteArray::fromHex("10ef"));
+    discovery.start();
+    QVERIFY2(discovery.waitForFinished(5000), "Discovery not finished");
+    const XBeeDiscovery::Radio found = discovery.radio(Q_UINT64_C(0x0013a20040a1b2c3));
+    QVERIFY2(found.isValid(), "Radio not found in command mode");
+    QVERIFY2(found.mode == XBee::CommandMode, "Bad mode");
+    QVERIFY2(found.firmwareVersion == 0x10ef, "Bad firmware version");
+}
+
+QTEST_GUILESS_MAIN(XbeeLinuxTransportTest)
+
+#include "tst_xbeelinuxtransporttest.moc"
@@ -0,0 +1,140 @@
+#include <QString>
+#include <QtTest>
+#include <QCoreApplication>
+
+#include <MpscQueue>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace QtXBee;
+
+class XbeeMpscQueueTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    XbeeMpscQueueTest();
+
+private Q_SLOTS:
+    void testFifo();
+    void testInterleaved();
+    void testMultipleProducers();
+    void testPendingValuesReleased();
+};
+
+XbeeMpscQueueTest::XbeeMpscQueueTest()
+{
+}
+
+void XbeeMpscQueueTest::testFifo()
+{
+    MpscQueue<int> queue;
+    int value = 0;
+
+    QVERIFY2(queue.isEmpty(), "New queue not empty");
+    QVERIFY2(!queue.pop(&value), "Popped from an empty queue");
+
+    for(int i=0; i<10; i++) {
+        queue.push(i);
+    }
+    QVERIFY2(!queue.isEmpty(), "Queue empty after push");
+    for(int i=0; i<10; i++) {
+        QVERIFY2(queue.pop(&value), "Failed to pop");
+        QVERIFY2(value == i, QString("Bad value, %1 expected").arg(i).toStdString().c_str());
+    }
+    QVERIFY2(queue.isEmpty(), "Queue not empty after popping everything");
+    QVERIFY2(!queue.pop(&value), "Popped from an empty queue");
+}
+
+/**
+ * The queue keeps working when it is drained between pushes (the stub node is only used once).
+ */
+void XbeeMpscQueueTest::testInterleaved()
+{
+    MpscQueue<QByteArray> queue;
+    QByteArray value;
+
+    for(int i=0; i<100; i++) {
+        queue.push(QByteArray::number(i));
+        queue.push(QByteArray::number(-i));
+        QVERIFY2(queue.pop(&value) && value == QByteArray::number(i), "Bad first value");
+        QVERIFY2(queue.pop(&value) && value == QByteArray::number(-i), "Bad second value");
+        QVERIFY2(!queue.pop(&value), "Popped from an empty queue");
+    }
+}
+
+/**
+ * Several threads push while the consumer pops: every value is popped exactly once,
+ * and each producer's values come out in the order they were pushed.
+ */
+void XbeeMpscQueueTest::testMultipleProducers()
+{
+    const int producerCount = 4;
+    const int valueCount = 100000;
+    MpscQueue<qint64> queue;
+    std::atomic<bool> start(false);
+    std::vector<std::thread> producers;
+
+    for(int p=0; p<producerCount; p++) {
+        producers.emplace_back([&queue, &start, p, valueCount]() {
+            while(!start.load()) {
+                std::this_thread::yield();
+            }
+            for(int i=0; i<valueCount; i++) {
+                queue.push((qint64(p) << 32) | i);
+            }
+        });
+    }
+
+    std::vector<int> next(producerCount, 0);
+    int popped = 0;
+    bool ordered = true;
+    qint64 value = 0;
+    QElapsedTimer timer;
+
+    start.store(true);
+    timer.start();
+    while(popped < producerCount * valueCount && timer.elapsed() < 10000) {
+        if(!queue.pop(&value)) {
+            std::this_thread::yield();
+            continue;
+        }
+        const int p = int(value >> 32);
+        const int i = int(value & 0xFFFFFFFF);
+        if(p < 0 || p >= producerCount || next[p] != i) {
+            ordered = false;
+            break;
+        }
+        next[p]++;
+        popped++;
+    }
+
+    for(std::thread & producer : producers) {
+        producer.join();
+    }
+
+    QVERIFY2(ordered, "Value lost, duplicated or out of its producer's order");
+    QVERIFY2(popped == producerCount * valueCount, "Values missing");
+    QVERIFY2(!queue.pop(&value), "Popped more values than pushed");
+}
+
+/**
+ * Values left in the queue are released by its destructor.
+ */
+void XbeeMpscQueueTest::testPendingValuesReleased()
+{
+    QByteArray value("pending");
+    {
+        MpscQueue<QByteArray> queue;
+        queue.push(value);
+        queue.push(value);
+        QVERIFY2(!value.isDetached(), "Value not shared with the queue");
+    }
+    QVERIFY2(value.isDetached(), "Values not released by the queue");
+}
+
+QTEST_GUILESS_MAIN(XbeeMpscQueueTest)
+
+#include "tst_xbeempscqueuetest.moc"
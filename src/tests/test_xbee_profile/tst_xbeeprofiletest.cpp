@@ -0,0 +1,141 @@
+#include <QString>
+#include <QtTest>
+#include <QCoreApplication>
+
+#include <ATCommand>
+#include <FrameDecoder>
+#include <XBeeProfile>
+
+using namespace QtXBee;
+
+class XbeeProfileTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    XbeeProfileTest();
+
+private Q_SLOTS:
+    void testObject();
+    void testArray();
+    void testInvalid();
+    void testSetValue();
+    void testDecoderOversize();
+};
+
+XbeeProfileTest::XbeeProfileTest()
+{
+}
+
+void XbeeProfileTest::testObject()
+{
+    bool ok = false;
+    const XBeeProfile profile = XBeeProfile::fromJson("{ \"name\": \"gateway\", \"parameters\": {"
+                                                      " \"ID\": \"0x3332\", \"CH\": 12, \"NI\": \"GATEWAY\","
+                                                      " \"KY\": \"0x000102030405060708090a0b0c0d0e0f\" } }", &ok);
+
+    QVERIFY2(ok, "Failed to load the profile");
+    QVERIFY2(profile.name() == "gateway", "Bad name");
+    QVERIFY2(profile.size() == 4, "Bad parameter count");
+    QVERIFY2(profile.value(ATCommand::ATID) == QByteArray::fromHex("3332"), "Bad ID value");
+    QVERIFY2(profile.value(ATCommand::ATCH) == QByteArray::fromHex("0c"), "Bad CH value");
+    QVERIFY2(profile.value(ATCommand::ATNI) == "GATEWAY", "Bad NI value");
+    QVERIFY2(profile.value(ATCommand::ATKY) == QByteArray::fromHex("000102030405060708090a0b0c0d0e0f"), "Bad KY value");
+
+    // QJsonObject sorts its keys
+    const QList<ATCommand::ATCommandType> order = QList<ATCommand::ATCommandType>()
+            << ATCommand::ATCH << ATCommand::ATID << ATCommand::ATKY << ATCommand::ATNI;
+    QVERIFY2(profile.parameters() == order, "Object parameters must be loaded in alphabetical order");
+}
+
+void XbeeProfileTest::testArray()
+{
+    bool ok = false;
+    const XBeeProfile profile = XBeeProfile::fromJson("{ \"parameters\": [ { \"NI\": \"ROUTER\" }, { \"ID\": 13106 },"
+                                                      " { \"DL\": \"0xFFFF\" }, { \"CH\": \"12\" } ] }", &ok);
+
+    QVERIFY2(ok, "Failed to load the profile");
+    const QList<ATCommand::ATCommandType> order = QList<ATCommand::ATCommandType>()
+            << ATCommand::ATNI << ATCommand::ATID << ATCommand::ATDL << ATCommand::ATCH;
+    QVERIFY2(profile.parameters() == order, "Array parameters must be loaded in array order");
+    QVERIFY2(profile.value(ATCommand::ATID) == QByteArray::fromHex("3332"), "Bad ID value");
+    QVERIFY2(profile.value(ATCommand::ATDL) == QByteArray::fromHex("0000ffff"), "Bad DL value");
+    QVERIFY2(profile.value(ATCommand::ATCH) == QByteArray::fromHex("0c"), "Bad CH value");
+}
+
+void XbeeProfileTest::testInvalid()
+{
+    bool ok = true;
+
+    QVERIFY2(XBeeProfile::fromJson("not json", &ok).isEmpty() && !ok, "Invalid JSON accepted");
+
+    ok = true;
+    QVERIFY2(XBeeProfile::fromJson("{ \"parameters\": { \"ZZ\": 1 } }", &ok).isEmpty() && !ok, "Unknown parameter accepted");
+
+    ok = true;
+    QVERIFY2(XBeeProfile::fromJson("{ \"parameters\": { \"CH\": 48 } }", &ok).isEmpty() && !ok, "Out of range CH accepted");
+
+    ok = true;
+    QVERIFY2(XBeeProfile::fromJson("{ \"parameters\": { \"CH\": \"twelve\" } }", &ok).isEmpty() && !ok, "Bad numeric string accepted");
+
+    ok = true;
+    QVERIFY2(XBeeProfile::fromJson("{ \"parameters\": { \"SH\": 1 } }", &ok).isEmpty() && !ok, "Read only SH accepted");
+
+    ok = true;
+    QVERIFY2(XBeeProfile::fromJson("{ \"parameters\": { \"NI\": 12 } }", &ok).isEmpty() && !ok, "Numeric NI accepted");
+
+    ok = true;
+    QVERIFY2(XBeeProfile::fromJson("{ \"parameters\": [ { \"CH\": 12, \"ID\": 1 } ] }", &ok).isEmpty() && !ok,
+             "Array entry with two parameters accepted");
+
+    ok = true;
+    QVERIFY2(XBeeProfile::fromJson("{ \"parameters\": [ { \"CH\": 12 }, 3 ] }", &ok).isEmpty() && !ok,
+             "Array entry which isn't an object accepted");
+}
+
+void XbeeProfileTest::testSetValue()
+{
+    XBeeProfile profile;
+
+    QVERIFY2(profile.setValue(ATCommand::ATID, 0x3332), "Failed to set ID");
+    QVERIFY2(profile.setValue(ATCommand::ATNI, QByteArray("NODE")), "Failed to set NI");
+    QVERIFY2(profile.setValue(ATCommand::ATID, 0x1234), "Failed to overwrite ID");
+    QVERIFY2(!profile.setValue(ATCommand::ATCH, 0x30), "Out of range CH accepted");
+
+    QVERIFY2(profile.size() == 2, "Overwriting a parameter must not add it twice");
+    QVERIFY2(profile.parameters().first() == ATCommand::ATID, "Overwriting a parameter must keep its position");
+    QVERIFY2(profile.value(ATCommand::ATID) == QByteArray::fromHex("1234"), "Bad overwritten ID value");
+
+    profile.remove(ATCommand::ATID);
+    QVERIFY2(!profile.contains(ATCommand::ATID) && profile.size() == 1, "Failed to remove ID");
+    profile.clear();
+    QVERIFY2(profile.isEmpty(), "Failed to clear the profile");
+}
+
+void XbeeProfileTest::testDecoderOversize()
+{
+    // AT command frame (ATVR, frame id 1)
+    const QByteArray valid = QByteArray::fromHex("7e0004080156524e");
+    FrameDecoder decoder;
+    QByteArray frame;
+
+    QVERIFY2(decoder.maxFrameSize() == FrameDecoder::DefaultMaxFrameSize, "Bad default max frame size");
+
+    // A start delimiter in noise announcing a 64 KB frame must not stall the following frames
+    decoder.append(QByteArray::fromHex("7effff0102") + valid);
+    QVERIFY2(decoder.takeFrame(&frame), "Oversized frame not skipped");
+    QVERIFY2(frame == valid, "Bad frame after resynchronization");
+    QVERIFY2(!decoder.takeFrame(&frame), "Unexpected frame");
+
+    decoder.setMaxFrameSize(valid.size() - 1);
+    decoder.append(valid);
+    QVERIFY2(!decoder.takeFrame(&frame), "Frame longer than maxFrameSize() accepted");
+
+    decoder.setMaxFrameSize(valid.size());
+    decoder.append(valid);
+    QVERIFY2(decoder.takeFrame(&frame) && frame == valid, "Frame of maxFrameSize() bytes dropped");
+}
+
+QTEST_GUILESS_MAIN(XbeeProfileTest)
+
+#include "tst_xbeeprofiletest.moc"
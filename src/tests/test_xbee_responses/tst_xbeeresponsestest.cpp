@@ -0,0 +1,192 @@
+#include <QString>
+#include <QtTest>
+#include <QCoreApplication>
+
+#include <wpan/RxResponse16>
+#include <wpan/RxResponse64>
+#include <zigbee/zbionodeidentificationresponse.h>
+
+using namespace QtXBee;
+
+class XbeeResponsesTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    XbeeResponsesTest();
+
+private Q_SLOTS:
+    void testRx16();
+    void testRx64();
+    void testSetterBeforeAccess();
+    void testReuse();
+    void testRx16TooShort();
+    void testNodeIdentification();
+    void testNodeIdentificationEmptyIdentifier();
+    void testNodeIdentificationUnterminated();
+};
+
+/**
+ * Builds an API frame around the given payload (API id included).
+ */
+static QByteArray frame(const QByteArray & payload)
+{
+    QByteArray f;
+    quint8 sum = 0;
+
+    f.append((char)0x7E);
+    f.append((char)((payload.size() >> 8) & 0xFF));
+    f.append((char)(payload.size() & 0xFF));
+    f.append(payload);
+    for(int i=0; i<payload.size(); i++) {
+        sum += (quint8)payload.at(i);
+    }
+    f.append((char)(0xFF - sum));
+    return f;
+}
+
+/**
+ * Node identification frame: sender 0013A20040A1B2C3/1234, options 0x02,
+ * remote 5678/0013A20040D4E5F6, the given identifier, then the trailer:
+ * parent FFFE, router, pushbutton event, profile C105, manufacturer 101E.
+ */
+static QByteArray nodeIdentificationFrame(const QByteArray & identifier)
+{
+    return frame(QByteArray::fromHex("95" "0013a20040a1b2c3" "1234" "02" "5678" "0013a20040d4e5f6")
+                 + identifier
+                 + QByteArray::fromHex("fffe" "01" "01" "c105" "101e"));
+}
+
+XbeeResponsesTest::XbeeResponsesTest()
+{
+}
+
+void XbeeResponsesTest::testRx16()
+{
+    RxResponse16 rx;
+
+    QVERIFY2(rx.setPacket(frame(QByteArray::fromHex("81" "0002" "28" "02" "74656d70"))), "Failed to set packet");
+    QVERIFY2(rx.sourceAddress() == 0x0002, "Bad source address");
+    QVERIFY2(rx.rssi() == -40, "Bad RSSI");
+    QVERIFY2(rx.options() == 0x02, "Bad options");
+    QVERIFY2(rx.payload().toByteArray() == "temp", "Bad payload");
+    QVERIFY2(rx.data() == "temp", "Bad data");
+}
+
+void XbeeResponsesTest::testRx64()
+{
+    RxResponse64 rx;
+
+    QVERIFY2(rx.setPacket(frame(QByteArray::fromHex("80" "0013a20040a1b2c3" "3c" "00" "68756d"))), "Failed to set packet");
+    QVERIFY2(rx.sourceAddress() == Q_UINT64_C(0x0013A20040A1B2C3), "Bad source address");
+    QVERIFY2(rx.rssi() == -60, "Bad RSSI");
+    QVERIFY2(rx.options() == 0x00, "Bad options");
+    QVERIFY2(rx.data() == "hum", "Bad data");
+}
+
+/**
+ * A field set before its first access must not be overwritten by the lazy decoding.
+ */
+void XbeeResponsesTest::testSetterBeforeAccess()
+{
+    RxResponse16 rx;
+
+    QVERIFY2(rx.setPacket(frame(QByteArray::fromHex("81" "0002" "28" "02" "74656d70"))), "Failed to set packet");
+    rx.setRSSI(-10);
+    rx.setSourceAddress(0x0005);
+    QVERIFY2(rx.rssi() == -10, "Set RSSI overwritten by the packet's");
+    QVERIFY2(rx.sourceAddress() == 0x0005, "Set source address overwritten by the packet's");
+    QVERIFY2(rx.options() == 0x02, "Options not decoded from the packet");
+
+    rx.setData("set");
+    QVERIFY2(rx.data() == "set", "Set data overwritten by the packet's");
+    QVERIFY2(rx.payload().toByteArray() == "set", "Payload doesn't follow the set data");
+}
+
+/**
+ * Setting another packet drops the fields decoded from the previous one.
+ */
+void XbeeResponsesTest::testReuse()
+{
+    RxResponse16 rx;
+
+    QVERIFY2(rx.setPacket(frame(QByteArray::fromHex("81" "0002" "28" "02" "74656d70"))), "Failed to set packet");
+    QVERIFY2(rx.sourceAddress() == 0x0002, "Bad source address");
+    QVERIFY2(rx.rssi() == -40, "Bad RSSI");
+    QVERIFY2(rx.data() == "temp", "Bad data");
+
+    QVERIFY2(rx.setPacket(frame(QByteArray::fromHex("81" "00ab" "50" "01" "6f6b"))), "Failed to set packet");
+    QVERIFY2(rx.sourceAddress() == 0x00AB, "Source address of the previous packet");
+    QVERIFY2(rx.rssi() == -80, "RSSI of the previous packet");
+    QVERIFY2(rx.options() == 0x01, "Options of the previous packet");
+    QVERIFY2(rx.data() == "ok", "Data of the previous packet");
+}
+
+/**
+ * Fields of a packet too short to be parsed are never read out of it.
+ */
+void XbeeResponsesTest::testRx16TooShort()
+{
+    RxResponse16 rx;
+
+    rx.setPacket(frame(QByteArray::fromHex("81" "0002" "28")));
+    QVERIFY2(rx.sourceAddress() == 0, "Source address decoded from a short packet");
+    QVERIFY2(rx.rssi() == -1, "RSSI decoded from a short packet");
+    QVERIFY2(rx.options() == 0, "Options decoded from a short packet");
+    QVERIFY2(rx.data().isEmpty(), "Data decoded from a short packet");
+}
+
+void XbeeResponsesTest::testNodeIdentification()
+{
+    ZBIONodeIdentificationResponse ni;
+
+    QVERIFY2(ni.setPacket(nodeIdentificationFrame(QByteArray("ROUTER", 7))), "Failed to set packet");
+    QVERIFY2(ni.senderAddress64() == Q_UINT64_C(0x0013A20040A1B2C3), "Bad sender address 64");
+    QVERIFY2(ni.senderAddress16() == 0x1234, "Bad sender address 16");
+    QVERIFY2(ni.receiveOptions() == 0x02, "Bad receive options");
+    QVERIFY2(ni.remoteAddress16() == 0x5678, "Bad remote address 16");
+    QVERIFY2(ni.remoteAddress64() == Q_UINT64_C(0x0013A20040D4E5F6), "Bad remote address 64");
+    QVERIFY2(ni.nodeIdentifier() == "ROUTER", "Bad node identifier");
+    QVERIFY2(ni.remoteParentAddress16() == 0xFFFE, "Bad remote parent address");
+    QVERIFY2(ni.deviceType() == 0x01, "Bad device type");
+    QVERIFY2(ni.sourceEvent() == 0x01, "Bad source event");
+    QVERIFY2(ni.digiProfileId() == 0xC105, "Bad profile id");
+    QVERIFY2(ni.digiManufacturerId() == 0x101E, "Bad manufacturer id");
+}
+
+void XbeeResponsesTest::testNodeIdentificationEmptyIdentifier()
+{
+    ZBIONodeIdentificationResponse ni;
+
+    QVERIFY2(ni.setPacket(nodeIdentificationFrame(QByteArray(1, '\0'))), "Failed to set packet");
+    QVERIFY2(ni.nodeIdentifier().isEmpty(), "Bad node identifier");
+    QVERIFY2(ni.remoteParentAddress16() == 0xFFFE, "Bad remote parent address");
+    QVERIFY2(ni.digiManufacturerId() == 0x101E, "Bad manufacturer id");
+}
+
+/**
+ * Without its terminating NUL, the identifier's end (hence the trailer) can't be found:
+ * the fixed fields are still decoded, the others are left empty.
+ */
+void XbeeResponsesTest::testNodeIdentificationUnterminated()
+{
+    ZBIONodeIdentificationResponse ni;
+
+    QVERIFY2(ni.setPacket(nodeIdentificationFrame("ROUTER")), "Failed to set packet");
+    QVERIFY2(ni.senderAddress16() == 0x1234, "Bad sender address 16");
+    QVERIFY2(ni.remoteAddress64() == Q_UINT64_C(0x0013A20040D4E5F6), "Bad remote address 64");
+    QVERIFY2(ni.nodeIdentifier().isEmpty(), "Unterminated node identifier decoded");
+    QVERIFY2(ni.remoteParentAddress16() == 0, "Trailer decoded without node identifier");
+    QVERIFY2(ni.digiManufacturerId() == 0, "Trailer decoded without node identifier");
+
+    // Terminated, but the trailer is truncated
+    QByteArray truncated = nodeIdentificationFrame(QByteArray("ROUTER", 7));
+    truncated.remove(truncated.size() - 3, 2);
+    QVERIFY2(ni.setPacket(truncated), "Failed to set packet");
+    QVERIFY2(ni.nodeIdentifier().isEmpty(), "Node identifier decoded without trailer");
+    QVERIFY2(ni.deviceType() == 0, "Truncated trailer decoded");
+}
+
+QTEST_GUILESS_MAIN(XbeeResponsesTest)
+
+#include "tst_xbeeresponsestest.moc"
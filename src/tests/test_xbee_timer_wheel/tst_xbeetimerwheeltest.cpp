@@ -0,0 +1,266 @@
+#include <QString>
+#include <QtTest>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QThread>
+
+#include <TimerWheel>
+#include <WheelTimer>
+
+using namespace QtXBee;
+
+// Expiries are rounded to the wheel's 1 ms tick
+static const int Tick = 1;
+
+/**
+ * Records the order in which the timers connected to record() expire.
+ */
+class TimeoutRecorder : public QObject
+{
+    Q_OBJECT
+public:
+    QList<QObject*> order;
+
+public slots:
+    void record() { order.append(sender()); }
+};
+
+class XbeeTimerWheelTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    XbeeTimerWheelTest();
+
+private Q_SLOTS:
+    void testNextTimeout();
+    void testSingleShot();
+    void testPeriodic();
+    void testCascade();
+    void testCascadeSecondLevel();
+    void testLateProcessing();
+    void testOverflow();
+    void testStop();
+
+private:
+    void drive(QSignalSpy * spy, const int count, const int msecs);
+};
+
+XbeeTimerWheelTest::XbeeTimerWheelTest()
+{
+}
+
+/**
+ * Drives the current thread's wheel without event loop, the way XBee::pump() does,
+ * until @a spy has recorded @a count timeouts or @a msecs elapsed.
+ */
+void XbeeTimerWheelTest::drive(QSignalSpy *spy, const int count, const int msecs)
+{
+    TimerWheel * wheel = TimerWheel::instance();
+    QElapsedTimer timer;
+
+    timer.start();
+    while(spy->count() < count && timer.elapsed() < msecs) {
+        const int next = wheel->nextTimeout();
+        const qint64 remaining = msecs - timer.elapsed();
+        QThread::msleep((unsigned long)qMax(Q_INT64_C(0), next < 0 ? remaining : qMin(qint64(next), remaining)));
+        wheel->processTimers();
+    }
+}
+
+void XbeeTimerWheelTest::testNextTimeout()
+{
+    TimerWheel * wheel = TimerWheel::instance();
+    WheelTimer timer;
+
+    QVERIFY2(wheel->count() == 0, "Timers armed before the test");
+    QVERIFY2(wheel->nextTimeout() == -1, "Next timeout without armed timer");
+
+    timer.setSingleShot(true);
+    timer.start(50);
+    QVERIFY2(wheel->count() == 1, "Bad armed timers count");
+    QVERIFY2(wheel->nextTimeout() >= 0 && wheel->nextTimeout() <= 50, "Bad next timeout");
+
+    // Nothing expires before the next timeout
+    QSignalSpy spy(&timer, SIGNAL(timeout()));
+    wheel->processTimers();
+    QVERIFY2(spy.count() == 0, "Timer expired early");
+    QVERIFY2(timer.isActive(), "Timer stopped early");
+
+    timer.stop();
+    QVERIFY2(wheel->count() == 0, "Stopped timer still counted");
+    QVERIFY2(wheel->nextTimeout() == -1, "Next timeout of a stopped timer");
+}
+
+void XbeeTimerWheelTest::testSingleShot()
+{
+    WheelTimer timer;
+    QSignalSpy spy(&timer, SIGNAL(timeout()));
+    QElapsedTimer clock;
+
+    timer.setSingleShot(true);
+    clock.start();
+    timer.start(30);
+    drive(&spy, 1, 1000);
+    QVERIFY2(spy.count() == 1, "Timer didn't expire");
+    QVERIFY2(clock.elapsed() >= 30 - Tick, "Timer expired early");
+    QVERIFY2(!timer.isActive(), "Single shot timer still active");
+    QVERIFY2(TimerWheel::instance()->nextTimeout() == -1, "Next timeout after the last timer");
+}
+
+void XbeeTimerWheelTest::testPeriodic()
+{
+    WheelTimer timer;
+    QSignalSpy spy(&timer, SIGNAL(timeout()));
+    QElapsedTimer clock;
+
+    clock.start();
+    timer.start(20);
+    drive(&spy, 5, 2000);
+    QVERIFY2(spy.count() == 5, "Periodic timer didn't expire 5 times");
+    QVERIFY2(clock.elapsed() >= 100 - Tick, "Periodic timer expired early");
+    QVERIFY2(timer.isActive(), "Periodic timer stopped");
+    timer.stop();
+}
+
+/**
+ * Timers beyond the first level (64 ms) move down when their slot is reached,
+ * and expire in order with the first level's ones.
+ */
+void XbeeTimerWheelTest::testCascade()
+{
+    TimeoutRecorder recorder;
+    WheelTimer late, early, middle;
+    QSignalSpy spy(&late, SIGNAL(timeout()));
+
+    foreach(WheelTimer * timer, QList<WheelTimer*>() << &late << &early << &middle) {
+        timer->setSingleShot(true);
+        connect(timer, SIGNAL(timeout()), &recorder, SLOT(record()));
+    }
+    QElapsedTimer clock;
+    clock.start();
+    late.start(300);
+    early.start(20);
+    middle.start(130);
+
+    drive(&spy, 1, 2000);
+    QVERIFY2(spy.count() == 1, "Cascaded timer didn't expire");
+    QVERIFY2(clock.elapsed() >= 300 - Tick, "Cascaded timer expired early");
+    QVERIFY2(recorder.order == QList<QObject*>() << &early << &middle << &late, "Timers expired out of order");
+}
+
+/**
+ * A timer beyond the second level (4096 ms) moves down twice.
+ */
+void XbeeTimerWheelTest::testCascadeSecondLevel()
+{
+    WheelTimer timer;
+    QSignalSpy spy(&timer, SIGNAL(timeout()));
+    QElapsedTimer clock;
+
+    timer.setSingleShot(true);
+    clock.start();
+    timer.start(4200);
+    drive(&spy, 1, 6000);
+    QVERIFY2(spy.count() == 1, "Cascaded timer didn't expire");
+    QVERIFY2(clock.elapsed() >= 4200 - Tick, "Cascaded timer expired early");
+}
+
+/**
+ * Processing the wheel late fires all the expired timers, across levels, in expiry order.
+ */
+void XbeeTimerWheelTest::testLateProcessing()
+{
+    TimerWheel * wheel = TimerWheel::instance();
+    TimeoutRecorder recorder;
+    WheelTimer first, second, third, pending;
+
+    foreach(WheelTimer * timer, QList<WheelTimer*>() << &first << &second << &third << &pending) {
+        timer->setSingleShot(true);
+        connect(timer, SIGNAL(timeout()), &recorder, SLOT(record()));
+    }
+    third.start(120);
+    first.start(10);
+    second.start(70);
+    pending.start(1000);
+
+    QThread::msleep(150);
+    wheel->processTimers();
+    QVERIFY2(recorder.order == QList<QObject*>() << &first << &second << &third, "Timers expired out of order");
+    QVERIFY2(pending.isActive(), "Pending timer expired");
+    QVERIFY2(wheel->count() == 1, "Bad armed timers count");
+    QVERIFY2(wheel->nextTimeout() >= 0 && wheel->nextTimeout() <= 850, "Bad next timeout");
+}
+
+/**
+ * Timers beyond the last level (about 12 days) wait in the overflow list,
+ * without disturbing the others, until restarted or stopped.
+ */
+void XbeeTimerWheelTest::testOverflow()
+{
+    TimerWheel * wheel = TimerWheel::instance();
+    const qint64 range = Q_INT64_C(1) << (TimerWheel::SlotBits*TimerWheel::Levels);
+    const int thirteenDays = 13*24*3600*1000;
+    WheelTimer overflow, shortTimer;
+    QSignalSpy overflowSpy(&overflow, SIGNAL(timeout()));
+    QSignalSpy shortSpy(&shortTimer, SIGNAL(timeout()));
+
+    QVERIFY2(thirteenDays > range, "Timer not beyond the last level");
+    overflow.setSingleShot(true);
+    overflow.start(thirteenDays);
+    QVERIFY2(wheel->count() == 1, "Overflow timer not counted");
+    QVERIFY2(overflow.remainingTime() > range - 1000, "Bad remaining time");
+    // The wheel wakes up when the overflow list must be cascaded, before the timer's expiry
+    QVERIFY2(wheel->nextTimeout() > 0 && wheel->nextTimeout() <= range, "Bad next timeout");
+
+    shortTimer.setSingleShot(true);
+    shortTimer.start(20);
+    QVERIFY2(wheel->nextTimeout() <= 20, "Short timer hidden by the overflow one");
+    drive(&shortSpy, 1, 1000);
+    QVERIFY2(shortSpy.count() == 1, "Short timer didn't expire");
+    QVERIFY2(overflowSpy.count() == 0, "Overflow timer expired");
+    QVERIFY2(overflow.isActive(), "Overflow timer stopped");
+    QVERIFY2(wheel->count() == 1, "Bad armed timers count");
+
+    // Restarted out of the overflow list
+    overflow.start(20);
+    drive(&overflowSpy, 1, 1000);
+    QVERIFY2(overflowSpy.count() == 1, "Restarted overflow timer didn't expire");
+
+    overflow.start(thirteenDays);
+    overflow.stop();
+    QVERIFY2(wheel->count() == 0, "Stopped overflow timer still counted");
+    QVERIFY2(wheel->nextTimeout() == -1, "Next timeout of a stopped overflow timer");
+}
+
+/**
+ * Stopping or deleting a timer of a cascaded level removes it from the wheel.
+ */
+void XbeeTimerWheelTest::testStop()
+{
+    TimerWheel * wheel = TimerWheel::instance();
+    WheelTimer stopped, kept;
+    WheelTimer * deleted = new WheelTimer();
+    QSignalSpy stoppedSpy(&stopped, SIGNAL(timeout()));
+    QSignalSpy keptSpy(&kept, SIGNAL(timeout()));
+
+    stopped.setSingleShot(true);
+    kept.setSingleShot(true);
+    stopped.start(100);
+    deleted->start(100);
+    kept.start(150);
+    QVERIFY2(wheel->count() == 3, "Bad armed timers count");
+
+    stopped.stop();
+    delete deleted;
+    QVERIFY2(wheel->count() == 1, "Stopped timers still counted");
+
+    drive(&keptSpy, 1, 1000);
+    QVERIFY2(keptSpy.count() == 1, "Kept timer didn't expire");
+    QVERIFY2(stoppedSpy.count() == 0, "Stopped timer expired");
+    QVERIFY2(wheel->count() == 0, "Bad armed timers count");
+}
+
+QTEST_GUILESS_MAIN(XbeeTimerWheelTest)
+
+#include "tst_xbeetimerwheeltest.moc"
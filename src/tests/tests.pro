@@ -8,7 +8,22 @@ TEMPLATE = subdirs
 
 SUBDIRS += \
     test_xbee_serial_port \
-    test_xbee_commands_send
+    test_xbee_commands_send \
+    test_xbee_at_parameters \
+    test_xbee_frame_template \
+    test_xbee_codec \
+    test_xbee_frame_tracer \
+    test_xbee_profile \
+    test_xbee_frame_filter \
+    test_xbee_await \
+    test_xbee_frame_ring \
+    test_xbee_frame_id_allocator \
+    test_xbee_responses \
+    test_xbee_byte_slice \
+    test_xbee_mpsc_queue \
+    test_xbee_timer_wheel
+
+linux: SUBDIRS += test_xbee_linux_transport
 
 OTHER_FILES += \
     tests.pri